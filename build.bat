@@ -113,6 +113,15 @@ REM Start logging all output
     REM gcc ./src/seperate/launcher/launcher.c -o ./dist/Tread -lkernel32 -lm
     gcc ./src/seperate/animator/animator.c -o ./dist/anim -lkernel32 -lm
     gcc ./src/seperate/libloader/libloader.c -o ./dist/libloader -lkernel32 -lm
+    gcc ./src/seperate/logview/logview.c -o ./dist/logview -lkernel32 -lm
+    gcc ./src/seperate/pathbench/pathbench.c -o ./dist/pathbench -lkernel32 -lm
+    gcc ./src/seperate/swarm/swarm.c -o ./dist/swarm -O2 -lkernel32 -lm
+    gcc ./src/seperate/spatialbench/spatialbench.c -o ./dist/spatialbench -lkernel32 -lm
+    gcc ./src/seperate/particles/particles.c -o ./dist/particles -O2 -lkernel32 -lm
+    gcc ./src/seperate/effects/effects.c -o ./dist/effects -lkernel32 -lws2_32 -lm
+    gcc ./src/seperate/tread-view/tread-view.c -o ./dist/tread-view -lkernel32 -lws2_32 -lm
+    gcc ./src/seperate/tread-top/tread-top.c -o ./dist/tread-top -lkernel32 -lm
+    gcc ./src/seperate/tread-bench/tread-bench.c -o ./dist/tread-bench -lkernel32 -lm
 
     REM Libs for libloader to load:
     gcc -shared ./src/seperate/libloader/libs/counter.c -o ./dist/libs/counter.dll -lm
@@ -125,6 +134,8 @@ REM Start logging all output
     gcc ./src/games/2D/tgame.c -o ./dist/2D/tgame -lkernel32 -lm
     gcc ./src/games/2D/pacman.c -o ./dist/2D/trpacman -lkernel32 -lm
     gcc ./src/games/2D/snake.c -o ./dist/2D/trsnake -lkernel32 -lm
+    gcc ./src/games/2D/life.c -o ./dist/2D/trlife -lkernel32 -lm
+    gcc ./src/games/2D/netsnake.c -o ./dist/2D/trnetsnake -lkernel32 -lws2_32 -lm
 
     if exist dist\logger.exe (
       dist\logger.exe -t Note -c "All files have been built."
@@ -146,6 +157,15 @@ REM Start logging all output
     REM clang ./src/seperate/launcher/launcher.c -o ./dist/Tread -lkernel32 -lm
     clang ./src/seperate/animator/animator.c -o ./dist/anim -lkernel32 -lm
     clang ./src/seperate/libloader/libloader.c -o ./dist/libloader -lkernel32 -lm
+    clang ./src/seperate/logview/logview.c -o ./dist/logview -lkernel32 -lm
+    clang ./src/seperate/pathbench/pathbench.c -o ./dist/pathbench -lkernel32 -lm
+    clang ./src/seperate/swarm/swarm.c -o ./dist/swarm -O2 -lkernel32 -lm
+    clang ./src/seperate/spatialbench/spatialbench.c -o ./dist/spatialbench -lkernel32 -lm
+    clang ./src/seperate/particles/particles.c -o ./dist/particles -O2 -lkernel32 -lm
+    clang ./src/seperate/effects/effects.c -o ./dist/effects -lkernel32 -lws2_32 -lm
+    clang ./src/seperate/tread-view/tread-view.c -o ./dist/tread-view -lkernel32 -lws2_32 -lm
+    clang ./src/seperate/tread-top/tread-top.c -o ./dist/tread-top -lkernel32 -lm
+    clang ./src/seperate/tread-bench/tread-bench.c -o ./dist/tread-bench -lkernel32 -lm
 
     REM Libs for libloader to load:
     clang -shared ./src/seperate/libloader/libs/counter.c -o ./dist/libs/counter.dll -lm
@@ -158,6 +178,8 @@ REM Start logging all output
     clang ./src/games/2D/tgame.c -o ./dist/2D/tgame -lkernel32 -lm
     clang ./src/games/2D/pacman.c -o ./dist/2D/trpacman -lkernel32 -lm
     clang ./src/games/2D/snake.c -o ./dist/2D/trsnake -lkernel32 -lm
+    clang ./src/games/2D/life.c -o ./dist/2D/trlife -lkernel32 -lm
+    clang ./src/games/2D/netsnake.c -o ./dist/2D/trnetsnake -lkernel32 -lws2_32 -lm
 
     if exist dist\logger.exe (
       dist\logger.exe -t Note -c "All files have been built."
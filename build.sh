@@ -101,7 +101,7 @@ fi
     COMPILER="gcc"
 
     # The notes about building. (logger functionality simplified for bash)
-    $COMPILER ./src/logger.c -o ./dist/logger
+    $COMPILER ./src/logger.c -o ./dist/logger -pthread
     if [ -f dist/logger ]; then
       ./dist/logger -t Note -c "Building with GCC..."
     fi
@@ -112,7 +112,16 @@ fi
     # Main working bits:
     $COMPILER ./src/seperate/launcher/launcher.c -o ./dist/Tread -lm
     $COMPILER ./src/seperate/animator/animator.c -o ./dist/anim -lm
-    $COMPILER ./src/seperate/libloader/libloader.c -o ./dist/libloader -lm
+    $COMPILER ./src/seperate/libloader/libloader.c -o ./dist/libloader -lm -pthread
+    $COMPILER ./src/seperate/logview/logview.c -o ./dist/logview -lm -pthread
+    $COMPILER ./src/seperate/pathbench/pathbench.c -o ./dist/pathbench -lm
+    $COMPILER ./src/seperate/swarm/swarm.c -o ./dist/swarm -O2 -lm
+    $COMPILER ./src/seperate/spatialbench/spatialbench.c -o ./dist/spatialbench -lm
+    $COMPILER ./src/seperate/particles/particles.c -o ./dist/particles -O2 -lm -pthread
+    $COMPILER ./src/seperate/effects/effects.c -o ./dist/effects -lm
+    $COMPILER ./src/seperate/tread-view/tread-view.c -o ./dist/tread-view -lm
+    $COMPILER ./src/seperate/tread-top/tread-top.c -o ./dist/tread-top -lm
+    $COMPILER ./src/seperate/tread-bench/tread-bench.c -o ./dist/tread-bench -lm
 
     # Libs for libloader to load:
     $COMPILER -shared -fPIC ./src/seperate/libloader/libs/counter.c -o ./dist/libs/counter.so -lm
@@ -123,8 +132,10 @@ fi
 
     # Testing game executables:
     $COMPILER ./src/games/2D/tgame.c -o ./dist/2D/tgame -lm
-    $COMPILER ./src/games/2D/pacman.c -o ./dist/2D/trpacman -lm
-    $COMPILER ./src/games/2D/snake.c -o ./dist/2D/trsnake -lm
+    $COMPILER ./src/games/2D/pacman.c -o ./dist/2D/trpacman -lm -pthread
+    $COMPILER ./src/games/2D/snake.c -o ./dist/2D/trsnake -lm -pthread
+    $COMPILER ./src/games/2D/life.c -o ./dist/2D/trlife -lm -pthread
+    $COMPILER ./src/games/2D/netsnake.c -o ./dist/2D/trnetsnake -lm
 
     if [ -f dist/logger ]; then
       ./dist/logger -t Note -c "All files have been built."
@@ -136,7 +147,7 @@ fi
     COMPILER="clang"
 
     # The notes about building. (logger functionality simplified for bash)
-    $COMPILER ./src/logger.c -o ./dist/logger
+    $COMPILER ./src/logger.c -o ./dist/logger -pthread
     if [ -f dist/logger ]; then
       ./dist/logger -t Note -c "Building with Clang..."
     fi
@@ -147,7 +158,16 @@ fi
     # Main working bits:
     $COMPILER ./src/seperate/launcher/launcher.c -o ./dist/Tread -lm
     $COMPILER ./src/seperate/animator/animator.c -o ./dist/anim -lm
-    $COMPILER ./src/seperate/libloader/libloader.c -o ./dist/libloader -lm
+    $COMPILER ./src/seperate/libloader/libloader.c -o ./dist/libloader -lm -pthread
+    $COMPILER ./src/seperate/logview/logview.c -o ./dist/logview -lm -pthread
+    $COMPILER ./src/seperate/pathbench/pathbench.c -o ./dist/pathbench -lm
+    $COMPILER ./src/seperate/swarm/swarm.c -o ./dist/swarm -O2 -lm
+    $COMPILER ./src/seperate/spatialbench/spatialbench.c -o ./dist/spatialbench -lm
+    $COMPILER ./src/seperate/particles/particles.c -o ./dist/particles -O2 -lm -pthread
+    $COMPILER ./src/seperate/effects/effects.c -o ./dist/effects -lm
+    $COMPILER ./src/seperate/tread-view/tread-view.c -o ./dist/tread-view -lm
+    $COMPILER ./src/seperate/tread-top/tread-top.c -o ./dist/tread-top -lm
+    $COMPILER ./src/seperate/tread-bench/tread-bench.c -o ./dist/tread-bench -lm
 
     # Libs for libloader to load:
     $COMPILER -shared -fPIC ./src/seperate/libloader/libs/counter.c -o ./dist/libs/counter.so -lm
@@ -158,8 +178,10 @@ fi
 
     # Testing game executables:
     $COMPILER ./src/games/2D/tgame.c -o ./dist/2D/tgame -lm
-    $COMPILER ./src/games/2D/pacman.c -o ./dist/2D/trpacman -lm
-    $COMPILER ./src/games/2D/snake.c -o ./dist/2D/trsnake -lm
+    $COMPILER ./src/games/2D/pacman.c -o ./dist/2D/trpacman -lm -pthread
+    $COMPILER ./src/games/2D/snake.c -o ./dist/2D/trsnake -lm -pthread
+    $COMPILER ./src/games/2D/life.c -o ./dist/2D/trlife -lm -pthread
+    $COMPILER ./src/games/2D/netsnake.c -o ./dist/2D/trnetsnake -lm
 
     if [ -f dist/logger ]; then
       ./dist/logger -t Note -c "All files have been built."
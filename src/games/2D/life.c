@@ -0,0 +1,645 @@
+#define TR_HEADLESS // For TR_Rng and TR_GetCPUCount
+#include "../../tread.h"
+
+#include <time.h>   // For time (to seed the soup)
+#include <ctype.h>  // For toupper (reading rules)
+
+// --- Game Configuration ---
+#define FPS 30
+#define MAX_THREADS 64
+#define MAX_STATES 256         // Generations rules can have up to this many states
+#define MAX_PLANES 8           // Bit-planes for a dying cell's age, enough for MAX_STATES
+#define MAX_STEPS_PER_FRAME 64
+#define MIN_SIZE 8
+#define MAX_SIZE 65536
+#define BENCH_SIZE 4096        // Default benchmark grid is BENCH_SIZE x BENCH_SIZE
+#define BENCH_GENERATIONS 100
+
+// --- Game Colors ---
+#define ALIVE_COLOR LIME
+#define BG_COLOR    BLACK
+#define TEXT_COLOR  RAYWHITE
+#define BAR_COLOR   DARKGRAY
+
+// --- Render Modes ---
+// Braille packs 2x4 cells into a character, half blocks 1x2, and ASCII one cell each
+enum { MODE_BRAILLE, MODE_HALF, MODE_ASCII, NUM_MODES };
+static const char* const MODE_NAMES[NUM_MODES] = { "braille", "half blocks", "ASCII" };
+
+// --- Rules ---
+// Written as B<counts>/S<counts>, plus /C<states> for Generations rules, where a cell
+// that dies goes through states - 2 dying states before it's dead and can be born again
+typedef struct {
+  const char* name;
+  const char* rule;
+} Preset;
+
+static const Preset PRESETS[] = {
+  { "Life", "B3/S23" },
+  { "HighLife", "B36/S23" },
+  { "Day & Night", "B3678/S34678" },
+  { "Seeds", "B2/S" },
+  { "Brian's Brain", "B2/S/C3" },
+  { "Star Wars", "B2/S345/C4" },
+};
+#define NUM_PRESETS (int)(sizeof(PRESETS) / sizeof(PRESETS[0]))
+
+typedef struct {
+  unsigned short birth;   // Bit n set: a dead cell with n live neighbors is born
+  unsigned short survive; // Bit n set: a live cell with n live neighbors stays alive
+  int states;             // 2 for Life-like rules
+} Rule;
+
+// --- Game State Structs ---
+// The grid is a torus stored as bitboards: bit i of word j of a row is column
+// j * 64 + i, and bits past the last column are always 0. A step counts all 64
+// neighborhoods of a word at once with bitwise adders (one bit-plane per bit of the
+// count), so it costs the same however busy the grid is.
+typedef struct {
+  int width;
+  int height;
+  int words;           // 64-bit words per row
+  int last_bit;        // Bit of the last column in a row's last word
+  uint64_t last_mask;  // Bits of a row's last word that are inside the grid
+  Rule rule;
+  int planes;          // Bit-planes for the dying age (0 for Life-like rules)
+  uint64_t* alive;     // height * words, for the current generation
+  uint64_t* next_alive;
+  // A dying cell's age (1 to states - 2) in binary, one plane per bit; 0 if not dying
+  uint64_t* age[MAX_PLANES];
+  uint64_t* next_age[MAX_PLANES];
+  long long generation;
+} Life;
+
+// Threads that each step a band of rows. They stay parked between steps, so a step
+// doesn't pay for starting threads.
+typedef struct WorkerPool WorkerPool;
+
+typedef struct {
+  WorkerPool* pool;
+  int index;
+} WorkerArg;
+
+struct WorkerPool {
+  Life* life;
+  int threads;        // Bands per step, the calling thread included
+  int step;           // Bumped to start a step
+  int busy;           // Workers still stepping their band
+  bool quit;
+  WorkerArg args[MAX_THREADS];
+#ifdef _WIN32
+  HANDLE workers[MAX_THREADS];
+  CRITICAL_SECTION lock;
+  CONDITION_VARIABLE wake;
+  CONDITION_VARIABLE done;
+#else
+  pthread_t workers[MAX_THREADS];
+  pthread_mutex_t lock;
+  pthread_cond_t wake;
+  pthread_cond_t done;
+#endif
+};
+
+#ifdef _WIN32
+  #define POOL_LOCK(pool) EnterCriticalSection(&(pool)->lock)
+  #define POOL_UNLOCK(pool) LeaveCriticalSection(&(pool)->lock)
+  #define POOL_WAIT(pool, cond) SleepConditionVariableCS(&(pool)->cond, &(pool)->lock, INFINITE)
+  #define POOL_WAKE_ALL(pool, cond) WakeAllConditionVariable(&(pool)->cond)
+#else
+  #define POOL_LOCK(pool) pthread_mutex_lock(&(pool)->lock)
+  #define POOL_UNLOCK(pool) pthread_mutex_unlock(&(pool)->lock)
+  #define POOL_WAIT(pool, cond) pthread_cond_wait(&(pool)->cond, &(pool)->lock)
+  #define POOL_WAKE_ALL(pool, cond) pthread_cond_broadcast(&(pool)->cond)
+#endif
+
+// --- Function Prototypes ---
+bool ParseRule(const char* text, Rule* rule);
+bool InitLife(Life* life, int width, int height, const Rule* rule);
+void FreeLife(Life* life);
+void RandomizeLife(Life* life, TR_Rng* rng);
+void StepRows(Life* life, int first_row, int end_row);
+long long CountAlive(const Life* life);
+int CellState(const Life* life, int x, int y);
+void StartWorkers(WorkerPool* pool, Life* life, int threads);
+void StopWorkers(WorkerPool* pool);
+void Step(WorkerPool* pool);
+void DrawLife(const Life* life, int mode, int columns, int rows);
+int RunBenchmark(int width, int height, int generations, int threads, const Rule* rule, const char* rule_text);
+
+int main(int argc, char* argv[]) {
+  // Usage: trlife [-r rule] [-j threads]
+  //        trlife -b [width height] [-n generations] [-j threads] [-r rule]
+  bool benchmark = false;
+  int threads = 0; // 0 for one per core
+  int generations = BENCH_GENERATIONS;
+  const char* rule_text = PRESETS[0].rule;
+  int positional[2];
+  int num_positional = 0;
+  for (int i = 1; i < argc; i++) {
+    bool has_value = (i + 1 < argc);
+    if (strcmp(argv[i], "-b") == 0) benchmark = true;
+    else if (strcmp(argv[i], "-n") == 0 && has_value) generations = atoi(argv[++i]);
+    else if (strcmp(argv[i], "-j") == 0 && has_value) threads = atoi(argv[++i]);
+    else if (strcmp(argv[i], "-r") == 0 && has_value) rule_text = argv[++i];
+    else if (argv[i][0] != '-' && num_positional < 2) positional[num_positional++] = atoi(argv[i]);
+    else num_positional = -1;
+    if (num_positional < 0) break;
+  }
+  Rule rule;
+  if (num_positional < 0 || num_positional == 1 || (num_positional == 2 && !benchmark)) {
+    fprintf(stderr, "Usage: %s [-r rule] [-j threads]\n", argv[0]);
+    fprintf(stderr, "       %s -b [width height] [-n generations] [-j threads] [-r rule]\n", argv[0]);
+    return 1;
+  }
+  if (!ParseRule(rule_text, &rule)) {
+    fprintf(stderr, "ERROR: '%s' isn't a rule like B3/S23 or B2/S/C3 (at most %d states).\n", rule_text, MAX_STATES);
+    return 1;
+  }
+  if (threads < 0 || threads > MAX_THREADS) {
+    fprintf(stderr, "ERROR: The thread count must be between 1 and %d (0 for one per core).\n", MAX_THREADS);
+    return 1;
+  }
+
+  if (benchmark) {
+    int width = (num_positional == 2) ? positional[0] : BENCH_SIZE;
+    int height = (num_positional == 2) ? positional[1] : BENCH_SIZE;
+    if (width < MIN_SIZE || height < MIN_SIZE || width > MAX_SIZE || height > MAX_SIZE || generations < 1) {
+      fprintf(stderr, "ERROR: The grid must be between %dx%d and %dx%d and run at least one generation.\n",
+              MIN_SIZE, MIN_SIZE, MAX_SIZE, MAX_SIZE);
+      return 1;
+    }
+    return RunBenchmark(width, height, generations, threads, &rule, rule_text);
+  }
+
+  TR_Rng rng;
+  TR_RngSeed(&rng, TR_RegisterSeed((uint64_t)time(NULL)));
+  if (threads == 0) threads = TR_GetCPUCount();
+  if (threads > MAX_THREADS) threads = MAX_THREADS;
+
+  int screen_width = TR_GetScreenWidth();
+  int screen_height = TR_GetScreenHeight();
+  TR_InitWindow(screen_width, screen_height, "tread.h - Life");
+  TR_SetTargetFPS(FPS);
+
+  int columns = screen_width;
+  int rows = screen_height - 1; // Bottom row for the status bar
+  int mode = MODE_BRAILLE;
+  int preset = -1; // -1 while running a rule from -r
+  for (int i = 0; i < NUM_PRESETS; i++) {
+    if (strcmp(PRESETS[i].rule, rule_text) == 0) preset = i;
+  }
+  int steps_per_frame = 1;
+  bool paused = false;
+  bool restart = true;
+  Life life;
+  memset(&life, 0, sizeof(life));
+  WorkerPool pool;
+  memset(&pool, 0, sizeof(pool));
+  double step_us = 0.0;
+  double draw_us = 0.0;
+
+  bool running = true;
+  while (running) {
+    // The grid is as many cells as the mode shows on screen, so changing mode restarts it
+    if (restart) {
+      if (pool.threads > 0) StopWorkers(&pool);
+      FreeLife(&life);
+      int scale_x = (mode == MODE_BRAILLE) ? 2 : 1;
+      int scale_y = (mode == MODE_BRAILLE) ? 4 : (mode == MODE_HALF) ? 2 : 1;
+      int width = columns * scale_x;
+      int height = rows * scale_y;
+      if (!InitLife(&life, (width > MIN_SIZE) ? width : MIN_SIZE, (height > MIN_SIZE) ? height : MIN_SIZE, &rule)) {
+        TR_CloseWindow();
+        fprintf(stderr, "ERROR: Failed to set up a %dx%d grid.\n", width, height);
+        return 1;
+      }
+      StartWorkers(&pool, &life, threads);
+      RandomizeLife(&life, &rng);
+      restart = false;
+    }
+
+    bool step_once = false;
+    switch (TR_GetKeyPressed()) {
+      case ' ': paused = !paused; break;
+      case 'n': case 'N': step_once = true; break;
+      case '+': case '=': if (steps_per_frame < MAX_STEPS_PER_FRAME) steps_per_frame *= 2; break;
+      case '-': case '_': if (steps_per_frame > 1) steps_per_frame /= 2; break;
+      case 'r': case 'R': RandomizeLife(&life, &rng); break;
+      case 'm': case 'M': mode = (mode + 1) % NUM_MODES; restart = true; break;
+      case 'c': case 'C':
+        preset = (preset + 1) % NUM_PRESETS;
+        ParseRule(PRESETS[preset].rule, &rule);
+        restart = true;
+        break;
+      case 't': case 'T':
+        threads = (threads < TR_GetCPUCount() && threads * 2 <= MAX_THREADS) ? threads * 2 : 1;
+        StopWorkers(&pool);
+        StartWorkers(&pool, &life, threads);
+        break;
+      case 'q': case 'Q': case TR_KEY_ESCAPE: running = false; break;
+    }
+    if (restart) continue;
+
+    int steps = paused ? (step_once ? 1 : 0) : steps_per_frame;
+    long long start_ns = __tr_get_time_ns();
+    for (int i = 0; i < steps; i++) Step(&pool);
+    long long stepped_ns = __tr_get_time_ns();
+
+    TR_BeginDrawing();
+    TR_ClearBackground(BG_COLOR);
+    DrawLife(&life, mode, columns, rows);
+    long long drawn_ns = __tr_get_time_ns();
+
+    // Smooth the timings so they can be read
+    if (steps > 0) step_us = step_us * 0.9 + (double)(stepped_ns - start_ns) / 1e3 / steps * 0.1;
+    draw_us = draw_us * 0.9 + (double)(drawn_ns - stepped_ns) / 1e3 * 0.1;
+
+    char status[320];
+    snprintf(status, sizeof(status),
+             " Gen %lld | %lld alive | step %.0f us | draw %.0f us | %s | %s | x%d | %d thread%s%s"
+             " | Space: Pause  N: Step  +/-: Speed  C: Rule  M: Mode  T: Threads  R: Reseed  Q: Quit",
+             life.generation, CountAlive(&life), step_us, draw_us, (preset >= 0) ? PRESETS[preset].name : rule_text,
+             MODE_NAMES[mode], steps_per_frame, pool.threads, pool.threads == 1 ? "" : "s", paused ? " (paused)" : "");
+    TR_DrawRectangle(0, screen_height - 1, screen_width, 1, TEXT_COLOR, BAR_COLOR);
+    TR_DrawText(status, 0, screen_height - 1, 10, TEXT_COLOR, BAR_COLOR);
+
+    TR_EndDrawing();
+  }
+
+  StopWorkers(&pool);
+  FreeLife(&life);
+  TR_CloseWindow();
+  return 0;
+}
+
+// --- Engine ---
+
+// Reads a rule like "B3/S23" or "B2/S/C3" (case doesn't matter). Returns false if it isn't one.
+bool ParseRule(const char* text, Rule* rule) {
+  memset(rule, 0, sizeof(*rule));
+  rule->states = 2;
+  bool seen_birth = false;
+  bool seen_survive = false;
+  const char* c = text;
+  while (*c != '\0') {
+    char part = (char)toupper((unsigned char)*c++);
+    if (part == 'B' || part == 'S') {
+      unsigned short* set = (part == 'B') ? &rule->birth : &rule->survive;
+      if (part == 'B') seen_birth = true;
+      else seen_survive = true;
+      while (*c >= '0' && *c <= '8') *set |= (unsigned short)(1 << (*c++ - '0'));
+    } else if (part == 'C' || part == 'G') {
+      int states = 0;
+      while (*c >= '0' && *c <= '9' && states <= MAX_STATES) states = states * 10 + (*c++ - '0');
+      if (states < 2 || states > MAX_STATES) return false;
+      rule->states = states;
+    } else {
+      return false;
+    }
+    if (*c == '/') c++;
+    else if (*c != '\0') return false;
+  }
+  return seen_birth && seen_survive && !(rule->birth & 1); // B0 would flash the whole torus
+}
+
+// Sets up an empty grid. Returns false if it couldn't be allocated.
+bool InitLife(Life* life, int width, int height, const Rule* rule) {
+  memset(life, 0, sizeof(*life));
+  life->width = width;
+  life->height = height;
+  life->words = (width + 63) / 64;
+  life->last_bit = (width - 1) % 64;
+  life->last_mask = (life->last_bit == 63) ? ~0ULL : ((1ULL << (life->last_bit + 1)) - 1);
+  life->rule = *rule;
+  while ((1 << life->planes) < rule->states - 1) life->planes++; // Ages 0 to states - 2
+  size_t words = (size_t)life->words * height;
+  life->alive = (uint64_t*)calloc(words, sizeof(uint64_t));
+  life->next_alive = (uint64_t*)calloc(words, sizeof(uint64_t));
+  bool ok = (life->alive != NULL && life->next_alive != NULL);
+  for (int p = 0; p < life->planes; p++) {
+    life->age[p] = (uint64_t*)calloc(words, sizeof(uint64_t));
+    life->next_age[p] = (uint64_t*)calloc(words, sizeof(uint64_t));
+    ok = ok && life->age[p] != NULL && life->next_age[p] != NULL;
+  }
+  if (!ok) FreeLife(life);
+  return ok;
+}
+
+void FreeLife(Life* life) {
+  free(life->alive);
+  free(life->next_alive);
+  for (int p = 0; p < MAX_PLANES; p++) {
+    free(life->age[p]);
+    free(life->next_age[p]);
+  }
+  memset(life, 0, sizeof(*life));
+}
+
+// Fills the grid with a random soup, 3/8 of it alive
+void RandomizeLife(Life* life, TR_Rng* rng) {
+  for (int y = 0; y < life->height; y++) {
+    uint64_t* row = &life->alive[(size_t)y * life->words];
+    for (int j = 0; j < life->words; j++) {
+      uint64_t a = TR_RngNext(rng);
+      uint64_t b = TR_RngNext(rng);
+      uint64_t c = TR_RngNext(rng);
+      row[j] = a & (b | c);
+    }
+    row[life->words - 1] &= life->last_mask;
+  }
+  for (int p = 0; p < life->planes; p++) memset(life->age[p], 0, sizeof(uint64_t) * (size_t)life->words * life->height);
+  life->generation = 0;
+}
+
+// Each cell's west neighbor: the word shifted up a bit, with the bit before it carried in
+static inline uint64_t WestOf(const Life* life, const uint64_t* row, int j) {
+  uint64_t carry = (j > 0) ? row[j - 1] >> 63 : (row[life->words - 1] >> life->last_bit) & 1;
+  return (row[j] << 1) | carry;
+}
+
+// Each cell's east neighbor; the last column's is the first column of the row
+static inline uint64_t EastOf(const Life* life, const uint64_t* row, int j) {
+  if (j < life->words - 1) return (row[j] >> 1) | (row[j + 1] << 63);
+  return (row[j] >> 1) | ((row[0] & 1) << life->last_bit);
+}
+
+// Cells whose neighbor count (bit-planes n0 to n3) is in `set`
+static inline uint64_t CountIn(unsigned short set, uint64_t n0, uint64_t n1, uint64_t n2, uint64_t n3) {
+  uint64_t result = 0;
+  for (int n = 0; n <= 8; n++) {
+    if (!(set & (1 << n))) continue;
+    result |= ((n & 1) ? n0 : ~n0) & ((n & 2) ? n1 : ~n1) & ((n & 4) ? n2 : ~n2) & ((n & 8) ? n3 : ~n3);
+  }
+  return result;
+}
+
+// Works out rows first_row to end_row - 1 of the next generation. Rows only read the
+// current generation, so bands of rows can run on different threads.
+void StepRows(Life* life, int first_row, int end_row) {
+  int words = life->words;
+  bool conway = (life->rule.birth == (1 << 3) && life->rule.survive == ((1 << 2) | (1 << 3)) && life->rule.states == 2);
+  for (int y = first_row; y < end_row; y++) {
+    const uint64_t* up = &life->alive[(size_t)((y + life->height - 1) % life->height) * words];
+    const uint64_t* mid = &life->alive[(size_t)y * words];
+    const uint64_t* down = &life->alive[(size_t)((y + 1) % life->height) * words];
+    uint64_t* out = &life->next_alive[(size_t)y * words];
+    for (int j = 0; j < words; j++) {
+      uint64_t a = up[j], aw = WestOf(life, up, j), ae = EastOf(life, up, j);
+      uint64_t b = mid[j], bw = WestOf(life, mid, j), be = EastOf(life, mid, j);
+      uint64_t c = down[j], cw = WestOf(life, down, j), ce = EastOf(life, down, j);
+
+      // Add up the eight neighbors: each row's (two for the middle row) into 2 bits,
+      // then the three rows into the 4-bit count n3 n2 n1 n0
+      uint64_t a0 = aw ^ a ^ ae;
+      uint64_t a1 = (aw & a) | (ae & (aw ^ a));
+      uint64_t c0 = cw ^ c ^ ce;
+      uint64_t c1 = (cw & c) | (ce & (cw ^ c));
+      uint64_t b0 = bw ^ be;
+      uint64_t b1 = bw & be;
+      uint64_t s0 = a0 ^ c0;
+      uint64_t k0 = a0 & c0;
+      uint64_t s1 = a1 ^ c1 ^ k0;
+      uint64_t s2 = (a1 & c1) | (k0 & (a1 ^ c1));
+      uint64_t n0 = s0 ^ b0;
+      uint64_t k1 = s0 & b0;
+      uint64_t n1 = s1 ^ b1 ^ k1;
+      uint64_t k2 = (s1 & b1) | (k1 & (s1 ^ b1));
+      uint64_t n2 = s2 ^ k2;
+      uint64_t n3 = s2 & k2;
+
+      uint64_t next;
+      if (conway) {
+        next = ~n3 & ~n2 & n1 & (n0 | b); // 3 neighbors, or 2 and alive
+      } else {
+        size_t index = (size_t)y * words + j;
+        uint64_t dying = 0;
+        for (int p = 0; p < life->planes; p++) dying |= life->age[p][index];
+        uint64_t stays = b & CountIn(life->rule.survive, n0, n1, n2, n3);
+        next = stays | (~b & ~dying & CountIn(life->rule.birth, n0, n1, n2, n3));
+        if (life->planes > 0) {
+          // Dying cells age by one and are dead after the last dying state; cells that
+          // just stopped living start at age 1
+          uint64_t last = dying;
+          int oldest = life->rule.states - 2;
+          for (int p = 0; p < life->planes; p++) last &= ((oldest >> p) & 1) ? life->age[p][index] : ~life->age[p][index];
+          uint64_t carry = dying & ~last;
+          for (int p = 0; p < life->planes; p++) {
+            uint64_t age = life->age[p][index] & ~last;
+            life->next_age[p][index] = age ^ carry;
+            carry &= age;
+          }
+          life->next_age[0][index] |= b & ~stays;
+        }
+      }
+      out[j] = next;
+    }
+    out[words - 1] &= life->last_mask;
+    for (int p = 0; p < life->planes; p++) life->next_age[p][(size_t)y * words + words - 1] &= life->last_mask;
+  }
+}
+
+long long CountAlive(const Life* life) {
+  long long count = 0;
+  size_t words = (size_t)life->words * life->height;
+  for (size_t i = 0; i < words; i++) count += __builtin_popcountll(life->alive[i]);
+  return count;
+}
+
+// 0 for dead, 1 for alive, 2 and up for the dying states
+int CellState(const Life* life, int x, int y) {
+  size_t index = (size_t)y * life->words + (x >> 6);
+  int bit = x & 63;
+  if ((life->alive[index] >> bit) & 1) return 1;
+  int age = 0;
+  for (int p = 0; p < life->planes; p++) age |= (int)((life->age[p][index] >> bit) & 1) << p;
+  return (age > 0) ? age + 1 : 0;
+}
+
+// --- Worker Pool ---
+
+#ifdef _WIN32
+static DWORD WINAPI WorkerMain(LPVOID param) {
+#else
+static void* WorkerMain(void* param) {
+#endif
+  WorkerArg* arg = (WorkerArg*)param;
+  WorkerPool* pool = arg->pool;
+  int seen = 0;
+  POOL_LOCK(pool);
+  for (;;) {
+    while (!pool->quit && pool->step == seen) POOL_WAIT(pool, wake);
+    if (pool->quit) break;
+    seen = pool->step;
+    POOL_UNLOCK(pool);
+    Life* life = pool->life;
+    StepRows(life, (int)((long long)life->height * arg->index / pool->threads),
+             (int)((long long)life->height * (arg->index + 1) / pool->threads));
+    POOL_LOCK(pool);
+    if (--pool->busy == 0) POOL_WAKE_ALL(pool, done);
+  }
+  POOL_UNLOCK(pool);
+  return 0;
+}
+
+// Starts threads - 1 workers (the caller steps the first band). If a thread can't be
+// started the pool makes do with the ones that did.
+void StartWorkers(WorkerPool* pool, Life* life, int threads) {
+  memset(pool, 0, sizeof(*pool));
+  pool->life = life;
+  if (threads > life->height) threads = life->height;
+  pool->threads = 1;
+#ifdef _WIN32
+  InitializeCriticalSection(&pool->lock);
+  InitializeConditionVariable(&pool->wake);
+  InitializeConditionVariable(&pool->done);
+#else
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->wake, NULL);
+  pthread_cond_init(&pool->done, NULL);
+#endif
+  for (int i = 1; i < threads; i++) {
+    pool->args[i].pool = pool;
+    pool->args[i].index = i;
+#ifdef _WIN32
+    pool->workers[i] = CreateThread(NULL, 0, WorkerMain, &pool->args[i], 0, NULL);
+    if (pool->workers[i] == NULL) break;
+#else
+    if (pthread_create(&pool->workers[i], NULL, WorkerMain, &pool->args[i]) != 0) break;
+#endif
+    pool->threads++; // Safe: no step is running yet
+  }
+}
+
+void StopWorkers(WorkerPool* pool) {
+  if (pool->threads == 0) return;
+  POOL_LOCK(pool);
+  pool->quit = true;
+  POOL_WAKE_ALL(pool, wake);
+  POOL_UNLOCK(pool);
+  for (int i = 1; i < pool->threads; i++) {
+#ifdef _WIN32
+    WaitForSingleObject(pool->workers[i], INFINITE);
+    CloseHandle(pool->workers[i]);
+#else
+    pthread_join(pool->workers[i], NULL);
+#endif
+  }
+#ifdef _WIN32
+  DeleteCriticalSection(&pool->lock);
+#else
+  pthread_mutex_destroy(&pool->lock);
+  pthread_cond_destroy(&pool->wake);
+  pthread_cond_destroy(&pool->done);
+#endif
+  pool->threads = 0;
+}
+
+// Advances the grid one generation, each thread stepping a band of rows
+void Step(WorkerPool* pool) {
+  Life* life = pool->life;
+  if (pool->threads <= 1) {
+    StepRows(life, 0, life->height);
+  } else {
+    POOL_LOCK(pool);
+    pool->busy = pool->threads - 1;
+    pool->step++;
+    POOL_WAKE_ALL(pool, wake);
+    POOL_UNLOCK(pool);
+    StepRows(life, 0, (int)((long long)life->height / pool->threads));
+    POOL_LOCK(pool);
+    while (pool->busy > 0) POOL_WAIT(pool, done);
+    POOL_UNLOCK(pool);
+  }
+  uint64_t* swap = life->alive;
+  life->alive = life->next_alive;
+  life->next_alive = swap;
+  for (int p = 0; p < life->planes; p++) {
+    swap = life->age[p];
+    life->age[p] = life->next_age[p];
+    life->next_age[p] = swap;
+  }
+  life->generation++;
+}
+
+// --- Drawing ---
+
+// Fades dying cells from the live color to the background as they age
+static Color StateColor(const Life* life, int state) {
+  static const Color fade[] = { YELLOW, ORANGE, RED, MAROON, DARKPURPLE, DARKBLUE };
+  if (state == 1) return ALIVE_COLOR;
+  int steps = (int)(sizeof(fade) / sizeof(fade[0]));
+  int index = (int)((long long)(state - 2) * steps / (life->rule.states - 2));
+  return fade[(index < steps) ? index : steps - 1];
+}
+
+void DrawLife(const Life* life, int mode, int columns, int rows) {
+  if (mode == MODE_BRAILLE) {
+    // Braille shows live cells only; a character covers columns 2x, 2x + 1 (always in one
+    // word) of rows 4y to 4y + 3
+    static const unsigned char left_dot[4] = { 0x01, 0x02, 0x04, 0x40 };
+    static const unsigned char right_dot[4] = { 0x08, 0x10, 0x20, 0x80 };
+    for (int y = 0; y < rows && y * 4 < life->height; y++) {
+      for (int x = 0; x < columns && x * 2 < life->width; x++) {
+        int word = (x * 2) >> 6;
+        int shift = (x * 2) & 63;
+        unsigned char dots = 0;
+        for (int r = 0; r < 4 && y * 4 + r < life->height; r++) {
+          uint64_t pair = life->alive[(size_t)(y * 4 + r) * life->words + word] >> shift;
+          if (pair & 1) dots |= left_dot[r];
+          if (pair & 2) dots |= right_dot[r];
+        }
+        if (dots != 0) TR_DrawBraille(x, y, dots, ALIVE_COLOR, BLANK);
+      }
+    }
+  } else if (mode == MODE_HALF) {
+    for (int y = 0; y < rows * 2 && y < life->height; y++) {
+      for (int x = 0; x < columns && x < life->width; x++) {
+        int state = CellState(life, x, y);
+        if (state != 0) TR_DrawHalfPixel(x, y, StateColor(life, state));
+      }
+    }
+  } else {
+    char cell[2] = { 0, 0 };
+    for (int y = 0; y < rows && y < life->height; y++) {
+      for (int x = 0; x < columns && x < life->width; x++) {
+        int state = CellState(life, x, y);
+        if (state == 0) continue;
+        cell[0] = (state == 1) ? '#' : '+';
+        TR_DrawText(cell, x, y, 10, StateColor(life, state), BLANK);
+      }
+    }
+  }
+}
+
+// --- Benchmark ---
+
+// Runs the same soup on each thread count (or just `threads`) and prints generations per
+// second. The live cell counts must match: the bands don't change the result.
+int RunBenchmark(int width, int height, int generations, int threads, const Rule* rule, const char* rule_text) {
+  printf("trlife: %dx%d torus, %s, %d generations\n", width, height, rule_text, generations);
+  int max_threads = (threads > 0) ? threads : TR_GetCPUCount();
+  if (max_threads > MAX_THREADS) max_threads = MAX_THREADS;
+  for (int t = (threads > 0) ? threads : 1;; t *= 2) {
+    if (t > max_threads) t = max_threads;
+    Life life;
+    WorkerPool pool;
+    if (!InitLife(&life, width, height, rule)) {
+      fprintf(stderr, "ERROR: Failed to allocate a %dx%d grid.\n", width, height);
+      return 1;
+    }
+    StartWorkers(&pool, &life, t);
+    TR_Rng rng;
+    TR_RngSeed(&rng, 1);
+    RandomizeLife(&life, &rng);
+    long long start_ns = __tr_get_time_ns();
+    for (int g = 0; g < generations; g++) Step(&pool);
+    double seconds = (double)(__tr_get_time_ns() - start_ns) / 1e9;
+    printf("  %2d thread%s: %10.1f generations/s %8.2f Gcells/s  (%lld alive at the end)\n", pool.threads,
+           pool.threads == 1 ? " " : "s", generations / seconds, (double)width * height * generations / seconds / 1e9,
+           CountAlive(&life));
+    StopWorkers(&pool);
+    FreeLife(&life);
+    if (t == max_threads) break;
+  }
+  return 0;
+}
@@ -0,0 +1,1268 @@
+// netsnake.c - Snake for many players, each in their own terminal, over tread.h's TR_NET
+//              module. One server owns the game and ticks it; clients send their turns for
+//              a tick a few ticks ahead (input-delayed lockstep) and replay the compact
+//              per-tick deltas the server broadcasts, checking a hash of the map now and
+//              then. Bots load-test the server and report latency and bandwidth.
+//
+// Usage: trnetsnake [-a address]       (join a game)
+//        trnetsnake -s [-a address] [-m width height] [-r ticks_per_second] [-d delay_ticks] [-t seconds]
+//        trnetsnake -b bots [-a address] [-t seconds]
+// Addresses are "unix:/path" or "host:port" (the default is unix:/tmp/trnetsnake.sock,
+// or 127.0.0.1:7777 on Windows).
+
+#define TR_NET
+#include "../../tread.h"
+
+#include <time.h>   // For time (to seed the RNG)
+#include <signal.h> // For signal (to stop the server on Ctrl+C)
+
+// --- Game Configuration ---
+#ifdef _WIN32
+  #define DEFAULT_ADDRESS "127.0.0.1:7777"
+#else
+  #define DEFAULT_ADDRESS "unix:/tmp/trnetsnake.sock"
+#endif
+#define MAP_WIDTH    60
+#define MAP_HEIGHT   24
+#define MIN_MAP_SIZE 8
+#define MAX_MAP_SIZE 1024
+#define TICK_RATE    10 // Server ticks per second
+#define INPUT_DELAY  2  // Ticks between the tick a client has seen and the one its turn is for
+#define MAX_PLAYERS  512
+#define MAX_FOOD     256
+#define RESPAWN_TICKS 20
+#define CLIENT_FPS   60
+#define PING_INTERVAL_NS 500000000LL
+#define HASH_INTERVAL 16 // Ticks between map hashes in the deltas
+#define INPUT_QUEUE  8   // Turns a player can have waiting for their tick
+#define MAX_PENDING_OUTPUT (1 << 20) // A client this far behind on reading is dropped
+#define MAX_SAMPLES  (1 << 20)       // Latency samples the bots keep
+#define PROTOCOL_VERSION 1
+
+// --- Game Characters ---
+#define WALL_CHAR  '#'
+#define FOOD_CHAR  '*'
+#define OWN_HEAD   '@'
+#define OTHER_HEAD 'O'
+#define BODY_CHAR  'o'
+
+// --- Game Colors ---
+#define WALL_COLOR     WHITE
+#define FOOD_COLOR     RED
+#define OWN_HEAD_COLOR WHITE
+#define OWN_BODY_COLOR LIME
+#define TEXT_COLOR     WHITE
+#define BG_COLOR       BLACK
+
+// --- Messages ---
+enum {
+  MSG_HELLO = 1, // Client: protocol version
+  MSG_WELCOME,   // Server: version, player id, map size, tick rate, input delay
+  MSG_FULL,      // Server: no free player slot
+  MSG_STATE,     // Server: the whole game, to a client that just joined
+  MSG_TICK,      // Server: what one tick changed, to every client
+  MSG_INPUT,     // Client: input sequence number, tick, direction
+  MSG_ACK,       // Server: the input with this sequence number was applied (or dropped)
+  MSG_PING,      // Client: 8 bytes the server echoes back
+  MSG_PONG
+};
+
+#define FOOD_OWNER 0xFFFF // World.owner of a cell holding food
+
+// --- Game State Structs ---
+enum { DIR_UP, DIR_RIGHT, DIR_DOWN, DIR_LEFT };
+static const int dir_x[4] = { 0, 1, 0, -1 };
+static const int dir_y[4] = { -1, 0, 1, 0 };
+
+typedef struct {
+  bool alive;
+  int* cells; // Ring buffer of cell indices (y * width + x), the head at cells[head]
+  int capacity;
+  int head;
+  int length;
+  int dir;
+} Snake;
+
+// The game as the server and every client see it. Clients only change it by replaying the
+// server's deltas, through the same functions, so it stays the same everywhere.
+typedef struct {
+  int width;
+  int height;
+  unsigned int tick; // Last tick applied
+  Snake snakes[MAX_PLAYERS];
+  unsigned short* owner; // Per cell: 0 if empty, FOOD_OWNER, or the snake's id + 1
+  // Empty cells inside the walls; free_slot[cell] is the cell's place in free_cells, or -1
+  int* free_cells;
+  int* free_slot;
+  int free_count;
+  int food[MAX_FOOD];
+  int food_count;
+} World;
+
+// One snake's part of a tick, in the order the deltas list them (alive snakes by id)
+typedef struct {
+  int id;
+  int dir;
+  bool grew;
+  bool died;
+} Move;
+
+typedef struct {
+  int id;
+  int cell;
+  int dir;
+} Spawn;
+
+typedef struct {
+  unsigned int tick;
+  int dir;
+  unsigned int seq;
+} QueuedInput;
+
+typedef struct {
+  TR_NetConn* conn; // NULL for a free slot
+  bool welcomed;
+  bool leaving;     // Disconnected: the snake dies on the next tick, then the slot is freed
+  unsigned int respawn_tick;
+  QueuedInput inputs[INPUT_QUEUE];
+  int input_start;
+  int input_count;
+} Player;
+
+// Where a client or bot stands: its copy of the world and its own numbers
+typedef struct {
+  TR_NetConn* conn;
+  World world;
+  bool joined; // Has its MSG_STATE
+  bool failed; // Disconnected, or its world stopped matching the server's
+  int id;
+  int tick_rate;
+  int input_delay;
+  int heading; // Direction of the last turn sent (the snake's own direction once applied)
+  unsigned int seq;       // Of the last input sent
+  unsigned int acked_seq; // Of the last input the server applied
+  long long sent_ns[256]; // When each recent input went out, by sequence number
+  long long next_ping_ns;
+  double rtt_ms;   // Smoothed
+  double input_ms; // Smoothed, key press to the server applying it
+  int best_length;
+  int desyncs;
+  long long ticks_seen;
+} Client;
+
+// Bounded byte writer; the callers size the buffer for the worst case
+typedef struct {
+  unsigned char* data;
+  int length;
+} Writer;
+
+typedef struct {
+  const unsigned char* p;
+  const unsigned char* end;
+  bool ok;
+} Reader;
+
+// --- Global State ---
+static volatile sig_atomic_t interrupted = 0;
+// Every round trip and input latency the clients measure, when set (the bots keep them all)
+static double* rtt_samples = NULL;
+static double* input_samples = NULL;
+static int num_rtt_samples = 0;
+static int num_input_samples = 0;
+
+// --- Function Prototypes ---
+bool InitWorld(World* world, int width, int height);
+void FreeWorld(World* world);
+bool IsInsideWalls(const World* world, int x, int y);
+bool PushHead(World* world, int id, int cell);
+void DropTail(World* world, int id);
+void KillSnake(World* world, int id);
+bool SpawnSnake(World* world, int id, int cell, int dir);
+void AddFood(World* world, int cell);
+bool ApplyMoves(World* world, const Move* moves, int count);
+uint32_t HashWorld(const World* world);
+int RunServer(const char* address, int width, int height, int tick_rate, int input_delay, double seconds);
+int RunClient(const char* address);
+int RunBots(const char* address, int count, double seconds);
+
+static void OnInterrupt(int signal_number) {
+  (void)signal_number;
+  interrupted = 1;
+}
+
+static double Milliseconds(long long ns) {
+  return (double)ns / 1e6;
+}
+
+// --- Encoding ---
+
+static void PutByte(Writer* writer, int value) {
+  writer->data[writer->length++] = (unsigned char)value;
+}
+
+static void PutVarint(Writer* writer, unsigned int value) {
+  writer->length += TR_NetPutVarint(writer->data + writer->length, value);
+}
+
+static void PutU32(Writer* writer, uint32_t value) {
+  for (int i = 0; i < 4; i++) PutByte(writer, (int)((value >> (i * 8)) & 0xFF));
+}
+
+static int GetByte(Reader* reader) {
+  if (!reader->ok || reader->p >= reader->end) {
+    reader->ok = false;
+    return 0;
+  }
+  return *reader->p++;
+}
+
+static unsigned int GetVarint(Reader* reader) {
+  uint32_t value = 0;
+  if (!reader->ok || !TR_NetGetVarint(&reader->p, reader->end, &value)) reader->ok = false;
+  return value;
+}
+
+static uint32_t GetU32(Reader* reader) {
+  uint32_t value = 0;
+  for (int i = 0; i < 4; i++) value |= (uint32_t)GetByte(reader) << (i * 8);
+  return value;
+}
+
+// --- World ---
+
+// Sets up an empty map. Returns false if it couldn't be allocated.
+bool InitWorld(World* world, int width, int height) {
+  memset(world, 0, sizeof(*world));
+  world->width = width;
+  world->height = height;
+  int num_cells = width * height;
+  world->owner = (unsigned short*)calloc((size_t)num_cells, sizeof(unsigned short));
+  world->free_cells = (int*)malloc(sizeof(int) * num_cells);
+  world->free_slot = (int*)malloc(sizeof(int) * num_cells);
+  if (world->owner == NULL || world->free_cells == NULL || world->free_slot == NULL) {
+    FreeWorld(world);
+    return false;
+  }
+  for (int cell = 0; cell < num_cells; cell++) {
+    if (IsInsideWalls(world, cell % width, cell / width)) {
+      world->free_slot[cell] = world->free_count;
+      world->free_cells[world->free_count++] = cell;
+    } else {
+      world->free_slot[cell] = -1;
+    }
+  }
+  return true;
+}
+
+void FreeWorld(World* world) {
+  for (int id = 0; id < MAX_PLAYERS; id++) free(world->snakes[id].cells);
+  free(world->owner);
+  free(world->free_cells);
+  free(world->free_slot);
+  memset(world, 0, sizeof(*world));
+}
+
+bool IsInsideWalls(const World* world, int x, int y) {
+  return x > 0 && x < world->width - 1 && y > 0 && y < world->height - 1;
+}
+
+// Gives a cell to a snake or food and takes it off the free list
+static void TakeCell(World* world, int cell, unsigned short owner) {
+  world->owner[cell] = owner;
+  int slot = world->free_slot[cell];
+  if (slot >= 0) {
+    int last = world->free_cells[--world->free_count];
+    world->free_cells[slot] = last;
+    world->free_slot[last] = slot;
+    world->free_slot[cell] = -1;
+  }
+}
+
+static void ReleaseCell(World* world, int cell) {
+  world->owner[cell] = 0;
+  if (world->free_slot[cell] < 0 && IsInsideWalls(world, cell % world->width, cell / world->width)) {
+    world->free_slot[cell] = world->free_count;
+    world->free_cells[world->free_count++] = cell;
+  }
+}
+
+static int TailCell(const Snake* snake) {
+  return snake->cells[(snake->head - snake->length + 1 + snake->capacity) % snake->capacity];
+}
+
+// Moves the snake's head onto `cell`, growing the ring buffer when it's full
+bool PushHead(World* world, int id, int cell) {
+  Snake* snake = &world->snakes[id];
+  if (snake->length == snake->capacity) {
+    int capacity = (snake->capacity > 0) ? snake->capacity * 2 : 16;
+    int* cells = (int*)malloc(sizeof(int) * capacity);
+    if (cells == NULL) return false;
+    for (int i = 0; i < snake->length; i++) { // Unwrapped, tail first
+      cells[i] = snake->cells[(snake->head - snake->length + 1 + i + snake->capacity) % snake->capacity];
+    }
+    free(snake->cells);
+    snake->cells = cells;
+    snake->capacity = capacity;
+    snake->head = snake->length - 1;
+  }
+  snake->head = (snake->head + 1) % snake->capacity;
+  snake->cells[snake->head] = cell;
+  snake->length++;
+  TakeCell(world, cell, (unsigned short)(id + 1));
+  return true;
+}
+
+void DropTail(World* world, int id) {
+  Snake* snake = &world->snakes[id];
+  ReleaseCell(world, TailCell(snake));
+  snake->length--;
+}
+
+void KillSnake(World* world, int id) {
+  Snake* snake = &world->snakes[id];
+  while (snake->length > 0) DropTail(world, id);
+  snake->alive = false;
+}
+
+bool SpawnSnake(World* world, int id, int cell, int dir) {
+  Snake* snake = &world->snakes[id];
+  snake->alive = true;
+  snake->length = 0;
+  snake->head = 0;
+  snake->dir = dir;
+  return PushHead(world, id, cell);
+}
+
+void AddFood(World* world, int cell) {
+  TakeCell(world, cell, FOOD_OWNER);
+  world->food[world->food_count++] = cell;
+}
+
+static void RemoveFood(World* world, int cell) {
+  for (int i = 0; i < world->food_count; i++) {
+    if (world->food[i] == cell) {
+      world->food[i] = world->food[--world->food_count];
+      return;
+    }
+  }
+}
+
+// Applies one tick's moves in three passes, so the result doesn't depend on the order of the
+// snakes: tails leave, the dead are removed, then heads move in. The server has already
+// checked that no two heads meet and no head hits anything. Returns false if out of memory.
+bool ApplyMoves(World* world, const Move* moves, int count) {
+  for (int i = 0; i < count; i++) {
+    if (!moves[i].died && !moves[i].grew) DropTail(world, moves[i].id);
+  }
+  for (int i = 0; i < count; i++) {
+    if (moves[i].died) KillSnake(world, moves[i].id);
+  }
+  for (int i = 0; i < count; i++) {
+    if (moves[i].died) continue;
+    Snake* snake = &world->snakes[moves[i].id];
+    int head = snake->cells[snake->head];
+    int cell = head + dir_y[moves[i].dir] * world->width + dir_x[moves[i].dir];
+    snake->dir = moves[i].dir;
+    if (moves[i].grew) RemoveFood(world, cell);
+    if (!PushHead(world, moves[i].id, cell)) return false;
+  }
+  return true;
+}
+
+// FNV-1a over every occupied cell and its owner
+uint32_t HashWorld(const World* world) {
+  uint32_t hash = 2166136261u;
+  int num_cells = world->width * world->height;
+  for (int cell = 0; cell < num_cells; cell++) {
+    if (world->owner[cell] == 0) continue;
+    uint32_t value = (uint32_t)cell * 65599u + world->owner[cell];
+    for (int i = 0; i < 4; i++) {
+      hash ^= (value >> (i * 8)) & 0xFF;
+      hash *= 16777619u;
+    }
+  }
+  return hash;
+}
+
+// Writes the whole world: food, then every snake as its head and the direction from each
+// segment to the next, two bits each
+static void EncodeState(const World* world, Writer* writer) {
+  PutVarint(writer, world->tick);
+  PutVarint(writer, (unsigned int)world->food_count);
+  for (int i = 0; i < world->food_count; i++) PutVarint(writer, (unsigned int)world->food[i]);
+  int alive = 0;
+  for (int id = 0; id < MAX_PLAYERS; id++) alive += world->snakes[id].alive;
+  PutVarint(writer, (unsigned int)alive);
+  for (int id = 0; id < MAX_PLAYERS; id++) {
+    const Snake* snake = &world->snakes[id];
+    if (!snake->alive) continue;
+    PutVarint(writer, (unsigned int)id);
+    PutByte(writer, snake->dir);
+    PutVarint(writer, (unsigned int)snake->length);
+    PutVarint(writer, (unsigned int)snake->cells[snake->head]);
+    int bits = 0;
+    int packed = 0;
+    for (int i = 0; i + 1 < snake->length; i++) {
+      int cell = snake->cells[(snake->head - i + snake->capacity) % snake->capacity];
+      int next = snake->cells[(snake->head - i - 1 + snake->capacity) % snake->capacity];
+      int dir = (next == cell - world->width) ? DIR_UP : (next == cell + 1) ? DIR_RIGHT : (next == cell + world->width) ? DIR_DOWN : DIR_LEFT;
+      packed |= dir << bits;
+      bits += 2;
+      if (bits == 8) {
+        PutByte(writer, packed);
+        bits = 0;
+        packed = 0;
+      }
+    }
+    if (bits > 0) PutByte(writer, packed);
+  }
+}
+
+// Rebuilds a world from MSG_STATE. Returns false if the message doesn't make sense.
+static bool DecodeState(World* world, Reader* reader) {
+  int num_cells = world->width * world->height;
+  world->tick = GetVarint(reader);
+  int food_count = (int)GetVarint(reader);
+  if (!reader->ok || food_count > MAX_FOOD) return false;
+  for (int i = 0; i < food_count; i++) {
+    unsigned int cell = GetVarint(reader); // Unsigned, so a huge value can't pass as a negative index
+    if (!reader->ok || cell >= (unsigned int)num_cells || world->owner[cell] != 0) return false;
+    AddFood(world, cell);
+  }
+  int alive = (int)GetVarint(reader);
+  if (!reader->ok || alive > MAX_PLAYERS) return false;
+  int* cells = (int*)malloc(sizeof(int) * num_cells);
+  if (cells == NULL) return false;
+  bool ok = true;
+  for (int s = 0; s < alive && ok; s++) {
+    unsigned int id = GetVarint(reader);
+    int dir = GetByte(reader);
+    unsigned int length = GetVarint(reader);
+    unsigned int head = GetVarint(reader);
+    ok = reader->ok && id < MAX_PLAYERS && !world->snakes[id].alive && dir < 4 && length >= 1 && length <= (unsigned int)num_cells &&
+         head < (unsigned int)num_cells;
+    cells[0] = (int)head;
+    int packed = 0;
+    for (int i = 1; i < (int)length && ok; i++) {
+      if ((i - 1) % 4 == 0) packed = GetByte(reader);
+      int step = (packed >> (((i - 1) % 4) * 2)) & 3;
+      int x = cells[i - 1] % world->width + dir_x[step];
+      int y = cells[i - 1] / world->width + dir_y[step];
+      ok = reader->ok && IsInsideWalls(world, x, y);
+      cells[i] = y * world->width + x;
+    }
+    if (!ok) break;
+    world->snakes[id].alive = true;
+    world->snakes[id].dir = dir;
+    for (int i = (int)length - 1; i >= 0 && ok; i--) { // Tail first, so the head ends up newest
+      ok = world->owner[cells[i]] == 0 && PushHead(world, id, cells[i]);
+    }
+  }
+  free(cells);
+  return ok && reader->ok;
+}
+
+// --- Server ---
+
+typedef struct {
+  World world;
+  Player players[MAX_PLAYERS];
+  int tick_rate;
+  int input_delay;
+  // Per cell, the last tick a head was headed there and whose: finds heads meeting
+  unsigned int* claim_tick;
+  int* claim_id;
+  unsigned long long closed_sent; // Bytes moved by connections already closed
+  unsigned long long closed_received;
+  // This second's numbers
+  long long late_inputs;
+  double tick_ms_total;
+  double tick_ms_max;
+  int ticks;
+} Server;
+
+static int CountPlayers(const Server* server) {
+  int count = 0;
+  for (int id = 0; id < MAX_PLAYERS; id++) count += (server->players[id].conn != NULL && server->players[id].welcomed);
+  return count;
+}
+
+// Closes a player's connection and frees the slot
+static void DropPlayer(Server* server, int id) {
+  Player* player = &server->players[id];
+  server->closed_sent += player->conn->bytes_sent;
+  server->closed_received += player->conn->bytes_received;
+  TR_NetClose(player->conn);
+  memset(player, 0, sizeof(*player));
+}
+
+static void SendToAll(Server* server, unsigned char type, const Writer* writer) {
+  for (int id = 0; id < MAX_PLAYERS; id++) {
+    Player* player = &server->players[id];
+    if (player->conn != NULL && player->welcomed && !player->leaving) TR_NetSend(player->conn, type, writer->data, writer->length);
+  }
+}
+
+static void HandleHello(Server* server, int id, Reader* reader) {
+  Player* player = &server->players[id];
+  if (GetByte(reader) != PROTOCOL_VERSION || player->welcomed) {
+    player->leaving = true;
+    return;
+  }
+  unsigned char welcome[32];
+  Writer writer = { welcome, 0 };
+  PutByte(&writer, PROTOCOL_VERSION);
+  PutVarint(&writer, (unsigned int)id);
+  PutVarint(&writer, (unsigned int)server->world.width);
+  PutVarint(&writer, (unsigned int)server->world.height);
+  PutVarint(&writer, (unsigned int)server->tick_rate);
+  PutVarint(&writer, (unsigned int)server->input_delay);
+  TR_NetSend(player->conn, MSG_WELCOME, writer.data, writer.length);
+
+  // Food, plus per snake about 12 bytes and a quarter byte per segment
+  int num_cells = server->world.width * server->world.height;
+  Writer state = { (unsigned char*)malloc((size_t)(num_cells / 4 + (MAX_PLAYERS + MAX_FOOD) * 16 + 64)), 0 };
+  if (state.data == NULL) {
+    player->leaving = true;
+    return;
+  }
+  EncodeState(&server->world, &state);
+  TR_NetSend(player->conn, MSG_STATE, state.data, state.length);
+  free(state.data);
+  player->welcomed = true;
+  player->respawn_tick = server->world.tick + 1;
+}
+
+static void HandleInput(Server* server, int id, Reader* reader) {
+  Player* player = &server->players[id];
+  unsigned int seq = GetVarint(reader);
+  unsigned int tick = GetVarint(reader);
+  int dir = GetByte(reader);
+  if (!reader->ok || dir > DIR_LEFT || !player->welcomed) return;
+  if (tick <= server->world.tick) server->late_inputs++; // Arrived after its tick; it goes on the next one
+  if (player->input_count == INPUT_QUEUE) { // Drop the oldest
+    player->input_start = (player->input_start + 1) % INPUT_QUEUE;
+    player->input_count--;
+  }
+  QueuedInput* input = &player->inputs[(player->input_start + player->input_count++) % INPUT_QUEUE];
+  input->tick = tick;
+  input->dir = dir;
+  input->seq = seq;
+}
+
+static void HandleMessages(Server* server, int id) {
+  Player* player = &server->players[id];
+  unsigned char type;
+  const unsigned char* data;
+  int length;
+  while (!player->leaving && TR_NetReceive(player->conn, &type, &data, &length)) {
+    Reader reader = { data, data + length, true };
+    switch (type) {
+      case MSG_HELLO: HandleHello(server, id, &reader); break;
+      case MSG_INPUT: HandleInput(server, id, &reader); break;
+      case MSG_PING: TR_NetSend(player->conn, MSG_PONG, data, length); break;
+      default: player->leaving = true; break; // Not a client we know how to talk to
+    }
+  }
+  if (player->conn->closed) player->leaving = true;
+}
+
+// Takes the oldest input off the player's queue and tells the player it's done with
+static QueuedInput PopInput(Server* server, int id) {
+  Player* player = &server->players[id];
+  QueuedInput input = player->inputs[player->input_start];
+  player->input_start = (player->input_start + 1) % INPUT_QUEUE;
+  player->input_count--;
+  unsigned char ack[8];
+  Writer writer = { ack, 0 };
+  PutVarint(&writer, input.seq);
+  TR_NetSend(player->conn, MSG_ACK, writer.data, writer.length);
+  return input;
+}
+
+// The snake's direction this tick: its queued turn for the tick, unless that turns it back
+// into itself
+static int NextTurn(Server* server, int id, unsigned int tick) {
+  Player* player = &server->players[id];
+  const Snake* snake = &server->world.snakes[id];
+  if (player->input_count == 0 || player->inputs[player->input_start].tick > tick) return snake->dir;
+  QueuedInput input = PopInput(server, id);
+  return (input.dir != (snake->dir + 2) % 4) ? input.dir : snake->dir;
+}
+
+// Runs one tick: decides every snake's move, applies it, spawns and feeds, then sends the
+// delta to everyone
+static bool RunServerTick(Server* server, unsigned char* buffer) {
+  World* world = &server->world;
+  unsigned int tick = world->tick + 1;
+  static Move moves[MAX_PLAYERS];
+  static int targets[MAX_PLAYERS];
+  int count = 0;
+
+  // Where every head wants to go, and whether it eats
+  for (int id = 0; id < MAX_PLAYERS; id++) {
+    Snake* snake = &world->snakes[id];
+    if (!snake->alive) continue;
+    Move* move = &moves[count];
+    move->id = id;
+    move->dir = (server->players[id].conn != NULL) ? NextTurn(server, id, tick) : snake->dir;
+    move->died = server->players[id].leaving || server->players[id].conn == NULL;
+    int head = snake->cells[snake->head];
+    int x = head % world->width + dir_x[move->dir];
+    int y = head / world->width + dir_y[move->dir];
+    targets[count] = y * world->width + x;
+    move->grew = IsInsideWalls(world, x, y) && world->owner[targets[count]] == FOOD_OWNER;
+    if (!IsInsideWalls(world, x, y)) move->died = true;
+    count++;
+  }
+
+  // Heads die on bodies (but not on tails leaving this tick) and on each other
+  for (int i = 0; i < count; i++) {
+    Move* move = &moves[i];
+    if (move->died) continue;
+    int cell = targets[i];
+    int owner = world->owner[cell];
+    if (owner != 0 && owner != FOOD_OWNER) {
+      const Snake* other = &world->snakes[owner - 1];
+      int j = 0; // The other snake's move (moves are in id order)
+      while (moves[j].id != owner - 1) j++;
+      bool tail_leaves = (TailCell(other) == cell && !moves[j].grew && !moves[j].died);
+      if (!tail_leaves) move->died = true;
+    }
+    if (move->died) continue;
+    if (server->claim_tick[cell] == tick) {
+      move->died = true;
+      for (int j = 0; j < i; j++) {
+        if (moves[j].id == server->claim_id[cell]) moves[j].died = true;
+      }
+    } else {
+      server->claim_tick[cell] = tick;
+      server->claim_id[cell] = move->id;
+    }
+  }
+  for (int i = 0; i < count; i++) {
+    if (moves[i].died) {
+      moves[i].grew = false;
+      server->players[moves[i].id].respawn_tick = tick + RESPAWN_TICKS;
+    }
+  }
+  if (!ApplyMoves(world, moves, count)) return false;
+  world->tick = tick;
+
+  // Turns sent for a snake that has died go nowhere
+  for (int id = 0; id < MAX_PLAYERS; id++) {
+    while (server->players[id].input_count > 0 && !world->snakes[id].alive) PopInput(server, id);
+  }
+
+  // Players without a snake get one somewhere free, heading for the middle
+  static Spawn spawns[MAX_PLAYERS];
+  int num_spawns = 0;
+  for (int id = 0; id < MAX_PLAYERS && world->free_count > 0; id++) {
+    Player* player = &server->players[id];
+    if (player->conn == NULL || !player->welcomed || player->leaving || world->snakes[id].alive || tick < player->respawn_tick) continue;
+    int cell = world->free_cells[rand() % world->free_count];
+    int x = cell % world->width;
+    int y = cell / world->width;
+    int dx = world->width / 2 - x;
+    int dy = (world->height / 2 - y) * 2; // Rows are about twice as tall as columns are wide
+    int dir = (abs(dx) >= abs(dy)) ? (dx >= 0 ? DIR_RIGHT : DIR_LEFT) : (dy >= 0 ? DIR_DOWN : DIR_UP);
+    if (!SpawnSnake(world, id, cell, dir)) return false;
+    spawns[num_spawns++] = (Spawn){ id, cell, dir };
+  }
+
+  // Keep some food out: two pieces plus one for every two players
+  int food_target = 2 + CountPlayers(server) / 2;
+  if (food_target > MAX_FOOD) food_target = MAX_FOOD;
+  int first_food = world->food_count;
+  while (world->food_count < food_target && world->free_count > 0) AddFood(world, world->free_cells[rand() % world->free_count]);
+
+  // The delta: tick, a nibble per move (direction, grew, died), spawns, new food and
+  // now and then a hash of the map
+  Writer writer = { buffer, 0 };
+  PutVarint(&writer, tick);
+  PutVarint(&writer, (unsigned int)count);
+  for (int i = 0; i < count; i += 2) {
+    int packed = 0;
+    for (int j = i; j < i + 2 && j < count; j++) {
+      int nibble = moves[j].dir | (moves[j].grew ? 4 : 0) | (moves[j].died ? 8 : 0);
+      packed |= nibble << ((j - i) * 4);
+    }
+    PutByte(&writer, packed);
+  }
+  PutVarint(&writer, (unsigned int)num_spawns);
+  for (int i = 0; i < num_spawns; i++) {
+    PutVarint(&writer, (unsigned int)spawns[i].id);
+    PutVarint(&writer, (unsigned int)spawns[i].cell);
+    PutByte(&writer, spawns[i].dir);
+  }
+  PutVarint(&writer, (unsigned int)(world->food_count - first_food));
+  for (int i = first_food; i < world->food_count; i++) PutVarint(&writer, (unsigned int)world->food[i]);
+  if (tick % HASH_INTERVAL == 0) PutU32(&writer, HashWorld(world));
+  SendToAll(server, MSG_TICK, &writer);
+
+  // Slots of players who left are free once their snake is gone
+  for (int id = 0; id < MAX_PLAYERS; id++) {
+    if (server->players[id].conn != NULL && server->players[id].leaving && !world->snakes[id].alive) DropPlayer(server, id);
+  }
+  return true;
+}
+
+int RunServer(const char* address, int width, int height, int tick_rate, int input_delay, double seconds) {
+  static Server server; // Too big for the stack
+  if (!InitWorld(&server.world, width, height)) {
+    fprintf(stderr, "ERROR: Failed to allocate a %dx%d map.\n", width, height);
+    return 1;
+  }
+  server.tick_rate = tick_rate;
+  server.input_delay = input_delay;
+  server.claim_tick = (unsigned int*)calloc((size_t)width * height, sizeof(unsigned int));
+  server.claim_id = (int*)calloc((size_t)width * height, sizeof(int));
+  // Worst case delta: header, a nibble, spawn and hash per player, and the food
+  unsigned char* buffer = (unsigned char*)malloc(MAX_PLAYERS * 16 + MAX_FOOD * 8 + 64);
+  if (server.claim_tick == NULL || server.claim_id == NULL || buffer == NULL) {
+    fprintf(stderr, "ERROR: Failed to allocate the server.\n");
+    return 1;
+  }
+  TR_Socket listener = TR_NetListen(address);
+  if (listener == TR_NET_INVALID_SOCKET) {
+    fprintf(stderr, "ERROR: Can't listen on %s (is another server using it?).\n", address);
+    return 1;
+  }
+  signal(SIGINT, OnInterrupt);
+  srand((unsigned int)time(NULL));
+  printf("trnetsnake server on %s: %dx%d map, %d ticks/s, input delay %d ticks. Ctrl+C stops it.\n",
+         address, width, height, tick_rate, input_delay);
+  fflush(stdout);
+
+  static TR_NetConn* conns[MAX_PLAYERS];
+  long long tick_ns = 1000000000LL / tick_rate;
+  long long start_ns = __tr_get_time_ns();
+  long long next_tick_ns = start_ns + tick_ns;
+  long long next_report_ns = start_ns + 1000000000LL;
+  unsigned long long last_sent = 0;
+  unsigned long long last_received = 0;
+  bool failed = false;
+  while (!interrupted && !failed && (seconds <= 0.0 || __tr_get_time_ns() - start_ns < (long long)(seconds * 1e9))) {
+    for (int id = 0; id < MAX_PLAYERS; id++) conns[id] = server.players[id].conn;
+    long long wait_ns = next_tick_ns - __tr_get_time_ns();
+    TR_NetWait(listener, conns, MAX_PLAYERS, (wait_ns > 0) ? (int)((wait_ns + 999999LL) / 1000000LL) : 0);
+
+    // New players take the first free slot
+    TR_NetConn* conn;
+    while ((conn = TR_NetAccept(listener)) != NULL) {
+      int id = 0;
+      while (id < MAX_PLAYERS && server.players[id].conn != NULL) id++;
+      if (id == MAX_PLAYERS) {
+        TR_NetSend(conn, MSG_FULL, NULL, 0);
+        TR_NetFlush(conn);
+        server.closed_sent += conn->bytes_sent;
+        TR_NetClose(conn);
+        continue;
+      }
+      server.players[id].conn = conn;
+    }
+    for (int id = 0; id < MAX_PLAYERS; id++) {
+      Player* player = &server.players[id];
+      if (player->conn == NULL) continue;
+      HandleMessages(&server, id);
+      // Leavers without a snake (or never welcomed) go at once
+      if (player->leaving && !server.world.snakes[id].alive) DropPlayer(&server, id);
+    }
+
+    long long now_ns = __tr_get_time_ns();
+    if (now_ns >= next_tick_ns) {
+      failed = !RunServerTick(&server, buffer);
+      double tick_ms = Milliseconds(__tr_get_time_ns() - now_ns);
+      server.tick_ms_total += tick_ms;
+      if (tick_ms > server.tick_ms_max) server.tick_ms_max = tick_ms;
+      server.ticks++;
+      next_tick_ns += tick_ns;
+      if (now_ns - next_tick_ns > 5 * tick_ns) next_tick_ns = now_ns + tick_ns; // Fell far behind: don't race to catch up
+    }
+
+    for (int id = 0; id < MAX_PLAYERS; id++) {
+      Player* player = &server.players[id];
+      if (player->conn == NULL) continue;
+      if (!TR_NetFlush(player->conn) || TR_NetPending(player->conn) > MAX_PENDING_OUTPUT) player->leaving = true;
+    }
+
+    if (now_ns >= next_report_ns) {
+      unsigned long long sent = server.closed_sent;
+      unsigned long long received = server.closed_received;
+      for (int id = 0; id < MAX_PLAYERS; id++) {
+        if (server.players[id].conn == NULL) continue;
+        sent += server.players[id].conn->bytes_sent;
+        received += server.players[id].conn->bytes_received;
+      }
+      printf("tick %u | %d players | tick %.3f ms (max %.3f) | out %.1f KB/s | in %.1f KB/s | %lld late inputs\n",
+             server.world.tick, CountPlayers(&server), server.ticks ? server.tick_ms_total / server.ticks : 0.0,
+             server.tick_ms_max, (double)(sent - last_sent) / 1024.0, (double)(received - last_received) / 1024.0, server.late_inputs);
+      fflush(stdout);
+      last_sent = sent;
+      last_received = received;
+      server.late_inputs = 0;
+      server.tick_ms_total = 0.0;
+      server.tick_ms_max = 0.0;
+      server.ticks = 0;
+      next_report_ns += 1000000000LL;
+      if (now_ns >= next_report_ns) next_report_ns = now_ns + 1000000000LL;
+    }
+  }
+  if (failed) fprintf(stderr, "ERROR: The server ran out of memory.\n");
+
+  for (int id = 0; id < MAX_PLAYERS; id++) TR_NetClose(server.players[id].conn);
+  TR_NetCloseListener(listener, address);
+  FreeWorld(&server.world);
+  free(server.claim_tick);
+  free(server.claim_id);
+  free(buffer);
+  return failed ? 1 : 0;
+}
+
+// --- Client ---
+
+// Replays one MSG_TICK. Returns false if it doesn't follow on from the client's world.
+static bool ApplyTick(Client* client, Reader* reader) {
+  World* world = &client->world;
+  static Move moves[MAX_PLAYERS];
+  unsigned int tick = GetVarint(reader);
+  int count = (int)GetVarint(reader);
+  int alive = 0;
+  for (int id = 0; id < MAX_PLAYERS; id++) {
+    if (!world->snakes[id].alive) continue;
+    if (alive < count) moves[alive].id = id;
+    alive++;
+  }
+  if (!reader->ok || tick != world->tick + 1 || count != alive) return false;
+  int packed = 0;
+  for (int i = 0; i < count; i++) {
+    if (i % 2 == 0) packed = GetByte(reader);
+    int nibble = (packed >> ((i % 2) * 4)) & 0xF;
+    moves[i].dir = nibble & 3;
+    moves[i].grew = (nibble & 4) != 0;
+    moves[i].died = (nibble & 8) != 0;
+    if (!moves[i].died) { // A bad move would write outside the map
+      const Snake* snake = &world->snakes[moves[i].id];
+      int head = snake->cells[snake->head];
+      if (!IsInsideWalls(world, head % world->width + dir_x[moves[i].dir], head / world->width + dir_y[moves[i].dir])) return false;
+    }
+  }
+  if (!reader->ok || !ApplyMoves(world, moves, count)) return false;
+  world->tick = tick;
+
+  int num_spawns = (int)GetVarint(reader);
+  for (int i = 0; i < num_spawns && reader->ok; i++) {
+    unsigned int id = GetVarint(reader);
+    unsigned int cell = GetVarint(reader);
+    int dir = GetByte(reader);
+    if (!reader->ok || id >= MAX_PLAYERS || world->snakes[id].alive || cell >= (unsigned int)(world->width * world->height) ||
+        world->owner[cell] != 0 || dir > DIR_LEFT || !SpawnSnake(world, id, cell, dir)) {
+      return false;
+    }
+    if ((int)id == client->id) client->heading = dir;
+  }
+  int num_food = (int)GetVarint(reader);
+  for (int i = 0; i < num_food && reader->ok; i++) {
+    unsigned int cell = GetVarint(reader);
+    if (!reader->ok || cell >= (unsigned int)(world->width * world->height) || world->owner[cell] != 0 || world->food_count == MAX_FOOD) return false;
+    AddFood(world, cell);
+  }
+  if (tick % HASH_INTERVAL == 0 && GetU32(reader) != HashWorld(world)) client->desyncs++;
+  const Snake* own = &world->snakes[client->id];
+  if (own->alive && client->acked_seq == client->seq) client->heading = own->dir; // No turn on the way
+  if (own->alive && own->length > client->best_length) client->best_length = own->length;
+  client->ticks_seen++;
+  return reader->ok;
+}
+
+// Handles every message that has arrived. Returns false once the client can't go on.
+static bool PumpClient(Client* client) {
+  unsigned char type;
+  const unsigned char* data;
+  int length;
+  while (!client->failed && TR_NetReceive(client->conn, &type, &data, &length)) {
+    Reader reader = { data, data + length, true };
+    switch (type) {
+      case MSG_WELCOME: {
+        // Only one welcome: a second InitWorld would drop the world without freeing it
+        bool ok = GetByte(&reader) == PROTOCOL_VERSION && client->world.owner == NULL;
+        unsigned int id = GetVarint(&reader);
+        unsigned int width = GetVarint(&reader);
+        unsigned int height = GetVarint(&reader);
+        client->tick_rate = (int)GetVarint(&reader);
+        client->input_delay = (int)GetVarint(&reader);
+        if (!ok || !reader.ok || id >= MAX_PLAYERS || width < MIN_MAP_SIZE || height < MIN_MAP_SIZE ||
+            width > MAX_MAP_SIZE || height > MAX_MAP_SIZE || !InitWorld(&client->world, (int)width, (int)height)) {
+          client->failed = true;
+          break;
+        }
+        client->id = (int)id;
+        break;
+      }
+      case MSG_STATE:
+        if (client->world.owner == NULL || client->joined || !DecodeState(&client->world, &reader)) client->failed = true;
+        client->joined = true;
+        break;
+      case MSG_TICK:
+        if (!client->joined || !ApplyTick(client, &reader)) {
+          client->desyncs++;
+          client->failed = true;
+        }
+        break;
+      case MSG_ACK: {
+        unsigned int seq = GetVarint(&reader);
+        double ms = Milliseconds(__tr_get_time_ns() - client->sent_ns[seq & 255]);
+        client->input_ms = (client->input_ms > 0.0) ? client->input_ms * 0.8 + ms * 0.2 : ms;
+        client->acked_seq = seq;
+        if (input_samples != NULL && num_input_samples < MAX_SAMPLES) input_samples[num_input_samples++] = ms;
+        break;
+      }
+      case MSG_PONG: {
+        long long sent_ns;
+        if (length != (int)sizeof(sent_ns)) break;
+        memcpy(&sent_ns, data, sizeof(sent_ns));
+        double ms = Milliseconds(__tr_get_time_ns() - sent_ns);
+        client->rtt_ms = (client->rtt_ms > 0.0) ? client->rtt_ms * 0.8 + ms * 0.2 : ms;
+        if (rtt_samples != NULL && num_rtt_samples < MAX_SAMPLES) rtt_samples[num_rtt_samples++] = ms;
+        break;
+      }
+      case MSG_FULL:
+      default:
+        client->failed = true;
+        break;
+    }
+  }
+  return !client->failed && !client->conn->closed;
+}
+
+// Asks for a turn on the tick `input_delay` after the latest one seen
+static void SendTurn(Client* client, int dir) {
+  const Snake* own = &client->world.snakes[client->id];
+  if (!own->alive || dir == client->heading || dir == (client->heading + 2) % 4) return;
+  unsigned char input[16];
+  Writer writer = { input, 0 };
+  client->seq++;
+  PutVarint(&writer, client->seq);
+  PutVarint(&writer, client->world.tick + (unsigned int)client->input_delay);
+  PutByte(&writer, dir);
+  client->sent_ns[client->seq & 255] = __tr_get_time_ns();
+  TR_NetSend(client->conn, MSG_INPUT, writer.data, writer.length);
+  client->heading = dir;
+}
+
+static void SendPing(Client* client, long long now_ns) {
+  if (now_ns < client->next_ping_ns) return;
+  TR_NetSend(client->conn, MSG_PING, &now_ns, (int)sizeof(now_ns));
+  client->next_ping_ns = now_ns + PING_INTERVAL_NS;
+}
+
+// Connects and waits (up to three seconds) for the welcome and the world
+static bool JoinGame(Client* client, const char* address) {
+  memset(client, 0, sizeof(*client));
+  client->conn = TR_NetConnect(address);
+  if (client->conn == NULL) return false;
+  unsigned char version = PROTOCOL_VERSION;
+  TR_NetSend(client->conn, MSG_HELLO, &version, 1);
+  long long deadline_ns = __tr_get_time_ns() + 3000000000LL;
+  while (!client->joined && __tr_get_time_ns() < deadline_ns) {
+    TR_NetFlush(client->conn);
+    TR_NetWait(TR_NET_INVALID_SOCKET, &client->conn, 1, 100);
+    if (!PumpClient(client)) break;
+  }
+  return client->joined && !client->failed;
+}
+
+static void LeaveGame(Client* client) {
+  TR_NetClose(client->conn);
+  FreeWorld(&client->world);
+  client->conn = NULL;
+}
+
+static void DrawClient(const Client* client, double down_kbs, double up_kbs) {
+  static const Color colors[] = { SKYBLUE, YELLOW, MAGENTA, ORANGE, CYAN, PINK, PURPLE, GOLD };
+  const World* world = &client->world;
+  const Snake* own = &world->snakes[client->id];
+  TR_BeginDrawing();
+
+  int screen_width = TR_GetScreenWidth();
+  int screen_height = TR_GetScreenHeight();
+  int view_width = screen_width;
+  int view_height = (screen_height - 3 > 1) ? screen_height - 3 : 1; // 3 rows for the status below
+  int offset_x = (screen_width - world->width) / 2;
+  int offset_y = (screen_height - (world->height + 3)) / 2;
+  if (offset_x < 0) offset_x = 0;
+  if (offset_y < 0) offset_y = 0;
+
+  // Maps bigger than the screen scroll to keep our head (or the middle) in view
+  int focus = own->alive ? own->cells[own->head] : (world->height / 2) * world->width + world->width / 2;
+  int camera_x = 0;
+  int camera_y = 0;
+  if (world->width > view_width) {
+    camera_x = focus % world->width - view_width / 2;
+    if (camera_x > world->width - view_width) camera_x = world->width - view_width;
+    if (camera_x < 0) camera_x = 0;
+  }
+  if (world->height > view_height) {
+    camera_y = focus / world->width - view_height / 2;
+    if (camera_y > world->height - view_height) camera_y = world->height - view_height;
+    if (camera_y < 0) camera_y = 0;
+  }
+  int visible_width = (world->width < view_width) ? world->width : view_width;
+  int visible_height = (world->height < view_height) ? world->height : view_height;
+
+  for (int y = camera_y; y < camera_y + visible_height; y++) {
+    for (int x = camera_x; x < camera_x + visible_width; x++) {
+      int cell = y * world->width + x;
+      int owner = world->owner[cell];
+      char cell_char;
+      Color cell_color;
+      if (owner == FOOD_OWNER) {
+        cell_char = FOOD_CHAR;
+        cell_color = FOOD_COLOR;
+      } else if (owner != 0) {
+        int id = owner - 1;
+        bool head = (world->snakes[id].cells[world->snakes[id].head] == cell);
+        if (id == client->id) {
+          cell_char = head ? OWN_HEAD : BODY_CHAR;
+          cell_color = head ? OWN_HEAD_COLOR : OWN_BODY_COLOR;
+        } else {
+          cell_char = head ? OTHER_HEAD : BODY_CHAR;
+          cell_color = colors[id % (int)(sizeof(colors) / sizeof(colors[0]))];
+        }
+      } else if (!IsInsideWalls(world, x, y)) {
+        cell_char = WALL_CHAR;
+        cell_color = WALL_COLOR;
+      } else {
+        continue;
+      }
+      char cell_text[2] = { cell_char, '\0' };
+      TR_DrawText(cell_text, x - camera_x + offset_x, y - camera_y + offset_y, 10, cell_color, BG_COLOR);
+    }
+  }
+
+  int players = 0;
+  for (int id = 0; id < MAX_PLAYERS; id++) players += world->snakes[id].alive;
+  char line[256];
+  if (own->alive) {
+    snprintf(line, sizeof(line), "Player %d | Length %d (best %d) | %d snakes | Tick %u", client->id, own->length, client->best_length, players, world->tick);
+  } else {
+    snprintf(line, sizeof(line), "Player %d | Respawning... (best %d) | %d snakes | Tick %u", client->id, client->best_length, players, world->tick);
+  }
+  TR_DrawText(line, offset_x + 1, screen_height - 2, 10, TEXT_COLOR, BLACK);
+  snprintf(line, sizeof(line), "RTT %.2f ms | Input %.0f ms (%d-tick delay) | Down %.1f KB/s | Up %.2f KB/s%s | WASD/Arrows: Turn | Q: Quit",
+           client->rtt_ms, client->input_ms, client->input_delay, down_kbs, up_kbs, client->desyncs ? " | DESYNC" : "");
+  TR_DrawText(line, offset_x + 1, screen_height - 1, 10, LIGHTGRAY, BLACK);
+
+  TR_EndDrawing();
+}
+
+int RunClient(const char* address) {
+  static Client client; // Too big for the stack
+  if (!JoinGame(&client, address)) {
+    bool full = client.conn != NULL && client.failed && !client.joined;
+    fprintf(stderr, "ERROR: Can't join a game at %s%s.\n", address,
+            full ? " (the server is full or speaks another version)" : " (start one with trnetsnake -s)");
+    LeaveGame(&client);
+    return 1;
+  }
+
+  TR_InitWindow(client.world.width, client.world.height + 3, "tread.h - TRNetSnake");
+  TR_SetTargetFPS(CLIENT_FPS);
+
+  unsigned long long last_received = 0;
+  unsigned long long last_sent = 0;
+  long long last_rate_ns = __tr_get_time_ns();
+  double down_kbs = 0.0;
+  double up_kbs = 0.0;
+  bool running = true;
+  while (running) {
+    switch (TR_GetKeyPressed()) {
+      case 'w': case 'W': case TR_KEY_UP: SendTurn(&client, DIR_UP); break;
+      case 'd': case 'D': case TR_KEY_RIGHT: SendTurn(&client, DIR_RIGHT); break;
+      case 's': case 'S': case TR_KEY_DOWN: SendTurn(&client, DIR_DOWN); break;
+      case 'a': case 'A': case TR_KEY_LEFT: SendTurn(&client, DIR_LEFT); break;
+      case 'q': case 'Q': case TR_KEY_ESCAPE: running = false; break;
+    }
+    long long now_ns = __tr_get_time_ns();
+    SendPing(&client, now_ns);
+    TR_NetFlush(client.conn);
+    if (!PumpClient(&client)) break;
+
+    if (now_ns - last_rate_ns >= 1000000000LL) {
+      double seconds = (double)(now_ns - last_rate_ns) / 1e9;
+      down_kbs = (double)(client.conn->bytes_received - last_received) / 1024.0 / seconds;
+      up_kbs = (double)(client.conn->bytes_sent - last_sent) / 1024.0 / seconds;
+      last_received = client.conn->bytes_received;
+      last_sent = client.conn->bytes_sent;
+      last_rate_ns = now_ns;
+    }
+    DrawClient(&client, down_kbs, up_kbs);
+  }
+
+  bool lost = running; // Left the loop without Q: the server went away or stopped making sense
+  TR_CloseWindow();
+  if (lost) fprintf(stderr, "%s\n", client.failed ? "ERROR: The game from the server stopped adding up." : "The server closed the connection.");
+  LeaveGame(&client);
+  return lost ? 1 : 0;
+}
+
+// --- Bots ---
+
+// Heads for the nearest food along whichever safe move gets closest, preferring straight on
+static int ChooseBotDir(const Client* bot) {
+  const World* world = &bot->world;
+  const Snake* snake = &world->snakes[bot->id];
+  int head = snake->cells[snake->head];
+  int best = -1;
+  int best_distance = 0;
+  for (int dir = 0; dir < 4; dir++) {
+    if (dir == (bot->heading + 2) % 4) continue;
+    int x = head % world->width + dir_x[dir];
+    int y = head / world->width + dir_y[dir];
+    if (!IsInsideWalls(world, x, y)) continue;
+    int owner = world->owner[y * world->width + x];
+    if (owner != 0 && owner != FOOD_OWNER) continue;
+    int distance = world->width + world->height;
+    for (int i = 0; i < world->food_count; i++) {
+      int food_distance = abs(world->food[i] % world->width - x) + abs(world->food[i] / world->width - y);
+      if (food_distance < distance) distance = food_distance;
+    }
+    if (best < 0 || distance < best_distance || (distance == best_distance && dir == bot->heading)) {
+      best = dir;
+      best_distance = distance;
+    }
+  }
+  return (best < 0) ? bot->heading : best;
+}
+
+static int CompareDoubles(const void* a, const void* b) {
+  double x = *(const double*)a;
+  double y = *(const double*)b;
+  return (x > y) - (x < y);
+}
+
+static void PrintPercentiles(const char* label, double* samples, int count) {
+  if (count == 0) {
+    printf("  %-14s no samples\n", label);
+    return;
+  }
+  qsort(samples, (size_t)count, sizeof(double), CompareDoubles);
+  printf("  %-14s p50 %8.3f ms  p90 %8.3f ms  p99 %8.3f ms  max %8.3f ms  (%d samples)\n", label,
+         samples[count / 2], samples[count * 9 / 10], samples[count * 99 / 100], samples[count - 1], count);
+}
+
+int RunBots(const char* address, int count, double seconds) {
+  Client* bots = (Client*)calloc((size_t)count, sizeof(Client));
+  TR_NetConn** conns = (TR_NetConn**)calloc((size_t)count, sizeof(TR_NetConn*));
+  rtt_samples = (double*)malloc(sizeof(double) * MAX_SAMPLES);
+  input_samples = (double*)malloc(sizeof(double) * MAX_SAMPLES);
+  if (bots == NULL || conns == NULL || rtt_samples == NULL || input_samples == NULL) {
+    fprintf(stderr, "ERROR: Failed to allocate %d bots.\n", count);
+    return 1;
+  }
+  srand((unsigned int)time(NULL));
+
+  int joined = 0;
+  for (int i = 0; i < count; i++) {
+    if (JoinGame(&bots[i], address)) joined++;
+    else bots[i].failed = true;
+    conns[i] = bots[i].conn;
+  }
+  printf("trnetsnake bots: %d of %d joined %s, running for %.1f s\n", joined, count, address, seconds);
+  fflush(stdout);
+
+  long long start_ns = __tr_get_time_ns();
+  long long end_ns = start_ns + (long long)(seconds * 1e9);
+  while (__tr_get_time_ns() < end_ns) {
+    TR_NetWait(TR_NET_INVALID_SOCKET, conns, count, 10);
+    long long now_ns = __tr_get_time_ns();
+    for (int i = 0; i < count; i++) {
+      Client* bot = &bots[i];
+      if (bot->failed) continue;
+      unsigned int tick = bot->world.tick;
+      if (PumpClient(bot)) {
+        if (bot->world.tick != tick && bot->world.snakes[bot->id].alive) SendTurn(bot, ChooseBotDir(bot)); // Think once per tick
+        SendPing(bot, now_ns);
+      }
+      if (!TR_NetFlush(bot->conn) || bot->conn->closed || bot->failed) {
+        bot->failed = true;
+        conns[i] = NULL;
+      }
+    }
+  }
+
+  double elapsed = (double)(__tr_get_time_ns() - start_ns) / 1e9;
+  unsigned long long received = 0;
+  unsigned long long sent = 0;
+  long long ticks = 0;
+  int failed = 0;
+  int desyncs = 0;
+  int best_length = 0;
+  for (int i = 0; i < count; i++) {
+    if (bots[i].conn != NULL) {
+      received += bots[i].conn->bytes_received;
+      sent += bots[i].conn->bytes_sent;
+    }
+    ticks += bots[i].ticks_seen;
+    failed += bots[i].failed;
+    desyncs += bots[i].desyncs;
+    if (bots[i].best_length > best_length) best_length = bots[i].best_length;
+  }
+  printf("  %d bots dropped or failed, %d desyncs, best length %d\n", failed, desyncs, best_length);
+  PrintPercentiles("round trip", rtt_samples, num_rtt_samples);
+  PrintPercentiles("input latency", input_samples, num_input_samples);
+  printf("  %-14s %.2f KB/s per bot, %.1f KB/s in all\n", "down", received / 1024.0 / elapsed / (joined ? joined : 1), received / 1024.0 / elapsed);
+  printf("  %-14s %.3f KB/s per bot, %.1f KB/s in all\n", "up", sent / 1024.0 / elapsed / (joined ? joined : 1), sent / 1024.0 / elapsed);
+  printf("  %-14s %.1f bytes per bot per tick\n", "deltas", ticks ? (double)received / ticks : 0.0);
+
+  for (int i = 0; i < count; i++) LeaveGame(&bots[i]);
+  free(bots);
+  free(conns);
+  free(rtt_samples);
+  free(input_samples);
+  return (joined == count && failed == 0 && desyncs == 0) ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+  const char* address = DEFAULT_ADDRESS;
+  bool serve = false;
+  int bots = 0;
+  int width = MAP_WIDTH;
+  int height = MAP_HEIGHT;
+  int tick_rate = TICK_RATE;
+  int input_delay = INPUT_DELAY;
+  double seconds = 0.0;
+  bool valid = true;
+  for (int i = 1; i < argc && valid; i++) {
+    bool has_value = (i + 1 < argc);
+    if (strcmp(argv[i], "-s") == 0) serve = true;
+    else if (strcmp(argv[i], "-a") == 0 && has_value) address = argv[++i];
+    else if (strcmp(argv[i], "-b") == 0 && has_value) bots = atoi(argv[++i]);
+    else if (strcmp(argv[i], "-r") == 0 && has_value) tick_rate = atoi(argv[++i]);
+    else if (strcmp(argv[i], "-d") == 0 && has_value) input_delay = atoi(argv[++i]);
+    else if (strcmp(argv[i], "-t") == 0 && has_value) seconds = atof(argv[++i]);
+    else if (strcmp(argv[i], "-m") == 0 && i + 2 < argc) {
+      width = atoi(argv[++i]);
+      height = atoi(argv[++i]);
+    }
+    else valid = false;
+  }
+  if (!valid || (serve && bots > 0) || bots < 0 || tick_rate < 1 || tick_rate > 1000 || input_delay < 0 || input_delay > 100 || seconds < 0.0) {
+    fprintf(stderr, "Usage: %s [-a address]\n"
+                    "       %s -s [-a address] [-m width height] [-r ticks_per_second] [-d delay_ticks] [-t seconds]\n"
+                    "       %s -b bots [-a address] [-t seconds]\n", argv[0], argv[0], argv[0]);
+    return 1;
+  }
+  if (width < MIN_MAP_SIZE || height < MIN_MAP_SIZE || width > MAX_MAP_SIZE || height > MAX_MAP_SIZE) {
+    fprintf(stderr, "ERROR: The map must be between %dx%d and %dx%d.\n", MIN_MAP_SIZE, MIN_MAP_SIZE, MAX_MAP_SIZE, MAX_MAP_SIZE);
+    return 1;
+  }
+  if (bots > MAX_PLAYERS) {
+    fprintf(stderr, "ERROR: A server takes at most %d players.\n", MAX_PLAYERS);
+    return 1;
+  }
+
+  if (serve) return RunServer(address, width, height, tick_rate, input_delay, seconds);
+  if (bots > 0) return RunBots(address, bots, (seconds > 0.0) ? seconds : 10.0);
+  return RunClient(address);
+}
@@ -1,13 +1,26 @@
+#define TR_HEADLESS
+#define TR_TILEMAP
 #include "../../tread.h"
 
-#include <time.h>   // For time (to seed rand)
+#include <time.h>   // For time (to seed the RNG) and clock (for the benchmark)
 
 // --- Game Configuration ---
-// MAP_WIDTH and MAP_HEIGHT define the logical size of the game board.
+// MAP_WIDTH and MAP_HEIGHT define the logical size of the built-in board.
+// trpacman <width> <height> [ghosts] generates a maze of another size instead.
 // The game will be drawn centered within the actual terminal size.
 #define MAP_WIDTH   31
 #define MAP_HEIGHT 21
+#define MIN_MAP_SIZE 7
+#define MAX_MAP_SIZE 2048
+#define NUM_GHOSTS  2 // Default ghost count
+#define MAX_GHOSTS  4096
 #define FPS    10
+#define HEADLESS_TICKS 100000 // Default tick limit per headless instance
+
+// --- Ghost AI Configuration ---
+#define GHOST_REST_INTERVAL 5 // Ghosts sit out one tick in this many, so Pac-Man can outrun them
+#define MIN_SPAWN_DISTANCE 8  // Extra ghosts start at least this many steps from Pac-Man
+#define BRAID_CHANCE 12       // Percent of dead-end walls knocked through in generated mazes
 
 // --- Game Characters ---
 #define WALL_CHAR   '#'
@@ -16,16 +29,27 @@
 #define GHOST_CHAR   'M'
 #define EMPTY_CHAR   ' '
 
+// --- Tile Types (for drawing the maze through a TR_TileMap) ---
+#define TILE_EMPTY  0
+#define TILE_WALL   1
+#define TILE_PELLET 2
+
 // --- Game Colors ---
 #define WALL_COLOR   BLUE
 #define PELLET_COLOR WHITE
 #define PACMAN_COLOR YELLOW
 #define GHOST_COLOR   RED
+#define SCATTER_COLOR PINK
 #define TEXT_COLOR   WHITE
 #define BG_COLOR   BLACK
 #define GAME_OVER_COLOR MAROON
 #define WIN_COLOR   LIME
 
+// --- Headless Outcomes ---
+#define OUTCOME_LOST 0
+#define OUTCOME_WON 1
+#define OUTCOME_TIMED_OUT 2 // Still alive when the tick limit ran out
+
 // --- Game State Structs ---
 typedef struct {
   int x;
@@ -34,8 +58,63 @@ typedef struct {
   int dy; // direction y
 } Entity;
 
+typedef enum {
+  MODE_SCATTER, // Ghosts head for their corners
+  MODE_CHASE    // Ghosts head for Pac-Man
+} GhostMode;
+
+// Everything one game needs, so the terminal game and any number of headless
+// instances can each have their own
+typedef struct {
+  int map_width;
+  int map_height;
+  char* game_map; // map_width * map_height cells, indexed y * map_width + x. The border is always wall.
+
+  // Distance fields: BFS step counts to a target over the open cells (-2 for walls, -1
+  // for cells the target can't be reached from). Ghosts only ever compare their four
+  // neighbours in one, so a ghost's move is O(1) however big the maze or however many
+  // ghosts there are.
+  int* chase_field;       // Distance to Pac-Man, rebuilt only when he changes tile
+  int chase_field_source; // The cell chase_field was built from
+  int* scatter_fields[4]; // Distance to each corner, built once per maze
+  int scatter_cells[4];   // The open cell nearest each corner
+  int* bfs_queue;
+
+  // Scratch space for the AI player. ai_distance and ai_parent are only valid where
+  // ai_stamp matches ai_search, so nothing has to be cleared between searches.
+  int* ghost_field; // Steps from the nearest ghost, like the distance fields
+  unsigned int* ai_stamp;
+  int* ai_distance;
+  int* ai_parent;
+  unsigned int ai_search;
+
+  Entity pacman;
+  Entity* ghosts;
+  int num_ghosts;
+  GhostMode ghost_mode;
+  int mode_index;
+  int mode_timer;
+  int tick_count;
+  int score;
+  int total_pellets;
+  bool game_over;
+  bool game_won;
+  TR_Rng rng; // Maze, spawns and the AI's tie-breaks, so a seed replays the same game
+  TR_TileMap* tiles; // The maze as DrawGame shows it, NULL in headless runs
+} PacmanGame;
+
+// Settings shared by every headless instance
+typedef struct {
+  int map_width;
+  int map_height;
+  bool generate;
+  int num_ghosts;
+  long long max_ticks;
+  const char* script; // Keys to press, one per tick ('.' for none), or NULL to let the AI play
+} HeadlessConfig;
+
 // --- Game Variables ---
-char game_map[MAP_HEIGHT][MAP_WIDTH + 1] = { // +1 for null terminator
+const char default_map[MAP_HEIGHT][MAP_WIDTH + 1] = { // +1 for null terminator
   "###############################",
   "#.............................#",
   "#.###.###.###.###.###.###.###.#",
@@ -59,26 +138,105 @@ char game_map[MAP_HEIGHT][MAP_WIDTH + 1] = { // +1 for null terminator
   "###############################"
 };
 
-Entity pacman;
-Entity ghosts[2]; // Two ghosts for simplicity
-int score = 0;
-int total_pellets = 0;
-bool game_over = false;
-bool game_won = false;
+// Chase/scatter schedule in ticks; the last mode lasts for the rest of the game
+const GhostMode mode_schedule[] = { MODE_SCATTER, MODE_CHASE, MODE_SCATTER, MODE_CHASE, MODE_SCATTER, MODE_CHASE };
+const int mode_ticks[] = { 7 * FPS, 20 * FPS, 7 * FPS, 20 * FPS, 5 * FPS, 0 };
 
 // --- Function Prototypes ---
-void InitGame();
-void UpdateGame();
-void DrawGame();
+bool InitGame(PacmanGame* game, int width, int height, bool generate, int num_ghosts, uint64_t seed);
+void FreeGame(PacmanGame* game);
+void UpdateGame(PacmanGame* game, int key);
+bool CreateTileMap(PacmanGame* game);
+void DrawGame(const PacmanGame* game);
 bool IsColliding(Entity e1, Entity e2);
-void GetRandomDirection(int* dx, int* dy);
+bool CreateMaze(PacmanGame* game, int width, int height, bool generate);
+void GenerateMaze(PacmanGame* game);
+void ComputeDistanceField(PacmanGame* game, int* field, int source);
+void MoveGhost(const PacmanGame* game, Entity* ghost, const int* field);
+int FindNearestOpenCell(const PacmanGame* game, int x, int y);
+int SearchAhead(PacmanGame* game, int from, int blocked, int* target, int first_dir);
+int ChooseAIKey(PacmanGame* game);
+int ScriptKey(char c);
+void RunHeadlessInstance(int index, TR_Rng* rng, void* user, TR_HeadlessResult* result);
+void RunBenchmark();
+
+int main(int argc, char* argv[]) {
+  // Usage: trpacman [width height [ghosts]] [-H instances [-n ticks] [-S seed] [-j threads] [-i keys]] | -b
+  int map_width = MAP_WIDTH;
+  int map_height = MAP_HEIGHT;
+  int num_ghosts = NUM_GHOSTS;
+  bool generate = false;
+  int instances = 0; // 0 to play in the terminal
+  int threads = 0;   // 0 for one per core
+  unsigned long long seed = 1;
+  HeadlessConfig config = { 0, 0, false, 0, HEADLESS_TICKS, NULL };
+  int positional[3];
+  int num_positional = 0;
+  if (argc == 2 && strcmp(argv[1], "-b") == 0) {
+    RunBenchmark();
+    return 0;
+  }
+  for (int i = 1; i < argc; i++) {
+    bool has_value = (i + 1 < argc);
+    if (strcmp(argv[i], "-H") == 0 && has_value) instances = atoi(argv[++i]);
+    else if (strcmp(argv[i], "-n") == 0 && has_value) config.max_ticks = atoll(argv[++i]);
+    else if (strcmp(argv[i], "-S") == 0 && has_value) seed = strtoull(argv[++i], NULL, 10);
+    else if (strcmp(argv[i], "-j") == 0 && has_value) threads = atoi(argv[++i]);
+    else if (strcmp(argv[i], "-i") == 0 && has_value) config.script = argv[++i];
+    else if (argv[i][0] != '-' && num_positional < 3) positional[num_positional++] = atoi(argv[i]);
+    else num_positional = -1;
+    if (num_positional < 0) break;
+  }
+  if (num_positional == 1 || num_positional < 0 || instances < 0 || config.max_ticks <= 0) {
+    fprintf(stderr, "Usage: %s [width height [ghosts]] [-H instances [-n ticks] [-S seed] [-j threads] [-i keys]] | -b\n", argv[0]);
+    return 1;
+  }
+
+  // Optional generated maze: trpacman <width> <height> [ghosts]
+  if (num_positional >= 2) {
+    map_width = positional[0];
+    map_height = positional[1];
+    if (map_width < MIN_MAP_SIZE || map_height < MIN_MAP_SIZE ||
+        map_width > MAX_MAP_SIZE || map_height > MAX_MAP_SIZE) {
+      fprintf(stderr, "ERROR: The map must be between %dx%d and %dx%d.\n", MIN_MAP_SIZE, MIN_MAP_SIZE, MAX_MAP_SIZE, MAX_MAP_SIZE);
+      return 1;
+    }
+    if (num_positional == 3) {
+      num_ghosts = positional[2];
+      if (num_ghosts < 0 || num_ghosts > MAX_GHOSTS) {
+        fprintf(stderr, "ERROR: The ghost count must be between 0 and %d.\n", MAX_GHOSTS);
+        return 1;
+      }
+    }
+    generate = true;
+  }
 
-int main() {
-  // Initialize random seed
-  srand((unsigned int)time(NULL));
+  // Headless: run the instances flat out and print the totals
+  if (instances > 0) {
+    config.map_width = map_width;
+    config.map_height = map_height;
+    config.generate = generate;
+    config.num_ghosts = num_ghosts;
+    TR_HeadlessReport report = TR_RunHeadless(instances, threads, seed, RunHeadlessInstance, &config);
+    const char* const outcome_names[TR_HEADLESS_OUTCOMES] = { "Lost:", "Won:", "Timed out:", NULL };
+    TR_PrintHeadlessReport(stdout, &report, outcome_names);
+    return (report.instances == instances) ? 0 : 1;
+  }
+
+  // TR_RegisterSeed keeps the seed in input recordings, so a replay plays the same game
+  PacmanGame game;
+  if (!InitGame(&game, map_width, map_height, generate, num_ghosts, TR_RegisterSeed((uint64_t)time(NULL)))) {
+    fprintf(stderr, "ERROR: Failed to allocate a %dx%d maze.\n", map_width, map_height);
+    return 1;
+  }
+  if (!CreateTileMap(&game)) {
+    fprintf(stderr, "ERROR: Failed to allocate a %dx%d maze.\n", map_width, map_height);
+    FreeGame(&game);
+    return 1;
+  }
 
   // Initialize the game window. tread.h will use the actual terminal size.
-  TR_InitWindow(MAP_WIDTH, MAP_HEIGHT + 3, "tread.h - TRPac-Man");
+  TR_InitWindow(map_width, map_height + 3, "tread.h - TRPac-Man");
 
   // Get actual screen dimensions for positioning
   int actual_screen_width = TR_GetScreenWidth();
@@ -87,12 +245,10 @@ int main() {
   // Adjust FPS based on your monitor or preference
   TR_SetTargetFPS(FPS);
 
-  InitGame();
-
   // Main game loop
-  while (!TR_WindowShouldClose() && !game_over && !game_won) {
-    UpdateGame();
-    DrawGame();
+  while (!TR_WindowShouldClose() && !game.game_over && !game.game_won) {
+    UpdateGame(&game, TR_GetKeyPressed());
+    DrawGame(&game);
   }
 
   // Final draw for game over/win screen
@@ -103,17 +259,17 @@ int main() {
   int text_center_x = actual_screen_width / 2;
   int text_center_y = actual_screen_height / 2;
 
-  if (game_won) {
+  if (game.game_won) {
     TR_DrawText("YOU WIN!", text_center_x - (int)(strlen("YOU WIN!") / 2), text_center_y - 1, 20, WIN_COLOR, BLACK);
     TR_DrawText("Score:", text_center_x - (int)(strlen("Score:") / 2), text_center_y + 1, 10, TEXT_COLOR, BLACK);
     char score_str[20];
-    sprintf(score_str, "%d", score);
+    sprintf(score_str, "%d", game.score);
     TR_DrawText(score_str, text_center_x - (int)(strlen(score_str) / 2), text_center_y + 2, 10, TEXT_COLOR, BLACK);
   } else {
     TR_DrawText("GAME OVER!", text_center_x - (int)(strlen("GAME OVER!") / 2), text_center_y - 1, 20, GAME_OVER_COLOR, BLACK);
     TR_DrawText("Final Score:", text_center_x - (int)(strlen("Final Score:") / 2), text_center_y + 1, 10, TEXT_COLOR, BLACK);
     char score_str[20];
-    sprintf(score_str, "%d", score);
+    sprintf(score_str, "%d", game.score);
     TR_DrawText(score_str, text_center_x - (int)(strlen(score_str) / 2), text_center_y + 2, 10, TEXT_COLOR, BLACK);
   }
   TR_EndDrawing();
@@ -129,158 +285,227 @@ int main() {
   // De-Initialization
   TR_CloseWindow();
 
+  FreeGame(&game);
+
   return 0;
 }
 
 // --- Game Functions ---
 
-void InitGame() {
-  // Count total pellets and set initial positions
-  total_pellets = 0; // Reset for new game
-  for (int y = 0; y < MAP_HEIGHT; y++) {
-    for (int x = 0; x < MAP_WIDTH; x++) {
-      if (game_map[y][x] == PELLET_CHAR) {
-        total_pellets++;
-      }
+// Sets up a new game on the built-in board or a generated maze. Returns false if
+// it couldn't be allocated.
+bool InitGame(PacmanGame* game, int width, int height, bool generate, int num_ghosts, uint64_t seed) {
+  memset(game, 0, sizeof(*game));
+  TR_RngSeed(&game->rng, seed);
+  if (!CreateMaze(game, width, height, generate)) return false;
+  int num_cells = width * height;
+
+  // Count total pellets
+  game->total_pellets = 0; // Reset for new game
+  for (int cell = 0; cell < num_cells; cell++) {
+    if (game->game_map[cell] == PELLET_CHAR) {
+      game->total_pellets++;
     }
   }
 
   // Set Pac-Man's initial position
-  pacman.x = MAP_WIDTH / 2;
-  pacman.y = MAP_HEIGHT / 2;
-  pacman.dx = 0;
-  pacman.dy = 0;
-
-  // Set Ghost initial positions
-  ghosts[0].x = 1;
-  ghosts[0].y = 1;
-  GetRandomDirection(&ghosts[0].dx, &ghosts[0].dy);
-
-  ghosts[1].x = MAP_WIDTH - 2;
-  ghosts[1].y = MAP_HEIGHT - 2;
-  GetRandomDirection(&ghosts[1].dx, &ghosts[1].dy);
+  int start = FindNearestOpenCell(game, width / 2, height / 2);
+  game->pacman.x = start % width;
+  game->pacman.y = start / width;
+  game->pacman.dx = 0;
+  game->pacman.dy = 0;
+  ComputeDistanceField(game, game->chase_field, start);
+  game->chase_field_source = start;
+
+  // The first four ghosts start in their scatter corners, the rest anywhere far enough from Pac-Man
+  game->num_ghosts = num_ghosts;
+  game->ghosts = (Entity*)malloc(sizeof(Entity) * (num_ghosts > 0 ? num_ghosts : 1));
+  if (game->ghosts == NULL) {
+    FreeGame(game);
+    return false;
+  }
+  for (int i = 0; i < num_ghosts; i++) {
+    int cell = game->scatter_cells[i % 4];
+    if (i >= 4) {
+      for (int attempt = 0; attempt < 1000; attempt++) {
+        int candidate = TR_RngRange(&game->rng, num_cells);
+        if (game->chase_field[candidate] >= MIN_SPAWN_DISTANCE) {
+          cell = candidate;
+          break;
+        }
+      }
+    }
+    game->ghosts[i].x = cell % width;
+    game->ghosts[i].y = cell / width;
+    game->ghosts[i].dx = 0;
+    game->ghosts[i].dy = 0;
+  }
+
+  game->ghost_mode = mode_schedule[0];
+  game->mode_index = 0;
+  game->mode_timer = mode_ticks[0];
+  game->tick_count = 0;
+  game->score = 0;
+  game->game_over = false;
+  game->game_won = false;
+  return true;
+}
+
+void FreeGame(PacmanGame* game) {
+  TR_TileMapDestroy(game->tiles);
+  free(game->game_map);
+  free(game->chase_field);
+  free(game->bfs_queue);
+  free(game->ai_stamp);
+  free(game->ghost_field);
+  free(game->ai_distance);
+  free(game->ai_parent);
+  free(game->ghosts);
+  for (int i = 0; i < 4; i++) {
+    free(game->scatter_fields[i]);
+  }
+  memset(game, 0, sizeof(*game));
 }
 
-void UpdateGame() {
+// Advances the game by one tick. key is the key pressed this tick, or 0.
+void UpdateGame(PacmanGame* game, int key) {
+  int map_width = game->map_width;
+  Entity* pacman = &game->pacman;
+
   // --- Handle Input ---
-  int key = TR_GetKeyPressed();
   if (key != 0) {
-    if (key == 'w' || key == TR_KEY_UP) { pacman.dx = 0; pacman.dy = -1; }
-    else if (key == 's' || key == TR_KEY_DOWN) { pacman.dx = 0; pacman.dy = 1; }
-    else if (key == 'a' || key == TR_KEY_LEFT) { pacman.dx = -1; pacman.dy = 0; }
-    else if (key == 'd' || key == TR_KEY_RIGHT) { pacman.dx = 1; pacman.dy = 0; }
+    if (key == 'w' || key == TR_KEY_UP) { pacman->dx = 0; pacman->dy = -1; }
+    else if (key == 's' || key == TR_KEY_DOWN) { pacman->dx = 0; pacman->dy = 1; }
+    else if (key == 'a' || key == TR_KEY_LEFT) { pacman->dx = -1; pacman->dy = 0; }
+    else if (key == 'd' || key == TR_KEY_RIGHT) { pacman->dx = 1; pacman->dy = 0; }
   }
 
   // --- Move Pac-Man ---
-  int nextPacmanX = pacman.x + pacman.dx;
-  int nextPacmanY = pacman.y + pacman.dy;
+  int nextPacmanX = pacman->x + pacman->dx;
+  int nextPacmanY = pacman->y + pacman->dy;
 
   // Check bounds and wall collision for Pac-Man
-  if (nextPacmanX >= 0 && nextPacmanX < MAP_WIDTH &&
-    nextPacmanY >= 0 && nextPacmanY < MAP_HEIGHT &&
-    game_map[nextPacmanY][nextPacmanX] != WALL_CHAR) {
-    pacman.x = nextPacmanX;
-    pacman.y = nextPacmanY;
+  if (nextPacmanX >= 0 && nextPacmanX < map_width &&
+    nextPacmanY >= 0 && nextPacmanY < game->map_height &&
+    game->game_map[nextPacmanY * map_width + nextPacmanX] != WALL_CHAR) {
+    pacman->x = nextPacmanX;
+    pacman->y = nextPacmanY;
 
     // Check for pellet
-    if (game_map[pacman.y][pacman.x] == PELLET_CHAR) {
-      game_map[pacman.y][pacman.x] = EMPTY_CHAR; // Eat pellet
-      score += 10;
-      total_pellets--;
+    if (game->game_map[pacman->y * map_width + pacman->x] == PELLET_CHAR) {
+      game->game_map[pacman->y * map_width + pacman->x] = EMPTY_CHAR; // Eat pellet
+      if (game->tiles != NULL) TR_TileMapSet(game->tiles, pacman->x, pacman->y, TILE_EMPTY);
+      game->score += 10;
+      game->total_pellets--;
+    }
+  }
+
+  // Maps bigger than the screen scroll to keep Pac-Man in view (3 rows below the map
+  // are for the score and messages)
+  if (game->tiles != NULL) {
+    int view_height = TR_GetScreenHeight() - 3;
+    TR_TileMapFollow(game->tiles, pacman->x, pacman->y, TR_GetScreenWidth(), (view_height > 1) ? view_height : 1);
+  }
+
+  // Catch ghosts Pac-Man walked into before they move, so the two can't swap places
+  for (int i = 0; i < game->num_ghosts; i++) {
+    if (IsColliding(*pacman, game->ghosts[i])) {
+      game->game_over = true;
+      return;
+    }
+  }
+
+  // --- Switch between scatter and chase ---
+  // Ghosts turn around whenever the mode changes, like in the arcade game
+  if (game->mode_timer > 0 && --game->mode_timer == 0) {
+    game->mode_index++;
+    game->ghost_mode = mode_schedule[game->mode_index];
+    game->mode_timer = mode_ticks[game->mode_index];
+    for (int i = 0; i < game->num_ghosts; i++) {
+      game->ghosts[i].dx = -game->ghosts[i].dx;
+      game->ghosts[i].dy = -game->ghosts[i].dy;
     }
   }
 
   // --- Move Ghosts ---
-  for (int i = 0; i < sizeof(ghosts) / sizeof(Entity); i++) {
-    int nextGhostX = ghosts[i].x + ghosts[i].dx;
-    int nextGhostY = ghosts[i].y + ghosts[i].dy;
-
-    // Simple ghost AI: change direction if hitting a wall or randomly
-    if (nextGhostX < 0 || nextGhostX >= MAP_WIDTH ||
-      nextGhostY < 0 || nextGhostY >= MAP_HEIGHT ||
-      game_map[nextGhostY][nextGhostX] == WALL_CHAR ||
-      (rand() % 10 == 0)) // 10% chance to change direction randomly
-    {
-      GetRandomDirection(&ghosts[i].dx, &ghosts[i].dy);
-    } else {
-      ghosts[i].x = nextGhostX;
-      ghosts[i].y = nextGhostY;
+  // The chase field is only rebuilt when Pac-Man reaches a new tile
+  int pacman_cell = pacman->y * map_width + pacman->x;
+  if (game->ghost_mode == MODE_CHASE && game->chase_field_source != pacman_cell) {
+    ComputeDistanceField(game, game->chase_field, pacman_cell);
+    game->chase_field_source = pacman_cell;
+  }
+  game->tick_count++;
+  if (game->tick_count % GHOST_REST_INTERVAL != 0) {
+    for (int i = 0; i < game->num_ghosts; i++) {
+      MoveGhost(game, &game->ghosts[i], game->ghost_mode == MODE_CHASE ? game->chase_field : game->scatter_fields[i % 4]);
     }
   }
 
   // --- Check Collisions ---
-  for (int i = 0; i < sizeof(ghosts) / sizeof(Entity); i++) {
-    if (IsColliding(pacman, ghosts[i])) {
-      game_over = true;
+  for (int i = 0; i < game->num_ghosts; i++) {
+    if (IsColliding(*pacman, game->ghosts[i])) {
+      game->game_over = true;
       break;
     }
   }
 
   // --- Check Win Condition ---
-  if (total_pellets <= 0) {
-    game_won = true;
+  if (game->total_pellets <= 0) {
+    game->game_won = true;
   }
 }
 
-void DrawGame() {
+void DrawGame(const PacmanGame* game) {
   TR_BeginDrawing();
 
   // Clear the background for the entire game area
   TR_ClearBackground(BG_COLOR);
 
+  int map_width = game->map_width;
+  int map_height = game->map_height;
+  const Entity* pacman = &game->pacman;
+
   // Get actual screen dimensions for positioning
   int actual_screen_width = TR_GetScreenWidth();
   int actual_screen_height = TR_GetScreenHeight();
+  int view_width = actual_screen_width;
+  int view_height = actual_screen_height - 3; // 3 rows for score/messages below map
+  if (view_height < 1) view_height = 1;
 
   // Calculate offset to center the game map
-  int offset_x = (actual_screen_width - MAP_WIDTH) / 2;
-  int offset_y = (actual_screen_height - (MAP_HEIGHT + 3)) / 2; // +3 for score/messages below map
+  int offset_x = (actual_screen_width - map_width) / 2;
+  int offset_y = (actual_screen_height - (map_height + 3)) / 2; // +3 for score/messages below map
 
   // Ensure offsets are not negative (if screen is smaller than map)
   if (offset_x < 0) offset_x = 0;
   if (offset_y < 0) offset_y = 0;
 
-  // Draw the map
-  for (int y = 0; y < MAP_HEIGHT; y++) {
-    for (int x = 0; x < MAP_WIDTH; x++) {
-      int draw_x = x + offset_x;
-      int draw_y = y + offset_y;
-
-      // Only draw if within actual screen bounds
-      if (draw_x >= 0 && draw_x < actual_screen_width &&
-        draw_y >= 0 && draw_y < actual_screen_height) {
-        if (game_map[y][x] == WALL_CHAR) {
-          TR_DrawText("#", draw_x, draw_y, 10, WALL_COLOR, BG_COLOR); // Walls blend with maze background
-        } else if (game_map[y][x] == PELLET_CHAR) {
-          TR_DrawText(".", draw_x, draw_y, 10, PELLET_COLOR, BG_COLOR); // Pellets blend with maze background
-        }
-        // Empty spaces are handled by ClearBackground, no need to draw ' '
-      }
-    }
-  }
-
-  // Draw Pac-Man (with offset)
-  int pacman_draw_x = pacman.x + offset_x;
-  int pacman_draw_y = pacman.y + offset_y;
-  if (pacman_draw_x >= 0 && pacman_draw_x < actual_screen_width &&
-    pacman_draw_y >= 0 && pacman_draw_y < actual_screen_height) {
-    TR_DrawText(PACMAN_CHAR == '@' ? "@" : "P", pacman_draw_x, pacman_draw_y, 10, PACMAN_COLOR, BG_COLOR); // Pac-Man blends with maze background
-  }
+  // UpdateGame moves the camera to keep Pac-Man in view on maps bigger than the screen
+  int visible_width = (map_width < view_width) ? map_width : view_width;
+  int visible_height = (map_height < view_height) ? map_height : view_height;
+  int camera_x = game->tiles->camera_x;
+  int camera_y = game->tiles->camera_y;
 
+  // Draw the maze. Only the chunks in view are visited, and their cells are cached.
+  TR_TileMapDraw(game->tiles, offset_x, offset_y, visible_width, visible_height);
 
-  // Draw Ghosts (with offset)
-  for (int i = 0; i < sizeof(ghosts) / sizeof(Entity); i++) {
-    int ghost_draw_x = ghosts[i].x + offset_x;
-    int ghost_draw_y = ghosts[i].y + offset_y;
-    if (ghost_draw_x >= 0 && ghost_draw_x < actual_screen_width &&
-      ghost_draw_y >= 0 && ghost_draw_y < actual_screen_height) {
-      TR_DrawText(GHOST_CHAR == 'M' ? "M" : "G", ghost_draw_x, ghost_draw_y, 10, GHOST_COLOR, BG_COLOR); // Ghosts blend with maze background
+  // Draw Pac-Man (with offset)
+  TR_DrawText(PACMAN_CHAR == '@' ? "@" : "P", pacman->x - camera_x + offset_x, pacman->y - camera_y + offset_y, 10, PACMAN_COLOR, BG_COLOR); // Pac-Man blends with maze background
+
+  // Draw Ghosts (with offset), skipping the ones outside the view
+  Color ghost_color = (game->ghost_mode == MODE_CHASE) ? GHOST_COLOR : SCATTER_COLOR;
+  for (int i = 0; i < game->num_ghosts; i++) {
+    int ghost_view_x = game->ghosts[i].x - camera_x;
+    int ghost_view_y = game->ghosts[i].y - camera_y;
+    if (ghost_view_x >= 0 && ghost_view_x < visible_width &&
+      ghost_view_y >= 0 && ghost_view_y < visible_height) {
+      TR_DrawText(GHOST_CHAR == 'M' ? "M" : "G", ghost_view_x + offset_x, ghost_view_y + offset_y, 10, ghost_color, BG_COLOR); // Ghosts blend with maze background
     }
   }
 
   // Draw Score and Messages below the map, relative to actual screen height
   char score_text[50];
-  sprintf(score_text, "SCORE: %d", score);
+  sprintf(score_text, "SCORE: %d", game->score);
   TR_DrawText(score_text, offset_x + 1, actual_screen_height - 2, 10, TEXT_COLOR, BLACK); // Score text has black background
 
   TR_DrawText("WASD/Arrows to move, ESC/Q to quit", offset_x + 1, actual_screen_height - 1, 10, LIGHTGRAY, BLACK); // Instructions text has black background
@@ -293,13 +518,403 @@ bool IsColliding(Entity e1, Entity e2) {
   return (e1.x == e2.x && e1.y == e2.y);
 }
 
-// Get a random direction (dx, dy)
-void GetRandomDirection(int* dx, int* dy) {
-  int dir = rand() % 4; // 0: up, 1: down, 2: left, 3: right
-  switch (dir) {
-    case 0: *dx = 0; *dy = -1; break; // Up
-    case 1: *dx = 0; *dy = 1; break;  // Down
-    case 2: *dx = -1; *dy = 0; break; // Left
-    case 3: *dx = 1; *dy = 0; break;  // Right
+// Copies the maze into a tile map for DrawGame. Returns false if it couldn't be allocated.
+bool CreateTileMap(PacmanGame* game) {
+  game->tiles = TR_TileMapCreate(game->map_width, game->map_height);
+  if (game->tiles == NULL) return false;
+  TR_TileMapSetStyle(game->tiles, TILE_EMPTY, EMPTY_CHAR, BG_COLOR, BG_COLOR);
+  TR_TileMapSetStyle(game->tiles, TILE_WALL, WALL_CHAR, WALL_COLOR, BG_COLOR);      // Walls blend with maze background
+  TR_TileMapSetStyle(game->tiles, TILE_PELLET, PELLET_CHAR, PELLET_COLOR, BG_COLOR); // Pellets blend with maze background
+  for (int y = 0; y < game->map_height; y++) {
+    for (int x = 0; x < game->map_width; x++) {
+      char cell = game->game_map[y * game->map_width + x];
+      unsigned char tile = (cell == WALL_CHAR) ? TILE_WALL : (cell == PELLET_CHAR) ? TILE_PELLET : TILE_EMPTY;
+      if (!TR_TileMapSet(game->tiles, x, y, tile)) return false;
+    }
+  }
+  return true;
+}
+
+// Allocates the maze, its distance fields and the AI's scratch space, then fills it
+// with the built-in board or a generated one. Returns false if the allocation failed.
+bool CreateMaze(PacmanGame* game, int width, int height, bool generate) {
+  int num_cells = width * height;
+  game->map_width = width;
+  game->map_height = height;
+  game->game_map = (char*)malloc(num_cells);
+  game->chase_field = (int*)malloc(sizeof(int) * num_cells);
+  game->bfs_queue = (int*)malloc(sizeof(int) * num_cells);
+  game->ai_stamp = (unsigned int*)calloc(num_cells, sizeof(unsigned int));
+  game->ghost_field = (int*)malloc(sizeof(int) * num_cells);
+  game->ai_distance = (int*)malloc(sizeof(int) * num_cells);
+  game->ai_parent = (int*)malloc(sizeof(int) * num_cells);
+  bool allocated = (game->game_map != NULL && game->chase_field != NULL && game->bfs_queue != NULL &&
+                    game->ghost_field != NULL && game->ai_stamp != NULL && game->ai_distance != NULL &&
+                    game->ai_parent != NULL);
+  for (int i = 0; i < 4; i++) {
+    game->scatter_fields[i] = (int*)malloc(sizeof(int) * num_cells);
+    if (game->scatter_fields[i] == NULL) allocated = false;
+  }
+  if (!allocated) {
+    FreeGame(game);
+    return false;
+  }
+
+  if (generate) {
+    GenerateMaze(game);
+  } else {
+    for (int y = 0; y < height; y++) {
+      memcpy(game->game_map + y * width, default_map[y], width);
+    }
+  }
+
+  // Corners in order top-left, bottom-right, top-right, bottom-left, so two ghosts take opposite ones
+  game->scatter_cells[0] = FindNearestOpenCell(game, 0, 0);
+  game->scatter_cells[1] = FindNearestOpenCell(game, width - 1, height - 1);
+  game->scatter_cells[2] = FindNearestOpenCell(game, width - 1, 0);
+  game->scatter_cells[3] = FindNearestOpenCell(game, 0, height - 1);
+  for (int i = 0; i < 4; i++) {
+    ComputeDistanceField(game, game->scatter_fields[i], game->scatter_cells[i]);
+  }
+  game->chase_field_source = -1;
+  return true;
+}
+
+// Carves a random maze into game_map: a depth-first backtracker over the odd cells
+// (using bfs_queue as its stack), then some dead ends are knocked through so there
+// are loops to run around, since a perfect maze gives Pac-Man nowhere to go.
+void GenerateMaze(PacmanGame* game) {
+  static const int dir_x[4] = { 0, 0, -1, 1 };
+  static const int dir_y[4] = { -1, 1, 0, 0 };
+  int map_width = game->map_width;
+  int map_height = game->map_height;
+  char* game_map = game->game_map;
+  int* stack = game->bfs_queue;
+  int rooms_x = (map_width - 1) / 2;  // Open cells sit at odd coordinates
+  int rooms_y = (map_height - 1) / 2;
+
+  memset(game_map, WALL_CHAR, map_width * map_height);
+  int start = map_width + 1;
+  game_map[start] = PELLET_CHAR;
+  int stack_size = 0;
+  stack[stack_size++] = start;
+  while (stack_size > 0) {
+    int cell = stack[stack_size - 1];
+    int x = cell % map_width;
+    int y = cell / map_width;
+
+    // Pick a random unvisited room two steps away
+    int options[4];
+    int num_options = 0;
+    for (int d = 0; d < 4; d++) {
+      int room_x = (x - 1) / 2 + dir_x[d];
+      int room_y = (y - 1) / 2 + dir_y[d];
+      if (room_x >= 0 && room_x < rooms_x && room_y >= 0 && room_y < rooms_y &&
+          game_map[(y + dir_y[d] * 2) * map_width + x + dir_x[d] * 2] == WALL_CHAR) {
+        options[num_options++] = d;
+      }
+    }
+    if (num_options == 0) {
+      stack_size--;
+      continue;
+    }
+    int d = options[TR_RngRange(&game->rng, num_options)];
+    game_map[(y + dir_y[d]) * map_width + x + dir_x[d]] = PELLET_CHAR;
+    int next = (y + dir_y[d] * 2) * map_width + x + dir_x[d] * 2;
+    game_map[next] = PELLET_CHAR;
+    stack[stack_size++] = next;
+  }
+
+  // Knock through walls between two corridors, mostly at dead ends
+  for (int y = 1; y < map_height - 1; y++) {
+    for (int x = 1; x < map_width - 1; x++) {
+      int cell = y * map_width + x;
+      if (game_map[cell] != WALL_CHAR) continue;
+      bool horizontal = (x + 1 < map_width - 1 && game_map[cell - 1] != WALL_CHAR && game_map[cell + 1] != WALL_CHAR);
+      bool vertical = (y + 1 < map_height - 1 && game_map[cell - map_width] != WALL_CHAR && game_map[cell + map_width] != WALL_CHAR);
+      if ((horizontal || vertical) && TR_RngRange(&game->rng, 100) < BRAID_CHANCE) {
+        game_map[cell] = PELLET_CHAR;
+      }
+    }
+  }
+}
+
+// Fills field with the number of steps from source to every open cell (breadth-first
+// search), -2 for walls or -1 for cells it can't reach. The border is always wall, so
+// neighbours of open cells never leave the map.
+void ComputeDistanceField(PacmanGame* game, int* field, int source) {
+  int map_width = game->map_width;
+  int* bfs_queue = game->bfs_queue;
+
+  // Walls start at -2 and open cells at -1, so the search only has to test the field, not the map
+  int num_cells = map_width * game->map_height;
+  for (int cell = 0; cell < num_cells; cell++) {
+    field[cell] = (game->game_map[cell] == WALL_CHAR) ? -2 : -1;
+  }
+  int head = 0;
+  int tail = 0;
+  field[source] = 0;
+  bfs_queue[tail++] = source;
+  while (head < tail) {
+    int cell = bfs_queue[head++];
+    int distance = field[cell] + 1;
+    if (field[cell - map_width] == -1) { field[cell - map_width] = distance; bfs_queue[tail++] = cell - map_width; }
+    if (field[cell + map_width] == -1) { field[cell + map_width] = distance; bfs_queue[tail++] = cell + map_width; }
+    if (field[cell - 1] == -1) { field[cell - 1] = distance; bfs_queue[tail++] = cell - 1; }
+    if (field[cell + 1] == -1) { field[cell + 1] = distance; bfs_queue[tail++] = cell + 1; }
+  }
+}
+
+// Takes one step down the field's gradient. Like in the arcade game ghosts never
+// reverse on their own; they only turn back at a dead end.
+void MoveGhost(const PacmanGame* game, Entity* ghost, const int* field) {
+  static const int dir_x[4] = { 0, -1, 0, 1 }; // Ties go up, left, down, right
+  static const int dir_y[4] = { -1, 0, 1, 0 };
+  int cell = ghost->y * game->map_width + ghost->x;
+  int best = -1;
+  int best_distance = 0;
+  for (int d = 0; d < 4; d++) {
+    if (dir_x[d] == -ghost->dx && dir_y[d] == -ghost->dy && (ghost->dx != 0 || ghost->dy != 0)) continue;
+    int distance = field[cell + dir_y[d] * game->map_width + dir_x[d]];
+    if (distance < 0) continue; // Wall
+    if (best < 0 || distance < best_distance) {
+      best = d;
+      best_distance = distance;
+    }
+  }
+
+  if (best < 0) {
+    // Dead end: turn back
+    if (ghost->dx == 0 && ghost->dy == 0) return; // Walled in
+    ghost->dx = -ghost->dx;
+    ghost->dy = -ghost->dy;
+  } else {
+    ghost->dx = dir_x[best];
+    ghost->dy = dir_y[best];
+  }
+  ghost->x += ghost->dx;
+  ghost->y += ghost->dy;
+}
+
+// Finds the open cell closest to (x, y), for starting positions and scatter corners
+int FindNearestOpenCell(const PacmanGame* game, int x, int y) {
+  int best = -1;
+  int best_distance = 0;
+  for (int cell = 0; cell < game->map_width * game->map_height; cell++) {
+    if (game->game_map[cell] == WALL_CHAR) continue;
+    int distance = abs(cell % game->map_width - x) + abs(cell / game->map_width - y);
+    if (best < 0 || distance < best_distance) {
+      best = cell;
+      best_distance = distance;
+    }
+  }
+  return best;
+}
+
+// Breadth-first search from Pac-Man's cell (or a step away from it, with blocked as
+// the cell he steps from) over the cells he reaches with a step to spare before any
+// ghost. Stops at the nearest pellet if target isn't NULL; returns how many cells
+// it reached. Neighbours are tried starting from first_dir, which picks between
+// pellets that are equally near.
+int SearchAhead(PacmanGame* game, int from, int blocked, int* target, int first_dir) {
+  static const int dir_x[4] = { 0, 0, -1, 1 };
+  static const int dir_y[4] = { -1, 1, 0, 0 };
+  int map_width = game->map_width;
+  const int* ghost_field = game->ghost_field;
+  int* queue = game->bfs_queue;
+
+  // New stamp instead of clearing the scratch arrays
+  if (++game->ai_search == 0) {
+    memset(game->ai_stamp, 0, sizeof(unsigned int) * map_width * game->map_height);
+    game->ai_search = 1;
+  }
+  unsigned int search = game->ai_search;
+  int first_distance = (from == blocked) ? 0 : 1;
+  int head = 0;
+  int tail = 0;
+  game->ai_stamp[blocked] = search;
+  game->ai_stamp[from] = search;
+  game->ai_distance[from] = first_distance;
+  game->ai_parent[from] = -1;
+  queue[tail++] = from;
+  while (head < tail) {
+    int cell = queue[head++];
+    if (target != NULL && cell != from && game->game_map[cell] == PELLET_CHAR) {
+      *target = cell;
+      break;
+    }
+    int distance = game->ai_distance[cell] + 1;
+    for (int i = 0; i < 4; i++) {
+      int d = (first_dir + i) & 3;
+      int next = cell + dir_y[d] * map_width + dir_x[d];
+      if (game->ai_stamp[next] == search || ghost_field[next] == -2) continue;
+      if (ghost_field[next] >= 0 && ghost_field[next] <= distance + 1) continue;
+      game->ai_stamp[next] = search;
+      game->ai_distance[next] = distance;
+      game->ai_parent[next] = cell;
+      queue[tail++] = next;
+    }
+  }
+  return tail;
+}
+
+// A simple player for headless runs. One breadth-first search from every ghost at once
+// gives how soon a ghost can reach each cell; a second one from Pac-Man then heads for
+// the nearest pellet he can reach before any ghost could get in his way. With no such
+// pellet he takes the step that keeps the most room to run. Ties are broken from the
+// game's RNG, so headless instances with different seeds play different games even on
+// the built-in board.
+int ChooseAIKey(PacmanGame* game) {
+  static const int dir_x[4] = { 0, 0, -1, 1 };
+  static const int dir_y[4] = { -1, 1, 0, 0 };
+  static const int dir_key[4] = { 'w', 's', 'a', 'd' };
+  int map_width = game->map_width;
+  int num_cells = map_width * game->map_height;
+  int start = game->pacman.y * map_width + game->pacman.x;
+  int* ghost_field = game->ghost_field;
+  int* queue = game->bfs_queue;
+  int head = 0;
+  int tail = 0;
+
+  // Ghost field, seeded from every ghost
+  for (int cell = 0; cell < num_cells; cell++) {
+    ghost_field[cell] = (game->game_map[cell] == WALL_CHAR) ? -2 : -1;
+  }
+  for (int i = 0; i < game->num_ghosts; i++) {
+    int cell = game->ghosts[i].y * map_width + game->ghosts[i].x;
+    if (ghost_field[cell] == -1) {
+      ghost_field[cell] = 0;
+      queue[tail++] = cell;
+    }
+  }
+  while (head < tail) {
+    int cell = queue[head++];
+    int distance = ghost_field[cell] + 1;
+    if (ghost_field[cell - map_width] == -1) { ghost_field[cell - map_width] = distance; queue[tail++] = cell - map_width; }
+    if (ghost_field[cell + map_width] == -1) { ghost_field[cell + map_width] = distance; queue[tail++] = cell + map_width; }
+    if (ghost_field[cell - 1] == -1) { ghost_field[cell - 1] = distance; queue[tail++] = cell - 1; }
+    if (ghost_field[cell + 1] == -1) { ghost_field[cell + 1] = distance; queue[tail++] = cell + 1; }
+  }
+
+  // Pac-Man's search only enters a cell if he gets there with a step to spare
+  int first_dir = TR_RngRange(&game->rng, 4);
+  int target = -1;
+  SearchAhead(game, start, start, &target, first_dir);
+
+  int step = -1;
+  if (target >= 0) {
+    step = target;
+    while (game->ai_parent[step] != start) step = game->ai_parent[step];
+  } else {
+    // Flee: the step that leaves him the most cells he can reach before any ghost
+    int best_area = -1;
+    for (int i = 0; i < 4; i++) {
+      int d = (first_dir + i) & 3;
+      int next = start + dir_y[d] * map_width + dir_x[d];
+      if (ghost_field[next] == -2 || ghost_field[next] == 0) continue;
+      int area = SearchAhead(game, next, start, NULL, first_dir);
+      if (area > best_area) {
+        best_area = area;
+        step = next;
+      }
+    }
+  }
+  if (step < 0) return 0;
+  for (int d = 0; d < 4; d++) {
+    if (step == start + dir_y[d] * map_width + dir_x[d]) return dir_key[d];
+  }
+  return 0;
+}
+
+// Turns a script character into a key ('.' and anything unknown are no key)
+int ScriptKey(char c) {
+  return (c == 'w' || c == 'a' || c == 's' || c == 'd') ? c : 0;
+}
+
+// Plays one game without a terminal (see TR_RunHeadless)
+void RunHeadlessInstance(int index, TR_Rng* rng, void* user, TR_HeadlessResult* result) {
+  (void)index;
+  const HeadlessConfig* config = (const HeadlessConfig*)user;
+  PacmanGame game;
+  if (!InitGame(&game, config->map_width, config->map_height, config->generate, config->num_ghosts, TR_RngNext(rng))) {
+    result->outcome = OUTCOME_LOST;
+    return;
+  }
+  size_t script_length = (config->script != NULL) ? strlen(config->script) : 0;
+  long long tick = 0;
+  while (!game.game_over && !game.game_won && tick < config->max_ticks) {
+    int key;
+    if (config->script != NULL) key = ((size_t)tick < script_length) ? ScriptKey(config->script[tick]) : 0;
+    else key = ChooseAIKey(&game);
+    UpdateGame(&game, key);
+    tick++;
+  }
+  result->ticks = tick;
+  result->score = game.score;
+  result->outcome = game.game_won ? OUTCOME_WON : (game.game_over ? OUTCOME_LOST : OUTCOME_TIMED_OUT);
+  FreeGame(&game);
+}
+
+// Times the chase field rebuild (one per Pac-Man tile change) and a ghost step
+// on generated mazes of growing size, and prints a table.
+void RunBenchmark() {
+  static const int sizes[] = { 31, 63, 127, 255, 511, 1023, 2047 };
+  const int bench_ghosts = 1000;
+  TR_Rng rng;
+  TR_RngSeed(&rng, 1);
+  printf("%-11s %10s %14s %12s %16s\n", "maze", "open cells", "field (us)", "ns / cell", "ghost step (ns)");
+  for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); s++) {
+    PacmanGame game;
+    memset(&game, 0, sizeof(game));
+    TR_RngSeed(&game.rng, TR_RngNext(&rng));
+    if (!CreateMaze(&game, sizes[s], sizes[s], true)) {
+      fprintf(stderr, "ERROR: Failed to allocate a %dx%d maze.\n", sizes[s], sizes[s]);
+      return;
+    }
+    int num_cells = game.map_width * game.map_height;
+    int open_cells = 0;
+    for (int cell = 0; cell < num_cells; cell++) {
+      if (game.game_map[cell] != WALL_CHAR) open_cells++;
+    }
+
+    // Rebuild from random open cells until a quarter second has passed
+    int sources[64];
+    for (int i = 0; i < 64; i++) {
+      do {
+        sources[i] = TR_RngRange(&rng, num_cells);
+      } while (game.game_map[sources[i]] == WALL_CHAR);
+    }
+    long long fields = 0;
+    clock_t start = clock();
+    clock_t elapsed;
+    do {
+      ComputeDistanceField(&game, game.chase_field, sources[fields % 64]);
+      fields++;
+      elapsed = clock() - start;
+    } while (elapsed < CLOCKS_PER_SEC / 4);
+    double field_us = (double)elapsed * 1e6 / CLOCKS_PER_SEC / fields;
+
+    // Step a crowd of ghosts down the last field
+    Entity crowd[1000];
+    for (int i = 0; i < bench_ghosts; i++) {
+      int cell = sources[i % 64];
+      crowd[i].x = cell % game.map_width;
+      crowd[i].y = cell / game.map_width;
+      crowd[i].dx = 0;
+      crowd[i].dy = 0;
+    }
+    long long steps = 0;
+    start = clock();
+    do {
+      for (int i = 0; i < bench_ghosts; i++) MoveGhost(&game, &crowd[i], game.chase_field);
+      steps += bench_ghosts;
+      elapsed = clock() - start;
+    } while (elapsed < CLOCKS_PER_SEC / 4);
+    double step_ns = (double)elapsed * 1e9 / CLOCKS_PER_SEC / steps;
+
+    char size_text[32];
+    snprintf(size_text, sizeof(size_text), "%dx%d", game.map_width, game.map_height);
+    printf("%-11s %10d %14.1f %12.2f %16.2f\n", size_text, open_cells, field_us, field_us * 1000.0 / open_cells, step_ns);
+    FreeGame(&game);
   }
 }
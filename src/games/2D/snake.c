@@ -1,12 +1,15 @@
+#define TR_HEADLESS
 #include "../../tread.h"
 
-#include <time.h>   // For time (to seed rand)
+#include <time.h>   // For time (to seed the RNG)
 
 // --- Game Configuration ---
-#define MAP_WIDTH   40
+#define MAP_WIDTH   40 // Default map size (trsnake <width> <height> picks another)
 #define MAP_HEIGHT  20
+#define MIN_MAP_SIZE 5
+#define MAX_MAP_SIZE 2048
 #define FPS         10
-#define MAX_SNAKE_LENGTH (MAP_WIDTH * MAP_HEIGHT)
+#define HEADLESS_TICKS 100000 // Default tick limit per headless instance
 
 // --- Game Characters ---
 #define WALL_CHAR   '#'
@@ -25,34 +28,125 @@
 #define GAME_OVER_COLOR MAROON
 #define WIN_COLOR    LIME
 
+// --- Headless Outcomes ---
+#define OUTCOME_LOST 0
+#define OUTCOME_WON 1
+#define OUTCOME_TIMED_OUT 2 // Still alive when the tick limit ran out
+
 // --- Game State Structs ---
 typedef struct {
   int x;
   int y;
 } Segment; // Represents a part of the snake or food position
 
-// --- Game Variables ---
-Segment snake[MAX_SNAKE_LENGTH];
-int snake_length;
-int current_dx; // current direction x for snake
-int current_dy; // current direction y for snake
-Segment food;
-int score;
-bool game_over;
+// Everything one game needs, so the terminal game and any number of headless
+// instances can each have their own
+typedef struct {
+  int map_width;
+  int map_height;
+
+  // The snake's body is a ring buffer of cell indices (y * map_width + x), so moving
+  // only writes the new head and drops the tail instead of shifting every segment.
+  int* snake_cells;
+  int snake_head;   // Ring buffer slot of the head
+  int snake_length;
+  int current_dx; // current direction x for snake
+  int current_dy; // current direction y for snake
+
+  // One bit per cell, set where the snake is, so collision checks don't walk the body
+  unsigned char* occupied;
+
+  // Every cell food can go on (inside the walls, not under the snake). free_slot[cell]
+  // is the cell's position in free_cells, or -1, so cells come and go in O(1).
+  int* free_cells;
+  int* free_slot;
+  int free_count;
+
+  Segment food;
+  int score;
+  bool game_over;
+  bool game_won; // The snake filled the whole map
+  TR_Rng rng;    // Only used for food, so a seed replays the same game
+} SnakeGame;
+
+// Settings shared by every headless instance
+typedef struct {
+  int map_width;
+  int map_height;
+  long long max_ticks;
+  const char* script; // Keys to press, one per tick ('.' for none), or NULL to let the AI play
+} HeadlessConfig;
 
 // --- Function Prototypes ---
-void InitGame();
-void UpdateGame();
-void DrawGame();
-void PlaceFoodRandomly();
-bool IsCollidingWithSelf(int head_x, int head_y);
+bool InitGame(SnakeGame* game, int map_width, int map_height, uint64_t seed);
+void FreeGame(SnakeGame* game);
+void UpdateGame(SnakeGame* game, int key);
+void DrawGame(const SnakeGame* game);
+void PlaceFoodRandomly(SnakeGame* game);
+bool IsCollidingWithSelf(const SnakeGame* game, int head_x, int head_y);
+bool IsInsideWalls(const SnakeGame* game, int x, int y);
+void OccupyCell(SnakeGame* game, int cell);
+void ReleaseCell(SnakeGame* game, int cell);
+int ChooseAIKey(const SnakeGame* game);
+int ScriptKey(char c);
+void RunHeadlessInstance(int index, TR_Rng* rng, void* user, TR_HeadlessResult* result);
+
+int main(int argc, char* argv[]) {
+  // Usage: trsnake [width height] [-H instances [-n ticks] [-S seed] [-j threads] [-i keys]]
+  int map_width = MAP_WIDTH;
+  int map_height = MAP_HEIGHT;
+  int instances = 0; // 0 to play in the terminal
+  int threads = 0;   // 0 for one per core
+  unsigned long long seed = 1;
+  HeadlessConfig config = { 0, 0, HEADLESS_TICKS, NULL };
+  int positional[2];
+  int num_positional = 0;
+  for (int i = 1; i < argc; i++) {
+    bool has_value = (i + 1 < argc);
+    if (strcmp(argv[i], "-H") == 0 && has_value) instances = atoi(argv[++i]);
+    else if (strcmp(argv[i], "-n") == 0 && has_value) config.max_ticks = atoll(argv[++i]);
+    else if (strcmp(argv[i], "-S") == 0 && has_value) seed = strtoull(argv[++i], NULL, 10);
+    else if (strcmp(argv[i], "-j") == 0 && has_value) threads = atoi(argv[++i]);
+    else if (strcmp(argv[i], "-i") == 0 && has_value) config.script = argv[++i];
+    else if (argv[i][0] != '-' && num_positional < 2) positional[num_positional++] = atoi(argv[i]);
+    else num_positional = -1;
+    if (num_positional < 0) break;
+  }
+  if (num_positional == 1 || num_positional < 0 || instances < 0 || config.max_ticks <= 0) {
+    fprintf(stderr, "Usage: %s [width height] [-H instances [-n ticks] [-S seed] [-j threads] [-i keys]]\n", argv[0]);
+    return 1;
+  }
+
+  // Optional map size: trsnake <width> <height>
+  if (num_positional == 2) {
+    map_width = positional[0];
+    map_height = positional[1];
+    if (map_width < MIN_MAP_SIZE || map_height < MIN_MAP_SIZE ||
+        map_width > MAX_MAP_SIZE || map_height > MAX_MAP_SIZE) {
+      fprintf(stderr, "ERROR: The map must be between %dx%d and %dx%d.\n", MIN_MAP_SIZE, MIN_MAP_SIZE, MAX_MAP_SIZE, MAX_MAP_SIZE);
+      return 1;
+    }
+  }
+
+  // Headless: run the instances flat out and print the totals
+  if (instances > 0) {
+    config.map_width = map_width;
+    config.map_height = map_height;
+    TR_HeadlessReport report = TR_RunHeadless(instances, threads, seed, RunHeadlessInstance, &config);
+    const char* const outcome_names[TR_HEADLESS_OUTCOMES] = { "Lost:", "Won:", "Timed out:", NULL };
+    TR_PrintHeadlessReport(stdout, &report, outcome_names);
+    return (report.instances == instances) ? 0 : 1;
+  }
 
-int main() {
-  // Initialize random seed
-  srand((unsigned int)time(NULL));
+  // TR_RegisterSeed keeps the seed in input recordings, so a replay plays the same game
+  SnakeGame game;
+  if (!InitGame(&game, map_width, map_height, TR_RegisterSeed((uint64_t)time(NULL)))) {
+    fprintf(stderr, "ERROR: Failed to allocate a %dx%d map.\n", map_width, map_height);
+    return 1;
+  }
 
   // Initialize the game window. tread.h will use the actual terminal size.
-  TR_InitWindow(MAP_WIDTH, MAP_HEIGHT + 3, "tread.h - TRSnake");
+  TR_InitWindow(map_width, map_height + 3, "tread.h - TRSnake");
 
   // Get actual screen dimensions for positioning
   int actual_screen_width = TR_GetScreenWidth();
@@ -61,12 +155,10 @@ int main() {
   // Adjust FPS based on your monitor or preference
   TR_SetTargetFPS(FPS);
 
-  InitGame();
-
   // Main game loop
-  while (!TR_WindowShouldClose() && !game_over) {
-    UpdateGame();
-    DrawGame();
+  while (!TR_WindowShouldClose() && !game.game_over) {
+    UpdateGame(&game, TR_GetKeyPressed());
+    DrawGame(&game);
   }
 
   // Final draw for game over screen
@@ -77,10 +169,11 @@ int main() {
   int text_center_x = actual_screen_width / 2;
   int text_center_y = actual_screen_height / 2;
 
-  TR_DrawText("GAME OVER!", text_center_x - (int)(strlen("GAME OVER!") / 2), text_center_y - 1, 20, GAME_OVER_COLOR, BLACK);
+  const char* result_text = game.game_won ? "YOU WIN!" : "GAME OVER!";
+  TR_DrawText(result_text, text_center_x - (int)(strlen(result_text) / 2), text_center_y - 1, 20, game.game_won ? WIN_COLOR : GAME_OVER_COLOR, BLACK);
   TR_DrawText("Final Score:", text_center_x - (int)(strlen("Final Score:") / 2), text_center_y + 1, 10, TEXT_COLOR, BLACK);
   char score_str[20];
-  sprintf(score_str, "%d", score);
+  sprintf(score_str, "%d", game.score);
   TR_DrawText(score_str, text_center_x - (int)(strlen(score_str) / 2), text_center_y + 2, 10, TEXT_COLOR, BLACK);
   TR_EndDrawing();
 
@@ -95,115 +188,190 @@ int main() {
   // De-Initialization
   TR_CloseWindow();
 
+  FreeGame(&game);
+
   return 0;
 }
 
 // --- Game Functions ---
 
-void InitGame() {
-  // Initialize snake
-  snake_length = 1;
-  snake[0].x = MAP_WIDTH / 2;
-  snake[0].y = MAP_HEIGHT / 2;
-  current_dx = 1; // Initial direction: right
-  current_dy = 0;
+// Sets up a new game. Returns false if the map couldn't be allocated.
+bool InitGame(SnakeGame* game, int map_width, int map_height, uint64_t seed) {
+  memset(game, 0, sizeof(*game));
+  game->map_width = map_width;
+  game->map_height = map_height;
+  TR_RngSeed(&game->rng, seed);
+
+  int num_cells = map_width * map_height;
+  game->snake_cells = (int*)malloc(sizeof(int) * num_cells);
+  game->occupied = (unsigned char*)calloc((num_cells + 7) / 8, 1);
+  game->free_cells = (int*)malloc(sizeof(int) * num_cells);
+  game->free_slot = (int*)malloc(sizeof(int) * num_cells);
+  if (game->snake_cells == NULL || game->occupied == NULL || game->free_cells == NULL || game->free_slot == NULL) {
+    FreeGame(game);
+    return false;
+  }
 
-  score = 0;
-  game_over = false;
+  // Every cell inside the walls starts out free for food
+  game->free_count = 0;
+  for (int cell = 0; cell < num_cells; cell++) {
+    if (IsInsideWalls(game, cell % map_width, cell / map_width)) {
+      game->free_slot[cell] = game->free_count;
+      game->free_cells[game->free_count++] = cell;
+    } else {
+      game->free_slot[cell] = -1;
+    }
+  }
 
-  PlaceFoodRandomly();
+  // Initialize snake
+  game->snake_length = 1;
+  game->snake_head = 0;
+  game->snake_cells[0] = (map_height / 2) * map_width + map_width / 2;
+  OccupyCell(game, game->snake_cells[0]);
+  game->current_dx = 1; // Initial direction: right
+  game->current_dy = 0;
+
+  game->score = 0;
+  game->game_over = false;
+  game->game_won = false;
+
+  PlaceFoodRandomly(game);
+  return true;
 }
 
-void UpdateGame() {
+void FreeGame(SnakeGame* game) {
+  free(game->snake_cells);
+  free(game->occupied);
+  free(game->free_cells);
+  free(game->free_slot);
+  game->snake_cells = NULL;
+  game->occupied = NULL;
+  game->free_cells = NULL;
+  game->free_slot = NULL;
+}
+
+// Advances the game by one tick. key is the key pressed this tick, or 0.
+void UpdateGame(SnakeGame* game, int key) {
   // --- Handle Input ---
-  int key = TR_GetKeyPressed();
   if (key != 0) {
     // Prevent immediate reverse
-    if ((key == 'w' || key == TR_KEY_UP) && current_dy == 0) { current_dx = 0; current_dy = -1; }
-    else if ((key == 's' || key == TR_KEY_DOWN) && current_dy == 0) { current_dx = 0; current_dy = 1; }
-    else if ((key == 'a' || key == TR_KEY_LEFT) && current_dx == 0) { current_dx = -1; current_dy = 0; }
-    else if ((key == 'd' || key == TR_KEY_RIGHT) && current_dx == 0) { current_dx = 1; current_dy = 0; }
+    if ((key == 'w' || key == TR_KEY_UP) && game->current_dy == 0) { game->current_dx = 0; game->current_dy = -1; }
+    else if ((key == 's' || key == TR_KEY_DOWN) && game->current_dy == 0) { game->current_dx = 0; game->current_dy = 1; }
+    else if ((key == 'a' || key == TR_KEY_LEFT) && game->current_dx == 0) { game->current_dx = -1; game->current_dy = 0; }
+    else if ((key == 'd' || key == TR_KEY_RIGHT) && game->current_dx == 0) { game->current_dx = 1; game->current_dy = 0; }
   }
 
   // --- Move Snake ---
-  // Shift body segments
-  for (int i = snake_length - 1; i > 0; i--) {
-    snake[i] = snake[i-1];
-  }
-
-  // Move head
-  snake[0].x += current_dx;
-  snake[0].y += current_dy;
+  int map_width = game->map_width;
+  int head_x = game->snake_cells[game->snake_head] % map_width + game->current_dx;
+  int head_y = game->snake_cells[game->snake_head] / map_width + game->current_dy;
 
   // --- Check for Collisions ---
   // Wall collision
-  if (snake[0].x < 0 || snake[0].x >= MAP_WIDTH ||
-      snake[0].y < 0 || snake[0].y >= MAP_HEIGHT) {
-    game_over = true;
+  if (head_x < 0 || head_x >= map_width ||
+      head_y < 0 || head_y >= game->map_height) {
+    game->game_over = true;
     return;
   }
 
+  // The tail moves out of the way first (unless the snake is growing), so the head can follow it
+  bool eating = (head_x == game->food.x && head_y == game->food.y);
+  int num_cells = map_width * game->map_height;
+  if (!eating) {
+    int tail = (game->snake_head - game->snake_length + 1 + num_cells) % num_cells;
+    ReleaseCell(game, game->snake_cells[tail]);
+    game->snake_length--;
+  }
+
   // Self-collision
-  if (IsCollidingWithSelf(snake[0].x, snake[0].y)) {
-    game_over = true;
+  if (IsCollidingWithSelf(game, head_x, head_y)) {
+    game->game_over = true;
     return;
   }
 
+  // Move head
+  game->snake_head = (game->snake_head + 1) % num_cells;
+  game->snake_cells[game->snake_head] = head_y * map_width + head_x;
+  game->snake_length++;
+  OccupyCell(game, game->snake_cells[game->snake_head]);
+
   // Food collision
-  if (snake[0].x == food.x && snake[0].y == food.y) {
-    score += 10;
-    snake_length++;
-    // Ensure snake doesn't exceed max length
-    if (snake_length > MAX_SNAKE_LENGTH) {
-      snake_length = MAX_SNAKE_LENGTH; // Cap length, though unlikely to be hit
-    }
-    PlaceFoodRandomly();
+  if (eating) {
+    game->score += 10;
+    PlaceFoodRandomly(game);
   }
 }
 
-void DrawGame() {
+void DrawGame(const SnakeGame* game) {
   TR_BeginDrawing();
 
   // TR_ClearBackground(BG_COLOR); // Removed: Redundant as TR_BeginDrawing already clears the buffer
 
+  int map_width = game->map_width;
+  int map_height = game->map_height;
+
   // Get actual screen dimensions for positioning
   int actual_screen_width = TR_GetScreenWidth();
   int actual_screen_height = TR_GetScreenHeight();
+  int view_width = actual_screen_width;
+  int view_height = actual_screen_height - 3; // 3 rows for score/messages below map
+  if (view_height < 1) view_height = 1;
 
   // Calculate offset to center the game map
-  int offset_x = (actual_screen_width - MAP_WIDTH) / 2;
-  int offset_y = (actual_screen_height - (MAP_HEIGHT + 3)) / 2; // +3 for score/messages below map
+  int offset_x = (actual_screen_width - map_width) / 2;
+  int offset_y = (actual_screen_height - (map_height + 3)) / 2; // +3 for score/messages below map
 
   // Ensure offsets are not negative (if screen is smaller than map)
   if (offset_x < 0) offset_x = 0;
   if (offset_y < 0) offset_y = 0;
 
-  // Draw Walls (simple border for now)
-  for (int x = 0; x < MAP_WIDTH; x++) {
-    TR_DrawText("#", x + offset_x, offset_y, 10, WALL_COLOR, BG_COLOR); // Top wall
-    TR_DrawText("#", x + offset_x, MAP_HEIGHT - 1 + offset_y, 10, WALL_COLOR, BG_COLOR); // Bottom wall
+  // Maps bigger than the screen scroll to keep the head in view
+  int head_x = game->snake_cells[game->snake_head] % map_width;
+  int head_y = game->snake_cells[game->snake_head] / map_width;
+  int camera_x = 0;
+  int camera_y = 0;
+  if (map_width > view_width) {
+    camera_x = head_x - view_width / 2;
+    if (camera_x > map_width - view_width) camera_x = map_width - view_width;
+    if (camera_x < 0) camera_x = 0;
   }
-  for (int y = 0; y < MAP_HEIGHT; y++) {
-    TR_DrawText("#", offset_x, y + offset_y, 10, WALL_COLOR, BG_COLOR); // Left wall
-    TR_DrawText("#", MAP_WIDTH - 1 + offset_x, y + offset_y, 10, WALL_COLOR, BG_COLOR); // Right wall
+  if (map_height > view_height) {
+    camera_y = head_y - view_height / 2;
+    if (camera_y > map_height - view_height) camera_y = map_height - view_height;
+    if (camera_y < 0) camera_y = 0;
   }
-
-
-  // Draw Food
-  char food_char_str[2] = {FOOD_CHAR, '\0'}; // Create a null-terminated string
-  TR_DrawText(food_char_str, food.x + offset_x, food.y + offset_y, 10, FOOD_COLOR, BG_COLOR);
-
-  // Draw Snake
-  for (int i = 0; i < snake_length; i++) {
-    Color segment_color = (i == 0) ? SNAKE_HEAD_COLOR : SNAKE_BODY_COLOR;
-    char segment_char_val = (i == 0) ? SNAKE_HEAD : SNAKE_BODY;
-    char segment_char_str[2] = {segment_char_val, '\0'}; // Create a null-terminated string
-    TR_DrawText(segment_char_str, snake[i].x + offset_x, snake[i].y + offset_y, 10, segment_color, BG_COLOR);
+  int visible_width = (map_width < view_width) ? map_width : view_width;
+  int visible_height = (map_height < view_height) ? map_height : view_height;
+
+  // Draw only the visible part of the map: snake over food over walls
+  for (int y = camera_y; y < camera_y + visible_height; y++) {
+    for (int x = camera_x; x < camera_x + visible_width; x++) {
+      char cell_char;
+      Color cell_color;
+      int cell = y * map_width + x;
+      if (x == head_x && y == head_y) {
+        cell_char = SNAKE_HEAD;
+        cell_color = SNAKE_HEAD_COLOR;
+      } else if (game->occupied[cell >> 3] & (1 << (cell & 7))) {
+        cell_char = SNAKE_BODY;
+        cell_color = SNAKE_BODY_COLOR;
+      } else if (x == game->food.x && y == game->food.y) {
+        cell_char = FOOD_CHAR;
+        cell_color = FOOD_COLOR;
+      } else if (!IsInsideWalls(game, x, y)) {
+        cell_char = WALL_CHAR;
+        cell_color = WALL_COLOR;
+      } else {
+        continue; // Empty
+      }
+      char cell_char_str[2] = {cell_char, '\0'}; // Create a null-terminated string
+      TR_DrawText(cell_char_str, x - camera_x + offset_x, y - camera_y + offset_y, 10, cell_color, BG_COLOR);
+    }
   }
 
   // Draw Score and Messages below the map, relative to actual screen height
   char score_text[50];
-  sprintf(score_text, "SCORE: %d", score);
+  sprintf(score_text, "SCORE: %d", game->score);
   TR_DrawText(score_text, offset_x + 1, actual_screen_height - 2, 10, TEXT_COLOR, BLACK); // Score text has black background
 
   TR_DrawText("WASD/Arrows to move, ESC/Q to quit", offset_x + 1, actual_screen_height - 1, 10, LIGHTGRAY, BLACK); // Instructions text has black background
@@ -211,37 +379,107 @@ void DrawGame() {
   TR_EndDrawing();
 }
 
-// Places food randomly on the map, ensuring it doesn't overlap with the snake
-void PlaceFoodRandomly() {
-  bool placed = false;
-  while (!placed) {
-    int new_x = rand() % (MAP_WIDTH - 2) + 1; // Avoid walls
-    int new_y = rand() % (MAP_HEIGHT - 2) + 1; // Avoid walls
-
-    bool overlap_with_snake = false;
-    for (int i = 0; i < snake_length; i++) {
-      if (snake[i].x == new_x && snake[i].y == new_y) {
-        overlap_with_snake = true;
-        break;
-      }
-      // If the snake is very long, this loop can be slow.
-      // For a simple game, it's usually fine.
-    }
-
-    if (!overlap_with_snake) {
-      food.x = new_x;
-      food.y = new_y;
-      placed = true;
-    }
+// Places food on a random free cell, in O(1) however long the snake is.
+// If there's no free cell left the snake has filled the map and the game is won.
+void PlaceFoodRandomly(SnakeGame* game) {
+  if (game->free_count == 0) {
+    game->food.x = -1;
+    game->food.y = -1;
+    game->game_won = true;
+    game->game_over = true;
+    return;
   }
+  int cell = game->free_cells[TR_RngRange(&game->rng, game->free_count)];
+  game->food.x = cell % game->map_width;
+  game->food.y = cell / game->map_width;
 }
 
 // Checks if the snake's head is colliding with its own body
-bool IsCollidingWithSelf(int head_x, int head_y) {
-  for (int i = 1; i < snake_length; i++) { // Start from 1 to ignore head itself
-    if (head_x == snake[i].x && head_y == snake[i].y) {
-      return true;
+bool IsCollidingWithSelf(const SnakeGame* game, int head_x, int head_y) {
+  int cell = head_y * game->map_width + head_x;
+  return (game->occupied[cell >> 3] & (1 << (cell & 7))) != 0;
+}
+
+// Checks if a cell is inside the walls (where food can go)
+bool IsInsideWalls(const SnakeGame* game, int x, int y) {
+  return x > 0 && x < game->map_width - 1 && y > 0 && y < game->map_height - 1;
+}
+
+// Marks a cell as part of the snake and takes it off the free list
+void OccupyCell(SnakeGame* game, int cell) {
+  game->occupied[cell >> 3] |= (unsigned char)(1 << (cell & 7));
+  int slot = game->free_slot[cell];
+  if (slot >= 0) {
+    // Move the last free cell into the gap
+    int last = game->free_cells[--game->free_count];
+    game->free_cells[slot] = last;
+    game->free_slot[last] = slot;
+    game->free_slot[cell] = -1;
+  }
+}
+
+// Clears a cell the snake left and puts it back on the free list
+void ReleaseCell(SnakeGame* game, int cell) {
+  game->occupied[cell >> 3] &= (unsigned char)~(1 << (cell & 7));
+  if (IsInsideWalls(game, cell % game->map_width, cell / game->map_width)) {
+    game->free_slot[cell] = game->free_count;
+    game->free_cells[game->free_count++] = cell;
+  }
+}
+
+// A greedy player for headless runs: heads for the food along whichever safe move
+// gets closest, and keeps going straight when that's as good. O(1) per tick.
+int ChooseAIKey(const SnakeGame* game) {
+  static const int dir_x[4] = { 0, 0, -1, 1 };
+  static const int dir_y[4] = { -1, 1, 0, 0 };
+  static const int dir_key[4] = { 'w', 's', 'a', 'd' };
+  int head = game->snake_cells[game->snake_head];
+  int head_x = head % game->map_width;
+  int head_y = head / game->map_width;
+  int best = -1;
+  int best_distance = 0;
+  for (int d = 0; d < 4; d++) {
+    if (dir_x[d] == -game->current_dx && dir_y[d] == -game->current_dy) continue; // Can't reverse
+    int x = head_x + dir_x[d];
+    int y = head_y + dir_y[d];
+    if (!IsInsideWalls(game, x, y) || IsCollidingWithSelf(game, x, y)) continue;
+    int distance = abs(game->food.x - x) + abs(game->food.y - y);
+    bool straight = (dir_x[d] == game->current_dx && dir_y[d] == game->current_dy);
+    if (best < 0 || distance < best_distance || (distance == best_distance && straight)) {
+      best = d;
+      best_distance = distance;
     }
   }
-  return false;
+  if (best < 0) return 0; // Trapped
+  if (dir_x[best] == game->current_dx && dir_y[best] == game->current_dy) return 0; // No key needed to keep going
+  return dir_key[best];
+}
+
+// Turns a script character into a key ('.' and anything unknown are no key)
+int ScriptKey(char c) {
+  return (c == 'w' || c == 'a' || c == 's' || c == 'd') ? c : 0;
+}
+
+// Plays one game without a terminal (see TR_RunHeadless)
+void RunHeadlessInstance(int index, TR_Rng* rng, void* user, TR_HeadlessResult* result) {
+  (void)index;
+  const HeadlessConfig* config = (const HeadlessConfig*)user;
+  SnakeGame game;
+  if (!InitGame(&game, config->map_width, config->map_height, TR_RngNext(rng))) {
+    result->outcome = OUTCOME_LOST;
+    return;
+  }
+  size_t script_length = (config->script != NULL) ? strlen(config->script) : 0;
+  long long tick = 0;
+  while (!game.game_over && tick < config->max_ticks) {
+    int key;
+    if (config->script != NULL) key = ((size_t)tick < script_length) ? ScriptKey(config->script[tick]) : 0;
+    else key = ChooseAIKey(&game);
+    UpdateGame(&game, key);
+    tick++;
+  }
+  result->ticks = tick;
+  result->score = game.score;
+  result->outcome = game.game_won ? OUTCOME_WON : (game.game_over ? OUTCOME_LOST : OUTCOME_TIMED_OUT);
+  FreeGame(&game);
 }
@@ -4,10 +4,19 @@
 #include <time.h>     // For time, localtime, strftime
 #include <stdarg.h>   // For va_list, va_start, va_end
 
+// For TR_LogDecodeBinary (reading the binary logs written by TR_LogOpenBinary)
+// and the platform's read/open calls used by the streaming mode.
+#define TR_LOG
+#include "tread.h"
+
 // Defining a constant for the log buffer size,
 // which was likely in the original cin.h.
 #define LOG_BUFFER_SIZE 1024
 
+// Size of the input and output buffers used by the streaming mode (-s).
+// Longer input lines are split into several messages.
+#define STREAM_BUFFER_SIZE 65536
+
 /**
  * @brief A custom logging function similar to printf, but with
  * timestamp and a log type prefix.
@@ -43,11 +52,112 @@ static inline void lprintf(const char* type, const char* format, ...) {
   fprintf(stdout, "%s [LOG] [%s] %s", timeBuffer, type, msgBuffer);
 }
 
+/**
+ * @brief Writes one streamed line as a log message. The type is the part before
+ * the first tab, or default_type if the line has no tab.
+ *
+ * @param line The line, without its '\n' (not null-terminated).
+ * @param length The line's length.
+ * @param default_type The type used for lines without a tab.
+ * @param timeBuffer The current timestamp, already formatted.
+ */
+static inline void write_stream_line(char* line, size_t length, const char* default_type, const char* timeBuffer) {
+  if (length > 0 && line[length - 1] == '\r') length--; // CRLF input
+  if (length == 0) return; // Nothing to log
+
+  const char* type = default_type;
+  size_t type_length = strlen(default_type);
+  char* tab = (char*)memchr(line, '\t', length);
+  if (tab != NULL) {
+    type = line;
+    type_length = (size_t)(tab - line);
+    length -= type_length + 1;
+    line = tab + 1;
+  }
+
+  // Format: [TIMESTAMP] [LOG] [TYPE] MESSAGE
+  fputs(timeBuffer, stdout);
+  fputs(" [LOG] [", stdout);
+  fwrite(type, 1, type_length, stdout);
+  fputs("] ", stdout);
+  fwrite(line, 1, length, stdout);
+  fputc('\n', stdout);
+}
+
+/**
+ * @brief Streaming mode: reads "TYPE<TAB>message" lines until end of input and
+ * writes them as log messages through one buffered writer. Output is flushed
+ * whenever the logger has caught up with its input, so a long-running writer
+ * sees its lines appear straight away.
+ *
+ * @param fd The descriptor to read from (stdin, a file or a FIFO).
+ * @param default_type The type used for lines without a tab.
+ * @return 0 on success, 1 if reading failed.
+ */
+static int stream_log_lines(int fd, const char* default_type) {
+  static char input[STREAM_BUFFER_SIZE];
+  size_t filled = 0;
+  char timeBuffer[64] = "";
+  time_t cachedTime = (time_t)-1;
+
+  setvbuf(stdout, NULL, _IOFBF, STREAM_BUFFER_SIZE);
+
+  for (;;) {
+    size_t requested = sizeof(input) - filled;
+#ifdef _WIN32
+    int got = _read(fd, input + filled, (unsigned int)requested);
+#else
+    ssize_t got = read(fd, input + filled, requested);
+    if (got < 0 && errno == EINTR) continue;
+#endif
+    if (got < 0) {
+      fflush(stdout);
+      return 1;
+    }
+
+    // The timestamp only changes once a second
+    time_t rawtime = time(NULL);
+    if (rawtime != cachedTime) {
+      strftime(timeBuffer, sizeof(timeBuffer), "[%d/%m/%y | %H:%M:%S]", localtime(&rawtime));
+      cachedTime = rawtime;
+    }
+
+    if (got == 0) {
+      write_stream_line(input, filled, default_type, timeBuffer); // Last line without a '\n'
+      break;
+    }
+    filled += (size_t)got;
+
+    // Write every complete line in the buffer
+    size_t start = 0;
+    char* newline;
+    while ((newline = (char*)memchr(input + start, '\n', filled - start)) != NULL) {
+      write_stream_line(input + start, (size_t)(newline - (input + start)), default_type, timeBuffer);
+      start = (size_t)(newline - input) + 1;
+    }
+    if (start == 0 && filled == sizeof(input)) {
+      write_stream_line(input, filled, default_type, timeBuffer); // Line too long for the buffer
+      start = filled;
+    }
+    memmove(input, input + start, filled - start);
+    filled -= start;
+
+    // A short read means there's nothing more waiting right now
+    if ((size_t)got < requested) fflush(stdout);
+  }
+
+  fflush(stdout);
+  return 0;
+}
+
 // The main entry point of the application.
 // argc: argument count (number of strings in argv)
 // argv: argument vector (array of strings, where argv[0] is the program name)
 /**
  * @brief The main function of the logger that handles the CLI arguments.
+ * `-d <file>` decodes a binary log instead of writing a message.
+ * `-s [file]` streams "TYPE<TAB>message" lines from stdin (or a file/FIFO),
+ * using `-t` as the type for lines without a tab.
  *
  * @param type A string indicating the type of log message (e.g., "INFO", "WARN", "ERROR").
  * @param format The format string for the log message (like printf).
@@ -56,6 +166,9 @@ int main(int argc, char *argv[]) {
   // Initialize type and content pointers to NULL or empty strings
   const char* log_type = NULL;
   const char* log_content = NULL;
+  const char* decode_path = NULL;
+  const char* stream_path = NULL;
+  int stream_mode = 0;
 
   // Iterate through command-line arguments to find -t and -c
   for (int i = 1; i < argc; ++i) {
@@ -79,6 +192,23 @@ int main(int argc, char *argv[]) {
         lprintf("ERROR", "Missing argument for -c. Usage: %s -t <type> -c <content>\n", argv[0]);
         return 1;
       }
+    } else if (strcmp(argv[i], "-d") == 0) {
+      // Check if there's a next argument for the binary log to decode
+      if (i + 1 < argc) {
+        decode_path = argv[i+1];
+        i++; // Skip the next argument as it's been consumed
+      } else {
+        fprintf(stderr, "Error: -d requires an argument.\n");
+        lprintf("ERROR", "Missing argument for -d. Usage: %s -d <binary log file>\n", argv[0]);
+        return 1;
+      }
+    } else if (strcmp(argv[i], "-s") == 0) {
+      // The input file or FIFO is optional; stdin is read without one
+      stream_mode = 1;
+      if (i + 1 < argc && argv[i+1][0] != '-') {
+        stream_path = argv[i+1];
+        i++; // Skip the next argument as it's been consumed
+      }
     } else {
       fprintf(stderr, "Error: Unrecognized argument '%s'.\n", argv[i]);
       lprintf("ERROR", "Unrecognized argument '%s'. Usage: %s -t <type> -c <content>\n", argv[i], argv[0]);
@@ -86,10 +216,56 @@ int main(int argc, char *argv[]) {
     }
   }
 
+  // Expand a binary log into the normal text format ("-" reads it from stdin)
+  if (decode_path != NULL) {
+    FILE* log_file = (strcmp(decode_path, "-") == 0) ? stdin : fopen(decode_path, "rb");
+    if (log_file == NULL) {
+      fprintf(stderr, "Error: Could not open '%s'.\n", decode_path);
+      lprintf("ERROR", "Could not open binary log '%s'.\n", decode_path);
+      return 1;
+    }
+    long long lines = TR_LogDecodeBinary(log_file, stdout);
+    if (log_file != stdin) fclose(log_file);
+    if (lines < 0) {
+      fprintf(stderr, "Error: '%s' is not a binary log or is damaged.\n", decode_path);
+      lprintf("ERROR", "Could not decode all of '%s'.\n", decode_path);
+      return 1;
+    }
+    return 0;
+  }
+
+  // Log every line of stdin or a file/FIFO through one process
+  if (stream_mode) {
+    int fd = 0; // stdin
+    if (stream_path != NULL) {
+#ifdef _WIN32
+      fd = _open(stream_path, _O_RDONLY | _O_BINARY);
+#else
+      fd = open(stream_path, O_RDONLY | O_CLOEXEC);
+#endif
+      if (fd < 0) {
+        fprintf(stderr, "Error: Could not open '%s'.\n", stream_path);
+        lprintf("ERROR", "Could not open '%s' for streaming.\n", stream_path);
+        return 1;
+      }
+    }
+    int result = stream_log_lines(fd, (log_type != NULL) ? log_type : "LOG");
+#ifdef _WIN32
+    if (stream_path != NULL) _close(fd);
+#else
+    if (stream_path != NULL) close(fd);
+#endif
+    if (result != 0) {
+      fprintf(stderr, "Error: Reading the log lines failed.\n");
+      return 1;
+    }
+    return 0;
+  }
+
   // Check if both type and content were provided
   if (log_type == NULL || log_content == NULL) {
     fprintf(stderr, "Error: Both -t (type) and -c (content) arguments are required.\n");
-    lprintf("ERROR", "Both -t and -c arguments are required. Usage: %s -t <type> -c <content>\n", argv[0]);
+    lprintf("ERROR", "Both -t and -c arguments are required. Usage: %s -t <type> -c <content> (or -s [file] to stream lines)\n", argv[0]);
     return 1;
   }
 
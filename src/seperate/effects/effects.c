@@ -0,0 +1,376 @@
+// effects.c - Full-screen demo effects (plasma, fire, a rotating tunnel and a starfield) used
+//             as render benchmarks: every cell changes every frame, so each frame is a full
+//             redraw, and the status bar shows the frames per second and bytes per frame.
+//
+// Usage: effects                (the show, as fast as the terminal keeps up)
+//        effects -b [seconds]   (runs each effect for `seconds`, 3 by default, then prints a table)
+// Keys:  1-4 / Tab: effect   A: alternate glyphs (off lets unchanged cells be skipped)
+//        F: 60 FPS cap   Q/ESC: quit
+// Run it with TREAD_STREAM=unix:/tmp/effects.sock (for example) to watch it with tread-view,
+// or with TREAD_INSPECT=effects to watch its numbers with tread-top.
+
+#define TR_STREAM
+#define TR_INSPECT
+#include "../../tread.h"
+
+#include <time.h> // For time (to seed rand)
+
+// --- Configuration ---
+#define CAPPED_FPS 60
+#define DEFAULT_BENCH_SECONDS 3.0
+#define STATUS_INTERVAL_MS 500.0 // How often the status bar numbers are refreshed
+#define NUM_STARS 400
+#define STAR_SPEED 0.6f          // Depth units per second
+
+enum { EFFECT_PLASMA, EFFECT_FIRE, EFFECT_TUNNEL, EFFECT_STARFIELD, NUM_EFFECTS };
+static const char* effect_names[NUM_EFFECTS] = { "plasma", "fire", "tunnel", "starfield" };
+
+// Two glyph ramps of about the same density, swapped every frame so no cell stays the same
+static const char ramp_even[] = " .:-=+*#%@";
+static const char ramp_odd[]  = "`,;~<x?&$W";
+#define RAMP_LENGTH 10
+
+// One palette entry per 0-255 intensity
+typedef struct {
+  char glyph[2]; // Even and odd frame
+  Color fg;
+  Color bg;
+} PaletteEntry;
+
+typedef struct {
+  int effect;
+  long long frames;
+  double seconds;
+  unsigned long long bytes;
+  unsigned long long cells;
+  double frame_ms;
+} EffectResult;
+
+// --- Global State ---
+static int width = 0;
+static int field_height = 0; // Screen rows minus the status bar
+static unsigned char sine[256]; // 128 + 127 * sin(i * 2pi / 256)
+static PaletteEntry palettes[NUM_EFFECTS][256];
+static unsigned char* field = NULL;       // This frame's intensity for every cell
+static unsigned char* radius_lut = NULL;  // Plasma: distance from the center
+static unsigned char* angle_lut = NULL;   // Tunnel: angle around the center
+static unsigned char* depth_lut = NULL;   // Tunnel: depth into the tunnel
+static unsigned char* shade_lut = NULL;   // Tunnel: darkening towards the far end
+static unsigned char* heat = NULL;        // Fire: two extra rows below the screen to seed from
+static float stars[NUM_STARS][3];
+
+// --- Prototypes ---
+static bool InitTables(void);
+static void FreeTables(void);
+static void BuildPalette(PaletteEntry* palette, const Color* keys, int num_keys);
+static void UpdatePlasma(int t);
+static void UpdateFire(void);
+static void UpdateTunnel(int t);
+static void UpdateStarfield(int t, float dt);
+static void DrawField(const PaletteEntry* palette, bool odd);
+static void DrawStars(bool odd);
+static void ResetStar(int i, bool anywhere);
+
+static float RandomFloat(float min, float max) {
+  return min + (max - min) * (float)rand() / (float)RAND_MAX;
+}
+
+// Spreads the key colors over 256 entries. Each entry's background is the key color below it
+// and its foreground the one above, with the glyph getting denser towards the upper one.
+static void BuildPalette(PaletteEntry* palette, const Color* keys, int num_keys) {
+  for (int i = 0; i < 256; i++) {
+    int position = i * (num_keys - 1); // In 256ths of a key
+    int key = position / 256;
+    int level = (position % 256) * RAMP_LENGTH / 256;
+    palette[i].bg = keys[key];
+    palette[i].fg = keys[(key + 1 < num_keys) ? key + 1 : key];
+    palette[i].glyph[0] = ramp_even[level];
+    palette[i].glyph[1] = ramp_odd[level];
+  }
+}
+
+static bool InitTables(void) {
+  size_t cells = (size_t)width * field_height;
+  field = (unsigned char*)malloc(cells);
+  radius_lut = (unsigned char*)malloc(cells);
+  angle_lut = (unsigned char*)malloc(cells);
+  depth_lut = (unsigned char*)malloc(cells);
+  shade_lut = (unsigned char*)malloc(cells);
+  heat = (unsigned char*)calloc((size_t)width * (field_height + 2), 1);
+  if (!field || !radius_lut || !angle_lut || !depth_lut || !shade_lut || !heat) return false;
+
+  for (int i = 0; i < 256; i++) sine[i] = (unsigned char)(128.0 + 127.0 * sin(i * 2.0 * M_PI / 256.0));
+
+  // Cells are about twice as tall as wide, so rows count double from the center
+  float cx = width * 0.5f;
+  float cy = field_height * 0.5f;
+  for (int y = 0; y < field_height; y++) {
+    for (int x = 0; x < width; x++) {
+      float dx = x - cx;
+      float dy = (y - cy) * 2.0f;
+      float distance = sqrtf(dx * dx + dy * dy) + 0.5f;
+      int i = y * width + x;
+      radius_lut[i] = (unsigned char)((int)(distance * 4.0f) & 255);
+      angle_lut[i] = (unsigned char)((int)((atan2f(dy, dx) / (2.0f * (float)M_PI) + 0.5f) * 256.0f) & 255);
+      depth_lut[i] = (unsigned char)((int)(32.0f * 64.0f / distance) & 255);
+      float shade = distance / cx * 320.0f;
+      shade_lut[i] = (unsigned char)((shade > 255.0f) ? 255 : shade);
+    }
+  }
+
+  const Color plasma[] = { DARKBLUE, BLUE, MAGENTA, RED, YELLOW, GREEN, CYAN, BLUE, DARKBLUE };
+  const Color fire[] = { BLACK, MAROON, RED, ORANGE, YELLOW, WHITE };
+  const Color tunnel[] = { BLACK, DARKBLUE, BLUE, CYAN, WHITE };
+  const Color nebula[] = { BLACK, BLACK, DARKPURPLE, DARKBLUE, BLACK };
+  BuildPalette(palettes[EFFECT_PLASMA], plasma, sizeof(plasma) / sizeof(plasma[0]));
+  BuildPalette(palettes[EFFECT_FIRE], fire, sizeof(fire) / sizeof(fire[0]));
+  BuildPalette(palettes[EFFECT_TUNNEL], tunnel, sizeof(tunnel) / sizeof(tunnel[0]));
+  BuildPalette(palettes[EFFECT_STARFIELD], nebula, sizeof(nebula) / sizeof(nebula[0]));
+
+  for (int i = 0; i < NUM_STARS; i++) ResetStar(i, true);
+  return true;
+}
+
+static void FreeTables(void) {
+  free(field);
+  free(radius_lut);
+  free(angle_lut);
+  free(depth_lut);
+  free(shade_lut);
+  free(heat);
+}
+
+// Four sine waves (across, down, diagonal and around the center) added up
+static void UpdatePlasma(int t) {
+  for (int y = 0; y < field_height; y++) {
+    int wave_y = sine[(y * 8 + t * 3) & 255];
+    for (int x = 0; x < width; x++) {
+      int i = y * width + x;
+      int value = sine[(x * 4 + t * 2) & 255] + wave_y + sine[(radius_lut[i] + t * 5) & 255] + sine[((x + y * 2) * 3 - t) & 255];
+      field[i] = (unsigned char)(value / 4 + t);
+    }
+  }
+}
+
+// Random heat along the bottom rises: each cell averages the three below it and the one
+// two below, losing a little on the way up
+static void UpdateFire(void) {
+  int rows = field_height + 2;
+  for (int y = field_height; y < rows; y++) {
+    for (int x = 0; x < width; x++) heat[y * width + x] = (rand() % 4 == 0) ? 0 : (unsigned char)(192 + rand() % 64);
+  }
+  for (int y = 0; y < field_height; y++) {
+    unsigned char* row = heat + y * width;
+    const unsigned char* below = row + width;
+    const unsigned char* below2 = below + width;
+    for (int x = 0; x < width; x++) {
+      int left = (x > 0) ? below[x - 1] : below[x];
+      int right = (x + 1 < width) ? below[x + 1] : below[x];
+      int sum = left + below[x] + right + below2[x];
+      int value = sum * 31 / 128 - 1; // About sum / 4, minus the cooling
+      row[x] = (unsigned char)((value > 0) ? value : 0);
+    }
+  }
+  memcpy(field, heat, (size_t)width * field_height);
+}
+
+// A checker texture wrapped around a tunnel: looked up by angle (turning) and depth (flying
+// in), then darkened towards the far end
+static void UpdateTunnel(int t) {
+  int turn = (sine[(t / 2) & 255] - 128) / 2 + t; // Turns one way, then the other
+  for (int i = 0; i < width * field_height; i++) {
+    int u = (angle_lut[i] + turn) & 255;
+    int v = (depth_lut[i] + t * 3) & 255;
+    int texture = ((u ^ v) & 32) ? 255 : 96;
+    texture = (texture + sine[(u * 2 + v) & 255] / 4) * shade_lut[i] >> 8;
+    field[i] = (unsigned char)((texture > 255) ? 255 : texture);
+  }
+}
+
+// Places a star at a random spot, either at any depth (at start) or far away
+static void ResetStar(int i, bool anywhere) {
+  stars[i][0] = RandomFloat(-1.0f, 1.0f);
+  stars[i][1] = RandomFloat(-1.0f, 1.0f);
+  stars[i][2] = anywhere ? RandomFloat(0.05f, 1.0f) : 1.0f;
+}
+
+// Stars fly towards the viewer in front of a slowly drifting nebula (drawn over it by DrawStars)
+static void UpdateStarfield(int t, float dt) {
+  for (int y = 0; y < field_height; y++) {
+    int wave_y = sine[(y * 5 + t) & 255];
+    for (int x = 0; x < width; x++) {
+      int i = y * width + x;
+      field[i] = (unsigned char)((sine[(x * 3 - t) & 255] + wave_y + sine[(radius_lut[i] - t * 2) & 255]) / 3);
+    }
+  }
+  for (int i = 0; i < NUM_STARS; i++) {
+    stars[i][2] -= STAR_SPEED * dt;
+    if (stars[i][2] <= 0.05f) ResetStar(i, false);
+  }
+}
+
+static void DrawField(const PaletteEntry* palette, bool odd) {
+  char text[2] = { 0, '\0' };
+  for (int y = 0; y < field_height; y++) {
+    for (int x = 0; x < width; x++) {
+      const PaletteEntry* entry = &palette[field[y * width + x]];
+      text[0] = entry->glyph[odd];
+      TR_DrawText(text, x, y, 10, entry->fg, entry->bg);
+    }
+  }
+}
+
+static void DrawStars(bool odd) {
+  static const char near_glyphs[2][4] = { { '@', '*', '+', '.' }, { '#', 'x', '-', ',' } };
+  static const Color near_colors[4] = { WHITE, RAYWHITE, LIGHTGRAY, GRAY };
+  float cx = width * 0.5f;
+  float cy = field_height * 0.5f;
+  char text[2] = { 0, '\0' };
+  for (int i = 0; i < NUM_STARS; i++) {
+    float z = stars[i][2];
+    int x = (int)(cx + stars[i][0] / z * cx);
+    int y = (int)(cy + stars[i][1] / z * cy);
+    if (x < 0 || x >= width || y < 0 || y >= field_height) {
+      ResetStar(i, false);
+      continue;
+    }
+    int nearness = (int)(z * 4.0f);
+    if (nearness > 3) nearness = 3;
+    text[0] = near_glyphs[odd][nearness];
+    TR_DrawText(text, x, y, 10, near_colors[nearness], palettes[EFFECT_STARFIELD][field[y * width + x]].bg);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  bool bench = false;
+  double bench_seconds = DEFAULT_BENCH_SECONDS;
+  if (argc >= 2 && strcmp(argv[1], "-b") == 0 && argc <= 3) {
+    bench = true;
+    if (argc == 3) bench_seconds = atof(argv[2]);
+  }
+  if ((argc > 1 && !bench) || bench_seconds <= 0.0) {
+    fprintf(stderr, "Usage: %s [-b [seconds]]\n", argv[0]);
+    return 1;
+  }
+  srand((unsigned int)TR_RegisterSeed((uint64_t)time(NULL)));
+
+  width = TR_GetScreenWidth();
+  int height = TR_GetScreenHeight();
+  field_height = height - 1; // Bottom row for the status bar
+  if (!InitTables()) {
+    fprintf(stderr, "ERROR: Failed to allocate the effect tables.\n");
+    FreeTables();
+    return 1;
+  }
+  TR_InitWindow(width, height, "tread.h - Effects");
+  bool capped = false;
+  TR_SetTargetFPS(0); // Flat out: the point is how fast the terminal can take full redraws
+
+  EffectResult results[NUM_EFFECTS];
+  int num_results = 0;
+  int effect = EFFECT_PLASMA;
+  bool alternate = true;
+  int t = 0;
+
+  // Measured per effect (for the benchmark) and per status interval (for the status bar)
+  long long effect_start_ns = __tr_get_time_ns();
+  TR_FrameStats effect_start = TR_GetFrameStats();
+  long long interval_start_ns = effect_start_ns;
+  TR_FrameStats interval_start = effect_start;
+  double shown_fps = 0.0, shown_kb = 0.0, shown_cells = 0.0, shown_ms = 0.0;
+  long long last_ns = effect_start_ns;
+
+  bool running = true;
+  while (running) {
+    int next_effect = effect;
+    int key = TR_GetKeyPressed();
+    switch (key) {
+      case '1': case '2': case '3': case '4': if (!bench) next_effect = key - '1'; break;
+      case '\t': if (!bench) next_effect = (effect + 1) % NUM_EFFECTS; break;
+      case 'a': case 'A': if (!bench) alternate = !alternate; break;
+      case 'f': case 'F':
+        if (!bench) {
+          capped = !capped;
+          TR_SetTargetFPS(capped ? CAPPED_FPS : 0);
+        }
+        break;
+      case 'q': case 'Q': case TR_KEY_ESCAPE: running = false; break;
+    }
+
+    TR_FrameStats stats = TR_GetFrameStats();
+    long long now_ns = __tr_get_time_ns();
+    if (bench && (double)(now_ns - effect_start_ns) >= bench_seconds * 1e9) {
+      next_effect = effect + 1;
+      if (next_effect == NUM_EFFECTS) running = false;
+    }
+    if (next_effect != effect || !running) {
+      if (bench) {
+        EffectResult* result = &results[num_results++];
+        result->effect = effect;
+        result->frames = (long long)(stats.frames - effect_start.frames);
+        result->seconds = (double)(now_ns - effect_start_ns) / 1e9;
+        result->bytes = stats.bytes_written - effect_start.bytes_written;
+        result->cells = stats.cells_written - effect_start.cells_written;
+        result->frame_ms = stats.total_frame_ms - effect_start.total_frame_ms;
+      }
+      effect = next_effect;
+      effect_start_ns = interval_start_ns = now_ns;
+      effect_start = interval_start = stats;
+      if (!running) break;
+    }
+
+    // Refresh the status bar numbers from the frames since the last refresh
+    unsigned long long interval_frames = stats.frames - interval_start.frames;
+    if (interval_frames > 0 && (double)(now_ns - interval_start_ns) >= STATUS_INTERVAL_MS * 1e6) {
+      shown_fps = (double)interval_frames * 1e9 / (double)(now_ns - interval_start_ns);
+      shown_kb = (double)(stats.bytes_written - interval_start.bytes_written) / 1024.0 / interval_frames;
+      shown_cells = (double)(stats.cells_written - interval_start.cells_written) / interval_frames;
+      shown_ms = (stats.total_frame_ms - interval_start.total_frame_ms) / interval_frames;
+      interval_start_ns = now_ns;
+      interval_start = stats;
+    }
+
+    float dt = (float)(now_ns - last_ns) / 1e9f;
+    last_ns = now_ns;
+    t++;
+    switch (effect) {
+      case EFFECT_PLASMA: UpdatePlasma(t); break;
+      case EFFECT_FIRE: UpdateFire(); break;
+      case EFFECT_TUNNEL: UpdateTunnel(t); break;
+      case EFFECT_STARFIELD: UpdateStarfield(t, dt); break;
+    }
+
+    TR_BeginDrawing();
+    bool odd = alternate && (t & 1);
+    DrawField(palettes[effect], odd);
+    if (effect == EFFECT_STARFIELD) DrawStars(odd);
+
+    char viewers[32] = "";
+    TR_StreamStats stream = TR_GetStreamStats();
+    if (stream.viewers > 0) snprintf(viewers, sizeof(viewers), " | %d viewer%s", stream.viewers, stream.viewers == 1 ? "" : "s");
+    char status[256];
+    snprintf(status, sizeof(status), " %s%s | %.0f FPS | %.1f KB/frame | %.0f cells/frame | %.2f ms/frame%s | 1-4/Tab: Effect | A: Alternate %s | F: %s | Q: Quit",
+             effect_names[effect], bench ? " (benchmark)" : "", shown_fps, shown_kb, shown_cells, shown_ms, viewers,
+             alternate ? "on" : "off", capped ? "Uncap" : "Cap 60");
+    TR_DrawRectangle(0, height - 1, width, 1, BLACK, DARKGRAY);
+    TR_DrawText(status, 0, height - 1, 10, RAYWHITE, DARKGRAY);
+
+    TR_EndDrawing();
+  }
+
+  TR_CloseWindow();
+  FreeTables();
+
+  if (bench) {
+    printf("effects: %dx%d cells, %.1f s per effect\n", width, height, bench_seconds);
+    printf("  %-10s %8s %8s %12s %12s %10s %10s\n", "effect", "frames", "FPS", "KB/frame", "cells/frame", "ms/frame", "MB/s");
+    for (int i = 0; i < num_results; i++) {
+      const EffectResult* result = &results[i];
+      double frames = (result->frames > 0) ? (double)result->frames : 1.0;
+      printf("  %-10s %8lld %8.1f %12.1f %12.0f %10.2f %10.2f\n", effect_names[result->effect], result->frames,
+             result->frames / result->seconds, result->bytes / 1024.0 / frames, result->cells / frames,
+             result->frame_ms / frames, result->bytes / 1e6 / result->seconds);
+    }
+  }
+  return 0;
+}
@@ -2,6 +2,8 @@
 
 #include <ctype.h>  // For tolower
 #include <errno.h>  // For errno in nanosleep (used by tread.h internally, and for safety)
+#include <stdarg.h> // For va_list in the preview pane
+#include <time.h>   // For time (plugin index timestamps)
 
 // --- Platform-Specific Includes and Definitions for Dynamic Loading and File I/O ---
 
@@ -9,6 +11,8 @@
   #include <windows.h> // For LoadLibrary, GetProcAddress, FreeLibrary
   #include <direct.h>  // For _getcwd, _chdir
   #include <io.h>    // For _findfirst, _findnext, _findclose
+  #define PSAPI_VERSION 2 // GetProcessMemoryInfo from kernel32, no psapi.lib needed
+  #include <psapi.h>   // For GetProcessMemoryInfo (plugin run statistics)
   #define PATH_SEP '\\'
   #define DLL_EXT ".dll"
   #define GET_CURRENT_DIR _getcwd
@@ -17,13 +21,33 @@
   #define DLSYM GetProcAddress
   #define DLCLOSE FreeLibrary
   #define MAX_PATH_LENGTH _MAX_PATH // Windows max path length
+  #define MAX_NAME_LENGTH _MAX_FNAME // Windows max file name length
   typedef HMODULE lib_handle_t;
   #define snprintf _snprintf // Microsoft's snprintf is _snprintf
+  // Threading primitives (used by the background directory scanner)
+  typedef CRITICAL_SECTION mutex_t;
+  #define MUTEX_INIT(m) InitializeCriticalSection(m)
+  #define MUTEX_DESTROY(m) DeleteCriticalSection(m)
+  #define MUTEX_LOCK(m) EnterCriticalSection(m)
+  #define MUTEX_UNLOCK(m) LeaveCriticalSection(m)
+  #define THREAD_FUNC(name) DWORD WINAPI name(LPVOID arg)
+  #define THREAD_RETURN return 0
+  typedef LPTHREAD_START_ROUTINE thread_func_t;
 #else
   #include <dlfcn.h>   // For dlopen, dlsym, dlsym_error, dlclose
   #include <unistd.h>  // For getcwd, chdir
-  #include <dirent.h>  // For opendir, readdir, closedir
-  #include <limits.h>  // For PATH_MAX
+  #include <dirent.h>  // For opendir, readdir, closedir, dirfd
+  #include <limits.h>  // For PATH_MAX, NAME_MAX
+  #include <pthread.h> // For the background directory scanner
+  #include <sys/stat.h> // For stat, fstatat
+  #include <sys/resource.h> // For getrusage (plugin run statistics)
+  #include <fcntl.h>   // For openat
+  #ifndef __APPLE__
+    #include <elf.h>     // For the ELF64 structures read by plugin inspection
+    #include <stdint.h>  // For uint32_t, uint64_t
+    #include <sys/mman.h> // For mmap, munmap
+    #define HAVE_ELF_INSPECTION // Plugins can be inspected without dlopen (macOS uses Mach-O)
+  #endif
   #define PATH_SEP '/'
   #define DLL_EXT ".so"
   #define GET_CURRENT_DIR getcwd
@@ -32,70 +56,360 @@
   #define DLSYM dlsym
   #define DLCLOSE dlclose
   #define MAX_PATH_LENGTH PATH_MAX // POSIX max path length
+  #define MAX_NAME_LENGTH (NAME_MAX + 1) // POSIX max file name length (+1 for null terminator)
   typedef void* lib_handle_t;
+  // Threading primitives (used by the background directory scanner)
+  typedef pthread_mutex_t mutex_t;
+  #define MUTEX_INIT(m) pthread_mutex_init(m, NULL)
+  #define MUTEX_DESTROY(m) pthread_mutex_destroy(m)
+  #define MUTEX_LOCK(m) pthread_mutex_lock(m)
+  #define MUTEX_UNLOCK(m) pthread_mutex_unlock(m)
+  #define THREAD_FUNC(name) void* name(void* arg)
+  #define THREAD_RETURN return NULL
+  typedef void* (*thread_func_t)(void*);
 #endif
 
 // --- Configuration ---
 #define MAX_LIBS 10 // Maximum number of libraries that can be loaded simultaneously
-#define MAX_FILE_ENTRIES 100 // Maximum number of files/directories to list
+#define SCAN_BATCH_SIZE 256 // Entries the scanner reads before handing them to the UI
+#define SCAN_INSPECT_THREADS 4 // Maximum threads used to stat unknown entries and inspect libraries
+#define SCAN_INSPECT_PARALLEL_MIN 32 // Entries needing fstatat or inspection in a batch before it goes parallel
+#define DIR_CACHE_SLOTS 8 // Number of directory listings kept in memory (keyed by mtime)
+#define NAME_BLOCK_SIZE 16384 // Size of one block in a listing's name arena
+#define FILTER_MAX_QUERY 64 // Maximum length of the type-to-filter query
+#define FILTER_SCORE_BUCKETS 4096 // Distinct ranks used by the counting sort of filter matches
+#define FILTER_SCORE_OFFSET 1024 // Added to match scores so negative scores still land in a bucket
+#define FILTER_SCORE_MATCH 16 // Score for each matched query character
+#define FILTER_BONUS_BOUNDARY 10 // Bonus for matching at the start of a word (after '.', '_', '-', ' ' or camelCase)
+#define FILTER_BONUS_CONSECUTIVE 4 // Bonus per character in a run of consecutive matches
+#define FILTER_MAX_RUN_BONUS 8 // Runs longer than this stop increasing the bonus
+#define FILTER_MAX_GAP_PENALTY 8 // Largest penalty for skipped characters between two matches
 #define RUN_FUNCTION_NAME "run_lib_app" // The exact name of the function to call in DLLs/SOs
+#define STATS_FUNCTION_NAME "run_lib_stats" // Optional: void run_lib_stats(TR_FrameStats*), read after each run
+#define RUN_STATS_CSV_FILE "libloader_runs.csv" // Run statistics are appended here (in the current directory) on export
+#define PLUGIN_ENTRY_PREFIX "run_lib_" // Exported functions with this prefix are listed as plugin entry points
+#define ABI_VERSION_SYMBOL "tread_abi_version" // Optional exported int holding the plugin's ABI version
+#define ELF_MAX_ENTRY_POINTS 8 // Entry points kept for the preview pane
+#define ELF_MAX_NEEDED 16 // DT_NEEDED dependencies kept for the preview pane
+#define ELF_NAME_LENGTH 64 // Longest symbol/dependency name kept for the preview pane
+#define PREVIEW_MIN_UI_WIDTH 90 // Narrower than this, the preview pane is hidden
+#define PLUGIN_INDEX_FILE ".libloader_index" // Index of known plugins, kept in the user's home directory
+#define PLUGIN_INDEX_VERSION 1 // Bump when the index file format changes
+#define MAX_INDEXED_PLUGINS 64 // Plugins remembered across launches (least recently loaded non-favorites go first)
 // The following SCREEN_WIDTH and SCREEN_HEIGHT are now primarily for initial window sizing,
 // but the UI drawing logic will dynamically adapt to actual terminal size.
 #define INITIAL_SCREEN_WIDTH 100 // Initial logical screen width for the loader TUI
 #define INITIAL_SCREEN_HEIGHT 30 // Initial logical screen height for the loader TUI
 #define LOADER_FPS 10 // FPS for the file manager UI
+#define MAX_TOASTS 4 // Messages shown at once (the oldest is dropped when another arrives)
+#define TOAST_MAX_LENGTH 256 // Longest message text kept by a toast
 
 // --- Data Structures ---
 
+// What inspecting a library file without loading it found
+typedef enum {
+  PLUGIN_UNCHECKED = 0,  // Not inspected (not a library, or no ELF inspection on this platform)
+  PLUGIN_LOADABLE,       // Exports RUN_FUNCTION_NAME
+  PLUGIN_NO_ENTRY,       // A valid shared object that doesn't export RUN_FUNCTION_NAME
+  PLUGIN_INVALID         // Not an ELF64 shared object for this machine
+} PluginState;
+
 // Represents an entry in the file manager
 typedef struct {
-  char name[MAX_PATH_LENGTH]; // Name of the file/directory
+  const char* name;      // Name of the file/directory (owned by the listing's name arena)
   bool is_directory;     // True if it's a directory
   bool is_loadable_lib;    // True if it's a .dll/.so
+  unsigned char plugin_state; // PluginState found by the scanner
 } FileEntry;
 
+// One block of the chunked string arena that owns a listing's names.
+// Blocks are never moved, so name pointers stay valid while entries are merged.
+typedef struct NameBlock {
+  struct NameBlock* next;
+  size_t used;
+  size_t capacity;
+  char data[];
+} NameBlock;
+
+// A sorted directory listing
+typedef struct {
+  FileEntry* entries;
+  int count;
+  int capacity;
+  NameBlock* names;
+} DirListing;
+
+// A cached listing for one directory. The listing is reused as long as the
+// directory's modification time hasn't changed since it was scanned.
+typedef struct {
+  char path[MAX_PATH_LENGTH];
+  long long mtime_ns;    // Directory mtime when the scan was started
+  bool in_use;           // True if this slot holds a listing (complete or not)
+  bool complete;         // True once the scanner finished the listing
+  unsigned long last_used; // For LRU eviction
+  DirListing listing;
+} DirCacheSlot;
+
+// An entry handed from the scanner thread to the UI thread
+typedef struct {
+  size_t name_offset;    // Offset into ScanJob.pending_names
+  bool is_directory;
+  unsigned char plugin_state;
+} PendingEntry;
+
+// A background directory scan. Shared between the UI thread and the scanner
+// thread; whichever side drops the last reference frees it.
+typedef struct {
+  char path[MAX_PATH_LENGTH];
+  mutex_t lock;
+  int refs;
+  bool cancelled;        // Set by the UI when it no longer wants the result
+  bool done;             // Set by the scanner when the directory has been fully read
+  bool failed;           // Set by the scanner if the directory couldn't be opened
+  PendingEntry* pending; // Entries read but not yet merged by the UI
+  int pending_count;
+  int pending_capacity;
+  char* pending_names;   // Null-separated names for the pending entries
+  size_t pending_names_len;
+  size_t pending_names_capacity;
+} ScanJob;
+
+// Lowercase copy of the current listing's names, laid out contiguously in listing
+// order, so the fuzzy filter scans one flat buffer instead of chasing name pointers.
+typedef struct {
+  char* text;            // Lowercase names, each null-terminated, in listing order
+  unsigned char* word_starts; // 1 where a word starts in text (start, after '.', '_', '-', ' ', or camelCase)
+  int* offsets;          // Start of each entry's name in text (count + 1 values)
+  int count;
+  size_t text_capacity;
+  int offsets_capacity;
+} FilterIndex;
+
+// Greedy subsequence match of the filter query against one entry. The state is
+// kept so that typing another character continues from where the match stopped.
+typedef struct {
+  int entry;             // Index into the current listing
+  unsigned short next_pos; // Position just after the last matched character
+  short score;           // Accumulated match score (higher is better)
+  unsigned char run;     // Length of the current run of consecutive matched characters
+  unsigned char length_penalty; // Rank penalty for long names, so shorter names win ties
+} FilterMatch;
+
+// The matches for one prefix of the filter query. Each level is a subset of the
+// one before it, so a longer query only rescans the previous level's matches and
+// Backspace just drops back to the previous level.
+typedef struct {
+  FilterMatch* matches;
+  int count;
+  int capacity;
+} FilterLevel;
+
+// Metadata read from a shared library's dynamic section, without loading it
+typedef struct {
+  PluginState state;
+  long long file_size;
+  int abi_version;       // Value of ABI_VERSION_SYMBOL, or -1 if not exported
+  int num_exports;       // Defined dynamic symbols
+  int num_entry_points;  // Exported functions starting with PLUGIN_ENTRY_PREFIX
+  char entry_points[ELF_MAX_ENTRY_POINTS][ELF_NAME_LENGTH];
+  int num_needed;        // DT_NEEDED dependencies
+  char needed[ELF_MAX_NEEDED][ELF_NAME_LENGTH];
+  const char* error;     // Why the file couldn't be inspected (NULL if it could)
+} LibraryInfo;
+
+// A plugin remembered across launches in the on-disk index
+typedef struct {
+  char path[MAX_PATH_LENGTH]; // Full path to the library file
+  long long mtime_ns;    // File mtime when info was read
+  long long size;        // File size when info was read
+  long long last_used;   // When the plugin was last loaded (Unix time)
+  char hotkey;           // Hotkey it had last time ('\0' if none)
+  bool favorite;         // Loaded in the background at startup
+  LibraryInfo info;      // ELF metadata (error is not stored)
+} PluginIndexEntry;
+
+// A favorite plugin opened by the preload thread
+typedef struct {
+  char path[MAX_PATH_LENGTH];
+  char hotkey;           // Hotkey remembered by the index
+  lib_handle_t handle;   // NULL if it couldn't be opened
+  void (*run_function)();
+} PreloadItem;
+
+// Favorites being opened in the background at startup. Shared between the UI
+// thread and the preload thread; whichever side drops the last reference frees it.
+typedef struct {
+  mutex_t lock;
+  int refs;
+  bool cancelled;        // Set by the UI when it no longer wants the result
+  int count;
+  int completed;         // Items the thread has finished with (guarded by lock)
+  int adopted;           // Items the UI has taken into loaded_libs (UI thread only)
+  PreloadItem items[MAX_LIBS];
+} PreloadJob;
+
+// Process-wide resource usage, sampled before and after a plugin run
+typedef struct {
+  long long wall_ns;     // Monotonic clock
+  long long cpu_ns;      // User + system CPU time
+  long long peak_rss_kb; // Peak resident set size so far
+} ProcessUsage;
+
+// What one run of a plugin cost
+typedef struct {
+  double wall_ms;
+  double cpu_ms;
+  long long peak_rss_delta_kb; // How much the process's peak RSS grew during the run
+  bool has_frame_stats;  // False if the plugin doesn't export STATS_FUNCTION_NAME
+  unsigned long long frames;
+  double avg_frame_ms;
+  double max_frame_ms;
+} PluginRunStats;
+
+// One run kept for CSV export
+typedef struct {
+  char path[MAX_PATH_LENGTH];
+  long long mtime_ns;    // Identifies the plugin build that was run
+  long long size;
+  long long finished_at; // Unix time
+  PluginRunStats stats;
+} RunRecord;
+
+// A message drawn over the UI until its time runs out
+typedef struct {
+  char text[TOAST_MAX_LENGTH];
+  Color color;
+  long long expires_ns;  // Frame clock time at which it disappears
+} Toast;
+
 // Represents a dynamically loaded library
 typedef struct {
   char name[MAX_PATH_LENGTH]; // Full path to the library file
   lib_handle_t handle;    // OS-specific handle to the loaded library
   void (*run_function)();  // Pointer to the 'run_lib_app' function
+  void (*stats_function)(TR_FrameStats*); // Pointer to 'run_lib_stats' (NULL if not exported)
+  int runs;            // Times it has been run this session
+  PluginRunStats last_run; // Statistics of the latest run
   char hotkey;         // Hotkey assigned to run this library
   bool is_loaded;      // True if the library is currently loaded
 } LoadedLibrary;
 
 // --- Global Variables ---
 static char current_path[MAX_PATH_LENGTH];
-static FileEntry current_dir_entries[MAX_FILE_ENTRIES];
-static int num_dir_entries = 0;
+static DirCacheSlot dir_cache[DIR_CACHE_SLOTS];
+static unsigned long dir_cache_clock = 0;
+static DirCacheSlot* current_dir = NULL; // Cache slot shown in the file manager
+static ScanJob* current_scan = NULL;     // In-flight scan for current_dir (NULL if none)
 static int selected_entry_index = 0;
+static int list_scroll_offset = 0;       // First visible entry in the file list
+
+// Type-to-filter state
+static bool filter_active = false;
+static char filter_query[FILTER_MAX_QUERY + 1]; // Lowercase query
+static int filter_query_len = 0;
+static FilterIndex filter_index;
+static FilterLevel filter_levels[FILTER_MAX_QUERY + 1]; // Matches for each query length (index 0 unused)
+static int* filter_ranked = NULL;        // Listing indices of the current matches, best first
+static int filter_ranked_capacity = 0;
+
+// Preview pane state (recomputed when the selection moves to another library)
+static const char* preview_entry_name = NULL; // Name the preview was computed for
+static LibraryInfo preview_info;
+
+// Known plugins, persisted in PLUGIN_INDEX_FILE
+static PluginIndexEntry plugin_index[MAX_INDEXED_PLUGINS];
+static int plugin_index_count = 0;
+static bool plugin_index_dirty = false; // True if the index needs saving
+static PreloadJob* current_preload = NULL; // Favorites still being opened (NULL if none)
 
 static LoadedLibrary loaded_libs[MAX_LIBS];
 static int num_loaded_libs = 0;
 
+// Plugin runs this session, for CSV export
+static RunRecord* run_history = NULL;
+static int run_history_count = 0;
+static int run_history_capacity = 0;
+static int run_history_exported = 0; // Runs already appended to RUN_STATS_CSV_FILE
+
+// Toast notifications, oldest first
+static Toast toasts[MAX_TOASTS];
+static int num_toasts = 0;
+static long long frame_clock_ns = 0; // Monotonic time sampled at the start of each frame
+
 static bool running = true; // Main loop flag
 
 // --- Function Prototypes ---
 // File Manager Functions
 static void InitFileManager();
-static void UpdateFileManager(); // Not used in current main loop, but kept for consistency
+static void UpdateFileManager(); // Polls the background directory scanner
 static void DrawFileManager();
 static void RefreshCurrentDirectory();
 static int CompareFileEntries(const void* a, const void* b); // For sorting file entries
 
+// Directory Scanning Functions
+static THREAD_FUNC(ScanDirectoryWorker);
+static void PollDirectoryScan();
+static void ReleaseScanJob(ScanJob* job);
+static void MergeIntoListing(DirListing* listing, FileEntry* batch, int batch_count);
+static const char* ListingAddName(DirListing* listing, const char* name);
+static void ListingAddParentEntry(DirListing* listing, const char* path);
+static void FreeListing(DirListing* listing);
+static DirCacheSlot* AcquireCacheSlot(const char* path);
+
+// Fuzzy Filter Functions
+static bool HandleFilterKey(int key);
+static void FilterPushChar(char c);
+static void FilterPopChar();
+static void ClearFilter();
+static void RebuildFilter();
+static int GetVisibleEntryCount();
+static FileEntry* GetVisibleEntry(int index);
+
+// Library Inspection Functions
+static bool InspectLibraryFile(int dir_fd, const char* name, LibraryInfo* info, bool full);
+static void DrawPluginPreview(int x, int y, int width, int height);
+
+// Plugin Index Functions
+static void LoadPluginIndex();
+static void SavePluginIndex();
+static PluginIndexEntry* FindIndexEntry(const char* path);
+static PluginIndexEntry* RememberPlugin(const char* path, char hotkey);
+static void TogglePluginFavorite(const char* path);
+static void StartFavoritePreload();
+static void PollFavoritePreload();
+static void ReleasePreloadJob(PreloadJob* job);
+
 // Dynamic Library Loader Functions
+static bool OpenPluginLibrary(const char* path, lib_handle_t* handle, void (**run_function)(), char* error, size_t error_size);
+static int AddLoadedLibrary(const char* path, lib_handle_t handle, void (*run_function)(), char preferred_hotkey);
+static bool IsLibraryLoaded(const char* path);
 static void LoadDynamicLibrary(const char* path);
 static void RunLoadedLibrary(char hotkey);
+static void RecordPluginRun(LoadedLibrary* lib, const PluginRunStats* stats);
+static void ExportRunStats();
 static void UnloadAllLibraries();
 
 // Utility Functions
 static void GetParentPath(char* dest, const char* path);
 static bool IsLoadableLibrary(const char* filename);
+static bool IsHotkeyInUse(char hotkey);
 static char GetNextAvailableHotkey();
-static void DisplayMessage(const char* message, Color color, int duration_ms); // For temporary messages
+static bool GetEntryPath(char* dest, size_t size, const char* name);
+static bool GetPathStat(const char* path, long long* mtime_ns, long long* size);
+static bool StartDetachedThread(thread_func_t func, void* arg);
+static void GetProcessUsage(ProcessUsage* usage);
+static long long GetMonotonicTimeNs();
+static void DisplayMessage(const char* message, Color color, int duration_ms); // Queues a toast notification
+static void UpdateToasts();
+static void DrawToasts();
 static bool ShowYesNoPrompt(const char* message, Color color); // New: Yes/No prompt
 
 // --- Main Program ---
 int main() {
+  // Validate the plugin index and start opening favorites before the terminal is set up
+  LoadPluginIndex();
+  StartFavoritePreload();
+
   // Initialize window with initial dimensions; drawing will adapt to actual screen size
   TR_InitWindow(INITIAL_SCREEN_WIDTH, INITIAL_SCREEN_HEIGHT, "Tread.h Library Loader");
   TR_SetTargetFPS(LOADER_FPS);
@@ -106,16 +420,29 @@ int main() {
     TR_BeginDrawing();
     TR_ClearBackground(DARKGRAY); // Dark background for the loader UI
 
+    frame_clock_ns = GetMonotonicTimeNs();
+    UpdateToasts(); // Drop messages whose time is up
+    UpdateFileManager(); // Merge any entries the background scanner has found
+    PollFavoritePreload(); // Take favorites the preload thread has opened
     DrawFileManager();
+    DrawToasts();
 
     int key = TR_GetKeyPressed();
+    if (key != 0 && filter_active && HandleFilterKey(key)) {
+      key = 0; // Consumed by the filter query
+    }
+    int num_dir_entries = GetVisibleEntryCount();
     if (key != 0) {
       switch (key) {
         case TR_KEY_UP:
-          selected_entry_index = (selected_entry_index - 1 + num_dir_entries) % num_dir_entries;
+          if (num_dir_entries > 0) {
+            selected_entry_index = (selected_entry_index - 1 + num_dir_entries) % num_dir_entries;
+          }
           break;
         case TR_KEY_DOWN:
-          selected_entry_index = (selected_entry_index + 1) % num_dir_entries;
+          if (num_dir_entries > 0) {
+            selected_entry_index = (selected_entry_index + 1) % num_dir_entries;
+          }
           break;
         case 8: // Backspace key (common ASCII for backspace)
         case 127: // Another common ASCII for backspace (e.g., on Linux terminals)
@@ -132,7 +459,7 @@ int main() {
           break;
         case 13: // Enter key
           if (num_dir_entries > 0) {
-            FileEntry* selected_entry = &current_dir_entries[selected_entry_index];
+            FileEntry* selected_entry = GetVisibleEntry(selected_entry_index);
             if (selected_entry->is_directory) {
               if (strcmp(selected_entry->name, "..") == 0) {
                 // Go up one directory
@@ -149,14 +476,9 @@ int main() {
               } else {
                 // Enter selected directory
                 char new_path[MAX_PATH_LENGTH];
-                #ifdef _WIN32
-                  // For Windows, append with backslash if current_path doesn't end with one
-                  snprintf(new_path, sizeof(new_path), "%s%c%s", current_path, PATH_SEP, selected_entry->name);
-                #else
-                  // For POSIX, append with slash if current_path doesn't end with one
-                  snprintf(new_path, sizeof(new_path), "%s%s%s", current_path, (current_path[strlen(current_path)-1] == PATH_SEP ? "" : "/"), selected_entry->name);
-                #endif
-                if (CHDIR(new_path) == 0) {
+                if (!GetEntryPath(new_path, sizeof(new_path), selected_entry->name)) {
+                  DisplayMessage("Error: The path is too long.", RED, 1000);
+                } else if (CHDIR(new_path) == 0) {
                   strcpy(current_path, new_path);
                   RefreshCurrentDirectory();
                 } else {
@@ -168,17 +490,26 @@ int main() {
               const char* warning_msg =
                 "Always make sure you have checked the source of the code if you downloaded the DLL off the internet and always also check the libraries for malware first with a responsible malware checker like your installed antivirus or (recommended more) VirusTotal (https://www.virustotal.com/).\n\nLoad this library? (Y/N)";
 
-              bool proceed = ShowYesNoPrompt(warning_msg, YELLOW);
+              char full_lib_path[MAX_PATH_LENGTH];
+              if (!GetEntryPath(full_lib_path, sizeof(full_lib_path), selected_entry->name)) {
+                DisplayMessage("Error: The path is too long.", RED, 1000);
+                break;
+              }
+
+              // Check the file is a plugin before anything gets loaded (it may have changed since the scan)
+              LibraryInfo info;
+              InspectLibraryFile(-1, full_lib_path, &info, false);
+              if (info.state == PLUGIN_NO_ENTRY) {
+                DisplayMessage("Not a plugin: '" RUN_FUNCTION_NAME "' is not exported.", RED, 1500);
+                break;
+              } else if (info.state == PLUGIN_INVALID) {
+                DisplayMessage(info.error, RED, 1500);
+                break;
+              }
 
-              RefreshCurrentDirectory(); // Refresh file list to redraw properly
+              bool proceed = ShowYesNoPrompt(warning_msg, YELLOW);
 
               if (proceed) {
-                char full_lib_path[MAX_PATH_LENGTH];
-                #ifdef _WIN32
-                  snprintf(full_lib_path, sizeof(full_lib_path), "%s%c%s", current_path, PATH_SEP, selected_entry->name);
-                #else
-                  snprintf(full_lib_path, sizeof(full_lib_path), "%s%s%s", current_path, (current_path[strlen(current_path)-1] == PATH_SEP ? "" : "/"), selected_entry->name);
-                #endif
                 LoadDynamicLibrary(full_lib_path);
               } else {
                 DisplayMessage("Library loading cancelled.", RED, 1500);
@@ -188,6 +519,28 @@ int main() {
             }
           }
           break;
+        case '*': // Toggle favorite for the selected library
+          if (num_dir_entries > 0) {
+            FileEntry* selected_entry = GetVisibleEntry(selected_entry_index);
+            if (selected_entry->is_loadable_lib) {
+              char full_lib_path[MAX_PATH_LENGTH];
+              if (GetEntryPath(full_lib_path, sizeof(full_lib_path), selected_entry->name)) {
+                TogglePluginFavorite(full_lib_path);
+              } else {
+                DisplayMessage("Error: The path is too long.", RED, 1000);
+              }
+            } else {
+              DisplayMessage("Only libraries can be favorites.", YELLOW, 1000);
+            }
+          }
+          break;
+        case '>': // Append this session's plugin run statistics to a CSV file
+          ExportRunStats();
+          break;
+        case '/': // Start type-to-filter
+          filter_active = true;
+          RebuildFilter();
+          break;
         case 'q': // Quit
         case 27:  // ESC
           running = false;
@@ -204,7 +557,28 @@ int main() {
     TR_EndDrawing();
   }
 
+  if (current_preload != NULL) {
+    ReleasePreloadJob(current_preload); // Closes any favorites it opened that weren't taken
+    current_preload = NULL;
+  }
+  SavePluginIndex();
   UnloadAllLibraries();
+  if (current_scan != NULL) {
+    ReleaseScanJob(current_scan); // The scanner frees the job once it notices
+    current_scan = NULL;
+  }
+  ClearFilter();
+  for (int i = 0; i <= FILTER_MAX_QUERY; ++i) {
+    free(filter_levels[i].matches);
+  }
+  free(filter_ranked);
+  free(filter_index.text);
+  free(filter_index.word_starts);
+  free(filter_index.offsets);
+  for (int i = 0; i < DIR_CACHE_SLOTS; ++i) {
+    FreeListing(&dir_cache[i].listing);
+  }
+  free(run_history);
   TR_CloseWindow();
   return 0;
 }
@@ -220,85 +594,451 @@ static void InitFileManager() {
   RefreshCurrentDirectory();
 }
 
-// This function is not explicitly used in the main loop, but could be for future updates.
+// Polls the background scanner and merges newly found entries into the listing.
 static void UpdateFileManager() {
-  // Logic for updating file manager state (e.g., polling directory changes)
-  // For now, RefreshCurrentDirectory is called only on navigation events.
+  PollDirectoryScan();
 }
 
-// Refreshes the list of files and directories in the current_path
+// Shows the listing for current_path. A cached listing is reused as long as the
+// directory hasn't been modified since it was scanned; otherwise a background scan
+// is started and its entries stream into the listing via PollDirectoryScan.
 static void RefreshCurrentDirectory() {
-  num_dir_entries = 0;
+  ClearFilter(); // The query belongs to the directory we're leaving
   selected_entry_index = 0; // Reset selection
+  list_scroll_offset = 0;
+  preview_entry_name = NULL; // Names of the old listing may be freed below
+
+  // Abandon any scan still running for the previous directory
+  if (current_scan != NULL) {
+    ReleaseScanJob(current_scan);
+    current_scan = NULL;
+    if (current_dir != NULL && !current_dir->complete) {
+      // A partial listing must never be served from the cache
+      FreeListing(&current_dir->listing);
+      current_dir->in_use = false;
+    }
+  }
+
+  long long mtime_ns = 0;
+  bool have_mtime = GetPathStat(current_path, &mtime_ns, NULL);
+
+  current_dir = AcquireCacheSlot(current_path);
+  current_dir->last_used = ++dir_cache_clock;
+  if (have_mtime && current_dir->in_use && current_dir->complete && current_dir->mtime_ns == mtime_ns) {
+    return; // Unchanged since it was last scanned, reuse the cached listing
+  }
+
+  FreeListing(&current_dir->listing);
+  strncpy(current_dir->path, current_path, sizeof(current_dir->path) - 1);
+  current_dir->path[sizeof(current_dir->path) - 1] = '\0';
+  current_dir->mtime_ns = mtime_ns; // Taken before scanning, so changes made mid-scan cause a rescan next time
+  current_dir->in_use = true;
+  current_dir->complete = false;
 
   // Add ".." for parent directory navigation
-  // This handles Windows drive roots (e.g., C:\) correctly as their parent is themselves
-  // and POSIX root (/) parent is itself.
-  char temp_parent_path[MAX_PATH_LENGTH];
-  GetParentPath(temp_parent_path, current_path);
-  if (strcmp(temp_parent_path, current_path) != 0) { // If parent is different, add ".."
-    if (num_dir_entries < MAX_FILE_ENTRIES) {
-      strcpy(current_dir_entries[num_dir_entries].name, "..");
-      current_dir_entries[num_dir_entries].is_directory = true;
-      current_dir_entries[num_dir_entries].is_loadable_lib = false;
-      num_dir_entries++;
+  ListingAddParentEntry(&current_dir->listing, current_path);
+
+  ScanJob* job = (ScanJob*)calloc(1, sizeof(ScanJob));
+  if (job == NULL) {
+    DisplayMessage("Error: Could not list directory contents.", RED, 2000);
+    return;
+  }
+  snprintf(job->path, sizeof(job->path), "%s", current_path); // Both MAX_PATH_LENGTH, so it always fits
+  MUTEX_INIT(&job->lock);
+  job->refs = 2; // One reference for the UI, one for the scanner
+  current_scan = job;
+
+  if (!StartDetachedThread(ScanDirectoryWorker, job)) {
+    // No thread available: scan synchronously, the entries are merged on the next poll
+    ScanDirectoryWorker(job);
+  }
+}
+
+// --- Directory Scanning Functions ---
+
+// An entry as read by the scanner, before it is queued for the UI
+typedef struct {
+  char name[MAX_NAME_LENGTH];
+  bool is_directory;
+  bool type_unknown; // True if d_type couldn't tell us and fstatat is needed
+  unsigned char plugin_state;
+} ScannedEntry;
+
+// Queues a batch of scanned entries for the UI.
+// Returns false if the UI has cancelled the scan.
+static bool FlushScanBatch(ScanJob* job, const ScannedEntry* batch, int count) {
+  MUTEX_LOCK(&job->lock);
+  if (job->cancelled) {
+    MUTEX_UNLOCK(&job->lock);
+    return false;
+  }
+
+  for (int i = 0; i < count; ++i) {
+    size_t name_len = strlen(batch[i].name) + 1;
+
+    if (job->pending_count == job->pending_capacity) {
+      int new_capacity = job->pending_capacity ? job->pending_capacity * 2 : SCAN_BATCH_SIZE;
+      PendingEntry* grown = (PendingEntry*)realloc(job->pending, sizeof(PendingEntry) * new_capacity);
+      if (grown == NULL) break;
+      job->pending = grown;
+      job->pending_capacity = new_capacity;
     }
+    if (job->pending_names_len + name_len > job->pending_names_capacity) {
+      size_t new_capacity = job->pending_names_capacity ? job->pending_names_capacity * 2 : NAME_BLOCK_SIZE;
+      while (new_capacity < job->pending_names_len + name_len) new_capacity *= 2;
+      char* grown = (char*)realloc(job->pending_names, new_capacity);
+      if (grown == NULL) break;
+      job->pending_names = grown;
+      job->pending_names_capacity = new_capacity;
+    }
+
+    memcpy(job->pending_names + job->pending_names_len, batch[i].name, name_len);
+    job->pending[job->pending_count].name_offset = job->pending_names_len;
+    job->pending[job->pending_count].is_directory = batch[i].is_directory;
+    job->pending[job->pending_count].plugin_state = batch[i].plugin_state;
+    job->pending_names_len += name_len;
+    job->pending_count++;
   }
 
+  MUTEX_UNLOCK(&job->lock);
+  return true;
+}
+
+#ifndef _WIN32
+// Work item for resolving entry types and inspecting libraries in parallel
+typedef struct {
+  int dir_fd;
+  ScannedEntry* entries;
+  int count;
+  int start;
+  int stride;
+} InspectTask;
+
+// True if a scanned entry needs fstatat or library inspection
+static bool NeedsInspection(const ScannedEntry* entry) {
+  return entry->type_unknown || (!entry->is_directory && IsLoadableLibrary(entry->name));
+}
+
+// Resolves every stride-th entry of a batch with fstatat (follows symlinks),
+// then checks whether library files export the plugin entry point
+static void* InspectTaskWorker(void* arg) {
+  InspectTask* task = (InspectTask*)arg;
+  for (int i = task->start; i < task->count; i += task->stride) {
+    ScannedEntry* entry = &task->entries[i];
+    if (entry->type_unknown) {
+      struct stat st;
+      if (fstatat(task->dir_fd, entry->name, &st, 0) == 0) {
+        entry->is_directory = S_ISDIR(st.st_mode);
+      }
+      entry->type_unknown = false;
+    }
+    if (!entry->is_directory && IsLoadableLibrary(entry->name)) {
+      LibraryInfo info;
+      InspectLibraryFile(task->dir_fd, entry->name, &info, false);
+      entry->plugin_state = (unsigned char)info.state;
+    }
+  }
+  return NULL;
+}
+
+// Fills in the type of entries whose d_type was DT_UNKNOWN (or a symlink) and
+// the plugin state of library files. Large numbers of them are split across
+// threads, since each fstatat or open can block on I/O.
+static void InspectScannedEntries(int dir_fd, ScannedEntry* entries, int count) {
+  int pending = 0;
+  for (int i = 0; i < count; ++i) {
+    if (NeedsInspection(&entries[i])) pending++;
+  }
+  if (pending == 0) return;
+
+  int num_threads = (pending >= SCAN_INSPECT_PARALLEL_MIN) ? SCAN_INSPECT_THREADS : 1;
+  InspectTask tasks[SCAN_INSPECT_THREADS];
+  pthread_t threads[SCAN_INSPECT_THREADS];
+  bool started[SCAN_INSPECT_THREADS] = {false};
+
+  for (int t = 0; t < num_threads; ++t) {
+    tasks[t] = (InspectTask){ dir_fd, entries, count, t, num_threads };
+    if (t > 0) {
+      started[t] = (pthread_create(&threads[t], NULL, InspectTaskWorker, &tasks[t]) == 0);
+    }
+  }
+  InspectTaskWorker(&tasks[0]); // This thread takes the first share
+  for (int t = 1; t < num_threads; ++t) {
+    if (started[t]) {
+      pthread_join(threads[t], NULL);
+    } else {
+      InspectTaskWorker(&tasks[t]); // Thread creation failed, do its share here
+    }
+  }
+}
+#endif
+
+// Background thread: reads the directory in batches and queues them for the UI.
+static THREAD_FUNC(ScanDirectoryWorker) {
+  ScanJob* job = (ScanJob*)arg;
+  ScannedEntry* batch = (ScannedEntry*)malloc(sizeof(ScannedEntry) * SCAN_BATCH_SIZE);
+  int count = 0;
+  bool failed = (batch == NULL);
+  bool keep_going = !failed;
 
 #ifdef _WIN32
   WIN32_FIND_DATAA find_data;
-  HANDLE h_find;
+  HANDLE h_find = INVALID_HANDLE_VALUE;
   char search_path[MAX_PATH_LENGTH];
-  snprintf(search_path, sizeof(search_path), "%s%c*", current_path, PATH_SEP);
+  snprintf(search_path, sizeof(search_path), "%s%c*", job->path, PATH_SEP);
 
-  h_find = FindFirstFileA(search_path, &find_data);
-  if (h_find == INVALID_HANDLE_VALUE) {
-    DisplayMessage("Error: Could not list directory contents.", RED, 2000);
-    return;
-  }
-
-  do {
-    if (strcmp(find_data.cFileName, ".") == 0 || strcmp(find_data.cFileName, "..") == 0) {
-      continue; // Skip "." and ".." (already added ".." if applicable)
+  if (keep_going) {
+    h_find = FindFirstFileA(search_path, &find_data);
+    if (h_find == INVALID_HANDLE_VALUE) {
+      failed = true;
+      keep_going = false;
     }
+  }
 
-    if (num_dir_entries < MAX_FILE_ENTRIES) {
-      strcpy(current_dir_entries[num_dir_entries].name, find_data.cFileName);
-      current_dir_entries[num_dir_entries].is_directory = (find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
-      current_dir_entries[num_dir_entries].is_loadable_lib = IsLoadableLibrary(find_data.cFileName);
-      num_dir_entries++;
+  while (keep_going) {
+    // Skip "." and ".." (".." is added by the UI if applicable)
+    if (strcmp(find_data.cFileName, ".") != 0 && strcmp(find_data.cFileName, "..") != 0) {
+      ScannedEntry* entry = &batch[count++];
+      strncpy(entry->name, find_data.cFileName, sizeof(entry->name) - 1);
+      entry->name[sizeof(entry->name) - 1] = '\0';
+      entry->is_directory = (find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+      entry->type_unknown = false;
+      entry->plugin_state = PLUGIN_UNCHECKED;
+
+      if (count == SCAN_BATCH_SIZE) {
+        keep_going = FlushScanBatch(job, batch, count);
+        count = 0;
+      }
     }
-  } while (FindNextFileA(h_find, &find_data) != 0);
+    if (keep_going && FindNextFileA(h_find, &find_data) == 0) break;
+  }
 
-  FindClose(h_find);
+  if (keep_going && count > 0) FlushScanBatch(job, batch, count);
+  if (h_find != INVALID_HANDLE_VALUE) FindClose(h_find);
 
 #else // POSIX
-  DIR* dir = opendir(current_path);
-  if (dir == NULL) {
-    perror("Error opening directory");
-    DisplayMessage("Error: Could not list directory contents.", RED, 2000);
-    return;
+  DIR* dir = NULL;
+  if (keep_going) {
+    dir = opendir(job->path);
+    if (dir == NULL) {
+      failed = true;
+      keep_going = false;
+    }
   }
 
-  struct dirent* entry;
-  while ((entry = readdir(dir)) != NULL) {
-    if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
-      continue; // Skip "." and ".." (already added ".." if applicable)
+  struct dirent* dir_entry;
+  while (keep_going && (dir_entry = readdir(dir)) != NULL) {
+    if (strcmp(dir_entry->d_name, ".") == 0 || strcmp(dir_entry->d_name, "..") == 0) {
+      continue; // Skip "." and ".." (".." is added by the UI if applicable)
     }
 
-    if (num_dir_entries < MAX_FILE_ENTRIES) {
-      strcpy(current_dir_entries[num_dir_entries].name, entry->d_name);
-      current_dir_entries[num_dir_entries].is_directory = (entry->d_type == DT_DIR);
-      current_dir_entries[num_dir_entries].is_loadable_lib = IsLoadableLibrary(entry->d_name);
-      num_dir_entries++;
+    ScannedEntry* entry = &batch[count++];
+    strncpy(entry->name, dir_entry->d_name, sizeof(entry->name) - 1);
+    entry->name[sizeof(entry->name) - 1] = '\0';
+    entry->is_directory = (dir_entry->d_type == DT_DIR);
+    // Some filesystems always report DT_UNKNOWN, and a symlink may point at a directory
+    entry->type_unknown = (dir_entry->d_type == DT_UNKNOWN || dir_entry->d_type == DT_LNK);
+    entry->plugin_state = PLUGIN_UNCHECKED;
+
+    if (count == SCAN_BATCH_SIZE) {
+      InspectScannedEntries(dirfd(dir), batch, count);
+      keep_going = FlushScanBatch(job, batch, count);
+      count = 0;
     }
   }
-  closedir(dir);
+
+  if (keep_going && count > 0) {
+    InspectScannedEntries(dirfd(dir), batch, count);
+    FlushScanBatch(job, batch, count);
+  }
+  if (dir != NULL) closedir(dir);
 #endif
 
-  // Sort entries: directories first, then regular files, alphabetically
-  qsort(current_dir_entries, num_dir_entries, sizeof(FileEntry), CompareFileEntries);
+  free(batch);
+
+  MUTEX_LOCK(&job->lock);
+  job->done = true;
+  job->failed = failed;
+  MUTEX_UNLOCK(&job->lock);
+  ReleaseScanJob(job);
+  THREAD_RETURN;
+}
+
+// Merges whatever the scanner has queued since the last poll into the current listing
+static void PollDirectoryScan() {
+  if (current_scan == NULL) return;
+  ScanJob* job = current_scan;
+
+  // Take the queued entries so the scanner can keep going while we sort and merge
+  MUTEX_LOCK(&job->lock);
+  PendingEntry* pending = job->pending;
+  int pending_count = job->pending_count;
+  char* pending_names = job->pending_names;
+  bool done = job->done;
+  bool failed = job->failed;
+  job->pending = NULL;
+  job->pending_count = 0;
+  job->pending_capacity = 0;
+  job->pending_names = NULL;
+  job->pending_names_len = 0;
+  job->pending_names_capacity = 0;
+  MUTEX_UNLOCK(&job->lock);
+
+  if (pending_count > 0) {
+    DirListing* listing = &current_dir->listing;
+    const char* selected_name = (selected_entry_index < GetVisibleEntryCount()) ? GetVisibleEntry(selected_entry_index)->name : NULL;
+
+    FileEntry* batch = (FileEntry*)malloc(sizeof(FileEntry) * pending_count);
+    if (batch != NULL) {
+      int batch_count = 0;
+      for (int i = 0; i < pending_count; ++i) {
+        const char* name = ListingAddName(listing, pending_names + pending[i].name_offset);
+        if (name == NULL) break;
+        batch[batch_count].name = name;
+        batch[batch_count].is_directory = pending[i].is_directory;
+        batch[batch_count].is_loadable_lib = !pending[i].is_directory && IsLoadableLibrary(name);
+        batch[batch_count].plugin_state = pending[i].plugin_state;
+        batch_count++;
+      }
+      qsort(batch, batch_count, sizeof(FileEntry), CompareFileEntries);
+      MergeIntoListing(listing, batch, batch_count);
+      free(batch);
+    }
+    if (filter_active) {
+      RebuildFilter(); // Entry indices have shifted and new entries may match
+    }
+
+    // Keep the cursor on the same entry while new entries are sorted in around it
+    if (selected_name != NULL) {
+      int visible_count = GetVisibleEntryCount();
+      for (int i = 0; i < visible_count; ++i) {
+        if (GetVisibleEntry(i)->name == selected_name) {
+          selected_entry_index = i;
+          break;
+        }
+      }
+    }
+  }
+  free(pending);
+  free(pending_names);
+
+  if (done) {
+    current_dir->complete = !failed;
+    ReleaseScanJob(job);
+    current_scan = NULL;
+    if (failed) {
+      DisplayMessage("Error: Could not list directory contents.", RED, 2000);
+    }
+  }
+}
+
+// Drops one reference to a scan job. Dropping the UI's reference also cancels the scan.
+static void ReleaseScanJob(ScanJob* job) {
+  MUTEX_LOCK(&job->lock);
+  job->cancelled = true;
+  int refs = --job->refs;
+  MUTEX_UNLOCK(&job->lock);
+
+  if (refs == 0) {
+    MUTEX_DESTROY(&job->lock);
+    free(job->pending);
+    free(job->pending_names);
+    free(job);
+  }
+}
+
+// Merges a sorted batch into a sorted listing (in place, back to front)
+static void MergeIntoListing(DirListing* listing, FileEntry* batch, int batch_count) {
+  if (batch_count <= 0) return;
+
+  int needed = listing->count + batch_count;
+  if (needed > listing->capacity) {
+    int new_capacity = listing->capacity ? listing->capacity : SCAN_BATCH_SIZE;
+    while (new_capacity < needed) new_capacity *= 2;
+    FileEntry* grown = (FileEntry*)realloc(listing->entries, sizeof(FileEntry) * new_capacity);
+    if (grown == NULL) return;
+    listing->entries = grown;
+    listing->capacity = new_capacity;
+  }
+
+  int i = listing->count - 1;
+  int j = batch_count - 1;
+  int k = needed - 1;
+  while (j >= 0) {
+    if (i >= 0 && CompareFileEntries(&listing->entries[i], &batch[j]) > 0) {
+      listing->entries[k--] = listing->entries[i--];
+    } else {
+      listing->entries[k--] = batch[j--];
+    }
+  }
+  listing->count = needed;
+}
+
+// Copies a name into the listing's arena. Returns NULL if out of memory.
+static const char* ListingAddName(DirListing* listing, const char* name) {
+  size_t len = strlen(name) + 1;
+  NameBlock* block = listing->names;
+
+  if (block == NULL || block->used + len > block->capacity) {
+    size_t capacity = (len > NAME_BLOCK_SIZE) ? len : NAME_BLOCK_SIZE;
+    NameBlock* new_block = (NameBlock*)malloc(sizeof(NameBlock) + capacity);
+    if (new_block == NULL) return NULL;
+    new_block->next = block;
+    new_block->used = 0;
+    new_block->capacity = capacity;
+    listing->names = new_block;
+    block = new_block;
+  }
+
+  char* dest = block->data + block->used;
+  memcpy(dest, name, len);
+  block->used += len;
+  return dest;
+}
+
+// Adds ".." to an empty listing, unless the path is a root
+static void ListingAddParentEntry(DirListing* listing, const char* path) {
+  // This handles Windows drive roots (e.g., C:\) correctly as their parent is themselves
+  // and POSIX root (/) parent is itself.
+  char temp_parent_path[MAX_PATH_LENGTH];
+  GetParentPath(temp_parent_path, path);
+  if (strcmp(temp_parent_path, path) != 0) { // If parent is different, add ".."
+    FileEntry parent = { ListingAddName(listing, ".."), true, false, PLUGIN_UNCHECKED };
+    if (parent.name != NULL) {
+      MergeIntoListing(listing, &parent, 1);
+    }
+  }
+}
+
+// Frees a listing's entries and names
+static void FreeListing(DirListing* listing) {
+  free(listing->entries);
+  NameBlock* block = listing->names;
+  while (block != NULL) {
+    NameBlock* next = block->next;
+    free(block);
+    block = next;
+  }
+  memset(listing, 0, sizeof(*listing));
+}
+
+// Finds the cache slot for a path, or picks one to reuse (empty first, then least recently used)
+static DirCacheSlot* AcquireCacheSlot(const char* path) {
+  DirCacheSlot* free_slot = NULL;
+  DirCacheSlot* lru_slot = &dir_cache[0];
+
+  for (int i = 0; i < DIR_CACHE_SLOTS; ++i) {
+    DirCacheSlot* slot = &dir_cache[i];
+    if (slot->in_use && strcmp(slot->path, path) == 0) return slot;
+    if (!slot->in_use && free_slot == NULL) free_slot = slot;
+    if (slot->last_used < lru_slot->last_used) lru_slot = slot;
+  }
+
+  DirCacheSlot* slot = (free_slot != NULL) ? free_slot : lru_slot;
+  FreeListing(&slot->listing);
+  slot->in_use = false;
+  slot->complete = false;
+  return slot;
 }
 
 // Comparison function for qsort to sort file entries
@@ -342,18 +1082,46 @@ static void DrawFileManager() {
   TR_DrawRectangleLines(start_x, start_y, ui_width, ui_height, RAYWHITE, BLANK);
   TR_DrawText(" Dynamic Library Loader ", start_x + (ui_width - strlen(" Dynamic Library Loader ")) / 2, start_y, 10, GREEN, DARKGRAY);
 
-  // Draw current path
-  char path_display[MAX_PATH_LENGTH + 20];
-  snprintf(path_display, sizeof(path_display), "Path: %s", current_path);
+  // Draw current path (and scan progress while the scanner is still running)
+  DirListing* listing = &current_dir->listing;
+  char path_display[MAX_PATH_LENGTH + 64];
+  if (current_scan != NULL) {
+    snprintf(path_display, sizeof(path_display), "Path: %s (scanning... %d entries)", current_path, listing->count);
+  } else {
+    snprintf(path_display, sizeof(path_display), "Path: %s", current_path);
+  }
   TR_DrawText(path_display, start_x + 2, start_y + 2, 10, LIGHTGRAY, DARKGRAY);
   TR_DrawRectangle(start_x + 1, start_y + 3, ui_width - 2, 1, DARKGRAY, DARKGRAY); // Separator line
 
+  int visible_count = GetVisibleEntryCount();
+  if (filter_active) {
+    char filter_display[FILTER_MAX_QUERY + 64];
+    snprintf(filter_display, sizeof(filter_display), "Filter: /%s_  (%d of %d)", filter_query, visible_count, listing->count);
+    TR_DrawText(filter_display, start_x + 2, start_y + 4, 10, YELLOW, DARKGRAY);
+  }
+
+  // The loaded libraries panel grows with its table, but always leaves room for 5 list entries
+  int panel_rows = (num_loaded_libs > 0) ? num_loaded_libs + 1 : 2;
+  if (panel_rows > ui_height - 13) panel_rows = ui_height - 13;
+  int loaded_libs_start_y = start_y + ui_height - 3 - panel_rows;
+
   // Draw file entries
   int list_start_y = start_y + 5;
-  int max_list_items = ui_height - 10; // Reserve space for header, path, loaded libs, footer
+  int max_list_items = loaded_libs_start_y - 1 - list_start_y; // Space between the header and the loaded libs panel
 
-  for (int i = 0; i < num_dir_entries && i < max_list_items; ++i) {
-    int draw_y = list_start_y + i;
+  // The preview pane takes the right part of the list area when there's room for it
+  int preview_width = (ui_width >= PREVIEW_MIN_UI_WIDTH) ? ui_width * 2 / 5 : 0;
+  int available_text_width = ui_width - 4 - preview_width; // 2 for prefix/padding, 2 for right padding
+
+  // Scroll so the selected entry stays visible
+  if (selected_entry_index < list_scroll_offset) list_scroll_offset = selected_entry_index;
+  if (selected_entry_index >= list_scroll_offset + max_list_items) list_scroll_offset = selected_entry_index - max_list_items + 1;
+  if (list_scroll_offset < 0) list_scroll_offset = 0;
+
+  for (int row = 0; row < max_list_items && list_scroll_offset + row < visible_count; ++row) {
+    int i = list_scroll_offset + row;
+    const FileEntry* entry = GetVisibleEntry(i);
+    int draw_y = list_start_y + row;
     Color fg_color = LIGHTGRAY;
     Color bg_color = DARKGRAY;
     char prefix = ' ';
@@ -363,19 +1131,26 @@ static void DrawFileManager() {
       bg_color = BLUE;
     }
 
-    if (current_dir_entries[i].is_directory) {
+    if (entry->is_directory) {
       fg_color = CYAN; // Directories in Cyan
       prefix = '/';
-    } else if (current_dir_entries[i].is_loadable_lib) {
-      fg_color = LIME; // Loadable libraries in Lime Green
-      prefix = '*';
+    } else if (entry->is_loadable_lib) {
+      if (entry->plugin_state == PLUGIN_NO_ENTRY) {
+        fg_color = GRAY; // Shared object without the plugin entry point
+        prefix = '-';
+      } else if (entry->plugin_state == PLUGIN_INVALID) {
+        fg_color = RED; // Not a shared object we could load
+        prefix = '!';
+      } else {
+        fg_color = LIME; // Loadable libraries in Lime Green
+        prefix = '*';
+      }
     }
 
-    char entry_text[MAX_PATH_LENGTH + 5];
+    char entry_text[MAX_NAME_LENGTH + 5];
     // Ensure text does not exceed available width
-    snprintf(entry_text, sizeof(entry_text), "%c %s", prefix, current_dir_entries[i].name);
+    snprintf(entry_text, sizeof(entry_text), "%c %s", prefix, entry->name);
     int entry_text_len = strlen(entry_text);
-    int available_text_width = ui_width - 4; // 2 for prefix/padding, 2 for right padding
     if (entry_text_len > available_text_width) {
       entry_text[available_text_width - 3] = '.'; // Truncate and add ellipsis
       entry_text[available_text_width - 2] = '.';
@@ -383,84 +1158,1006 @@ static void DrawFileManager() {
       entry_text[available_text_width] = '\0';
     }
     TR_DrawText(entry_text, start_x + 2, draw_y, 10, fg_color, bg_color);
+
+    // Highlight the characters matched by the filter query
+    if (filter_active && filter_query_len > 0) {
+      const char* lower_name = filter_index.text + filter_index.offsets[filter_ranked[i]];
+      int name_len = (int)strlen(lower_name);
+      int pos = 0;
+      for (int q = 0; q < filter_query_len; ++q) {
+        const char* hit = (const char*)memchr(lower_name + pos, filter_query[q], name_len - pos);
+        if (hit == NULL) break;
+        pos = (int)(hit - lower_name);
+        if (pos + 2 >= available_text_width - 3) break; // Inside the ellipsis
+        char matched[2] = { entry->name[pos], '\0' };
+        TR_DrawText(matched, start_x + 4 + pos, draw_y, 10, GOLD, bg_color);
+        pos++;
+      }
+    }
+  }
+
+  if (preview_width > 0) {
+    DrawPluginPreview(start_x + ui_width - preview_width - 2, list_start_y - 1, preview_width, max_list_items);
   }
 
-  // Calculate position for loaded libraries section based on dynamic height
-  int loaded_libs_start_y = start_y + ui_height - 5;
-  // Draw loaded libraries section
+  // Draw loaded libraries section: one row per library with the statistics of its last run
   TR_DrawRectangle(start_x + 1, loaded_libs_start_y - 1, ui_width - 2, 1, DARKGRAY, DARKGRAY); // Separator
   TR_DrawText("Loaded Libraries:", start_x + 2, loaded_libs_start_y, 10, RAYWHITE, DARKGRAY);
+  if (run_history_count > 0) {
+    TR_DrawText("(>: export runs to CSV)", start_x + 20, loaded_libs_start_y, 10, GRAY, DARKGRAY);
+  }
 
-  for (int i = 0; i < MAX_LIBS; ++i) {
+  int available_lib_info_width = ui_width - 4;
+  const int STATS_COLUMNS_WIDTH = 65; // Everything after the library name
+  int name_width = available_lib_info_width - 4 - STATS_COLUMNS_WIDTH;
+  if (name_width < 12) name_width = 12;
+  if (num_loaded_libs > 0) {
+    char header[MAX_PATH_LENGTH + 128];
+    snprintf(header, sizeof(header), "    %-*s %4s %10s %10s %9s %8s %8s %8s", name_width, "Library",
+             "Runs", "Wall ms", "CPU ms", "+RSS KB", "Frames", "Avg ms", "Max ms");
+    header[available_lib_info_width] = '\0';
+    TR_DrawText(header, start_x + 2, loaded_libs_start_y + 1, 10, LIGHTGRAY, DARKGRAY);
+  }
+
+  int row = 0;
+  for (int i = 0; i < MAX_LIBS && row < panel_rows - 1; ++i) {
     if (loaded_libs[i].is_loaded) {
-      char lib_info[MAX_PATH_LENGTH + 50];
-      snprintf(lib_info, sizeof(lib_info), "[%c] %s", loaded_libs[i].hotkey, loaded_libs[i].name);
+      const LoadedLibrary* lib = &loaded_libs[i];
+      const PluginIndexEntry* known = FindIndexEntry(lib->name);
+      const char* base_name = strrchr(lib->name, PATH_SEP);
+      base_name = (base_name != NULL) ? base_name + 1 : lib->name;
+
+      char lib_name[MAX_PATH_LENGTH + 16];
+      int lib_name_length = snprintf(lib_name, sizeof(lib_name), "%s%s", base_name, (known != NULL && known->favorite) ? " (fav)" : "");
+      if (lib_name_length > name_width) {
+        strcpy(lib_name + name_width - 3, "..."); // Truncate and add ellipsis
+      }
+
+      char lib_info[MAX_PATH_LENGTH + 128];
+      if (lib->runs == 0) {
+        snprintf(lib_info, sizeof(lib_info), "[%c] %-*s %4d %10s %10s %9s %8s %8s %8s", lib->hotkey, name_width, lib_name,
+                 0, "-", "-", "-", "-", "-", "-");
+      } else if (!lib->last_run.has_frame_stats) {
+        snprintf(lib_info, sizeof(lib_info), "[%c] %-*s %4d %10.1f %10.1f %+9lld %8s %8s %8s", lib->hotkey, name_width, lib_name,
+                 lib->runs, lib->last_run.wall_ms, lib->last_run.cpu_ms, lib->last_run.peak_rss_delta_kb, "-", "-", "-");
+      } else {
+        snprintf(lib_info, sizeof(lib_info), "[%c] %-*s %4d %10.1f %10.1f %+9lld %8llu %8.2f %8.2f", lib->hotkey, name_width, lib_name,
+                 lib->runs, lib->last_run.wall_ms, lib->last_run.cpu_ms, lib->last_run.peak_rss_delta_kb,
+                 lib->last_run.frames, lib->last_run.avg_frame_ms, lib->last_run.max_frame_ms);
+      }
       int lib_info_len = strlen(lib_info);
-      int available_lib_info_width = ui_width - 4;
       if (lib_info_len > available_lib_info_width) {
         lib_info[available_lib_info_width - 3] = '.';
         lib_info[available_lib_info_width - 2] = '.';
         lib_info[available_lib_info_width - 1] = '.';
         lib_info[available_lib_info_width] = '\0';
       }
-      TR_DrawText(lib_info, start_x + 2, loaded_libs_start_y + 1 + i, 10, GOLD, DARKGRAY);
+      TR_DrawText(lib_info, start_x + 2, loaded_libs_start_y + 2 + row, 10, GOLD, DARKGRAY);
+      row++;
     }
   }
 
   // Draw instructions based on dynamic height
-  TR_DrawText("Arrows: Navigate | Enter: Open/Load | Backspace: Up | Hotkey: Run | Q/ESC: Quit",
+  TR_DrawText("Arrows: Move | Enter: Open/Load | Bksp: Up | /: Filter | *: Favorite | Hotkey: Run | Q: Quit",
         start_x + 2, start_y + ui_height - 2, 10, WHITE, DARKGRAY);
 }
 
 
-// --- Dynamic Library Loader Functions ---
+// --- Fuzzy Filter Functions ---
 
-// Loads a dynamic library from the specified path
-static void LoadDynamicLibrary(const char* path) {
-  if (num_loaded_libs >= MAX_LIBS) {
-    DisplayMessage("Max loaded libraries reached!", RED, 1500);
+// Handles a key while the filter is active. Returns true if the key was consumed.
+// Arrows and Enter are left to the normal handling so they work on the filtered list.
+static bool HandleFilterKey(int key) {
+  if (key == TR_KEY_ESCAPE) {
+    ClearFilter();
+    return true;
+  }
+  if (key == TR_KEY_BACKSPACE || key == TR_KEY_DELETE) {
+    if (filter_query_len == 0) {
+      ClearFilter(); // Backspace on an empty query leaves filter mode
+    } else {
+      FilterPopChar();
+    }
+    return true;
+  }
+  if (key >= 32 && key <= 126) {
+    FilterPushChar((char)key);
+    return true;
+  }
+  return false;
+}
+
+// Rebuilds the lowercase name index from the current listing
+static void BuildFilterIndex() {
+  DirListing* listing = &current_dir->listing;
+  FilterIndex* index = &filter_index;
+  index->count = 0;
+
+  size_t total = 0;
+  for (int i = 0; i < listing->count; ++i) total += strlen(listing->entries[i].name) + 1;
+
+  if (total > index->text_capacity) {
+    char* text = (char*)realloc(index->text, total);
+    unsigned char* word_starts = (unsigned char*)realloc(index->word_starts, total);
+    if (text != NULL) index->text = text;
+    if (word_starts != NULL) index->word_starts = word_starts;
+    if (text == NULL || word_starts == NULL) return;
+    index->text_capacity = total;
+  }
+  if (listing->count + 1 > index->offsets_capacity) {
+    int* offsets = (int*)realloc(index->offsets, sizeof(int) * (listing->count + 1));
+    if (offsets == NULL) return;
+    index->offsets = offsets;
+    index->offsets_capacity = listing->count + 1;
+  }
+
+  size_t pos = 0;
+  for (int i = 0; i < listing->count; ++i) {
+    const char* name = listing->entries[i].name;
+    index->offsets[i] = (int)pos;
+    unsigned char prev = '\0';
+    for (int j = 0; name[j] != '\0'; ++j) {
+      unsigned char c = (unsigned char)name[j];
+      bool upper = (c >= 'A' && c <= 'Z');
+      index->text[pos] = (char)(upper ? c + ('a' - 'A') : c);
+      index->word_starts[pos] = (j == 0 || prev == '.' || prev == '_' || prev == '-' || prev == ' ' ||
+                                 (upper && prev >= 'a' && prev <= 'z'));
+      prev = c;
+      pos++;
+    }
+    index->text[pos] = '\0';
+    index->word_starts[pos] = 0;
+    pos++;
+  }
+  index->offsets[listing->count] = (int)pos;
+  index->count = listing->count;
+}
+
+// Continues a match with the next (lowercase) query character.
+// Returns false if the entry has no occurrence of it after the previous match.
+static bool FilterMatchChar(FilterMatch* match, char c, bool first) {
+  int start = filter_index.offsets[match->entry];
+  int name_len = filter_index.offsets[match->entry + 1] - start - 1;
+  const char* name = filter_index.text + start;
+  const char* hit = (const char*)memchr(name + match->next_pos, c, name_len - match->next_pos);
+  if (hit == NULL) return false;
+
+  int pos = (int)(hit - name);
+  int score = FILTER_SCORE_MATCH;
+
+  if (!first && pos == match->next_pos) {
+    if (match->run < FILTER_MAX_RUN_BONUS) match->run++;
+    score += FILTER_BONUS_CONSECUTIVE * match->run;
+  } else {
+    int gap = pos - match->next_pos;
+    match->run = 0;
+    score -= (gap < FILTER_MAX_GAP_PENALTY) ? gap : FILTER_MAX_GAP_PENALTY;
+  }
+
+  // Word starts rank higher: "ls" should prefer "lib_loader.so" over "tools.so"
+  if (filter_index.word_starts[start + pos]) score += FILTER_BONUS_BOUNDARY;
+
+  match->score += score;
+  match->next_pos = (unsigned short)(pos + 1);
+  return true;
+}
+
+// Makes sure a level can hold the given number of matches
+static bool ReserveFilterLevel(FilterLevel* level, int count) {
+  if (count <= level->capacity) return true;
+  FilterMatch* grown = (FilterMatch*)realloc(level->matches, sizeof(FilterMatch) * count);
+  if (grown == NULL) {
+    level->count = 0;
+    return false;
+  }
+  level->matches = grown;
+  level->capacity = count;
+  return true;
+}
+
+// Computes filter_levels[level] by narrowing the previous level with query character level-1
+static void FilterExtend(int level) {
+  FilterLevel* dest = &filter_levels[level];
+  char c = filter_query[level - 1];
+  int count = 0;
+
+  if (level == 1) {
+    // First character: sweep the whole index with memchr, jumping from hit to hit
+    dest->count = 0;
+    if (filter_index.count == 0 || !ReserveFilterLevel(dest, filter_index.count)) return;
+    const char* text = filter_index.text;
+    const char* end = text + filter_index.offsets[filter_index.count];
+    const char* p = text;
+    int entry = 0;
+    while (p < end && (p = (const char*)memchr(p, c, end - p)) != NULL) {
+      int offset = (int)(p - text);
+      while (filter_index.offsets[entry + 1] <= offset) entry++;
+      // Same scoring as FilterMatchChar, without searching the name a second time
+      int start = filter_index.offsets[entry];
+      int pos = offset - start;
+      int name_len = filter_index.offsets[entry + 1] - start - 1;
+      int score = FILTER_SCORE_MATCH - ((pos < FILTER_MAX_GAP_PENALTY) ? pos : FILTER_MAX_GAP_PENALTY);
+      if (filter_index.word_starts[offset]) score += FILTER_BONUS_BOUNDARY;
+      dest->matches[count++] = (FilterMatch){ entry, (unsigned short)(pos + 1), (short)score, 0, (unsigned char)(name_len >> 3) };
+      p = text + filter_index.offsets[entry + 1]; // Next entry
+    }
+  } else {
+    FilterLevel* src = &filter_levels[level - 1];
+    if (!ReserveFilterLevel(dest, src->count)) return;
+    for (int i = 0; i < src->count; ++i) {
+      FilterMatch match = src->matches[i];
+      if (FilterMatchChar(&match, c, false)) {
+        dest->matches[count++] = match;
+      }
+    }
+  }
+  dest->count = count;
+}
+
+// Bucket of a match in the ranking. Among equal matches, shorter names win.
+static int FilterRankBucket(const FilterMatch* match) {
+  int rank = match->score - match->length_penalty + FILTER_SCORE_OFFSET;
+  if (rank < 0) rank = 0;
+  if (rank >= FILTER_SCORE_BUCKETS) rank = FILTER_SCORE_BUCKETS - 1;
+  return rank;
+}
+
+// Orders the matches of the current query best first. Ranks are small integers,
+// so a counting sort does this in linear time. It is stable, so equal ranks keep
+// the listing order (directories first, then alphabetical).
+static void FilterRank() {
+  static int bucket_starts[FILTER_SCORE_BUCKETS];
+  FilterLevel* level = &filter_levels[filter_query_len];
+
+  if (level->count > filter_ranked_capacity) {
+    int* grown = (int*)realloc(filter_ranked, sizeof(int) * level->count);
+    if (grown == NULL) {
+      level->count = 0;
+      return;
+    }
+    filter_ranked = grown;
+    filter_ranked_capacity = level->count;
+  }
+
+  memset(bucket_starts, 0, sizeof(bucket_starts));
+  for (int i = 0; i < level->count; ++i) {
+    bucket_starts[FilterRankBucket(&level->matches[i])]++;
+  }
+
+  // Turn counts into start offsets, highest rank first
+  int offset = 0;
+  for (int b = FILTER_SCORE_BUCKETS - 1; b >= 0; --b) {
+    int n = bucket_starts[b];
+    bucket_starts[b] = offset;
+    offset += n;
+  }
+
+  for (int i = 0; i < level->count; ++i) {
+    filter_ranked[bucket_starts[FilterRankBucket(&level->matches[i])]++] = level->matches[i].entry;
+  }
+}
+
+// Appends a character to the query and narrows the matches
+static void FilterPushChar(char c) {
+  if (filter_query_len >= FILTER_MAX_QUERY) return;
+  filter_query[filter_query_len++] = (char)tolower((unsigned char)c);
+  filter_query[filter_query_len] = '\0';
+  FilterExtend(filter_query_len);
+  FilterRank();
+  selected_entry_index = 0; // Jump to the best match
+  list_scroll_offset = 0;
+}
+
+// Removes the last query character; the shorter query's matches are still at hand
+static void FilterPopChar() {
+  if (filter_query_len == 0) return;
+  filter_query[--filter_query_len] = '\0';
+  if (filter_query_len > 0) FilterRank();
+  selected_entry_index = 0;
+  list_scroll_offset = 0;
+}
+
+// Leaves filter mode and shows the whole listing again
+static void ClearFilter() {
+  if (filter_active) {
+    selected_entry_index = 0;
+    list_scroll_offset = 0;
+  }
+  filter_active = false;
+  filter_query_len = 0;
+  filter_query[0] = '\0';
+}
+
+// Recomputes the name index and every query level after the listing has changed
+static void RebuildFilter() {
+  BuildFilterIndex();
+
+  // Grow (and touch) the first level and the ranking up front, so the first
+  // keystroke on a big directory doesn't pay for fresh pages
+  FilterLevel* first = &filter_levels[1];
+  if (first->capacity < filter_index.count && ReserveFilterLevel(first, filter_index.count)) {
+    memset(first->matches, 0, sizeof(FilterMatch) * first->capacity);
+  }
+  if (filter_ranked_capacity < filter_index.count) {
+    int* grown = (int*)realloc(filter_ranked, sizeof(int) * filter_index.count);
+    if (grown != NULL) {
+      filter_ranked = grown;
+      filter_ranked_capacity = filter_index.count;
+      memset(filter_ranked, 0, sizeof(int) * filter_ranked_capacity);
+    }
+  }
+
+  for (int level = 1; level <= filter_query_len; ++level) {
+    FilterExtend(level);
+  }
+  if (filter_query_len > 0) FilterRank();
+}
+
+// Number of entries shown in the file list (all entries, or the filter matches)
+static int GetVisibleEntryCount() {
+  if (filter_active && filter_query_len > 0) return filter_levels[filter_query_len].count;
+  return current_dir->listing.count;
+}
+
+// Gets the entry shown at a position in the file list
+static FileEntry* GetVisibleEntry(int index) {
+  if (filter_active && filter_query_len > 0) return &current_dir->listing.entries[filter_ranked[index]];
+  return &current_dir->listing.entries[index];
+}
+
+
+// --- Library Inspection Functions ---
+
+#ifdef HAVE_ELF_INSPECTION
+// A mapped ELF64 file and the dynamic-linking tables found in it.
+// Every table has been bounds-checked against the mapping before use.
+typedef struct {
+  const unsigned char* data;
+  size_t size;
+  const Elf64_Shdr* sections;
+  int num_sections;
+  const Elf64_Sym* symbols; // .dynsym
+  size_t num_symbols;
+  const char* strings;      // .dynstr
+  size_t strings_size;
+  const uint32_t* gnu_hash; // .gnu.hash (NULL if absent)
+  size_t gnu_hash_words;
+  const Elf64_Dyn* dynamic; // .dynamic (NULL if absent)
+  size_t num_dynamic;
+} ElfImage;
+
+// Checks that [offset, offset + length) lies inside the mapping
+static bool ElfRangeOk(const ElfImage* image, uint64_t offset, uint64_t length) {
+  return offset <= image->size && length <= image->size - offset;
+}
+
+// Returns a name from .dynstr, or NULL if the offset is out of range or unterminated
+static const char* ElfString(const ElfImage* image, uint64_t offset) {
+  if (offset >= image->strings_size) return NULL;
+  if (memchr(image->strings + offset, '\0', image->strings_size - offset) == NULL) return NULL;
+  return image->strings + offset;
+}
+
+// True if a dynamic symbol is defined in this file and visible to dlsym
+static bool ElfSymbolExported(const Elf64_Sym* symbol) {
+  int binding = ELF64_ST_BIND(symbol->st_info);
+  return symbol->st_shndx != SHN_UNDEF &&
+         (binding == STB_GLOBAL || binding == STB_WEAK) &&
+         ELF64_ST_VISIBILITY(symbol->st_other) == STV_DEFAULT;
+}
+
+// The hash function used by .gnu.hash (DJB hash)
+static uint32_t ElfGnuHash(const char* name) {
+  uint32_t hash = 5381;
+  for (const unsigned char* c = (const unsigned char*)name; *c != '\0'; ++c) {
+    hash = (hash << 5) + hash + *c;
+  }
+  return hash;
+}
+
+// Looks up an exported symbol by name. Uses the .gnu.hash bloom filter and
+// bucket chain when present, so a miss usually costs a single bloom word test.
+static const Elf64_Sym* ElfFindSymbol(const ElfImage* image, const char* name) {
+  if (image->gnu_hash == NULL) {
+    // No GNU hash table: fall back to a linear scan of .dynsym
+    for (size_t i = 1; i < image->num_symbols; ++i) {
+      const char* symbol_name = ElfString(image, image->symbols[i].st_name);
+      if (symbol_name != NULL && strcmp(symbol_name, name) == 0 && ElfSymbolExported(&image->symbols[i])) {
+        return &image->symbols[i];
+      }
+    }
+    return NULL;
+  }
+
+  // Layout: nbuckets, symoffset, bloom_size, bloom_shift, bloom[bloom_size] (64-bit), buckets[nbuckets], chain[]
+  const uint32_t* table = image->gnu_hash;
+  uint32_t num_buckets = table[0];
+  uint32_t sym_offset = table[1];
+  uint32_t bloom_size = table[2];
+  uint32_t bloom_shift = table[3];
+  if (num_buckets == 0 || bloom_size == 0 || bloom_shift >= 32) return NULL;
+  size_t buckets_start = 4 + (size_t)bloom_size * 2;
+  size_t chain_start = buckets_start + num_buckets;
+  if (chain_start > image->gnu_hash_words) return NULL;
+
+  uint32_t hash = ElfGnuHash(name);
+  uint64_t bloom_word;
+  memcpy(&bloom_word, &table[4 + ((hash / 64) % bloom_size) * 2], sizeof(bloom_word));
+  uint64_t bloom_mask = (1ULL << (hash % 64)) | (1ULL << ((hash >> bloom_shift) % 64));
+  if ((bloom_word & bloom_mask) != bloom_mask) return NULL; // Definitely not exported
+
+  uint32_t index = table[buckets_start + hash % num_buckets];
+  if (index < sym_offset) return NULL; // Empty bucket
+  for (; index < image->num_symbols; ++index) {
+    size_t chain_index = chain_start + (index - sym_offset);
+    if (chain_index >= image->gnu_hash_words) return NULL;
+    uint32_t chain_hash = table[chain_index];
+    if ((chain_hash | 1) == (hash | 1)) {
+      const char* symbol_name = ElfString(image, image->symbols[index].st_name);
+      if (symbol_name != NULL && strcmp(symbol_name, name) == 0 && ElfSymbolExported(&image->symbols[index])) {
+        return &image->symbols[index];
+      }
+    }
+    if (chain_hash & 1) break; // Last symbol in this bucket
+  }
+  return NULL;
+}
+
+// Reads the int a data symbol points at. Returns false if it lives outside the file (e.g. .bss).
+static bool ElfReadSymbolInt(const ElfImage* image, const Elf64_Sym* symbol, int* value) {
+  if (symbol->st_shndx >= image->num_sections || symbol->st_size < sizeof(int32_t)) return false;
+  const Elf64_Shdr* section = &image->sections[symbol->st_shndx];
+  if (section->sh_type == SHT_NOBITS || symbol->st_value < section->sh_addr) return false;
+  uint64_t offset = section->sh_offset + (symbol->st_value - section->sh_addr);
+  if (!ElfRangeOk(image, offset, sizeof(int32_t))) return false;
+  int32_t raw;
+  memcpy(&raw, image->data + offset, sizeof(raw));
+  *value = (int)raw;
+  return true;
+}
+
+// Finds .dynsym, .dynstr, .gnu.hash and .dynamic through the section headers.
+// Returns an error message, or NULL on success.
+static const char* ElfOpenImage(ElfImage* image) {
+  if (image->size < sizeof(Elf64_Ehdr)) return "File too small for an ELF header";
+  const Elf64_Ehdr* header = (const Elf64_Ehdr*)image->data;
+  if (memcmp(header->e_ident, ELFMAG, SELFMAG) != 0) return "Not an ELF file";
+  if (header->e_ident[EI_CLASS] != ELFCLASS64) return "Not a 64-bit ELF file";
+  #if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    if (header->e_ident[EI_DATA] != ELFDATA2LSB) return "Wrong byte order for this machine";
+  #else
+    if (header->e_ident[EI_DATA] != ELFDATA2MSB) return "Wrong byte order for this machine";
+  #endif
+  if (header->e_type != ET_DYN) return "Not a shared object";
+  if (header->e_shentsize != sizeof(Elf64_Shdr) || header->e_shnum == 0) return "No section headers";
+  if (!ElfRangeOk(image, header->e_shoff, (uint64_t)header->e_shnum * sizeof(Elf64_Shdr))) return "Section headers out of range";
+  if (header->e_shoff % _Alignof(Elf64_Shdr) != 0) return "Misaligned section headers";
+
+  image->sections = (const Elf64_Shdr*)(image->data + header->e_shoff);
+  image->num_sections = header->e_shnum;
+
+  for (int i = 0; i < image->num_sections; ++i) {
+    const Elf64_Shdr* section = &image->sections[i];
+    if (section->sh_type != SHT_DYNSYM && section->sh_type != SHT_GNU_HASH && section->sh_type != SHT_DYNAMIC) continue;
+    if (!ElfRangeOk(image, section->sh_offset, section->sh_size) || section->sh_offset % 8 != 0) continue;
+    const void* contents = image->data + section->sh_offset;
+
+    if (section->sh_type == SHT_DYNSYM && section->sh_link < (Elf64_Word)image->num_sections) {
+      const Elf64_Shdr* strtab = &image->sections[section->sh_link];
+      if (!ElfRangeOk(image, strtab->sh_offset, strtab->sh_size)) continue;
+      image->symbols = (const Elf64_Sym*)contents;
+      image->num_symbols = section->sh_size / sizeof(Elf64_Sym);
+      image->strings = (const char*)(image->data + strtab->sh_offset);
+      image->strings_size = strtab->sh_size;
+    } else if (section->sh_type == SHT_GNU_HASH && section->sh_size >= 4 * sizeof(uint32_t)) {
+      image->gnu_hash = (const uint32_t*)contents;
+      image->gnu_hash_words = section->sh_size / sizeof(uint32_t);
+    } else if (section->sh_type == SHT_DYNAMIC) {
+      image->dynamic = (const Elf64_Dyn*)contents;
+      image->num_dynamic = section->sh_size / sizeof(Elf64_Dyn);
+    }
+  }
+
+  if (image->symbols == NULL) return "No dynamic symbol table";
+  return NULL;
+}
+
+// Fills in the preview details: ABI version, entry points, export count and DT_NEEDED dependencies
+static void ElfCollectDetails(const ElfImage* image, LibraryInfo* info) {
+  const Elf64_Sym* abi_symbol = ElfFindSymbol(image, ABI_VERSION_SYMBOL);
+  if (abi_symbol != NULL && !ElfReadSymbolInt(image, abi_symbol, &info->abi_version)) {
+    info->abi_version = -1;
+  }
+
+  size_t prefix_len = strlen(PLUGIN_ENTRY_PREFIX);
+  for (size_t i = 1; i < image->num_symbols; ++i) {
+    const Elf64_Sym* symbol = &image->symbols[i];
+    if (!ElfSymbolExported(symbol)) continue;
+    info->num_exports++;
+    const char* name = ElfString(image, symbol->st_name);
+    // The stats hook shares the prefix but isn't something to run
+    if (name != NULL && ELF64_ST_TYPE(symbol->st_info) == STT_FUNC && strncmp(name, PLUGIN_ENTRY_PREFIX, prefix_len) == 0 &&
+        strcmp(name, STATS_FUNCTION_NAME) != 0 && info->num_entry_points < ELF_MAX_ENTRY_POINTS) {
+      snprintf(info->entry_points[info->num_entry_points++], ELF_NAME_LENGTH, "%s", name);
+    }
+  }
+
+  for (size_t i = 0; image->dynamic != NULL && i < image->num_dynamic; ++i) {
+    if (image->dynamic[i].d_tag == DT_NULL) break;
+    if (image->dynamic[i].d_tag != DT_NEEDED || info->num_needed >= ELF_MAX_NEEDED) continue;
+    const char* name = ElfString(image, image->dynamic[i].d_un.d_val);
+    if (name != NULL) {
+      snprintf(info->needed[info->num_needed++], ELF_NAME_LENGTH, "%s", name);
+    }
+  }
+}
+
+// Inspects a shared library without loading it: the file is mapped read-only and
+// only its dynamic symbol table is read, so no constructors run and no dependencies
+// are mapped. name is relative to dir_fd (or the working directory if dir_fd is -1).
+// A quick inspection only checks for RUN_FUNCTION_NAME; a full one also fills in
+// the ABI version, entry points, export count and dependencies.
+static bool InspectLibraryFile(int dir_fd, const char* name, LibraryInfo* info, bool full) {
+  memset(info, 0, sizeof(*info));
+  info->state = PLUGIN_INVALID;
+  info->abi_version = -1;
+
+  int fd = openat(dir_fd < 0 ? AT_FDCWD : dir_fd, name, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    info->error = "Cannot open file";
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+    close(fd);
+    info->error = "Not a regular file";
+    return false;
+  }
+  info->file_size = (long long)st.st_size;
+  if (st.st_size == 0) {
+    close(fd);
+    info->error = "Empty file";
+    return false;
+  }
+
+  void* mapping = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd); // The mapping keeps the file referenced
+  if (mapping == MAP_FAILED) {
+    info->error = "Cannot map file";
+    return false;
+  }
+
+  ElfImage image = {0};
+  image.data = (const unsigned char*)mapping;
+  image.size = (size_t)st.st_size;
+  info->error = ElfOpenImage(&image);
+  if (info->error == NULL) {
+    info->state = (ElfFindSymbol(&image, RUN_FUNCTION_NAME) != NULL) ? PLUGIN_LOADABLE : PLUGIN_NO_ENTRY;
+    if (full) ElfCollectDetails(&image, info);
+  }
+
+  munmap(mapping, (size_t)st.st_size);
+  return info->error == NULL;
+}
+#else
+// ELF inspection isn't available here (Windows DLLs and macOS dylibs use other formats)
+static bool InspectLibraryFile(int dir_fd, const char* name, LibraryInfo* info, bool full) {
+  (void)dir_fd; (void)name; (void)full;
+  memset(info, 0, sizeof(*info));
+  info->state = PLUGIN_UNCHECKED;
+  info->abi_version = -1;
+  info->file_size = -1;
+  info->error = "Inspection not supported on this platform";
+  return false;
+}
+#endif
+
+// Draws one formatted line of the preview pane, clipped to its width and height
+static void DrawPreviewLine(int x, int* row, int last_row, int width, Color color, const char* format, ...) {
+  if (*row > last_row) return;
+  char line[ELF_NAME_LENGTH + 32];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(line, sizeof(line), format, args);
+  va_end(args);
+  if ((int)strlen(line) > width) line[width > 0 ? width : 0] = '\0';
+  TR_DrawText(line, x, (*row)++, 10, color, DARKGRAY);
+}
+
+// Draws details of the selected library (recomputed when the selection changes)
+static void DrawPluginPreview(int x, int y, int width, int height) {
+  TR_DrawRectangleLines(x, y, width, height, GRAY, BLANK);
+  TR_DrawText(" Preview ", x + 2, y, 10, RAYWHITE, DARKGRAY);
+
+  int visible_count = GetVisibleEntryCount();
+  const FileEntry* entry = (selected_entry_index < visible_count) ? GetVisibleEntry(selected_entry_index) : NULL;
+  if (entry == NULL || !entry->is_loadable_lib) {
+    preview_entry_name = NULL;
+    TR_DrawText("Select a library", x + 2, y + 2, 10, GRAY, DARKGRAY);
     return;
   }
+  if (entry->name != preview_entry_name) {
+    InspectLibraryFile(-1, entry->name, &preview_info, true); // current_path is the working directory
+    preview_entry_name = entry->name;
+  }
 
-  // Check if this library is already loaded
-  for (int i = 0; i < num_loaded_libs; ++i) {
-    if (loaded_libs[i].is_loaded && strcmp(loaded_libs[i].name, path) == 0) {
-      DisplayMessage("Library already loaded!", YELLOW, 1000);
+  const LibraryInfo* info = &preview_info;
+  int text_width = width - 4;
+  int row = y + 2;
+  int last_row = y + height - 2;
+
+
+  DrawPreviewLine(x + 2, &row, last_row, text_width, RAYWHITE, "%s", entry->name);
+  if (info->file_size >= 0) {
+    DrawPreviewLine(x + 2, &row, last_row, text_width, LIGHTGRAY, "Size: %.1f KB", info->file_size / 1024.0);
+  }
+  if (info->error != NULL) {
+    DrawPreviewLine(x + 2, &row, last_row, text_width, info->state == PLUGIN_UNCHECKED ? GRAY : RED, "%s", info->error);
+    return;
+  }
+
+  if (info->state == PLUGIN_LOADABLE) {
+    DrawPreviewLine(x + 2, &row, last_row, text_width, LIME, "Plugin: yes");
+  } else {
+    DrawPreviewLine(x + 2, &row, last_row, text_width, ORANGE, "Plugin: no (missing %s)", RUN_FUNCTION_NAME);
+  }
+  if (info->abi_version >= 0) {
+    DrawPreviewLine(x + 2, &row, last_row, text_width, LIGHTGRAY, "ABI version: %d", info->abi_version);
+  } else {
+    DrawPreviewLine(x + 2, &row, last_row, text_width, GRAY, "ABI version: not set");
+  }
+  DrawPreviewLine(x + 2, &row, last_row, text_width, LIGHTGRAY, "Exports: %d symbols", info->num_exports);
+
+  row++;
+  DrawPreviewLine(x + 2, &row, last_row, text_width, RAYWHITE, "Entry points:");
+  if (info->num_entry_points == 0) DrawPreviewLine(x + 2, &row, last_row, text_width, GRAY, "  (none)");
+  for (int i = 0; i < info->num_entry_points; ++i) {
+    DrawPreviewLine(x + 2, &row, last_row, text_width, GOLD, "  %s", info->entry_points[i]);
+  }
+
+  row++;
+  DrawPreviewLine(x + 2, &row, last_row, text_width, RAYWHITE, "Needs:");
+  if (info->num_needed == 0) DrawPreviewLine(x + 2, &row, last_row, text_width, GRAY, "  (nothing)");
+  for (int i = 0; i < info->num_needed; ++i) {
+    DrawPreviewLine(x + 2, &row, last_row, text_width, CYAN, "  %s", info->needed[i]);
+  }
+}
+
+// --- Plugin Index Functions ---
+
+// Gets the path of the index file in the user's home directory. Returns false if there's no home.
+static bool GetPluginIndexPath(char* dest, size_t size) {
+  #ifdef _WIN32
+    const char* home = getenv("USERPROFILE");
+  #else
+    const char* home = getenv("HOME");
+  #endif
+  if (home == NULL || home[0] == '\0') return false;
+  return snprintf(dest, size, "%s%c%s", home, PATH_SEP, PLUGIN_INDEX_FILE) < (int)size;
+}
+
+// Finds the index entry for a library path (NULL if it isn't indexed)
+static PluginIndexEntry* FindIndexEntry(const char* path) {
+  for (int i = 0; i < plugin_index_count; ++i) {
+    if (strcmp(plugin_index[i].path, path) == 0) return &plugin_index[i];
+  }
+  return NULL;
+}
+
+// Splits a comma-separated index field into fixed-size names ("-" means none)
+static int ParseIndexList(char* field, char names[][ELF_NAME_LENGTH], int max_names) {
+  int count = 0;
+  if (strcmp(field, "-") == 0) return 0;
+  for (char* name = strtok(field, ","); name != NULL && count < max_names; name = strtok(NULL, ",")) {
+    snprintf(names[count++], ELF_NAME_LENGTH, "%s", name);
+  }
+  return count;
+}
+
+// Writes names as a comma-separated index field ("-" if there are none)
+static void WriteIndexList(FILE* file, const char names[][ELF_NAME_LENGTH], int count) {
+  if (count == 0) fputc('-', file);
+  for (int i = 0; i < count; ++i) {
+    fprintf(file, "%s%s", i > 0 ? "," : "", names[i]);
+  }
+  fputc('\t', file);
+}
+
+// Reads the index and validates it against the filesystem. Only entries whose
+// mtime or size changed are inspected again; entries whose file is gone are dropped.
+static void LoadPluginIndex() {
+  char index_path[MAX_PATH_LENGTH];
+  if (!GetPluginIndexPath(index_path, sizeof(index_path))) return;
+  FILE* file = fopen(index_path, "r");
+  if (file == NULL) return; // No index yet
+
+  char line[MAX_PATH_LENGTH + ELF_NAME_LENGTH * (ELF_MAX_ENTRY_POINTS + ELF_MAX_NEEDED) + 256];
+  int version = 0;
+  if (fgets(line, sizeof(line), file) == NULL || sscanf(line, "# libloader plugin index v%d", &version) != 1 ||
+      version != PLUGIN_INDEX_VERSION) {
+    fclose(file);
+    plugin_index_dirty = true; // Unknown format, rewrite it on the next save
+    return;
+  }
+
+  while (plugin_index_count < MAX_INDEXED_PLUGINS && fgets(line, sizeof(line), file) != NULL) {
+    line[strcspn(line, "\r\n")] = '\0';
+
+    // hotkey, favorite, last_used, mtime_ns, size, state, abi_version, num_exports, entry_points, needed, path
+    char* fields[11];
+    int num_fields = 0;
+    char* cursor = line;
+    while (num_fields < 10 && cursor != NULL) {
+      fields[num_fields++] = cursor;
+      cursor = strchr(cursor, '\t');
+      if (cursor != NULL) *cursor++ = '\0';
+    }
+    if (num_fields < 10 || cursor == NULL || cursor[0] == '\0') {
+      plugin_index_dirty = true; // Malformed line, drop it
+      continue;
+    }
+    fields[10] = cursor; // The path is last, so it may contain anything but a newline
+
+    PluginIndexEntry* entry = &plugin_index[plugin_index_count];
+    memset(entry, 0, sizeof(*entry));
+    snprintf(entry->path, sizeof(entry->path), "%s", fields[10]);
+    entry->hotkey = (fields[0][0] == '-') ? '\0' : fields[0][0];
+    entry->favorite = atoi(fields[1]) != 0;
+    entry->last_used = strtoll(fields[2], NULL, 10);
+    entry->mtime_ns = strtoll(fields[3], NULL, 10);
+    entry->size = strtoll(fields[4], NULL, 10);
+    int state = atoi(fields[5]);
+    bool stale = (state < PLUGIN_UNCHECKED || state > PLUGIN_INVALID); // Unknown state, so inspect it again
+    entry->info.state = stale ? PLUGIN_UNCHECKED : (PluginState)state;
+    entry->info.abi_version = atoi(fields[6]);
+    entry->info.num_exports = atoi(fields[7]);
+    entry->info.num_entry_points = ParseIndexList(fields[8], entry->info.entry_points, ELF_MAX_ENTRY_POINTS);
+    entry->info.num_needed = ParseIndexList(fields[9], entry->info.needed, ELF_MAX_NEEDED);
+    entry->info.file_size = entry->size;
+
+    long long mtime_ns = 0;
+    long long size = 0;
+    if (!GetPathStat(entry->path, &mtime_ns, &size)) {
+      plugin_index_dirty = true; // The library is gone
+      continue;
+    }
+    if (stale || mtime_ns != entry->mtime_ns || size != entry->size) {
+      // The library was rebuilt: only now is it worth reading its symbols again
+      InspectLibraryFile(-1, entry->path, &entry->info, true);
+      entry->info.error = NULL;
+      entry->mtime_ns = mtime_ns;
+      entry->size = size;
+      plugin_index_dirty = true;
+    }
+    plugin_index_count++;
+  }
+  fclose(file);
+}
+
+// Writes the index if it changed. The file is replaced atomically so a crash never leaves half an index.
+static void SavePluginIndex() {
+  if (!plugin_index_dirty) return;
+  char index_path[MAX_PATH_LENGTH];
+  char temp_path[MAX_PATH_LENGTH + 8];
+  if (!GetPluginIndexPath(index_path, sizeof(index_path))) return;
+  snprintf(temp_path, sizeof(temp_path), "%s.tmp", index_path);
+
+  FILE* file = fopen(temp_path, "w");
+  if (file == NULL) return;
+  fprintf(file, "# libloader plugin index v%d\n", PLUGIN_INDEX_VERSION);
+  for (int i = 0; i < plugin_index_count; ++i) {
+    const PluginIndexEntry* entry = &plugin_index[i];
+    fprintf(file, "%c\t%d\t%lld\t%lld\t%lld\t%d\t%d\t%d\t", entry->hotkey != '\0' ? entry->hotkey : '-', entry->favorite ? 1 : 0,
+            entry->last_used, entry->mtime_ns, entry->size, (int)entry->info.state, entry->info.abi_version, entry->info.num_exports);
+    WriteIndexList(file, entry->info.entry_points, entry->info.num_entry_points);
+    WriteIndexList(file, entry->info.needed, entry->info.num_needed);
+    fprintf(file, "%s\n", entry->path);
+  }
+  bool written = (fflush(file) == 0);
+  written = (fclose(file) == 0) && written;
+
+  if (written) {
+    #ifdef _WIN32
+      remove(index_path); // rename doesn't replace existing files on Windows
+    #endif
+    written = (rename(temp_path, index_path) == 0);
+  }
+  if (!written) {
+    remove(temp_path);
+    return;
+  }
+  plugin_index_dirty = false;
+}
+
+// Records a library in the index (adding it, or refreshing its metadata and hotkey).
+// When the index is full, the least recently loaded non-favorite is replaced.
+// Returns NULL if the library can't be indexed.
+static PluginIndexEntry* RememberPlugin(const char* path, char hotkey) {
+  if (strpbrk(path, "\r\n") != NULL) return NULL; // Can't be stored in the line-based index
+
+  PluginIndexEntry* entry = FindIndexEntry(path);
+  if (entry == NULL) {
+    if (plugin_index_count < MAX_INDEXED_PLUGINS) {
+      entry = &plugin_index[plugin_index_count++];
+    } else {
+      for (int i = 0; i < plugin_index_count; ++i) {
+        if (!plugin_index[i].favorite && (entry == NULL || plugin_index[i].last_used < entry->last_used)) {
+          entry = &plugin_index[i];
+        }
+      }
+      if (entry == NULL) return NULL; // Every indexed plugin is a favorite
+    }
+    memset(entry, 0, sizeof(*entry));
+    snprintf(entry->path, sizeof(entry->path), "%s", path);
+  }
+
+  long long mtime_ns = 0;
+  long long size = 0;
+  GetPathStat(path, &mtime_ns, &size);
+  if (entry->last_used == 0 || mtime_ns != entry->mtime_ns || size != entry->size) {
+    InspectLibraryFile(-1, path, &entry->info, true);
+    entry->info.error = NULL;
+    entry->mtime_ns = mtime_ns;
+    entry->size = size;
+  }
+  if (hotkey != '\0') entry->hotkey = hotkey;
+  entry->last_used = (long long)time(NULL);
+  plugin_index_dirty = true;
+  return entry;
+}
+
+// Marks or unmarks a library as a favorite (favorites are preloaded at startup)
+static void TogglePluginFavorite(const char* path) {
+  PluginIndexEntry* entry = FindIndexEntry(path);
+  if (entry == NULL) {
+    entry = RememberPlugin(path, '\0');
+    if (entry == NULL) {
+      DisplayMessage("Error: Plugin index is full of favorites.", RED, 1500);
       return;
     }
   }
+  if (!entry->favorite && (entry->info.state == PLUGIN_NO_ENTRY || entry->info.state == PLUGIN_INVALID)) {
+    DisplayMessage("Not a plugin: '" RUN_FUNCTION_NAME "' is not exported.", RED, 1500);
+    return;
+  }
+
+  entry->favorite = !entry->favorite;
+  plugin_index_dirty = true;
+  SavePluginIndex();
+  DisplayMessage(entry->favorite ? "Added to favorites (loaded at startup)." : "Removed from favorites.", GREEN, 1000);
+}
+
+// Background thread: opens each favorite so it's ready by the time the UI polls
+static THREAD_FUNC(PreloadFavoritesWorker) {
+  PreloadJob* job = (PreloadJob*)arg;
+  for (int i = 0; i < job->count; ++i) {
+    MUTEX_LOCK(&job->lock);
+    bool cancelled = job->cancelled;
+    MUTEX_UNLOCK(&job->lock);
+    if (cancelled) break;
+
+    PreloadItem* item = &job->items[i];
+    char error[256];
+    if (!OpenPluginLibrary(item->path, &item->handle, &item->run_function, error, sizeof(error))) {
+      item->handle = NULL; // Skipped quietly; it can still be loaded by hand to see the error
+    }
+
+    MUTEX_LOCK(&job->lock);
+    job->completed = i + 1;
+    MUTEX_UNLOCK(&job->lock);
+  }
+  ReleasePreloadJob(job);
+  THREAD_RETURN;
+}
+
+// Starts loading the favorite plugins in the background. Called before the window
+// opens, so the libraries load while the terminal is being set up.
+static void StartFavoritePreload() {
+  PreloadJob* job = (PreloadJob*)calloc(1, sizeof(PreloadJob));
+  if (job == NULL) return;
+  for (int i = 0; i < plugin_index_count && job->count < MAX_LIBS; ++i) {
+    const PluginIndexEntry* entry = &plugin_index[i];
+    if (!entry->favorite || entry->info.state == PLUGIN_NO_ENTRY || entry->info.state == PLUGIN_INVALID) continue;
+    PreloadItem* item = &job->items[job->count];
+    if (snprintf(item->path, sizeof(item->path), "%s", entry->path) >= (int)sizeof(item->path)) continue; // Wouldn't name the same file
+    item->hotkey = entry->hotkey;
+    job->count++;
+  }
+  if (job->count == 0) {
+    free(job);
+    return;
+  }
+
+  MUTEX_INIT(&job->lock);
+  job->refs = 2; // One reference for the UI, one for the preload thread
+  current_preload = job;
+  if (!StartDetachedThread(PreloadFavoritesWorker, job)) {
+    PreloadFavoritesWorker(job); // No thread available: load them now
+  }
+}
+
+// Moves favorites the preload thread has finished opening into loaded_libs
+static void PollFavoritePreload() {
+  if (current_preload == NULL) return;
+  PreloadJob* job = current_preload;
+
+  MUTEX_LOCK(&job->lock);
+  int completed = job->completed;
+  MUTEX_UNLOCK(&job->lock);
+
+  for (; job->adopted < completed; job->adopted++) {
+    PreloadItem* item = &job->items[job->adopted];
+    if (item->handle == NULL) continue;
+    int slot = IsLibraryLoaded(item->path) ? -1 : AddLoadedLibrary(item->path, item->handle, item->run_function, item->hotkey);
+    if (slot == -1) {
+      DLCLOSE(item->handle); // Loaded by hand in the meantime, or no slot left
+      continue;
+    }
+    PluginIndexEntry* entry = FindIndexEntry(item->path);
+    if (entry != NULL && entry->hotkey != loaded_libs[slot].hotkey) {
+      entry->hotkey = loaded_libs[slot].hotkey; // Its old hotkey was taken
+      plugin_index_dirty = true;
+    }
+  }
 
-  lib_handle_t handle = DLOPEN(path);
-  if (handle == NULL) {
+  if (completed == job->count) {
+    ReleasePreloadJob(job);
+    current_preload = NULL;
+  }
+}
+
+// Drops one reference to a preload job. Dropping the UI's reference also cancels it;
+// whoever frees the job closes the libraries the UI never took.
+static void ReleasePreloadJob(PreloadJob* job) {
+  MUTEX_LOCK(&job->lock);
+  job->cancelled = true;
+  int refs = --job->refs;
+  MUTEX_UNLOCK(&job->lock);
+
+  if (refs == 0) {
+    for (int i = job->adopted; i < job->completed; ++i) {
+      if (job->items[i].handle != NULL) DLCLOSE(job->items[i].handle);
+    }
+    MUTEX_DESTROY(&job->lock);
+    free(job);
+  }
+}
+
+// --- Dynamic Library Loader Functions ---
+
+// Opens a library and looks up its run function without touching the UI, so it
+// can also be used by the preload thread. On failure, writes the reason to error.
+static bool OpenPluginLibrary(const char* path, lib_handle_t* handle, void (**run_function)(), char* error, size_t error_size) {
+  *handle = DLOPEN(path);
+  if (*handle == NULL) {
     #ifdef _WIN32
-      char msg[256];
-      snprintf(msg, sizeof(msg), "LoadLibrary failed: Error %lu", GetLastError());
-      DisplayMessage(msg, RED, 2000);
+      snprintf(error, error_size, "LoadLibrary failed: Error %lu", GetLastError());
     #else
       const char* error_msg = dlerror(); // Get the error message
-      if (error_msg == NULL) error_msg = "Unknown dlopen error"; // Fallback
-      DisplayMessage(error_msg, RED, 2000);
+      snprintf(error, error_size, "%s", error_msg != NULL ? error_msg : "Unknown dlopen error");
     #endif
-    return;
+    return false;
   }
 
   // Cast to (void*) to silence compiler warnings before casting to function pointer
-  void (*run_func)() = (void (*)())DLSYM(handle, RUN_FUNCTION_NAME);
-  if (run_func == NULL) {
-    DLCLOSE(handle); // Unload if function not found
+  *run_function = (void (*)())DLSYM(*handle, RUN_FUNCTION_NAME);
+  if (*run_function == NULL) {
     #ifdef _WIN32
-      char msg[256];
-      snprintf(msg, sizeof(msg), "GetProcAddress failed for '%s': Error %lu", RUN_FUNCTION_NAME, GetLastError());
-      DisplayMessage(msg, RED, 2000);
+      snprintf(error, error_size, "GetProcAddress failed for '%s': Error %lu", RUN_FUNCTION_NAME, GetLastError());
     #else
       const char* error_msg = dlerror(); // Get the error message
-      if (error_msg == NULL) error_msg = "Unknown dlsym error"; // Fallback
-      DisplayMessage(error_msg, RED, 2000);
+      snprintf(error, error_size, "%s", error_msg != NULL ? error_msg : "Unknown dlsym error");
     #endif
-    return;
+    DLCLOSE(*handle); // Unload if function not found
+    *handle = NULL;
+    return false;
   }
+  return true;
+}
 
-  // Find an empty slot
+// Stores an opened library in a free slot, using preferred_hotkey if it's still free.
+// Returns the slot, or -1 if every slot is taken.
+static int AddLoadedLibrary(const char* path, lib_handle_t handle, void (*run_function)(), char preferred_hotkey) {
   int slot = -1;
   for (int i = 0; i < MAX_LIBS; ++i) {
     if (!loaded_libs[i].is_loaded) {
@@ -468,23 +2165,61 @@ static void LoadDynamicLibrary(const char* path) {
       break;
     }
   }
+  if (slot == -1) return -1;
 
-  if (slot == -1) { // Should not happen if max_libs check is correct, but as a safeguard
-    DLCLOSE(handle);
-    DisplayMessage("Internal error: No empty slot for library.", RED, 1500);
-    return;
-  }
-
-  // Store library info
   strncpy(loaded_libs[slot].name, path, sizeof(loaded_libs[slot].name) - 1);
   loaded_libs[slot].name[sizeof(loaded_libs[slot].name) - 1] = '\0';
   loaded_libs[slot].handle = handle;
-  loaded_libs[slot].run_function = run_func;
-  loaded_libs[slot].hotkey = GetNextAvailableHotkey();
+  loaded_libs[slot].run_function = run_function;
+  loaded_libs[slot].stats_function = (void (*)(TR_FrameStats*))DLSYM(handle, STATS_FUNCTION_NAME); // Optional
+  loaded_libs[slot].runs = 0;
+  loaded_libs[slot].hotkey = (preferred_hotkey != '\0' && !IsHotkeyInUse(preferred_hotkey)) ? preferred_hotkey : GetNextAvailableHotkey();
   loaded_libs[slot].is_loaded = true;
   num_loaded_libs++;
+  return slot;
+}
+
+// True if a library with this path is already loaded
+static bool IsLibraryLoaded(const char* path) {
+  for (int i = 0; i < MAX_LIBS; ++i) {
+    if (loaded_libs[i].is_loaded && strcmp(loaded_libs[i].name, path) == 0) return true;
+  }
+  return false;
+}
+
+// Loads a dynamic library from the specified path
+static void LoadDynamicLibrary(const char* path) {
+  if (num_loaded_libs >= MAX_LIBS) {
+    DisplayMessage("Max loaded libraries reached!", RED, 1500);
+    return;
+  }
 
-  char msg[256];
+  // Check if this library is already loaded
+  if (IsLibraryLoaded(path)) {
+    DisplayMessage("Library already loaded!", YELLOW, 1000);
+    return;
+  }
+
+  lib_handle_t handle;
+  void (*run_func)();
+  char error[256];
+  if (!OpenPluginLibrary(path, &handle, &run_func, error, sizeof(error))) {
+    DisplayMessage(error, RED, 2000);
+    return;
+  }
+
+  // Reuse the hotkey this plugin had last time, if the index remembers it
+  const PluginIndexEntry* known = FindIndexEntry(path);
+  int slot = AddLoadedLibrary(path, handle, run_func, known != NULL ? known->hotkey : '\0');
+  if (slot == -1) { // Should not happen if max_libs check is correct, but as a safeguard
+    DLCLOSE(handle);
+    DisplayMessage("Internal error: No empty slot for library.", RED, 1500);
+    return;
+  }
+  RememberPlugin(path, loaded_libs[slot].hotkey);
+  SavePluginIndex();
+
+  char msg[MAX_PATH_LENGTH + 64];
   snprintf(msg, sizeof(msg), "Loaded '%s' with hotkey '%c'", path, loaded_libs[slot].hotkey);
   DisplayMessage(msg, GREEN, 2000);
 }
@@ -501,12 +2236,29 @@ static void RunLoadedLibrary(char hotkey) {
   }
 
   if (found_index != -1) {
-    DisplayMessage("Launching library...", YELLOW, 500);
     // Important: Close tread.h window before calling external library to restore terminal state
     TR_CloseWindow();
 
-    // Call the external library's run function
-    loaded_libs[found_index].run_function();
+    // Call the external library's run function, measuring what the run costs
+    LoadedLibrary* lib = &loaded_libs[found_index];
+    ProcessUsage before, after;
+    GetProcessUsage(&before);
+    lib->run_function();
+    GetProcessUsage(&after);
+
+    PluginRunStats stats = {0};
+    stats.wall_ms = (after.wall_ns - before.wall_ns) / 1000000.0;
+    stats.cpu_ms = (after.cpu_ns - before.cpu_ns) / 1000000.0;
+    stats.peak_rss_delta_kb = after.peak_rss_kb - before.peak_rss_kb;
+    if (lib->stats_function != NULL) {
+      TR_FrameStats frame_stats = {0};
+      lib->stats_function(&frame_stats);
+      stats.has_frame_stats = true;
+      stats.frames = frame_stats.frames;
+      stats.avg_frame_ms = frame_stats.frames > 0 ? frame_stats.total_frame_ms / frame_stats.frames : 0.0;
+      stats.max_frame_ms = frame_stats.max_frame_ms;
+    }
+    RecordPluginRun(lib, &stats);
 
     // Re-initialize tread.h window after external library exits
     // Use actual screen dimensions for re-initialization if tread.h handles this well.
@@ -514,7 +2266,9 @@ static void RunLoadedLibrary(char hotkey) {
     // For now, we revert to initial fixed size as a safer default if behavior is inconsistent.
     TR_InitWindow(INITIAL_SCREEN_WIDTH, INITIAL_SCREEN_HEIGHT, "Tread.h Library Loader");
     TR_SetTargetFPS(LOADER_FPS);
-    DisplayMessage("Returned to loader.", GREEN, 1500);
+    char msg[128];
+    snprintf(msg, sizeof(msg), "Returned to loader. (%.0f ms, %.0f ms CPU)", stats.wall_ms, stats.cpu_ms);
+    DisplayMessage(msg, GREEN, 1500);
   } else {
     char msg[64];
     snprintf(msg, sizeof(msg), "No library loaded for hotkey '%c'", hotkey);
@@ -522,6 +2276,84 @@ static void RunLoadedLibrary(char hotkey) {
   }
 }
 
+// Stores a run's statistics on the library and in the session history
+static void RecordPluginRun(LoadedLibrary* lib, const PluginRunStats* stats) {
+  lib->last_run = *stats;
+  lib->runs++;
+
+  if (run_history_count == run_history_capacity) {
+    int new_capacity = run_history_capacity ? run_history_capacity * 2 : 16;
+    RunRecord* grown = (RunRecord*)realloc(run_history, sizeof(RunRecord) * new_capacity);
+    if (grown == NULL) return;
+    run_history = grown;
+    run_history_capacity = new_capacity;
+  }
+  RunRecord* record = &run_history[run_history_count++];
+  snprintf(record->path, sizeof(record->path), "%s", lib->name);
+  record->mtime_ns = 0;
+  record->size = 0;
+  GetPathStat(lib->name, &record->mtime_ns, &record->size);
+  record->finished_at = (long long)time(NULL);
+  record->stats = *stats;
+}
+
+// Appends the runs not exported yet to RUN_STATS_CSV_FILE in the current directory.
+// The plugin's mtime and size are included so runs of different builds can be compared.
+static void ExportRunStats() {
+  if (run_history_exported == run_history_count) {
+    DisplayMessage("No new plugin runs to export.", YELLOW, 1000);
+    return;
+  }
+
+  char csv_path[MAX_PATH_LENGTH];
+  if (!GetEntryPath(csv_path, sizeof(csv_path), RUN_STATS_CSV_FILE)) {
+    DisplayMessage("Error: The path is too long.", RED, 1500);
+    return;
+  }
+  long long existing_size = 0;
+  long long mtime_ns = 0;
+  bool exists = GetPathStat(csv_path, &mtime_ns, &existing_size);
+  FILE* file = fopen(csv_path, "a");
+  if (file == NULL) {
+    DisplayMessage("Error: Cannot write " RUN_STATS_CSV_FILE " here.", RED, 1500);
+    return;
+  }
+  if (!exists || existing_size == 0) {
+    fprintf(file, "finished_at,plugin,plugin_mtime_ns,plugin_size,wall_ms,cpu_ms,peak_rss_delta_kb,frames,avg_frame_ms,max_frame_ms\n");
+  }
+
+  for (int i = run_history_exported; i < run_history_count; ++i) {
+    const RunRecord* record = &run_history[i];
+    char finished_at[32];
+    time_t finished_time = (time_t)record->finished_at;
+    strftime(finished_at, sizeof(finished_at), "%Y-%m-%d %H:%M:%S", localtime(&finished_time));
+
+    // Quote the path, doubling any quotes in it
+    fprintf(file, "%s,\"", finished_at);
+    for (const char* c = record->path; *c != '\0'; ++c) {
+      if (*c == '"') fputc('"', file);
+      fputc(*c, file);
+    }
+    fprintf(file, "\",%lld,%lld,%.3f,%.3f,%lld,", record->mtime_ns, record->size,
+            record->stats.wall_ms, record->stats.cpu_ms, record->stats.peak_rss_delta_kb);
+    if (record->stats.has_frame_stats) {
+      fprintf(file, "%llu,%.3f,%.3f\n", record->stats.frames, record->stats.avg_frame_ms, record->stats.max_frame_ms);
+    } else {
+      fprintf(file, ",,\n"); // The plugin doesn't report frame statistics
+    }
+  }
+
+  bool written = (fclose(file) == 0);
+  if (!written) {
+    DisplayMessage("Error: Cannot write " RUN_STATS_CSV_FILE " here.", RED, 1500);
+    return;
+  }
+  char msg[MAX_PATH_LENGTH + 64];
+  snprintf(msg, sizeof(msg), "Exported %d run(s) to %s", run_history_count - run_history_exported, csv_path);
+  run_history_exported = run_history_count;
+  DisplayMessage(msg, GREEN, 1500);
+}
+
 // Unloads all currently loaded libraries
 static void UnloadAllLibraries() {
   for (int i = 0; i < MAX_LIBS; ++i) {
@@ -597,6 +2429,29 @@ static bool IsLoadableLibrary(const char* filename) {
   return false;
 }
 
+// Checks if a hotkey is taken by a loaded library (case-insensitive)
+static bool IsHotkeyInUse(char hotkey) {
+  for (int i = 0; i < MAX_LIBS; ++i) {
+    if (loaded_libs[i].is_loaded && tolower((unsigned char)loaded_libs[i].hotkey) == tolower((unsigned char)hotkey)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Builds the full path of an entry in the current directory. Returns false if it
+// doesn't fit in `size` bytes, rather than leaving a cut-off path naming another file.
+static bool GetEntryPath(char* dest, size_t size, const char* name) {
+  int length;
+  #ifdef _WIN32
+    length = snprintf(dest, size, "%s%c%s", current_path, PATH_SEP, name);
+  #else
+    // Append with slash if current_path doesn't end with one
+    length = snprintf(dest, size, "%s%s%s", current_path, (current_path[strlen(current_path)-1] == PATH_SEP ? "" : "/"), name);
+  #endif
+  return length >= 0 && (size_t)length < size;
+}
+
 // Gets the next available hotkey (1-9, then a-z)
 static char GetNextAvailableHotkey() {
   bool used[36] = {false}; // 0-9 (first 9 slots), then a-z (next 26 slots)
@@ -627,41 +2482,153 @@ static char GetNextAvailableHotkey() {
   return '\0'; // No hotkey available (should not happen if MAX_LIBS is reasonable)
 }
 
-// Displays a temporary message on the screen
-static void DisplayMessage(const char* message, Color color, int duration_ms) {
-  int screen_width = TR_GetScreenWidth();
-  int screen_height = TR_GetScreenHeight();
-  int text_len = (int)strlen(message);
+// Gets the last modification time (in nanoseconds) and size of a path. size may be NULL. Returns false on error.
+static bool GetPathStat(const char* path, long long* mtime_ns, long long* size) {
+#ifdef _WIN32
+  WIN32_FILE_ATTRIBUTE_DATA data;
+  if (!GetFileAttributesExA(path, GetFileExInfoStandard, &data)) return false;
+  ULARGE_INTEGER ticks; // 100ns intervals
+  ticks.LowPart = data.ftLastWriteTime.dwLowDateTime;
+  ticks.HighPart = data.ftLastWriteTime.dwHighDateTime;
+  *mtime_ns = (long long)ticks.QuadPart * 100LL;
+  if (size != NULL) *size = ((long long)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+#else
+  struct stat st;
+  if (stat(path, &st) != 0) return false;
+  #ifdef __APPLE__
+    *mtime_ns = (long long)st.st_mtimespec.tv_sec * 1000000000LL + st.st_mtimespec.tv_nsec;
+  #else
+    *mtime_ns = (long long)st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+  #endif
+  if (size != NULL) *size = (long long)st.st_size;
+#endif
+  return true;
+}
 
-  // Ensure message doesn't overflow screen width
-  if (text_len > screen_width - 4) { // 4 chars for padding on both sides
-    text_len = screen_width - 4;
+// Starts a thread that cleans up after itself when it returns. Returns false on failure.
+static bool StartDetachedThread(thread_func_t func, void* arg) {
+#ifdef _WIN32
+  HANDLE thread = CreateThread(NULL, 0, func, arg, 0, NULL);
+  if (thread == NULL) return false;
+  CloseHandle(thread);
+#else
+  pthread_t thread;
+  if (pthread_create(&thread, NULL, func, arg) != 0) return false;
+  pthread_detach(thread);
+#endif
+  return true;
+}
+
+// Gets a monotonic timestamp in nanoseconds
+static long long GetMonotonicTimeNs() {
+#ifdef _WIN32
+  LARGE_INTEGER counter, frequency;
+  QueryPerformanceCounter(&counter);
+  QueryPerformanceFrequency(&frequency);
+  return (long long)((double)counter.QuadPart * 1000000000.0 / (double)frequency.QuadPart);
+#else
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+#endif
+}
+
+// Samples wall clock, CPU time and peak RSS of this process
+static void GetProcessUsage(ProcessUsage* usage) {
+#ifdef _WIN32
+  usage->wall_ns = GetMonotonicTimeNs();
+
+  FILETIME creation_time, exit_time, kernel_time, user_time;
+  usage->cpu_ns = 0;
+  if (GetProcessTimes(GetCurrentProcess(), &creation_time, &exit_time, &kernel_time, &user_time)) {
+    ULARGE_INTEGER kernel_ticks, user_ticks; // 100ns intervals
+    kernel_ticks.LowPart = kernel_time.dwLowDateTime;
+    kernel_ticks.HighPart = kernel_time.dwHighDateTime;
+    user_ticks.LowPart = user_time.dwLowDateTime;
+    user_ticks.HighPart = user_time.dwHighDateTime;
+    usage->cpu_ns = (long long)(kernel_ticks.QuadPart + user_ticks.QuadPart) * 100LL;
+  }
+
+  PROCESS_MEMORY_COUNTERS memory;
+  usage->peak_rss_kb = 0;
+  if (GetProcessMemoryInfo(GetCurrentProcess(), &memory, sizeof(memory))) {
+    usage->peak_rss_kb = (long long)(memory.PeakWorkingSetSize / 1024);
+  }
+#else
+  usage->wall_ns = GetMonotonicTimeNs();
+
+  struct rusage ru;
+  memset(&ru, 0, sizeof(ru));
+  getrusage(RUSAGE_SELF, &ru);
+  usage->cpu_ns = ((long long)ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000000LL +
+                  ((long long)ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) * 1000LL;
+  #ifdef __APPLE__
+    usage->peak_rss_kb = (long long)ru.ru_maxrss / 1024; // Bytes on macOS
+  #else
+    usage->peak_rss_kb = (long long)ru.ru_maxrss; // Kilobytes on Linux and the BSDs
+  #endif
+#endif
+}
+
+// Queues a message to be shown for duration_ms. It is drawn by the normal frame
+// loop, so the UI keeps running and taking input while it's on screen.
+static void DisplayMessage(const char* message, Color color, int duration_ms) {
+  // Timed from now rather than from the frame start, since it may be queued after a blocking prompt or plugin run
+  long long expires_ns = GetMonotonicTimeNs() + (long long)duration_ms * 1000000LL;
+
+  // The same message again (e.g. a repeated error) just stays up longer
+  for (int i = 0; i < num_toasts; ++i) {
+    if (strncmp(toasts[i].text, message, sizeof(toasts[i].text) - 1) == 0) {
+      toasts[i].color = color;
+      if (expires_ns > toasts[i].expires_ns) toasts[i].expires_ns = expires_ns;
+      return;
+    }
   }
 
-  int x_pos = (screen_width - text_len) / 2;
-  int y_pos = screen_height - 3; // Near bottom
+  if (num_toasts == MAX_TOASTS) {
+    memmove(&toasts[0], &toasts[1], sizeof(Toast) * (MAX_TOASTS - 1)); // Drop the oldest
+    num_toasts--;
+  }
+  Toast* toast = &toasts[num_toasts++];
+  strncpy(toast->text, message, sizeof(toast->text) - 1);
+  toast->text[sizeof(toast->text) - 1] = '\0';
+  toast->color = color;
+  toast->expires_ns = expires_ns;
+}
 
-  TR_BeginDrawing();
-  // Clear previous message area
-  // Adjust rectangle width and height to cover potential multi-line messages if they were implemented
-  TR_DrawRectangle(x_pos - 1, y_pos - 1, text_len + 2, 3, DARKGRAY, DARKGRAY);
-  char truncated_message[256]; // Buffer for the potentially truncated message
-  strncpy(truncated_message, message, text_len);
-  truncated_message[text_len] = '\0'; // Null-terminate
+// Removes toasts that have expired by the current frame's clock
+static void UpdateToasts() {
+  int kept = 0;
+  for (int i = 0; i < num_toasts; ++i) {
+    if (toasts[i].expires_ns > frame_clock_ns) {
+      toasts[kept++] = toasts[i];
+    }
+  }
+  num_toasts = kept;
+}
 
-  TR_DrawText(truncated_message, x_pos, y_pos, 10, color, DARKGRAY);
-  TR_EndDrawing();
+// Draws the queued toasts near the bottom of the screen, newest lowest
+static void DrawToasts() {
+  int screen_width = TR_GetScreenWidth();
+  int screen_height = TR_GetScreenHeight();
 
-  // Use platform-specific sleep for duration
-  #ifdef _WIN32
-    Sleep((DWORD)duration_ms);
-  #else
-    struct timespec req = { .tv_sec = duration_ms / 1000, .tv_nsec = (long)((duration_ms % 1000) * 1000000) };
-    struct timespec rem; // For remaining time if interrupted
-    while (nanosleep(&req, &rem) == -1 && errno == EINTR) {
-      req = rem; // Resume sleep if interrupted by signal
+  for (int i = num_toasts - 1, row = 0; i >= 0; --i, ++row) {
+    int text_len = (int)strlen(toasts[i].text);
+    // Ensure message doesn't overflow screen width
+    if (text_len > screen_width - 4) { // 4 chars for padding on both sides
+      text_len = screen_width - 4;
     }
-  #endif
+    if (text_len <= 0) continue; // Nothing to show, or too narrow to show any of it
+    int x_pos = (screen_width - text_len) / 2;
+    int y_pos = screen_height - 3 - row * 2; // Near bottom, older messages stacked above
+
+    char truncated_message[TOAST_MAX_LENGTH]; // Buffer for the potentially truncated message
+    memcpy(truncated_message, toasts[i].text, text_len);
+    truncated_message[text_len] = '\0'; // Null-terminate
+
+    TR_DrawRectangle(x_pos - 1, y_pos - 1, text_len + 2, 3, DARKGRAY, DARKGRAY); // Clear the area behind it
+    TR_DrawText(truncated_message, x_pos, y_pos, 10, toasts[i].color, DARKGRAY);
+  }
 }
 
 // Displays a multi-line message and waits for 'Y' or 'N' input.
@@ -93,6 +93,14 @@ static const TR_Triangle octa_faces[] = {
 };
 static const int num_octa_faces = sizeof(octa_faces) / sizeof(TR_Triangle);
 
+// ABI version of the loader interface this plugin was built for (libloader reads it without loading the library)
+const int tread_abi_version = 1;
+
+// Lets the loader read this plugin's frame statistics after run_lib_app returns
+void run_lib_stats(TR_FrameStats* stats) {
+  *stats = TR_GetFrameStats();
+}
+
 void run_lib_app() {
   const int screenWidth = 80;
   const int screenHeight = 25;
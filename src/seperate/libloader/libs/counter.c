@@ -55,6 +55,14 @@ char* increment_string_number(const char* num_str) {
 }
 
 
+// ABI version of the loader interface this plugin was built for (libloader reads it without loading the library)
+const int tread_abi_version = 1;
+
+// Lets the loader read this plugin's frame statistics after run_lib_app returns
+void run_lib_stats(TR_FrameStats* stats) {
+  *stats = TR_GetFrameStats();
+}
+
 // This is the function the loader will look for and call
 void run_lib_app() {
   // Get the actual screen dimensions from the terminal, which tread.h can now query.
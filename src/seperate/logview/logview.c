@@ -0,0 +1,162 @@
+// logview.c - A terminal log viewer built on tread.h's TR_LOG_VIEWER widget.
+//             Opens a text file of any size, follows it as it grows (like tail -f)
+//             and searches it as you type.
+//
+// Usage: logview <file>
+
+#define TR_LOG_VIEWER
+#include "../../tread.h"
+
+#include <ctype.h> // For isprint()
+
+// --- Configuration ---
+#define FPS 30
+
+// --- Global State ---
+static TR_LogViewer* viewer = NULL;
+static bool running = true;         // Main loop flag
+static bool typing_query = false;   // True while the search bar has focus
+static char query[TR_VIEWER_MAX_QUERY] = "";
+static int query_length = 0;
+
+// Formats a byte count with a unit (e.g. "1.5 GB")
+static void FormatSize(size_t bytes, char* out, size_t out_size) {
+  const char* units[] = { "B", "KB", "MB", "GB", "TB" };
+  double value = (double)bytes;
+  int unit = 0;
+  while (value >= 1024.0 && unit < 4) {
+    value /= 1024.0;
+    unit++;
+  }
+  if (unit == 0) snprintf(out, out_size, "%zu B", bytes);
+  else snprintf(out, out_size, "%.1f %s", value, units[unit]);
+}
+
+// Handles a key while the search bar has focus. Every change searches again.
+static void HandleQueryKey(int key) {
+  if (key == TR_KEY_ENTER || key == '\n') {
+    typing_query = false; // Keep the search, go back to scrolling
+  } else if (key == TR_KEY_ESCAPE) {
+    typing_query = false;
+    query_length = 0;
+    query[0] = '\0';
+    TR_LogViewerSearch(viewer, query);
+  } else if (key == TR_KEY_BACKSPACE || key == TR_KEY_DELETE) {
+    if (query_length > 0) {
+      query[--query_length] = '\0';
+      TR_LogViewerSearch(viewer, query);
+    }
+  } else if (key > 0 && key < 256 && isprint(key) && query_length < TR_VIEWER_MAX_QUERY - 1) {
+    query[query_length++] = (char)key;
+    query[query_length] = '\0';
+    TR_LogViewerSearch(viewer, query);
+  }
+}
+
+// Handles a key while the log has focus
+static void HandleViewKey(int key) {
+  if (TR_LogViewerHandleKey(viewer, key)) return;
+  switch (key) {
+    case '/':
+      typing_query = true;
+      query_length = 0;
+      query[0] = '\0';
+      TR_LogViewerSearch(viewer, query);
+      break;
+    case 'q':
+    case 'Q':
+    case TR_KEY_ESCAPE:
+      running = false;
+      break;
+  }
+}
+
+// Draws the title bar and the status/search bar around the log
+static void DrawBars(int width, int height, const char* path) {
+  TR_LogViewerStatus status = TR_LogViewerGetStatus(viewer);
+
+  // Title bar: file name and size
+  char size_text[32];
+  char title[512];
+  FormatSize(status.file_size, size_text, sizeof(size_text));
+  TR_DrawRectangle(0, 0, width, 1, BLACK, DARKBLUE);
+  snprintf(title, sizeof(title), " logview - %s (%s)", path, size_text);
+  TR_DrawText(title, 0, 0, 10, RAYWHITE, DARKBLUE);
+
+  // Status bar: position, indexing progress and the search
+  char position[128];
+  if (status.top_line > 0) {
+    snprintf(position, sizeof(position), "Line %lld/%zu%s", status.top_line, status.lines, status.index_complete ? "" : "+");
+  } else {
+    snprintf(position, sizeof(position), "Line ?/%zu+", status.lines);
+  }
+  if (!status.index_complete && status.file_size > 0) {
+    size_t used = strlen(position);
+    snprintf(position + used, sizeof(position) - used, " (indexing)");
+  }
+
+  char search[TR_VIEWER_MAX_QUERY + 64] = "";
+  if (typing_query || query_length > 0) {
+    const char* state = "";
+    char progress[32] = "";
+    switch (status.search_state) {
+      case TR_VIEWER_SEARCH_RUNNING:
+        snprintf(progress, sizeof(progress), " [searching %d%%]", (int)(status.search_progress * 100.0));
+        state = progress;
+        break;
+      case TR_VIEWER_SEARCH_FOUND: state = " [found]"; break;
+      case TR_VIEWER_SEARCH_NOT_FOUND: state = " [not found]"; break;
+    }
+    snprintf(search, sizeof(search), "/%s%s%s", query, typing_query ? "_" : "", state);
+  }
+
+  char bar[512];
+  snprintf(bar, sizeof(bar), " %s | %s | %s", position, status.following ? "FOLLOWING" : "G: Follow",
+           typing_query ? "Enter: Done | Esc: Clear" : "/: Search | n: Next | Q: Quit");
+  TR_DrawRectangle(0, height - 1, width, 1, BLACK, DARKGRAY);
+  TR_DrawText(bar, 0, height - 1, 10, RAYWHITE, DARKGRAY);
+  if (search[0] != '\0') {
+    int x = width - (int)strlen(search) - 1;
+    if (x < (int)strlen(bar) + 1) x = (int)strlen(bar) + 1;
+    TR_DrawText(search, x, height - 1, 10, YELLOW, DARKGRAY);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  if (argc != 2) {
+    fprintf(stderr, "Usage: %s <file>\n", argv[0]);
+    return 1;
+  }
+
+  viewer = TR_LogViewerOpen(argv[1]);
+  if (viewer == NULL) {
+    fprintf(stderr, "ERROR: Could not open '%s'.\n", argv[1]);
+    return 1;
+  }
+
+  int width = TR_GetScreenWidth();
+  int height = TR_GetScreenHeight();
+  TR_InitWindow(width, height, "tread.h - Log Viewer");
+  TR_SetTargetFPS(FPS);
+
+  while (running) {
+    TR_BeginDrawing();
+    TR_ClearBackground(BLACK);
+
+    int key = TR_GetKeyPressed();
+    if (key != 0) {
+      if (typing_query) HandleQueryKey(key);
+      else HandleViewKey(key);
+    }
+
+    TR_LogViewerUpdate(viewer);
+    TR_LogViewerDraw(viewer, 0, 1, width, height - 2, LIGHTGRAY, BLACK);
+    DrawBars(width, height, argv[1]);
+
+    TR_EndDrawing();
+  }
+
+  TR_CloseWindow();
+  TR_LogViewerClose(viewer);
+  return 0;
+}
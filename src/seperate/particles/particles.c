@@ -0,0 +1,193 @@
+// particles.c - Fireworks, rain and a comet drawn with tread.h's TR_PARTICLES module, as
+//               glyphs or half-block pixels. Shows how long the update and draw take.
+//
+// Usage: particles            (the show)
+//        particles -b [count] (times updating `count` live particles, 100000 by default,
+//                              on 1, 2, 4 and 8 threads without opening the terminal)
+// Keys:  + / -: more or less rain   Space: a firework   P: glyphs/pixels   T: threads   Q/ESC: quit
+
+#define TR_PARTICLES
+#include "../../tread.h"
+
+#include <time.h> // For time (to seed rand and the pool)
+
+// --- Configuration ---
+#define FPS 60
+#define CAPACITY 1000000
+#define DEFAULT_BENCH_COUNT 100000
+#define BENCH_SECONDS 1.0
+#define MIN_RAIN 50.0f
+#define MAX_RAIN 400000.0f // Drops per second
+#define FIREWORK_PARTICLES 600
+#define FIREWORK_INTERVAL 0.7f // Seconds between automatic fireworks
+#define COMET_RATE 400.0f
+
+enum { STYLE_SPARK, STYLE_EMBER, STYLE_RAIN, STYLE_COMET };
+
+static float RandomFloat(float min, float max) {
+  return min + (max - min) * (float)rand() / (float)RAND_MAX;
+}
+
+static double Microseconds(long long start_ns, long long end_ns) {
+  return (double)(end_ns - start_ns) / 1e3;
+}
+
+static void SetStyles(TR_ParticlePool* pool) {
+  static const Color spark[] = { WHITE, YELLOW, GOLD, ORANGE, RED, MAROON, DARKGRAY };
+  static const Color ember[] = { WHITE, PINK, MAGENTA, PURPLE, VIOLET, DARKPURPLE };
+  static const Color rain[] = { SKYBLUE, BLUE, DARKBLUE };
+  static const Color comet[] = { WHITE, CYAN, SKYBLUE, BLUE, DARKBLUE };
+  TR_ParticlesSetStyle(pool, STYLE_SPARK, "@*+:.", spark, 7);
+  TR_ParticlesSetStyle(pool, STYLE_EMBER, "O*o+.", ember, 6);
+  TR_ParticlesSetStyle(pool, STYLE_RAIN, "|||:", rain, 3);
+  TR_ParticlesSetStyle(pool, STYLE_COMET, "#*+-.", comet, 5);
+}
+
+// Keeps `count` particles alive for BENCH_SECONDS per thread count and prints the times
+static int RunBenchmark(int count) {
+  TR_ParticlePool* pool = TR_ParticlePoolCreate(count, 1);
+  if (pool == NULL) {
+    fprintf(stderr, "ERROR: Failed to allocate %d particles.\n", count);
+    return 1;
+  }
+  TR_ParticleEmitter emitter = TR_ParticleExplosion(500.0f, 500.0f, 40.0f, STYLE_SPARK);
+  printf("particles: %d live particles, lives of 0.6 to 1.4 s, dt = 1/%d s\n", count, FPS);
+  for (int threads = 1; threads <= 8; threads *= 2) {
+    pool->count = 0;
+    TR_ParticlesBurst(pool, &emitter, count);
+    long long updates = 0;
+    long long respawned = 0;
+    double update_us = 0.0;
+    double spawn_us = 0.0;
+    long long start_ns = __tr_get_time_ns();
+    long long now_ns = start_ns;
+    while ((double)(now_ns - start_ns) < BENCH_SECONDS * 1e9) {
+      long long update_start_ns = now_ns;
+      TR_ParticlesUpdate(pool, 1.0f / FPS, threads);
+      long long updated_ns = __tr_get_time_ns();
+      respawned += TR_ParticlesBurst(pool, &emitter, count - pool->count); // Replace the dead
+      now_ns = __tr_get_time_ns();
+      update_us += Microseconds(update_start_ns, updated_ns);
+      spawn_us += Microseconds(updated_ns, now_ns);
+      updates++;
+    }
+    printf("  %d thread%s: %8.1f us/update, %8.1f us/update respawning %.0f dead\n",
+           threads, threads == 1 ? " " : "s", update_us / updates, spawn_us / updates, (double)respawned / updates);
+  }
+  TR_ParticlePoolDestroy(pool);
+  return 0;
+}
+
+// Converts live particles between cell units and pixel units (two per cell vertically)
+static void ScaleY(TR_ParticlePool* pool, float scale) {
+  for (int i = 0; i < pool->count; i++) {
+    pool->y[i] *= scale;
+    pool->vy[i] *= scale;
+    pool->ay[i] *= scale;
+  }
+}
+
+int main(int argc, char* argv[]) {
+  if (argc >= 2 && strcmp(argv[1], "-b") == 0) {
+    int count = (argc >= 3) ? atoi(argv[2]) : DEFAULT_BENCH_COUNT;
+    if (argc > 3 || count < 1 || count > CAPACITY) {
+      fprintf(stderr, "Usage: %s -b [count]   (count between 1 and %d)\n", argv[0], CAPACITY);
+      return 1;
+    }
+    return RunBenchmark(count);
+  }
+  if (argc > 1) {
+    fprintf(stderr, "Usage: %s [-b [count]]\n", argv[0]);
+    return 1;
+  }
+
+  uint64_t seed = TR_RegisterSeed((uint64_t)time(NULL));
+  srand((unsigned int)seed);
+  TR_ParticlePool* pool = TR_ParticlePoolCreate(CAPACITY, seed);
+  if (pool == NULL) {
+    fprintf(stderr, "ERROR: Failed to allocate %d particles.\n", CAPACITY);
+    return 1;
+  }
+  SetStyles(pool);
+
+  int width = TR_GetScreenWidth();
+  int height = TR_GetScreenHeight();
+  TR_InitWindow(width, height, "tread.h - Particles");
+  TR_SetTargetFPS(FPS);
+
+  int field_height = height - 1; // Bottom row for the status bar
+  bool pixels = false;
+  float scale_y = 1.0f; // World units per cell vertically: 1 for glyphs, 2 for pixels
+  int threads = 1;
+  float rain_rate = 2000.0f;
+  float firework_timer = 0.0f;
+  float time_s = 0.0f;
+  TR_ParticleEmitter comet = TR_ParticleTrail(0.0f, 0.0f, COMET_RATE, STYLE_COMET);
+  TR_ParticleEmitter rain = TR_ParticleRain(0.0f, 0.0f, (float)width, (float)field_height, (float)field_height, rain_rate, STYLE_RAIN);
+
+  double update_us = 0.0;
+  double draw_us = 0.0;
+  bool running = true;
+  while (running) {
+    float dt = 1.0f / FPS; // A fixed step keeps recorded sessions replaying the same way
+    bool firework = false;
+    switch (TR_GetKeyPressed()) {
+      case '+': case '=': rain_rate = (rain_rate * 2.0f < MAX_RAIN) ? rain_rate * 2.0f : MAX_RAIN; break;
+      case '-': case '_': rain_rate = (rain_rate * 0.5f > MIN_RAIN) ? rain_rate * 0.5f : MIN_RAIN; break;
+      case ' ': firework = true; break;
+      case 'p': case 'P':
+        pixels = !pixels;
+        ScaleY(pool, pixels ? 2.0f : 0.5f);
+        scale_y = pixels ? 2.0f : 1.0f;
+        break;
+      case 't': case 'T': threads = (threads < 8) ? threads * 2 : 1; break;
+      case 'q': case 'Q': case TR_KEY_ESCAPE: running = false; break;
+    }
+
+    // Emit this frame's particles
+    time_s += dt;
+    firework_timer -= dt;
+    if (firework || firework_timer <= 0.0f) {
+      float x = RandomFloat(0.15f, 0.85f) * (float)width;
+      float y = RandomFloat(0.15f, 0.6f) * (float)field_height * scale_y;
+      TR_ParticleEmitter burst = TR_ParticleExplosion(x, y, (float)width * 0.25f, (firework_timer <= 0.0f) ? STYLE_SPARK : STYLE_EMBER);
+      burst.ay *= scale_y;
+      TR_ParticlesBurst(pool, &burst, FIREWORK_PARTICLES);
+      if (firework_timer <= 0.0f) firework_timer = FIREWORK_INTERVAL;
+    }
+    float pending = rain.pending; // Rebuilt for the current scale, keeping the part-drop it owes
+    rain = TR_ParticleRain(0.0f, 0.0f, (float)width, (float)field_height * scale_y, (float)field_height * scale_y, rain_rate, STYLE_RAIN);
+    rain.pending = pending;
+    TR_ParticlesEmit(pool, &rain, dt);
+    comet.x = (float)width * (0.5f + 0.4f * sinf(time_s * 0.7f));
+    comet.y = (float)field_height * scale_y * (0.5f + 0.35f * sinf(time_s * 1.3f));
+    TR_ParticlesEmit(pool, &comet, dt);
+
+    long long start_ns = __tr_get_time_ns();
+    TR_ParticlesUpdate(pool, dt, threads);
+    long long updated_ns = __tr_get_time_ns();
+
+    TR_BeginDrawing();
+    TR_ClearBackground(BLACK);
+    long long draw_start_ns = __tr_get_time_ns();
+    if (pixels) TR_ParticlesDrawPixels(pool, 0, 0, width, field_height, 0.0f, 0.0f);
+    else TR_ParticlesDraw(pool, 0, 0, width, field_height, 0.0f, 0.0f);
+    long long drawn_ns = __tr_get_time_ns();
+
+    // Smooth the timings so they can be read
+    update_us = update_us * 0.9 + Microseconds(start_ns, updated_ns) * 0.1;
+    draw_us = draw_us * 0.9 + Microseconds(draw_start_ns, drawn_ns) * 0.1;
+
+    char status[256];
+    snprintf(status, sizeof(status), " %d particles | update %.0f us | draw %.0f us | %s | %d thread%s | +/-: Rain | Space: Firework | P: %s | T: Threads | Q: Quit",
+             pool->count, update_us, draw_us, pixels ? "pixels" : "glyphs", threads, threads == 1 ? "" : "s", pixels ? "Glyphs" : "Pixels");
+    TR_DrawRectangle(0, height - 1, width, 1, BLACK, DARKGRAY);
+    TR_DrawText(status, 0, height - 1, 10, RAYWHITE, DARKGRAY);
+
+    TR_EndDrawing();
+  }
+
+  TR_CloseWindow();
+  TR_ParticlePoolDestroy(pool);
+  return 0;
+}
@@ -0,0 +1,216 @@
+// pathbench.c - Benchmarks tread.h's TR_PATHFINDING module: A* against Jump Point Search
+//               on the same random queries, and flow fields from one and many sources,
+//               on a generated maze and on an open field with scattered blocks.
+//
+// Usage: pathbench [size [queries]]   (defaults to a 1024x1024 grid and 200 queries)
+
+#define TR_PATHFINDING
+#include "../../tread.h"
+
+#include <time.h> // For clock
+
+// --- Configuration ---
+#define DEFAULT_SIZE 1024
+#define DEFAULT_QUERIES 200
+#define MIN_SIZE 16
+#define MAX_SIZE 8192
+#define BRAID_CHANCE 12     // Percent of maze walls between two corridors that get knocked through
+#define OPEN_WALL_SHARE 25  // Percent of the open field covered by blocks
+#define MAX_BLOCK_SIZE 24
+#define FLOW_SOURCES 64     // Sources for the multi-source flow field
+
+// Picks a random index below count (two rand() calls, since RAND_MAX can be as low as 32767)
+static int RandomIndex(int count) {
+  unsigned int value = ((unsigned int)rand() << 15) ^ (unsigned int)rand();
+  return (int)(value % (unsigned int)count);
+}
+
+// Carves a braided maze into grid ('#' walls, '.' floor): a depth-first backtracker over
+// the odd cells, then some walls between two corridors are knocked through to make loops.
+static void GenerateMaze(char* grid, int size, int* stack) {
+  static const int dir_x[4] = { 0, 0, -1, 1 };
+  static const int dir_y[4] = { -1, 1, 0, 0 };
+  int rooms = (size - 1) / 2;
+  memset(grid, '#', (size_t)size * size);
+  int stack_size = 0;
+  grid[size + 1] = '.';
+  stack[stack_size++] = size + 1;
+  while (stack_size > 0) {
+    int cell = stack[stack_size - 1];
+    int x = cell % size;
+    int y = cell / size;
+    int options[4];
+    int num_options = 0;
+    for (int d = 0; d < 4; d++) {
+      int room_x = (x - 1) / 2 + dir_x[d];
+      int room_y = (y - 1) / 2 + dir_y[d];
+      if (room_x >= 0 && room_x < rooms && room_y >= 0 && room_y < rooms &&
+          grid[(y + dir_y[d] * 2) * size + x + dir_x[d] * 2] == '#') {
+        options[num_options++] = d;
+      }
+    }
+    if (num_options == 0) {
+      stack_size--;
+      continue;
+    }
+    int d = options[RandomIndex(num_options)];
+    grid[(y + dir_y[d]) * size + x + dir_x[d]] = '.';
+    int next = (y + dir_y[d] * 2) * size + x + dir_x[d] * 2;
+    grid[next] = '.';
+    stack[stack_size++] = next;
+  }
+  for (int y = 1; y < size - 1; y++) {
+    for (int x = 1; x < size - 1; x++) {
+      int cell = y * size + x;
+      if (grid[cell] != '#') continue;
+      bool horizontal = (grid[cell - 1] != '#' && grid[cell + 1] != '#');
+      bool vertical = (grid[cell - size] != '#' && grid[cell + size] != '#');
+      if ((horizontal || vertical) && rand() % 100 < BRAID_CHANCE) grid[cell] = '.';
+    }
+  }
+}
+
+// Picks a random open cell
+static TR_PathPoint RandomOpenCell(TR_Pathfinder* pf) {
+  TR_PathPoint point;
+  do {
+    point.x = RandomIndex(pf->width);
+    point.y = RandomIndex(pf->height);
+  } while (TR_PathfinderIsBlocked(pf, point.x, point.y));
+  return point;
+}
+
+static double Milliseconds(clock_t elapsed) {
+  return (double)elapsed * 1000.0 / CLOCKS_PER_SEC;
+}
+
+// Runs every benchmark on one grid, 4-way and 8-way
+static void RunGrid(const char* name, const char* grid, const unsigned char* bits, int size, int queries,
+                    TR_PathPoint* path, int* field) {
+  for (int flags = 0; flags <= TR_PATH_DIAGONAL; flags++) {
+    TR_Pathfinder* pf = TR_PathfinderCreate(size, size, flags);
+    if (pf == NULL) {
+      fprintf(stderr, "ERROR: Failed to allocate a %dx%d pathfinder.\n", size, size);
+      exit(1);
+    }
+    clock_t start = clock();
+    if (bits != NULL) TR_PathfinderSetGridBits(pf, bits);
+    else TR_PathfinderSetGrid(pf, grid, size, "#");
+    double setup_ms = Milliseconds(clock() - start);
+
+    char label[64];
+    snprintf(label, sizeof(label), "%s %s", name, (flags & TR_PATH_DIAGONAL) ? "8-way" : "4-way");
+    printf("%-14s set grid from %s: %.2f ms\n", label, (bits != NULL) ? "bitset" : "chars", setup_ms);
+
+    // The same queries for A* and JPS
+    srand(7);
+    clock_t astar_time = 0;
+    clock_t jps_time = 0;
+    long long astar_expanded = 0;
+    long long jps_expanded = 0;
+    long long total_length = 0;
+    int found = 0;
+    int mismatches = 0;
+    for (int q = 0; q < queries; q++) {
+      TR_PathPoint from = RandomOpenCell(pf);
+      TR_PathPoint to = RandomOpenCell(pf);
+
+      start = clock();
+      int astar_length = TR_FindPath(pf, from.x, from.y, to.x, to.y, path, size * size);
+      astar_time += clock() - start;
+      astar_expanded += pf->expanded;
+
+      start = clock();
+      int jps_length = TR_FindPathJPS(pf, from.x, from.y, to.x, to.y, path, size * size);
+      jps_time += clock() - start;
+      jps_expanded += pf->expanded;
+
+      // Both are optimal, so without diagonals the lengths must agree exactly (with them
+      // equal-cost paths can differ in how many steps they take)
+      if ((astar_length < 0) != (jps_length < 0) || (!(flags & TR_PATH_DIAGONAL) && astar_length != jps_length)) mismatches++;
+      if (astar_length > 0) {
+        found++;
+        total_length += astar_length;
+      }
+    }
+    printf("  %-12s %10.3f ms/query %12.0f nodes/query\n", "A*", Milliseconds(astar_time) / queries, (double)astar_expanded / queries);
+    printf("  %-12s %10.3f ms/query %12.0f nodes/query\n", "JPS", Milliseconds(jps_time) / queries, (double)jps_expanded / queries);
+    printf("  %d/%d paths found, %.0f points on average, %d A*/JPS mismatches\n",
+           found, queries, found > 0 ? (double)total_length / found : 0.0, mismatches);
+
+    // Flow fields, until a second has passed
+    TR_PathPoint sources[FLOW_SOURCES];
+    for (int i = 0; i < FLOW_SOURCES; i++) sources[i] = RandomOpenCell(pf);
+    int counts[2] = { 1, FLOW_SOURCES };
+    for (int c = 0; c < 2; c++) {
+      int fields = 0;
+      start = clock();
+      clock_t elapsed;
+      do {
+        TR_ComputeFlowField(pf, sources, counts[c], field);
+        fields++;
+        elapsed = clock() - start;
+      } while (elapsed < CLOCKS_PER_SEC);
+      char flow_label[32];
+      snprintf(flow_label, sizeof(flow_label), "flow x%d", counts[c]);
+      printf("  %-12s %10.3f ms/field  %12d cells\n", flow_label, Milliseconds(elapsed) / fields, pf->expanded);
+    }
+    TR_PathfinderDestroy(pf);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  int size = DEFAULT_SIZE;
+  int queries = DEFAULT_QUERIES;
+  if (argc > 3) {
+    fprintf(stderr, "Usage: %s [size [queries]]\n", argv[0]);
+    return 1;
+  }
+  if (argc >= 2) size = atoi(argv[1]);
+  if (argc >= 3) queries = atoi(argv[2]);
+  if (size < MIN_SIZE || size > MAX_SIZE || queries < 1) {
+    fprintf(stderr, "ERROR: The size must be between %d and %d and there must be at least one query.\n", MIN_SIZE, MAX_SIZE);
+    return 1;
+  }
+
+  size_t cells = (size_t)size * size;
+  char* grid = (char*)malloc(cells);
+  unsigned char* bits = (unsigned char*)calloc((cells + 7) / 8, 1);
+  int* scratch = (int*)malloc(cells * sizeof(int)); // Maze stack, then the flow field
+  TR_PathPoint* path = (TR_PathPoint*)malloc(cells * sizeof(TR_PathPoint));
+  if (grid == NULL || bits == NULL || scratch == NULL || path == NULL) {
+    fprintf(stderr, "ERROR: Failed to allocate a %dx%d grid.\n", size, size);
+    return 1;
+  }
+
+  printf("pathbench: %dx%d grids, %d queries each\n\n", size, size, queries);
+
+  // A braided maze of one-cell corridors, given as chars like pacman's map
+  srand(1);
+  GenerateMaze(grid, size, scratch);
+  RunGrid("maze", grid, NULL, size, queries, path, scratch);
+  printf("\n");
+
+  // An open field with scattered blocks, given as a bitset like snake's occupancy grid
+  size_t covered = 0;
+  while (covered * 100 < cells * OPEN_WALL_SHARE) {
+    int block_width = 1 + RandomIndex(MAX_BLOCK_SIZE);
+    int block_height = 1 + RandomIndex(MAX_BLOCK_SIZE);
+    int left = RandomIndex(size - block_width + 1);
+    int top = RandomIndex(size - block_height + 1);
+    for (int y = top; y < top + block_height; y++) {
+      for (int x = left; x < left + block_width; x++) {
+        size_t i = (size_t)y * size + x;
+        if (!(bits[i >> 3] & (1 << (i & 7)))) covered++;
+        bits[i >> 3] |= (unsigned char)(1 << (i & 7));
+      }
+    }
+  }
+  RunGrid("open", NULL, bits, size, queries, path, scratch);
+
+  free(grid);
+  free(bits);
+  free(scratch);
+  free(path);
+  return 0;
+}
@@ -0,0 +1,145 @@
+// spatialbench.c - Benchmarks tread.h's TR_SPATIAL_HASH module: rebuilding the grid every
+//                  tick for thousands of moving points, then a radius, rect and point query
+//                  around each one, checked against testing every pair.
+//
+// Usage: spatialbench [count [ticks]]   (defaults to 10000 and 100000 points, 30 ticks)
+
+#define TR_SPATIAL_HASH
+#include "../../tread.h"
+
+#include <time.h> // For clock
+
+// --- Configuration ---
+#define DEFAULT_TICKS 30
+#define MAX_COUNT 10000000
+#define AREA_PER_POINT 16.0f // World cells per point, so density stays the same at any count
+#define RADIUS 2.0f
+#define CELL_SIZE 4.0f       // About twice the query radius
+#define MAX_RESULTS 256
+#define CHECKED_POINTS 200   // Points whose queries are checked against every pair
+
+static float RandomFloat(float min, float max) {
+  return min + (max - min) * (float)rand() / (float)RAND_MAX;
+}
+
+static double Milliseconds(clock_t elapsed) {
+  return (double)elapsed * 1000.0 / CLOCKS_PER_SEC;
+}
+
+// Moves the points and bounces them off the edges of the world
+static void MovePoints(float* x, float* y, float* vx, float* vy, int count, float size) {
+  for (int i = 0; i < count; i++) {
+    x[i] += vx[i];
+    y[i] += vy[i];
+    if (x[i] < 0.0f || x[i] >= size) { vx[i] = -vx[i]; x[i] += 2.0f * vx[i]; }
+    if (y[i] < 0.0f || y[i] >= size) { vy[i] = -vy[i]; y[i] += 2.0f * vy[i]; }
+  }
+}
+
+static void RunCount(int count, int ticks) {
+  float size = sqrtf((float)count * AREA_PER_POINT);
+  float* x = (float*)malloc(sizeof(float) * count);
+  float* y = (float*)malloc(sizeof(float) * count);
+  float* vx = (float*)malloc(sizeof(float) * count);
+  float* vy = (float*)malloc(sizeof(float) * count);
+  TR_SpatialHash* hash = TR_SpatialHashCreate(0.0f, 0.0f, size, size, CELL_SIZE);
+  if (x == NULL || y == NULL || vx == NULL || vy == NULL || hash == NULL) {
+    fprintf(stderr, "ERROR: Failed to allocate %d points.\n", count);
+    exit(1);
+  }
+  srand(7);
+  for (int i = 0; i < count; i++) {
+    x[i] = RandomFloat(0.0f, size);
+    y[i] = RandomFloat(0.0f, size);
+    vx[i] = RandomFloat(-0.5f, 0.5f);
+    vy[i] = RandomFloat(-0.5f, 0.5f);
+  }
+
+  int results[MAX_RESULTS];
+  clock_t build_time = 0;
+  clock_t radius_time = 0;
+  clock_t rect_time = 0;
+  clock_t point_time = 0;
+  long long radius_found = 0;
+  long long rect_found = 0;
+  long long point_found = 0;
+  for (int tick = 0; tick < ticks; tick++) {
+    MovePoints(x, y, vx, vy, count, size);
+
+    clock_t start = clock();
+    if (!TR_SpatialHashBuild(hash, x, y, count)) {
+      fprintf(stderr, "ERROR: Failed to grow the spatial hash.\n");
+      exit(1);
+    }
+    build_time += clock() - start;
+
+    start = clock();
+    for (int i = 0; i < count; i++) radius_found += TR_SpatialHashQueryRadius(hash, x[i], y[i], RADIUS, results, MAX_RESULTS);
+    radius_time += clock() - start;
+
+    start = clock();
+    for (int i = 0; i < count; i++) {
+      rect_found += TR_SpatialHashQueryRect(hash, x[i] - RADIUS, y[i] - RADIUS, x[i] + RADIUS, y[i] + RADIUS, results, MAX_RESULTS);
+    }
+    rect_time += clock() - start;
+
+    start = clock();
+    for (int i = 0; i < count; i++) point_found += TR_SpatialHashQueryPoint(hash, (int)x[i], (int)y[i], results, MAX_RESULTS);
+    point_time += clock() - start;
+  }
+
+  // Every pair for a sample of points, to check the answers and to time the naive way
+  int checked = (count < CHECKED_POINTS) ? count : CHECKED_POINTS;
+  int mismatches = 0;
+  clock_t start = clock();
+  for (int c = 0; c < checked; c++) {
+    int i = (int)((long long)c * count / checked);
+    int expected = 0;
+    for (int j = 0; j < count; j++) {
+      float dx = x[j] - x[i];
+      float dy = y[j] - y[i];
+      if (dx * dx + dy * dy <= RADIUS * RADIUS) expected++;
+    }
+    if (TR_SpatialHashQueryRadius(hash, x[i], y[i], RADIUS, results, MAX_RESULTS) != expected) mismatches++;
+  }
+  double pairs_ms = Milliseconds(clock() - start) / checked * count;
+
+  double queries = (double)count * ticks;
+  printf("%d points in a %.0fx%.0f world, %d ticks\n", count, size, size, ticks);
+  printf("  %-22s %10.3f ms/tick\n", "build", Milliseconds(build_time) / ticks);
+  printf("  %-22s %10.3f ms/tick %8.1f found/query\n", "radius query per point", Milliseconds(radius_time) / ticks, radius_found / queries);
+  printf("  %-22s %10.3f ms/tick %8.1f found/query\n", "rect query per point", Milliseconds(rect_time) / ticks, rect_found / queries);
+  printf("  %-22s %10.3f ms/tick %8.1f found/query\n", "point query per point", Milliseconds(point_time) / ticks, point_found / queries);
+  printf("  %-22s %10.3f ms/tick (estimated from %d points)\n", "every pair instead", pairs_ms, checked);
+  printf("  %d/%d checked queries disagreed with every-pair testing\n", mismatches, checked);
+
+  TR_SpatialHashDestroy(hash);
+  free(x);
+  free(y);
+  free(vx);
+  free(vy);
+}
+
+int main(int argc, char* argv[]) {
+  int count = 0;
+  int ticks = DEFAULT_TICKS;
+  if (argc > 3) {
+    fprintf(stderr, "Usage: %s [count [ticks]]\n", argv[0]);
+    return 1;
+  }
+  if (argc >= 2) count = atoi(argv[1]);
+  if (argc >= 3) ticks = atoi(argv[2]);
+  if ((argc >= 2 && (count < 1 || count > MAX_COUNT)) || ticks < 1) {
+    fprintf(stderr, "ERROR: The count must be between 1 and %d and there must be at least one tick.\n", MAX_COUNT);
+    return 1;
+  }
+
+  if (count > 0) {
+    RunCount(count, ticks);
+  } else {
+    RunCount(10000, ticks);
+    printf("\n");
+    RunCount(100000, ticks);
+  }
+  return 0;
+}
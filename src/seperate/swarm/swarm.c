@@ -0,0 +1,120 @@
+// swarm.c - Thousands of sprites bouncing around the terminal, kept in tread.h's
+//           TR_ENTITIES store. Shows how long the batch update and draw take.
+//
+// Usage: swarm [count]   (defaults to 5000 sprites)
+// Keys:  + / -: add or remove 1000 sprites   Space: pause   Q/ESC: quit
+
+#define TR_ENTITIES
+#include "../../tread.h"
+
+#include <time.h> // For time (to seed rand) and clock (to time the update and draw)
+
+// --- Configuration ---
+#define FPS 60
+#define DEFAULT_COUNT 5000
+#define MAX_COUNT 1000000
+#define BATCH 1000      // Sprites added or removed per key press
+#define MAX_SPEED 30.0f // Cells per second
+
+// --- Global State ---
+static TR_EntityStore* store = NULL;
+static TR_Entity* handles = NULL; // Every live sprite, in spawn order
+static int num_handles = 0;
+static bool paused = false;
+
+static float RandomFloat(float min, float max) {
+  return min + (max - min) * (float)rand() / (float)RAND_MAX;
+}
+
+// Adds sprites at random places with random velocities, colored by speed
+static void AddSprites(int count, int width, int height) {
+  static const char glyphs[] = { '*', 'o', '+', '.', '@' };
+  for (int i = 0; i < count && num_handles < MAX_COUNT; i++) {
+    float vx = RandomFloat(-MAX_SPEED, MAX_SPEED);
+    float vy = RandomFloat(-MAX_SPEED, MAX_SPEED) * 0.5f; // Cells are about twice as tall as wide
+    float speed = sqrtf(vx * vx + vy * vy * 4.0f);
+    Color color = (speed < MAX_SPEED * 0.4f) ? SKYBLUE : (speed < MAX_SPEED * 0.8f) ? LIME : (speed < MAX_SPEED * 1.1f) ? YELLOW : RED;
+    TR_Entity entity = TR_EntitySpawn(store, RandomFloat(0.0f, (float)width), RandomFloat(0.0f, (float)height), vx, vy,
+                                      glyphs[rand() % 5], color, BLANK);
+    if (entity == TR_ENTITY_NONE) break;
+    handles[num_handles++] = entity;
+  }
+}
+
+// Removes random sprites. Their handles go stale; the store moves other sprites into the holes.
+static void RemoveSprites(int count) {
+  for (int i = 0; i < count && num_handles > 0; i++) {
+    int pick = rand() % num_handles;
+    TR_EntityDespawn(store, handles[pick]);
+    handles[pick] = handles[--num_handles];
+  }
+}
+
+int main(int argc, char* argv[]) {
+  int count = DEFAULT_COUNT;
+  if (argc > 2) {
+    fprintf(stderr, "Usage: %s [count]\n", argv[0]);
+    return 1;
+  }
+  if (argc == 2) count = atoi(argv[1]);
+  if (count < 0 || count > MAX_COUNT) {
+    fprintf(stderr, "ERROR: The count must be between 0 and %d.\n", MAX_COUNT);
+    return 1;
+  }
+
+  store = TR_EntityStoreCreate(count);
+  handles = (TR_Entity*)malloc(sizeof(TR_Entity) * MAX_COUNT);
+  if (store == NULL || handles == NULL) {
+    fprintf(stderr, "ERROR: Failed to allocate %d sprites.\n", count);
+    return 1;
+  }
+  srand((unsigned int)TR_RegisterSeed((uint64_t)time(NULL)));
+
+  int width = TR_GetScreenWidth();
+  int height = TR_GetScreenHeight();
+  TR_InitWindow(width, height, "tread.h - Swarm");
+  TR_SetTargetFPS(FPS);
+
+  int field_height = height - 1; // Bottom row for the status bar
+  TR_EntitiesSetBounds(store, 0.0f, 0.0f, (float)width, (float)field_height, TR_ENTITY_BOUNDS_BOUNCE);
+  AddSprites(count, width, field_height);
+
+  double update_us = 0.0;
+  double draw_us = 0.0;
+  bool running = true;
+  while (running) {
+    TR_BeginDrawing();
+    TR_ClearBackground(BLACK);
+
+    switch (TR_GetKeyPressed()) {
+      case '+': case '=': AddSprites(BATCH, width, field_height); break;
+      case '-': case '_': RemoveSprites(BATCH); break;
+      case ' ': paused = !paused; break;
+      case 'q': case 'Q': case TR_KEY_ESCAPE: running = false; break;
+    }
+
+    // A fixed step keeps recorded sessions replaying the same way
+    clock_t start = clock();
+    if (!paused) TR_EntitiesUpdate(store, 1.0f / FPS);
+    clock_t updated = clock();
+    TR_EntitiesDraw(store, 0, 0, width, field_height, 0.0f, 0.0f);
+    clock_t drawn = clock();
+
+    // Smooth the timings so they can be read
+    update_us = update_us * 0.9 + (double)(updated - start) * 1e6 / CLOCKS_PER_SEC * 0.1;
+    draw_us = draw_us * 0.9 + (double)(drawn - updated) * 1e6 / CLOCKS_PER_SEC * 0.1;
+
+    char status[256];
+    snprintf(status, sizeof(status), " %d sprites | update %.0f us | draw %.0f us%s | +/-: %d more/fewer | Space: Pause | Q: Quit",
+             store->count, update_us, draw_us, paused ? " (paused)" : "", BATCH);
+    TR_DrawRectangle(0, height - 1, width, 1, BLACK, DARKGRAY);
+    TR_DrawText(status, 0, height - 1, 10, RAYWHITE, DARKGRAY);
+
+    TR_EndDrawing();
+  }
+
+  TR_CloseWindow();
+  TR_EntityStoreDestroy(store);
+  free(handles);
+  return 0;
+}
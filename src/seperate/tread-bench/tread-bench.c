@@ -0,0 +1,425 @@
+// tread-bench.c - End-to-end benchmark for tread.h apps. Runs one under a pseudo-terminal the
+//                 way a terminal would, types keys into it and reads everything it writes, so
+//                 the numbers include the kernel's TTY layer: bytes per frame, frames per
+//                 second and the latency from a key to the first byte of the frame that read
+//                 it. No real terminal is needed.
+//
+// Usage: tread-bench [options] -- command [arguments]
+//   -s columns rows  Terminal size (80 x 24)
+//   -t seconds       How long to measure (5)
+//   -w seconds       Warm-up before measuring (1)
+//   -i ms            Average time between keys (50), at random moments so they don't line
+//                    up with the app's frames; a key is only typed once the app has read the
+//                    one before, as tread.h reads one key per frame
+//   -k keys          Keys to type, in turn ("~", which most apps ignore)
+//   -q keys          Typed at the end to close the app ("q")
+//   -o file          Also writes the results as JSON, for comparing versions
+//
+// The app is run with TREAD_FRAME_MARKS set, which makes tread.h end every frame's output
+// with a marker terminals don't display: "ESC _ tread;<frame>;<keys read> ESC \". That's
+// how frames are counted and keys matched to the frame that read them. The markers aren't
+// counted in the bytes.
+
+#define _GNU_SOURCE // For posix_openpt, grantpt, unlockpt and ptsname in glibc
+#include "../../tread.h"
+
+#ifndef _WIN32
+  #include <poll.h>     // For poll
+  #include <sys/wait.h> // For waitpid
+#endif
+
+// --- Configuration ---
+#define DEFAULT_COLUMNS 80
+#define DEFAULT_ROWS 24
+#define DEFAULT_SECONDS 5.0
+#define DEFAULT_WARMUP_SECONDS 1.0
+#define DEFAULT_INTERVAL_MS 50.0
+#define START_TIMEOUT_NS 10000000000LL // The app has this long to draw its first frame
+#define KEY_TIMEOUT_NS 2000000000LL    // A key not read by then is counted as lost
+#define QUIT_TIMEOUT_NS 3000000000LL   // Then the app is killed
+#define READ_SIZE 65536
+
+#ifdef _WIN32
+
+int main() {
+  fprintf(stderr, "ERROR: tread-bench needs a POSIX system (it runs the app under a pseudo-terminal).\n");
+  return 1;
+}
+
+#else
+
+static const char marker_prefix[] = "\x1b_tread;";
+#define MARKER_PREFIX_LENGTH 8
+#define MAX_MARKER 48
+
+typedef struct {
+  double* values;
+  int count;
+  int capacity;
+} Samples;
+
+// Scans the app's output for frame markers
+typedef struct {
+  int matched;             // Bytes of marker_prefix seen so far
+  bool in_marker;
+  char marker[MAX_MARKER]; // The marker's "<frame>;<keys>" so far
+  int marker_length;
+  long long frame_first_ns; // When the current frame's first byte was read, 0 before it
+  long long frame_bytes;
+} Scanner;
+
+typedef struct {
+  // Settings
+  int columns;
+  int rows;
+  double seconds;
+  double warmup_seconds;
+  double interval_ms;
+  const char* keys;
+  const char* quit_keys;
+  // Timeline
+  long long warmup_end_ns;    // 0 until the first frame
+  long long measure_start_ns; // 0 until the warm-up is over
+  long long measure_end_ns;
+  long long last_frame_ns;
+  // Frames read inside the measuring window
+  unsigned long long frames;
+  unsigned long long frames_total; // Including warm-up
+  Samples frame_bytes;
+  Samples frame_intervals_ms;
+  // Keys
+  unsigned long long keys_read;    // As the latest marker says
+  unsigned long long key_expected; // keys_read the app reaches by reading the key in flight, 0 if none is
+  long long key_sent_ns;
+  long long next_key_ns;
+  int key_index;
+  int keys_sent;
+  int keys_lost;
+  Samples latencies_ms;
+} Bench;
+
+static bool AddSample(Samples* samples, double value) {
+  if (samples->count == samples->capacity) {
+    int capacity = (samples->capacity > 0) ? samples->capacity * 2 : 1024;
+    double* values = (double*)realloc(samples->values, sizeof(double) * (size_t)capacity);
+    if (values == NULL) return false;
+    samples->values = values;
+    samples->capacity = capacity;
+  }
+  samples->values[samples->count++] = value;
+  return true;
+}
+
+static int CompareDoubles(const void* a, const void* b) {
+  double x = *(const double*)a;
+  double y = *(const double*)b;
+  return (x > y) - (x < y);
+}
+
+static double Percentile(const Samples* samples, double percentile) {
+  if (samples->count == 0) return 0.0;
+  int index = (int)(percentile / 100.0 * (samples->count - 1) + 0.5);
+  return samples->values[index];
+}
+
+static double Mean(const Samples* samples) {
+  double sum = 0.0;
+  for (int i = 0; i < samples->count; i++) sum += samples->values[i];
+  return (samples->count > 0) ? sum / samples->count : 0.0;
+}
+
+static bool Measuring(const Bench* bench, long long now_ns) {
+  return bench->measure_start_ns != 0 && now_ns < bench->measure_end_ns;
+}
+
+// Counted from when the app read the last key, so keys don't fall into step with its frames
+static void ScheduleKey(Bench* bench, long long now_ns) {
+  double gap = bench->interval_ms * (0.5 + (double)rand() / RAND_MAX); // Half to one and a half intervals
+  bench->key_expected = 0;
+  bench->next_key_ns = now_ns + (long long)(gap * 1e6);
+}
+
+// A marker ended the frame: count it and match the keys it read to their latencies
+static void EndFrame(Bench* bench, Scanner* scanner, long long now_ns) {
+  unsigned long long keys = 0;
+  scanner->marker[scanner->marker_length] = '\0';
+  if (sscanf(scanner->marker, "%*u;%llu", &keys) != 1) return; // The frame's number isn't needed
+
+  bench->frames_total++;
+  if (bench->warmup_end_ns == 0) bench->warmup_end_ns = now_ns + (long long)(bench->warmup_seconds * 1e9);
+  if (bench->measure_start_ns == 0 && now_ns >= bench->warmup_end_ns) {
+    bench->measure_start_ns = now_ns;
+    bench->measure_end_ns = now_ns + (long long)(bench->seconds * 1e9);
+    bench->next_key_ns = now_ns;
+  }
+
+  if (Measuring(bench, now_ns)) {
+    if (bench->frames > 0) AddSample(&bench->frame_intervals_ms, (double)(now_ns - bench->last_frame_ns) / 1e6);
+    bench->frames++;
+    AddSample(&bench->frame_bytes, (double)scanner->frame_bytes);
+  }
+  bench->last_frame_ns = now_ns;
+
+  bench->keys_read = keys;
+  if (bench->key_expected != 0 && keys >= bench->key_expected) {
+    AddSample(&bench->latencies_ms, (double)(scanner->frame_first_ns - bench->key_sent_ns) / 1e6);
+    ScheduleKey(bench, now_ns);
+  }
+  scanner->frame_first_ns = 0;
+  scanner->frame_bytes = 0;
+}
+
+// Feeds bytes read from the app at `now_ns`
+static void Scan(Bench* bench, Scanner* scanner, const unsigned char* data, int length, long long now_ns) {
+  for (int i = 0; i < length; i++) {
+    unsigned char c = data[i];
+    if (scanner->frame_first_ns == 0) scanner->frame_first_ns = now_ns; // A frame with nothing to draw still has its marker
+    if (scanner->in_marker) {
+      if (c == '\x1b') continue;
+      if (c == '\\') {
+        scanner->in_marker = false;
+        EndFrame(bench, scanner, now_ns);
+      } else if (scanner->marker_length < MAX_MARKER - 1) {
+        scanner->marker[scanner->marker_length++] = (char)c;
+      }
+      continue;
+    }
+    if (c == (unsigned char)marker_prefix[scanner->matched]) {
+      if (++scanner->matched == MARKER_PREFIX_LENGTH) {
+        scanner->in_marker = true;
+        scanner->marker_length = 0;
+        scanner->matched = 0;
+      }
+      continue;
+    }
+    scanner->frame_bytes += scanner->matched; // A false start: those bytes were the frame's
+    scanner->matched = (c == '\x1b') ? 1 : 0;
+    if (scanner->matched == 0) scanner->frame_bytes++;
+  }
+}
+
+// Starts `argv` on a new pseudo-terminal of the given size. Returns the master side.
+static int Spawn(char* const argv[], int columns, int rows, pid_t* pid) {
+  int master = posix_openpt(O_RDWR | O_NOCTTY);
+  if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) return -1;
+  const char* slave_name = ptsname(master);
+  if (slave_name == NULL) return -1;
+  struct winsize size = { (unsigned short)rows, (unsigned short)columns, 0, 0 };
+
+  *pid = fork();
+  if (*pid < 0) return -1;
+  if (*pid == 0) {
+    setsid(); // A session of its own, with the pseudo-terminal as its terminal
+    int slave = open(slave_name, O_RDWR);
+    if (slave < 0) _exit(127);
+#ifdef TIOCSCTTY
+    ioctl(slave, TIOCSCTTY, 0);
+#endif
+    ioctl(slave, TIOCSWINSZ, &size);
+    dup2(slave, STDIN_FILENO);
+    dup2(slave, STDOUT_FILENO);
+    dup2(slave, STDERR_FILENO);
+    if (slave > STDERR_FILENO) close(slave);
+    close(master);
+    setenv("TREAD_FRAME_MARKS", "1", 1);
+    if (getenv("TERM") == NULL) setenv("TERM", "xterm-256color", 1);
+    execvp(argv[0], argv);
+    fprintf(stderr, "ERROR: Could not run '%s'.\n", argv[0]);
+    _exit(127);
+  }
+  fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+  return master;
+}
+
+// Types the next key once the app has read the last one and the interval has passed
+static void TypeKey(Bench* bench, int master, long long now_ns) {
+  if (bench->key_expected != 0) {
+    if (now_ns - bench->key_sent_ns < KEY_TIMEOUT_NS) return;
+    bench->keys_lost++; // Never read (keys typed together get read as one)
+    ScheduleKey(bench, now_ns);
+  }
+  if (!Measuring(bench, now_ns) || now_ns < bench->next_key_ns || bench->keys[0] == '\0') return;
+  char key = bench->keys[bench->key_index];
+  if (write(master, &key, 1) != 1) return;
+  bench->key_index = (bench->keys[bench->key_index + 1] != '\0') ? bench->key_index + 1 : 0;
+  bench->key_sent_ns = now_ns;
+  bench->key_expected = bench->keys_read + 1;
+  bench->keys_sent++;
+}
+
+static void PrintJsonString(FILE* file, const char* text) {
+  fputc('"', file);
+  for (const char* c = text; *c != '\0'; c++) {
+    if (*c == '"' || *c == '\\') fprintf(file, "\\%c", *c);
+    else if ((unsigned char)*c < 0x20) fprintf(file, "\\u%04x", (unsigned char)*c);
+    else fputc(*c, file);
+  }
+  fputc('"', file);
+}
+
+static void PrintJsonSamples(FILE* file, const char* name, const Samples* samples, bool last) {
+  fprintf(file, "  \"%s\": {\"count\": %d, \"mean\": %.4f, \"min\": %.4f, \"p50\": %.4f, \"p90\": %.4f, \"p99\": %.4f, \"max\": %.4f}%s\n",
+          name, samples->count, Mean(samples), Percentile(samples, 0.0), Percentile(samples, 50.0), Percentile(samples, 90.0),
+          Percentile(samples, 99.0), Percentile(samples, 100.0), last ? "" : ",");
+}
+
+static bool WriteJson(const Bench* bench, const char* path, char* const command[], int exit_status) {
+  FILE* file = fopen(path, "w");
+  if (file == NULL) return false;
+  double seconds = (double)(bench->measure_end_ns - bench->measure_start_ns) / 1e9;
+  double bytes = 0.0;
+  for (int i = 0; i < bench->frame_bytes.count; i++) bytes += bench->frame_bytes.values[i];
+  fprintf(file, "{\n  \"command\": [");
+  for (int i = 0; command[i] != NULL; i++) {
+    if (i > 0) fprintf(file, ", ");
+    PrintJsonString(file, command[i]);
+  }
+  fprintf(file, "],\n");
+  fprintf(file, "  \"columns\": %d,\n  \"rows\": %d,\n  \"seconds\": %.3f,\n  \"warmup_seconds\": %.3f,\n",
+          bench->columns, bench->rows, seconds, bench->warmup_seconds);
+  fprintf(file, "  \"frames\": %llu,\n  \"frames_per_second\": %.3f,\n", bench->frames, bench->frames / seconds);
+  fprintf(file, "  \"bytes\": %.0f,\n  \"bytes_per_second\": %.1f,\n", bytes, bytes / seconds);
+  PrintJsonSamples(file, "bytes_per_frame", &bench->frame_bytes, false);
+  PrintJsonSamples(file, "frame_interval_ms", &bench->frame_intervals_ms, false);
+  fprintf(file, "  \"keys_sent\": %d,\n  \"keys_lost\": %d,\n", bench->keys_sent, bench->keys_lost);
+  PrintJsonSamples(file, "key_latency_ms", &bench->latencies_ms, false);
+  fprintf(file, "  \"exit_status\": %d\n}\n", exit_status);
+  return fclose(file) == 0;
+}
+
+static void PrintUsage(const char* program) {
+  fprintf(stderr, "Usage: %s [-s columns rows] [-t seconds] [-w seconds] [-i ms] [-k keys] [-q keys] [-o file.json] -- command [arguments]\n", program);
+}
+
+int main(int argc, char* argv[]) {
+  Bench bench = {0};
+  bench.columns = DEFAULT_COLUMNS;
+  bench.rows = DEFAULT_ROWS;
+  bench.seconds = DEFAULT_SECONDS;
+  bench.warmup_seconds = DEFAULT_WARMUP_SECONDS;
+  bench.interval_ms = DEFAULT_INTERVAL_MS;
+  bench.keys = "~";
+  bench.quit_keys = "q";
+  const char* json_path = NULL;
+
+  int arg = 1;
+  for (; arg < argc && strcmp(argv[arg], "--") != 0; arg++) {
+    bool has_value = arg + 1 < argc;
+    if (strcmp(argv[arg], "-s") == 0 && arg + 2 < argc) {
+      bench.columns = atoi(argv[++arg]);
+      bench.rows = atoi(argv[++arg]);
+    } else if (strcmp(argv[arg], "-t") == 0 && has_value) {
+      bench.seconds = atof(argv[++arg]);
+    } else if (strcmp(argv[arg], "-w") == 0 && has_value) {
+      bench.warmup_seconds = atof(argv[++arg]);
+    } else if (strcmp(argv[arg], "-i") == 0 && has_value) {
+      bench.interval_ms = atof(argv[++arg]);
+    } else if (strcmp(argv[arg], "-k") == 0 && has_value) {
+      bench.keys = argv[++arg];
+    } else if (strcmp(argv[arg], "-q") == 0 && has_value) {
+      bench.quit_keys = argv[++arg];
+    } else if (strcmp(argv[arg], "-o") == 0 && has_value) {
+      json_path = argv[++arg];
+    } else {
+      break;
+    }
+  }
+  if (arg + 1 >= argc || strcmp(argv[arg], "--") != 0 || bench.columns < 1 || bench.columns > 1000 || bench.rows < 1 ||
+      bench.rows > 1000 || bench.seconds <= 0.0 || bench.warmup_seconds < 0.0 || bench.interval_ms < 0.0) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+  char** command = &argv[arg + 1];
+
+  srand(1); // The same key times every run
+  signal(SIGPIPE, SIG_IGN);
+  pid_t pid;
+  int master = Spawn(command, bench.columns, bench.rows, &pid);
+  if (master < 0) {
+    fprintf(stderr, "ERROR: Could not start '%s' on a pseudo-terminal.\n", command[0]);
+    return 1;
+  }
+  fprintf(stderr, "tread-bench: %s at %dx%d, %.1f s warm-up, %.1f s measured\n", command[0], bench.columns, bench.rows,
+          bench.warmup_seconds, bench.seconds);
+
+  Scanner scanner = {0};
+  unsigned char* buffer = (unsigned char*)malloc(READ_SIZE);
+  long long start_ns = __tr_get_time_ns();
+  long long quit_ns = 0; // When the quit keys were typed
+  bool open = true;
+  while (open && buffer != NULL) {
+    long long now_ns = __tr_get_time_ns();
+    if (bench.warmup_end_ns == 0 && now_ns - start_ns > START_TIMEOUT_NS) break; // Never drew a frame
+    if (quit_ns == 0 && bench.measure_start_ns != 0 && now_ns >= bench.measure_end_ns) {
+      quit_ns = now_ns;
+      if (write(master, bench.quit_keys, strlen(bench.quit_keys)) < 0) break;
+    }
+    if (quit_ns != 0 && now_ns - quit_ns > QUIT_TIMEOUT_NS) break;
+    if (quit_ns == 0) TypeKey(&bench, master, now_ns);
+
+    // Wake for output, or in time for the next key
+    int timeout_ms = 10;
+    if (bench.key_expected == 0 && Measuring(&bench, now_ns) && bench.next_key_ns > now_ns) {
+      long long until_key_ms = (bench.next_key_ns - now_ns + 999999LL) / 1000000LL;
+      if (until_key_ms < timeout_ms) timeout_ms = (int)until_key_ms;
+    }
+    struct pollfd poll_fd = { master, POLLIN, 0 };
+    if (poll(&poll_fd, 1, timeout_ms) <= 0) continue;
+    for (;;) {
+      ssize_t length = read(master, buffer, READ_SIZE);
+      if (length > 0) {
+        Scan(&bench, &scanner, buffer, (int)length, __tr_get_time_ns());
+      } else {
+        if (length == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) open = false; // EIO once the app is gone
+        break;
+      }
+    }
+  }
+  free(buffer);
+
+  // Close the app if it didn't close by itself
+  int status = 0;
+  if (waitpid(pid, &status, WNOHANG) == 0) {
+    kill(pid, SIGTERM);
+    long long kill_ns = __tr_get_time_ns();
+    while (waitpid(pid, &status, WNOHANG) == 0) {
+      if (__tr_get_time_ns() - kill_ns > 1000000000LL) {
+        kill(pid, SIGKILL);
+        waitpid(pid, &status, 0);
+        break;
+      }
+      struct timespec pause = { 0, 10000000L };
+      nanosleep(&pause, NULL);
+    }
+  }
+  close(master);
+  int exit_status = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+
+  if (bench.frames == 0) {
+    fprintf(stderr, "ERROR: No frames were measured. Is '%s' a tread.h app built with this tread.h?%s\n", command[0],
+            (bench.frames_total > 0) ? " (It closed during the warm-up.)" : "");
+    return 1;
+  }
+  if (quit_ns == 0) bench.measure_end_ns = bench.last_frame_ns; // Closed by itself early
+
+  qsort(bench.frame_bytes.values, (size_t)bench.frame_bytes.count, sizeof(double), CompareDoubles);
+  qsort(bench.frame_intervals_ms.values, (size_t)bench.frame_intervals_ms.count, sizeof(double), CompareDoubles);
+  qsort(bench.latencies_ms.values, (size_t)bench.latencies_ms.count, sizeof(double), CompareDoubles);
+  double seconds = (double)(bench.measure_end_ns - bench.measure_start_ns) / 1e9;
+  double bytes = Mean(&bench.frame_bytes) * bench.frame_bytes.count;
+  printf("frames:        %llu in %.2f s, %.1f frames/s\n", bench.frames, seconds, bench.frames / seconds);
+  printf("bytes/frame:   mean %.0f, p50 %.0f, p99 %.0f, max %.0f (%.1f KB/s)\n", Mean(&bench.frame_bytes),
+         Percentile(&bench.frame_bytes, 50.0), Percentile(&bench.frame_bytes, 99.0), Percentile(&bench.frame_bytes, 100.0), bytes / 1024.0 / seconds);
+  printf("frame gap ms:  p50 %.3f, p99 %.3f, max %.3f\n", Percentile(&bench.frame_intervals_ms, 50.0),
+         Percentile(&bench.frame_intervals_ms, 99.0), Percentile(&bench.frame_intervals_ms, 100.0));
+  printf("key latency:   %d keys (%d lost), ms: min %.3f, p50 %.3f, p90 %.3f, p99 %.3f, max %.3f\n", bench.keys_sent, bench.keys_lost,
+         Percentile(&bench.latencies_ms, 0.0), Percentile(&bench.latencies_ms, 50.0), Percentile(&bench.latencies_ms, 90.0),
+         Percentile(&bench.latencies_ms, 99.0), Percentile(&bench.latencies_ms, 100.0));
+  if (json_path != NULL && !WriteJson(&bench, json_path, command, exit_status)) {
+    fprintf(stderr, "ERROR: Could not write '%s'.\n", json_path);
+    return 1;
+  }
+  return 0;
+}
+
+#endif // _WIN32
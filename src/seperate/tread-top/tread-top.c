@@ -0,0 +1,214 @@
+// tread-top.c - Watches a running tread.h app from another terminal through the inspector's
+//               shared memory (TR_INSPECT, or any app run with TREAD_INSPECT set): frames
+//               per second, bytes per second, a histogram of its last frame times and a
+//               mirror of its screen. Attaches read-only; the app never waits for it.
+//
+// Usage: tread-top [name]   (the name defaults to $TREAD_INSPECT; on Linux, with neither,
+//                            it lists the apps publishing)
+// Keys:  M: mirror on/off   Q/ESC: quit
+
+#define TR_INSPECT
+#include "../../tread.h"
+
+#ifdef __linux__
+  #include <dirent.h> // For listing /dev/shm
+#endif
+
+// --- Configuration ---
+#define FPS 20
+#define RATE_INTERVAL_NS 500000000LL // How often the per-second numbers are worked out
+#define HISTOGRAM_ROWS 9
+#define IDLE_NS 2000000000LL         // No frame for this long and the app is shown as idle
+
+// Upper bounds of the histogram's rows, in milliseconds (the last row takes the rest)
+static const double bucket_limits[HISTOGRAM_ROWS - 1] = { 0.5, 1.0, 2.0, 4.0, 8.0, 16.7, 33.3, 66.7 };
+
+static int ListApps() {
+#ifdef __linux__
+  DIR* dir = opendir("/dev/shm");
+  int found = 0;
+  if (dir != NULL) {
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+      if (strncmp(entry->d_name, "tread-", 6) != 0) continue;
+      TR_Inspector* inspector = TR_InspectAttach(entry->d_name + 6);
+      if (inspector == NULL) continue;
+      TR_InspectHeader header;
+      if (TR_InspectRead(inspector, &header, NULL)) {
+        printf("%-24s pid %-8lld %dx%d, %llu frames%s\n", header.name, (long long)header.pid, header.width, header.height,
+               header.stats.frames, TR_InspectAlive(&header) ? "" : " (gone)");
+        found++;
+      }
+      TR_InspectDetach(inspector);
+    }
+    closedir(dir);
+  }
+  if (found == 0) printf("No tread.h apps are publishing. Run one with TREAD_INSPECT=<name>.\n");
+  return 0;
+#else
+  fprintf(stderr, "Usage: tread-top [name]   (the name defaults to $TREAD_INSPECT)\n");
+  return 1;
+#endif
+}
+
+static int CompareFloats(const void* a, const void* b) {
+  float x = *(const float*)a;
+  float y = *(const float*)b;
+  return (x > y) - (x < y);
+}
+
+// Draws the histogram of the last frame times at (x, y)
+static void DrawHistogram(const TR_InspectHeader* header, int x, int y, int width) {
+  int count = (header->stats.frames < TR_INSPECT_TIMINGS) ? (int)header->stats.frames : TR_INSPECT_TIMINGS;
+  int buckets[HISTOGRAM_ROWS] = {0};
+  float sorted[TR_INSPECT_TIMINGS];
+  for (int i = 0; i < count; i++) {
+    float ms = header->frame_ms[i];
+    int bucket = 0;
+    while (bucket < HISTOGRAM_ROWS - 1 && ms >= bucket_limits[bucket]) bucket++;
+    buckets[bucket]++;
+    sorted[i] = ms;
+  }
+  int most = 1;
+  for (int i = 0; i < HISTOGRAM_ROWS; i++) if (buckets[i] > most) most = buckets[i];
+
+  char line[128];
+  if (count > 0) {
+    qsort(sorted, (size_t)count, sizeof(float), CompareFloats);
+    snprintf(line, sizeof(line), "Last %d frames: p50 %.2f ms, p90 %.2f ms, p99 %.2f ms, max %.2f ms", count,
+             sorted[count / 2], sorted[count * 9 / 10], sorted[count * 99 / 100], sorted[count - 1]);
+  } else {
+    snprintf(line, sizeof(line), "No frames yet");
+  }
+  TR_DrawText(line, x, y, 10, RAYWHITE, BLANK);
+
+  int bar_width = width - 24;
+  for (int i = 0; i < HISTOGRAM_ROWS; i++) {
+    bool last = (i == HISTOGRAM_ROWS - 1);
+    snprintf(line, sizeof(line), "%8s%5.1f ms %5d ", last ? ">=" : "<", bucket_limits[last ? i - 1 : i], buckets[i]);
+    TR_DrawText(line, x, y + 1 + i, 10, LIGHTGRAY, BLANK);
+    int length = (bar_width > 0) ? buckets[i] * bar_width / most : 0;
+    if (buckets[i] > 0 && length == 0) length = 1;
+    Color color = (i < 6) ? GREEN : (i < 7) ? YELLOW : RED; // Slower than 60 FPS is yellow, slower than 30 red
+    TR_DrawRectangle(x + 24, y + 1 + i, length, 1, color, color);
+  }
+}
+
+// Draws the app's screen into the rectangle, taking every n-th cell when it doesn't fit
+static void DrawMirror(const TR_InspectHeader* header, const __TR_Cell* cells, int x, int y, int width, int height) {
+  if (width <= 0 || height <= 0) return;
+  int mirror_width = (header->width < width) ? header->width : width;
+  int mirror_height = (header->height < height) ? header->height : height;
+  for (int row = 0; row < mirror_height; row++) {
+    int source_y = row * header->height / mirror_height;
+    for (int column = 0; column < mirror_width; column++) {
+      __TR_Cell cell = cells[source_y * header->width + column * header->width / mirror_width];
+      if (cell.character == TR_GLYPH_BRAILLE) {
+        TR_DrawBraille(x + column, y + row, cell.dots, cell.fg_color, cell.bg_color);
+      } else {
+        char text[2] = { (cell.character != '\0') ? cell.character : ' ', '\0' };
+        TR_DrawText(text, x + column, y + row, 10, cell.fg_color, cell.bg_color);
+      }
+    }
+  }
+}
+
+int main(int argc, char* argv[]) {
+  char name[TR_INSPECT_NAME_SIZE];
+  const char* env_name = getenv("TREAD_INSPECT");
+  const char* requested = (argc >= 2) ? argv[1] : env_name;
+  if (argc > 2 || (requested != NULL && requested[0] == '-')) {
+    fprintf(stderr, "Usage: %s [name]   (the name defaults to $TREAD_INSPECT)\n", argv[0]);
+    return 1;
+  }
+  if (requested == NULL || requested[0] == '\0') return ListApps();
+  snprintf(name, sizeof(name), "%s", requested);
+
+  TR_Inspector* inspector = TR_InspectAttach(name);
+  if (inspector == NULL) {
+    fprintf(stderr, "ERROR: No tread.h app is publishing as '%s' (or it was built with a different tread.h).\n", name);
+    return 1;
+  }
+  TR_InspectHeader header;
+  __TR_Cell* cells = (__TR_Cell*)malloc(sizeof(__TR_Cell) * (size_t)inspector->header->width * (size_t)inspector->header->height);
+  if (cells == NULL || !TR_InspectRead(inspector, &header, cells)) {
+    fprintf(stderr, "ERROR: Could not read '%s'.\n", name);
+    TR_InspectDetach(inspector);
+    free(cells);
+    return 1;
+  }
+
+  // tread-top is a tread.h app too: don't let it try to publish under the name it's watching
+  if (env_name != NULL) {
+#ifdef _WIN32
+    _putenv("TREAD_INSPECT=");
+#else
+    unsetenv("TREAD_INSPECT");
+#endif
+  }
+
+  int width = TR_GetScreenWidth();
+  int height = TR_GetScreenHeight();
+  TR_InitWindow(width, height, "tread.h - tread-top");
+  TR_SetTargetFPS(FPS);
+
+  TR_FrameStats rate_start = header.stats;
+  long long rate_start_ns = __tr_get_time_ns();
+  double fps = 0.0;
+  double kb_per_second = 0.0;
+  double cells_per_second = 0.0;
+  bool mirror = true;
+  bool alive = true;
+  bool running = true;
+  while (running) {
+    switch (TR_GetKeyPressed()) {
+      case 'm': case 'M': mirror = !mirror; break;
+      case 'q': case 'Q': case TR_KEY_ESCAPE: running = false; break;
+    }
+
+    long long now_ns = __tr_get_time_ns();
+    if (alive) {
+      TR_InspectRead(inspector, &header, cells);
+      alive = TR_InspectAlive(&header);
+    }
+    if (now_ns - rate_start_ns >= RATE_INTERVAL_NS) {
+      double seconds = (double)(now_ns - rate_start_ns) / 1e9;
+      fps = (double)(header.stats.frames - rate_start.frames) / seconds;
+      kb_per_second = (double)(header.stats.bytes_written - rate_start.bytes_written) / 1024.0 / seconds;
+      cells_per_second = (double)(header.stats.cells_written - rate_start.cells_written) / seconds;
+      rate_start = header.stats;
+      rate_start_ns = now_ns;
+    }
+
+    TR_BeginDrawing();
+    TR_ClearBackground(BLACK);
+
+    const char* state = !alive ? "gone" : (now_ns - header.updated_ns > IDLE_NS) ? "idle" : "running";
+    char line[256];
+    snprintf(line, sizeof(line), " tread-top | %s | pid %lld | %dx%d | %s | frame %llu | publishing %.1f us/frame | M: Mirror | Q: Quit",
+             header.name, (long long)header.pid, header.width, header.height, state, header.stats.frames, header.publish_ns / 1e3);
+    TR_DrawRectangle(0, 0, width, 1, BLACK, DARKGRAY);
+    TR_DrawText(line, 0, 0, 10, RAYWHITE, DARKGRAY);
+
+    double average_ms = (header.stats.frames > 0) ? header.stats.total_frame_ms / (double)header.stats.frames : 0.0;
+    snprintf(line, sizeof(line), "%.1f FPS | %.1f KB/s | %.0f cells/s | %.2f ms/frame average, %.2f ms slowest | %.1f MB written in all",
+             fps, kb_per_second, cells_per_second, average_ms, header.stats.max_frame_ms, (double)header.stats.bytes_written / (1024.0 * 1024.0));
+    TR_DrawText(line, 1, 2, 10, alive ? GREEN : RED, BLANK);
+
+    DrawHistogram(&header, 1, 4, width - 2);
+
+    int mirror_y = 5 + HISTOGRAM_ROWS;
+    if (mirror) {
+      TR_DrawRectangle(0, mirror_y, width, 1, DARKGRAY, BLACK);
+      TR_DrawText("-- screen --", 1, mirror_y, 10, GRAY, BLACK);
+      DrawMirror(&header, cells, 0, mirror_y + 1, width, height - mirror_y - 1);
+    }
+
+    TR_EndDrawing();
+  }
+
+  TR_CloseWindow();
+  TR_InspectDetach(inspector);
+  free(cells);
+  return 0;
+}
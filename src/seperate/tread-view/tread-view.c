@@ -0,0 +1,141 @@
+// tread-view.c - Watches a tread.h app that streams its frames (TR_STREAM, or any app run with
+//                TREAD_STREAM set) from another terminal. Any number of viewers can watch the
+//                same app; each gets the changes since the frame it last took in, encoded for
+//                its own terminal's colors and size.
+//
+// Usage: tread-view [address] [-c none|8|256|true]
+// The address defaults to $TREAD_STREAM; colors are guessed from $COLORTERM and $TERM.
+// Keys:  Q/ESC: quit
+
+#define TR_STREAM
+#include "../../tread.h"
+
+// --- Configuration ---
+#define WAIT_MS 20 // How long to wait for a frame before checking the keys and terminal size
+
+static int GuessColors() {
+  const char* colorterm = getenv("COLORTERM");
+  const char* term = getenv("TERM");
+  if (colorterm != NULL && (strstr(colorterm, "truecolor") != NULL || strstr(colorterm, "24bit") != NULL)) return TR_STREAM_COLORS_TRUE;
+  if (term != NULL && strstr(term, "256color") != NULL) return TR_STREAM_COLORS_256;
+  if (term != NULL && strcmp(term, "dumb") == 0) return TR_STREAM_COLORS_NONE;
+  return TR_STREAM_COLORS_8;
+}
+
+static int ParseColors(const char* name) {
+  if (strcmp(name, "none") == 0) return TR_STREAM_COLORS_NONE;
+  if (strcmp(name, "8") == 0) return TR_STREAM_COLORS_8;
+  if (strcmp(name, "256") == 0) return TR_STREAM_COLORS_256;
+  if (strcmp(name, "true") == 0) return TR_STREAM_COLORS_TRUE;
+  return -1;
+}
+
+// Sends the terminal's size, after the color mode when it's the hello
+static void SendSize(TR_NetConn* conn, unsigned char type, int colors, int width, int height) {
+  unsigned char message[16];
+  int length = 0;
+  if (type == TR_STREAM_MSG_HELLO) length += TR_NetPutVarint(message + length, (uint32_t)colors);
+  length += TR_NetPutVarint(message + length, (uint32_t)width);
+  length += TR_NetPutVarint(message + length, (uint32_t)height);
+  TR_NetSend(conn, type, message, length);
+}
+
+// The app's output is ANSI sequences and UTF-8, so the terminal has to understand both
+static void SetViewerMode(bool viewing) {
+#ifdef _WIN32
+  static DWORD original_out_mode;
+  static UINT original_code_page;
+  __tr_h_stdout = GetStdHandle(STD_OUTPUT_HANDLE);
+  __tr_h_stdin = GetStdHandle(STD_INPUT_HANDLE);
+  if (viewing) {
+    GetConsoleMode(__tr_h_stdout, &original_out_mode);
+    GetConsoleMode(__tr_h_stdin, &__tr_original_in_mode);
+    original_code_page = GetConsoleOutputCP();
+    SetConsoleMode(__tr_h_stdout, original_out_mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+    SetConsoleMode(__tr_h_stdin, __tr_original_in_mode & ~(ENABLE_LINE_INPUT | ENABLE_ECHO_INPUT));
+    SetConsoleOutputCP(CP_UTF8);
+  } else {
+    SetConsoleOutputCP(original_code_page);
+    SetConsoleMode(__tr_h_stdout, original_out_mode);
+    SetConsoleMode(__tr_h_stdin, __tr_original_in_mode);
+  }
+#else
+  if (viewing) __tr_set_raw_mode();
+  else __tr_restore_terminal_mode();
+#endif
+  if (viewing) {
+    printf("\x1b[0m\x1b[2J\x1b[?25l"); // Blank, cursor hidden
+  } else {
+    printf("\x1b[0m\x1b[2J\x1b[H\x1b[?25h");
+  }
+  fflush(stdout);
+}
+
+int main(int argc, char* argv[]) {
+  const char* address = getenv("TREAD_STREAM");
+  int colors = GuessColors();
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-c") == 0 && i + 1 < argc && ParseColors(argv[i + 1]) >= 0) {
+      colors = ParseColors(argv[++i]);
+    } else if (argv[i][0] != '-') {
+      address = argv[i];
+    } else {
+      address = NULL;
+      break;
+    }
+  }
+  if (address == NULL || address[0] == '\0') {
+    fprintf(stderr, "Usage: %s [address] [-c none|8|256|true]   (the address defaults to $TREAD_STREAM)\n", argv[0]);
+    return 1;
+  }
+
+  TR_NetConn* conn = TR_NetConnect(address);
+  if (conn == NULL) {
+    fprintf(stderr, "ERROR: Could not connect to '%s'.\n", address);
+    return 1;
+  }
+  SetViewerMode(true);
+  int width = TR_GetScreenWidth();
+  int height = TR_GetScreenHeight();
+  SendSize(conn, TR_STREAM_MSG_HELLO, colors, width, height);
+
+  unsigned long long frames = 0;
+  long long start_ns = __tr_get_time_ns();
+  bool quit = false;
+  while (!quit && !conn->closed) {
+    TR_NetFlush(conn);
+    TR_NetWait(TR_NET_INVALID_SOCKET, &conn, 1, WAIT_MS);
+
+    unsigned char type;
+    const unsigned char* data;
+    int length;
+    while (TR_NetReceive(conn, &type, &data, &length)) {
+      if (type != TR_STREAM_MSG_OUTPUT) continue;
+      fwrite(data, 1, (size_t)length, stdout);
+      frames++;
+    }
+    fflush(stdout);
+
+    int key;
+    while ((key = __tr_get_key_nonblocking()) != 0) {
+      if (key == 'q' || key == 'Q' || key == TR_KEY_ESCAPE) quit = true;
+    }
+    int new_width = TR_GetScreenWidth();
+    int new_height = TR_GetScreenHeight();
+    if (new_width != width || new_height != height) {
+      width = new_width;
+      height = new_height;
+      SendSize(conn, TR_STREAM_MSG_SIZE, colors, width, height); // The app redraws everything
+    }
+  }
+
+  bool ended = conn->closed;
+  double seconds = (double)(__tr_get_time_ns() - start_ns) / 1e9;
+  unsigned long long bytes_received = conn->bytes_received;
+  TR_NetClose(conn);
+  SetViewerMode(false);
+  if (ended) printf("tread-view: the stream at %s ended.\n", address);
+  printf("tread-view: %llu frames, %.1f KB in %.1f s (%.1f frames/s, %.1f KB/s)\n", frames, (double)bytes_received / 1024.0,
+         seconds, (seconds > 0.0) ? (double)frames / seconds : 0.0, (seconds > 0.0) ? (double)bytes_received / 1024.0 / seconds : 0.0);
+  return 0;
+}
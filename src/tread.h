@@ -21,6 +21,7 @@
 // - Drawing functions now accept an optional background color (use BLANK for transparency).
 // - IMPORTANT: Ctrl+C (SIGINT) is now disabled by default when TR_InitWindow is called.
 //   Applications must provide an alternative way to exit (e.g., 'q' or ESC key).
+// - Input can be recorded and replayed frame for frame (TREAD_RECORD / TREAD_REPLAY).
 
 #ifndef TREAD_H
 #define TREAD_H
@@ -31,15 +32,29 @@
 #include <stdbool.h> // For bool type
 #include <errno.h>   // For errno in nanosleep
 #include <math.h>  // For sin, cos, tan (for 3D math)
+#include <stdint.h>  // For uint64_t (recorded seeds)
 
 // Define M_PI if not already defined (common in math.h but not guaranteed)
 #ifndef M_PI
   #define M_PI 3.14159265358979323846
 #endif
 
+// Frame streaming runs on the networking module
+#if defined(TR_STREAM) && !defined(TR_NET)
+  #define TR_NET
+#endif
+
 // --- Platform-Specific Includes and Definitions ---
 
 #ifdef _WIN32
+  #ifdef TR_NET
+    #if !defined(_WIN32_WINNT) || _WIN32_WINNT < 0x0600
+      #undef _WIN32_WINNT
+      #define _WIN32_WINNT 0x0600 // Vista, for WSAPoll
+    #endif
+    #include <winsock2.h> // Sockets for TR_NET (must come before windows.h)
+    #include <ws2tcpip.h> // For getaddrinfo
+  #endif
   #include <windows.h> // Windows API for console manipulation
   #include <conio.h>   // For _kbhit, _getch (non-blocking input)
 #else
@@ -67,17 +82,41 @@ typedef struct {
   char character;
   Color fg_color;
   Color bg_color;
+  unsigned char dots; // Raised dots when character is TR_GLYPH_BRAILLE
 } __TR_Cell;
 
+// Frame statistics gathered by TR_EndDrawing since the window was opened
+typedef struct {
+  unsigned long long frames;        // Frames presented with TR_EndDrawing
+  unsigned long long cells_written; // Cells that changed and were redrawn
+  unsigned long long bytes_written; // Bytes printed for them, escape codes included (on Windows, where colors
+                                    // and cursor moves are console calls, just the characters)
+  double total_frame_ms;            // Time from TR_BeginDrawing to the end of output, summed (excludes the FPS sleep)
+  double max_frame_ms;              // Slowest frame
+} TR_FrameStats;
+
 // --- Function Prototypes (to resolve C99 implicit declaration errors) ---
 static inline int TR_GetScreenWidth();
 static inline int TR_GetScreenHeight();
+#ifdef TR_STREAM
+static inline void __tr_stream_check_env();
+static inline void __tr_stream_frame();
+static inline void TR_StreamStop();
+#endif
+#ifdef TR_INSPECT
+static inline void __tr_inspect_check_env();
+static inline void __tr_inspect_frame(double frame_ms);
+static inline void TR_InspectStop();
+#endif
 
 // --- Global State and Configuration ---
 
 static bool __tr_window_open = false;
 static long long __tr_frame_time_us = 0; // Target frame time in microseconds
 static int __tr_key_buffer = 0;     // Stores the last key pressed
+static TR_FrameStats __tr_frame_stats = {0}; // Reset by TR_InitWindow
+static bool __tr_frame_marks = false;         // TREAD_FRAME_MARKS: end each frame's output with a marker
+static unsigned long long __tr_keys_read = 0; // Keys the frames have taken in, for the markers
 
 // Double buffering related globals
 static __TR_Cell* __tr_screen_buffer = NULL;    // Current frame buffer
@@ -141,6 +180,16 @@ static int __tr_z_buffer_size = 0;
 #define MAGENTA    (Color){ 255, 0, 255, 255 }
 #define CYAN       (Color){ 0, 255, 255, 255 }
 
+// --- Special Glyphs ---
+// Cell characters that aren't plain ASCII. The renderer prints the real glyph for them.
+#define TR_GLYPH_UPPER_HALF '\x01' // The top half of the cell in fg_color, the bottom half in bg_color
+#define TR_GLYPH_BRAILLE '\x02'    // A 2x4 braille pattern of the cell's dots, in fg_color
+#ifdef _WIN32
+  #define __TR_UPPER_HALF_TEXT "\xDF"         // In the console's default code page (437)
+#else
+  #define __TR_UPPER_HALF_TEXT "\xE2\x96\x80" // UTF-8
+#endif
+
 // --- Custom Key Codes for Special Keys (to avoid multi-character literals) ---
 // These are arbitrary integer values chosen to not conflict with ASCII characters.
 #define TR_KEY_UP     256
@@ -222,13 +271,14 @@ static BOOL WINAPI __tr_ctrl_c_handler(DWORD dwCtrlType) {
 }
 
 // Sets cursor position on Windows console
-static inline void __tr_set_cursor_position(int x, int y) {
+static inline int __tr_set_cursor_position(int x, int y) {
   COORD coord = { (SHORT)x, (SHORT)y };
   SetConsoleCursorPosition(__tr_h_stdout, coord);
+  return 0; // Nothing printed
 }
 
 // Sets foreground and background colors on Windows console
-static inline void __tr_set_terminal_color(Color fg_color, Color bg_color) {
+static inline int __tr_set_terminal_color(Color fg_color, Color bg_color) {
   WORD attributes = 0;
   short fg_code = __tr_map_color_to_terminal(fg_color, false);
   short bg_code = __tr_map_color_to_terminal(bg_color, true);
@@ -250,6 +300,7 @@ static inline void __tr_set_terminal_color(Color fg_color, Color bg_color) {
   }
 
   SetConsoleTextAttribute(__tr_h_stdout, attributes);
+  return 0; // Nothing printed
 }
 
 // Clears the Windows console screen (used internally for initial setup or full clear)
@@ -359,14 +410,16 @@ static void __tr_sigint_handler(int signum) {
 }
 
 // Sets cursor position using ANSI escape codes
-static inline void __tr_set_cursor_position(int x, int y) {
+// Returns the bytes printed.
+static inline int __tr_set_cursor_position(int x, int y) {
   // ANSI: \x1b[<ROW>;<COL>H or \x1b[<ROW>;<COL>f
   // Terminals are 1-indexed for rows/cols
-  printf("\x1b[%d;%dH", y + 1, x + 1);
+  return printf("\x1b[%d;%dH", y + 1, x + 1);
 }
 
 // Sets foreground and background colors using ANSI escape codes
-static inline void __tr_set_terminal_color(Color fg_color, Color bg_color) {
+// Returns the bytes printed.
+static inline int __tr_set_terminal_color(Color fg_color, Color bg_color) {
   short fg_code = __tr_map_color_to_terminal(fg_color, false);
   short bg_code = __tr_map_color_to_terminal(bg_color, true);
 
@@ -379,7 +432,7 @@ static inline void __tr_set_terminal_color(Color fg_color, Color bg_color) {
   if (fg_color.r > 128 || fg_color.g > 128 || fg_color.b > 128) ansi_fg += 60;
   if (bg_color.r > 128 || bg_color.g > 128 || bg_color.b > 128) ansi_bg += 60;
 
-  printf("\x1b[%d;%dm", ansi_fg, ansi_bg);
+  return printf("\x1b[%d;%dm", ansi_fg, ansi_bg);
 }
 
 // Clears the POSIX terminal screen (used internally for initial setup or full clear)
@@ -492,6 +545,216 @@ static inline int __tr_get_screen_height_platform() {
 
 #endif // _WIN32 / POSIX
 
+// --- Input Recording and Replay ---
+// Every key TR_BeginDrawing reads can be written to a file along with the frame it came
+// in on, then fed back in place of the keyboard with the FPS limit switched off. A
+// replayed session sees the same keys on the same frames, only as fast as it can draw,
+// which turns any tread app into a repeatable benchmark. Set TREAD_RECORD=<file> or
+// TREAD_REPLAY=<file> in the environment to do this to any app without changing it.
+//
+// File format: "TRIN" and a version byte, then records of a varint (frames since the
+// previous record << 2 | type) followed by a varint key code (type 0), an 8-byte
+// little-endian seed (type 1) or nothing (type 2, the last frame, written at exit).
+
+#define __TR_INPUT_VERSION 1
+#define __TR_INPUT_KEY 0
+#define __TR_INPUT_SEED 1
+#define __TR_INPUT_END 2
+
+static FILE* __tr_record_file = NULL;
+static FILE* __tr_replay_file = NULL;
+static bool __tr_input_env_checked = false;          // TREAD_RECORD/TREAD_REPLAY only apply once
+static bool __tr_input_exit_registered = false;
+static unsigned long long __tr_input_frame = 0;      // Frames since recording or replay started
+static unsigned long long __tr_input_last_frame = 0; // Frame of the last record written or read
+static long long __tr_replay_start_ns = 0;           // When the first replayed frame began
+static long long __tr_replay_last_ns = 0;            // When the latest one began
+static int __tr_replay_type = -1;                    // Next record to replay (read ahead), -1 at the end
+static unsigned long long __tr_replay_frame = 0;
+static uint64_t __tr_replay_value = 0;
+
+static inline void __tr_write_varint(FILE* file, uint64_t value) {
+  while (value >= 0x80) {
+    fputc((int)(value & 0x7F) | 0x80, file);
+    value >>= 7;
+  }
+  fputc((int)value, file);
+}
+
+static inline bool __tr_read_varint(FILE* file, uint64_t* value) {
+  *value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    int byte = fgetc(file);
+    if (byte == EOF) return false;
+    *value |= (uint64_t)(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) return true;
+  }
+  return false;
+}
+
+static inline void __tr_record(int type, uint64_t value) {
+  __tr_write_varint(__tr_record_file, ((__tr_input_frame - __tr_input_last_frame) << 2) | (uint64_t)type);
+  __tr_input_last_frame = __tr_input_frame;
+  if (type == __TR_INPUT_KEY) {
+    __tr_write_varint(__tr_record_file, value);
+  } else if (type == __TR_INPUT_SEED) {
+    for (int i = 0; i < 8; i++) fputc((int)((value >> (i * 8)) & 0xFF), __tr_record_file);
+  }
+  fflush(__tr_record_file); // Keys are rare, and a crash shouldn't lose them
+}
+
+// Reads the next record to replay into __tr_replay_type/_frame/_value
+static inline void __tr_replay_advance() {
+  uint64_t header;
+  __tr_replay_type = -1;
+  if (__tr_replay_file == NULL || !__tr_read_varint(__tr_replay_file, &header)) return;
+  __tr_replay_frame = __tr_input_last_frame + (header >> 2);
+  __tr_input_last_frame = __tr_replay_frame;
+  int type = (int)(header & 3);
+  if (type == __TR_INPUT_KEY) {
+    if (!__tr_read_varint(__tr_replay_file, &__tr_replay_value)) return;
+  } else if (type == __TR_INPUT_SEED) {
+    unsigned char bytes[8];
+    if (fread(bytes, 1, 8, __tr_replay_file) != 8) return;
+    __tr_replay_value = 0;
+    for (int i = 0; i < 8; i++) __tr_replay_value |= (uint64_t)bytes[i] << (i * 8);
+  } else if (type != __TR_INPUT_END) {
+    return;
+  }
+  __tr_replay_type = type;
+}
+
+// At exit: marks the last frame of a recording, or reports how fast a replay ran
+static void __tr_input_log_exit(void) {
+  if (__tr_record_file != NULL) {
+    __tr_record(__TR_INPUT_END, 0);
+    fclose(__tr_record_file);
+    __tr_record_file = NULL;
+  }
+  if (__tr_replay_file != NULL) {
+    // From the first frame to the start of the last, so pauses after it don't count
+    unsigned long long frames = (__tr_input_frame > 1) ? __tr_input_frame - 1 : 0;
+    double seconds = (__tr_replay_last_ns - __tr_replay_start_ns) / 1e9;
+    fprintf(stderr, "TREAD REPLAY: %llu frames in %.3f s (%.1f FPS)\n", frames, seconds,
+            seconds > 0.0 ? frames / seconds : 0.0);
+    fclose(__tr_replay_file);
+    __tr_replay_file = NULL;
+  }
+}
+
+static inline void __tr_input_log_started() {
+  __tr_input_env_checked = true; // An explicit start wins over the environment
+  __tr_input_frame = 0;
+  __tr_input_last_frame = 0;
+  if (!__tr_input_exit_registered) {
+    atexit(__tr_input_log_exit);
+    __tr_input_exit_registered = true;
+  }
+}
+
+// Starts recording input to `path` (overwriting it). Returns false if it can't be created.
+static inline bool TR_StartRecording(const char* path) {
+  if (__tr_record_file != NULL || __tr_replay_file != NULL) return false;
+  __tr_record_file = fopen(path, "wb");
+  if (__tr_record_file == NULL) return false;
+  fwrite("TRIN", 1, 4, __tr_record_file);
+  fputc(__TR_INPUT_VERSION, __tr_record_file);
+  __tr_input_log_started();
+  return true;
+}
+
+// Starts replaying input from `path` instead of reading the keyboard. Once the recording
+// runs out, every frame gets TR_KEY_ESCAPE so the app closes. Returns false if the file
+// can't be opened or isn't a recording.
+static inline bool TR_StartReplay(const char* path) {
+  if (__tr_record_file != NULL || __tr_replay_file != NULL) return false;
+  FILE* file = fopen(path, "rb");
+  if (file == NULL) return false;
+  char magic[5];
+  if (fread(magic, 1, 5, file) != 5 || memcmp(magic, "TRIN", 4) != 0 || magic[4] != __TR_INPUT_VERSION) {
+    fclose(file);
+    return false;
+  }
+  __tr_replay_file = file;
+  __tr_input_log_started();
+  __tr_replay_advance();
+  return true;
+}
+
+// Returns true while input is being replayed from a file.
+static inline bool TR_IsReplaying() {
+  return __tr_replay_file != NULL;
+}
+
+// Applies TREAD_RECORD or TREAD_REPLAY the first time it's called. Plugins carry their own
+// copy of tread.h, so each copy that picks the variable up bumps TREAD_INPUT_INDEX and the
+// later ones use <file>.1, <file>.2 and so on, in the order they start.
+static inline void __tr_input_log_check_env() {
+  if (__tr_input_env_checked) return;
+  __tr_input_env_checked = true;
+  const char* record_path = getenv("TREAD_RECORD");
+  const char* replay_path = getenv("TREAD_REPLAY");
+  const char* path = (replay_path != NULL && replay_path[0] != '\0') ? replay_path : record_path;
+  if (path == NULL || path[0] == '\0') return;
+
+  const char* index_text = getenv("TREAD_INPUT_INDEX");
+  int index = (index_text != NULL) ? atoi(index_text) : 0;
+  char indexed_path[1024];
+  if (index > 0) snprintf(indexed_path, sizeof(indexed_path), "%s.%d", path, index);
+  else snprintf(indexed_path, sizeof(indexed_path), "%s", path);
+  char next_index[16];
+  snprintf(next_index, sizeof(next_index), "%d", index + 1);
+#ifdef _WIN32
+  _putenv_s("TREAD_INPUT_INDEX", next_index);
+#else
+  setenv("TREAD_INPUT_INDEX", next_index, 1);
+#endif
+
+  bool started = (path == replay_path) ? TR_StartReplay(indexed_path) : TR_StartRecording(indexed_path);
+  if (!started) {
+    fprintf(stderr, "TREAD WARNING: Could not %s '%s'.\n", (path == replay_path) ? "replay" : "record to", indexed_path);
+  }
+}
+
+// Lets a recording capture the app's random seed. Pass the seed the app would use; while
+// recording it's saved, while replaying the recorded one comes back instead. Call it
+// once per seed, in the same order every run.
+static inline uint64_t TR_RegisterSeed(uint64_t seed) {
+  __tr_input_log_check_env();
+  if (__tr_record_file != NULL) {
+    __tr_record(__TR_INPUT_SEED, seed);
+  } else if (__tr_replay_type == __TR_INPUT_SEED) {
+    seed = __tr_replay_value;
+    __tr_replay_advance();
+  }
+  return seed;
+}
+
+// Returns this frame's key: from the keyboard (recording it if needed) or the replay
+static inline int __tr_next_input_key() {
+  int key;
+  if (__tr_replay_file != NULL) {
+    __tr_replay_last_ns = __tr_get_time_ns();
+    if (__tr_replay_start_ns == 0) __tr_replay_start_ns = __tr_replay_last_ns;
+    while (__tr_replay_type == __TR_INPUT_SEED && __tr_replay_frame <= __tr_input_frame) {
+      __tr_replay_advance(); // A seed the app didn't ask for this time
+    }
+    if (__tr_replay_type == __TR_INPUT_KEY && __tr_replay_frame == __tr_input_frame) {
+      key = (int)__tr_replay_value;
+      __tr_replay_advance();
+    } else if (__tr_replay_type == -1 || (__tr_replay_type == __TR_INPUT_END && __tr_input_frame >= __tr_replay_frame)) {
+      key = TR_KEY_ESCAPE;
+    } else {
+      key = 0;
+    }
+  } else {
+    key = __tr_get_key_nonblocking();
+    if (key != 0 && __tr_record_file != NULL) __tr_record(__TR_INPUT_KEY, (uint64_t)key);
+  }
+  if (__tr_record_file != NULL || __tr_replay_file != NULL) __tr_input_frame++;
+  return key;
+}
+
 // --- Raylib-like API Functions ---
 
 // Initializes the terminal window for drawing.
@@ -502,6 +765,7 @@ static inline void TR_InitWindow(int width, int height, const char* title) {
   (void)height; // Suppress unused parameter warning
 
   if (__tr_window_open) return;
+  __tr_input_log_check_env();
 
 #ifdef _WIN32
   __tr_h_stdout = GetStdHandle(STD_OUTPUT_HANDLE);
@@ -567,8 +831,8 @@ static inline void TR_InitWindow(int width, int height, const char* title) {
 
   // Initialize buffers to empty spaces with black background
   for (int i = 0; i < __tr_buffer_width * __tr_buffer_height; ++i) {
-    __tr_screen_buffer[i] = (__TR_Cell){' ', BLACK, BLACK};
-    __tr_prev_screen_buffer[i] = (__TR_Cell){' ', BLACK, BLACK};
+    __tr_screen_buffer[i] = (__TR_Cell){' ', BLACK, BLACK, 0};
+    __tr_prev_screen_buffer[i] = (__TR_Cell){' ', BLACK, BLACK, 0};
   }
   __tr_current_bg_color = BLACK; // Default background color
 
@@ -586,6 +850,15 @@ static inline void TR_InitWindow(int width, int height, const char* title) {
   __tr_window_open = true;
   __tr_frame_time_us = 0; // Reset frame time
   __tr_key_buffer = 0;  // Clear key buffer
+  __tr_frame_stats = (TR_FrameStats){0}; // Start counting frames for this window
+  __tr_keys_read = 0;
+  __tr_frame_marks = getenv("TREAD_FRAME_MARKS") != NULL;
+#ifdef TR_STREAM
+  __tr_stream_check_env(); // Serve frames if TREAD_STREAM names an address
+#endif
+#ifdef TR_INSPECT
+  __tr_inspect_check_env(); // Publish to the inspector if TREAD_INSPECT names a segment
+#endif
 }
 
 // Closes the terminal window and restores original terminal settings.
@@ -618,6 +891,13 @@ static inline void TR_CloseWindow() {
   fflush(stdout); // Ensure changes are applied
 #endif
 
+#ifdef TR_STREAM
+  TR_StreamStop();
+#endif
+#ifdef TR_INSPECT
+  TR_InspectStop();
+#endif
+
   // Free allocated buffers
   if (__tr_screen_buffer != NULL) {
     free(__tr_screen_buffer);
@@ -686,22 +966,42 @@ static inline void TR_BeginDrawing() {
   clock_gettime(CLOCK_MONOTONIC, &__tr_last_frame_start_ts);
 #endif
 
-  // Read input at beginning of frame
-  __tr_key_buffer = __tr_get_key_nonblocking();
+  // Read input at beginning of frame (or take it from a replay)
+  __tr_key_buffer = __tr_next_input_key();
+  if (__tr_key_buffer != 0) __tr_keys_read++;
 
   // The buffer is cleared by TR_ClearBackground, which should be called by the user.
   // If not called, the previous frame's content will persist unless overwritten.
   // For consistency, we'll reset the current buffer with the last known background color.
   for (int i = 0; i < __tr_buffer_width * __tr_buffer_height; ++i) {
-    __tr_screen_buffer[i] = (__TR_Cell){' ', __tr_current_bg_color, __tr_current_bg_color};
+    __tr_screen_buffer[i] = (__TR_Cell){' ', __tr_current_bg_color, __tr_current_bg_color, 0};
   }
 }
 
+// Prints a braille pattern: U+2800 plus the dots in UTF-8, or on Windows (whose console
+// code page has no braille) a shade block about as dense as the pattern. Returns the bytes printed.
+static inline int __tr_print_braille(unsigned char dots) {
+#ifdef _WIN32
+  int count = 0;
+  for (int i = 0; i < 8; i++) count += (dots >> i) & 1;
+  static const char shades[9] = { ' ', '\xB0', '\xB0', '\xB1', '\xB1', '\xB1', '\xB2', '\xB2', '\xDB' };
+  putchar(shades[count]);
+  return 1;
+#else
+  putchar(0xE2);
+  putchar(0xA0 | (dots >> 6));
+  putchar(0x80 | (dots & 0x3F));
+  return 3;
+#endif
+}
+
 // Ends the drawing phase. Flushes output and handles frame timing.
 static inline void TR_EndDrawing() {
   if (!__tr_window_open) return;
 
   // Compare buffers and draw only changed cells
+  unsigned long long cells_written = 0;
+  unsigned long long bytes_written = 0;
   for (int y = 0; y < __tr_buffer_height; ++y) {
     for (int x = 0; x < __tr_buffer_width; ++x) {
       int index = y * __tr_buffer_width + x;
@@ -711,34 +1011,64 @@ static inline void TR_EndDrawing() {
       // Only update if character or colors have changed
       if (current_cell.character != prev_cell.character ||
         !__tr_colors_equal(current_cell.fg_color, prev_cell.fg_color) ||
-        !__tr_colors_equal(current_cell.bg_color, prev_cell.bg_color))
+        !__tr_colors_equal(current_cell.bg_color, prev_cell.bg_color) ||
+        (current_cell.character == TR_GLYPH_BRAILLE && current_cell.dots != prev_cell.dots))
       {
-        __tr_set_cursor_position(x, y);
-        __tr_set_terminal_color(current_cell.fg_color, current_cell.bg_color);
-        printf("%c", current_cell.character);
+        bytes_written += __tr_set_cursor_position(x, y);
+        bytes_written += __tr_set_terminal_color(current_cell.fg_color, current_cell.bg_color);
+        if (current_cell.character == TR_GLYPH_UPPER_HALF) {
+          fputs(__TR_UPPER_HALF_TEXT, stdout);
+          bytes_written += sizeof(__TR_UPPER_HALF_TEXT) - 1;
+        } else if (current_cell.character == TR_GLYPH_BRAILLE) {
+          bytes_written += __tr_print_braille(current_cell.dots);
+        } else {
+          putchar(current_cell.character);
+          bytes_written++;
+        }
+        cells_written++;
       }
     }
   }
 
+  // For tools driving the app through a pseudo-terminal (see tread-bench): an APC string,
+  // which terminals don't display, with the frame's number and the keys read so far
+  if (__tr_frame_marks) printf("\x1b_tread;%llu;%llu\x1b\\", __tr_frame_stats.frames + 1, __tr_keys_read);
+
   fflush(stdout); // Ensure all printed characters are displayed
 
   // Copy current buffer to previous buffer for next frame's comparison
   memcpy(__tr_prev_screen_buffer, __tr_screen_buffer, sizeof(__TR_Cell) * __tr_buffer_width * __tr_buffer_height);
 
-  if (__tr_frame_time_us > 0) {
-    long long current_time_ns;
-    long long elapsed_ns;
+#ifdef TR_STREAM
+  __tr_stream_frame(); // The same frame for any viewers
+#endif
+
+  // Time spent on this frame (since TR_BeginDrawing)
+  long long current_time_ns;
+  long long elapsed_ns;
 
 #ifdef _WIN32
-    current_time_ns = __tr_get_time_ns();
-    elapsed_ns = current_time_ns - __tr_last_frame_start_ns;
+  current_time_ns = __tr_get_time_ns();
+  elapsed_ns = current_time_ns - __tr_last_frame_start_ns;
 #else
-    struct timespec current_ts;
-    clock_gettime(CLOCK_MONOTONIC, &current_ts);
-    current_time_ns = (long long)current_ts.tv_sec * 1000000000LL + current_ts.tv_nsec;
-    elapsed_ns = current_time_ns - ((long long)__tr_last_frame_start_ts.tv_sec * 1000000000LL + __tr_last_frame_start_ts.tv_nsec);
+  struct timespec current_ts;
+  clock_gettime(CLOCK_MONOTONIC, &current_ts);
+  current_time_ns = (long long)current_ts.tv_sec * 1000000000LL + current_ts.tv_nsec;
+  elapsed_ns = current_time_ns - ((long long)__tr_last_frame_start_ts.tv_sec * 1000000000LL + __tr_last_frame_start_ts.tv_nsec);
 #endif
 
+  // Update frame statistics
+  double frame_ms = elapsed_ns / 1000000.0;
+  __tr_frame_stats.frames++;
+  __tr_frame_stats.cells_written += cells_written;
+  __tr_frame_stats.bytes_written += bytes_written;
+  __tr_frame_stats.total_frame_ms += frame_ms;
+  if (frame_ms > __tr_frame_stats.max_frame_ms) __tr_frame_stats.max_frame_ms = frame_ms;
+#ifdef TR_INSPECT
+  __tr_inspect_frame(frame_ms); // After the timing, so it isn't counted in the frame
+#endif
+
+  if (__tr_frame_time_us > 0 && __tr_replay_file == NULL) { // Replays run flat out
     long long target_ns = __tr_frame_time_us * 1000LL; // Convert us to ns
 
     if (elapsed_ns < target_ns) {
@@ -757,12 +1087,17 @@ static inline void TR_EndDrawing() {
   }
 }
 
+// Returns the frame statistics gathered since TR_InitWindow (still readable after TR_CloseWindow).
+static inline TR_FrameStats TR_GetFrameStats() {
+  return __tr_frame_stats;
+}
+
 // Clears the entire drawing surface with the specified color.
 static inline void TR_ClearBackground(Color color) {
   if (!__tr_window_open) return;
   __tr_current_bg_color = color; // Store the background color
   for (int i = 0; i < __tr_buffer_width * __tr_buffer_height; ++i) {
-    __tr_screen_buffer[i] = (__TR_Cell){' ', color, color};
+    __tr_screen_buffer[i] = (__TR_Cell){' ', color, color, 0};
   }
 }
 
@@ -776,6 +1111,33 @@ static inline void TR_DrawPixel(int x, int y, Color color) {
   __tr_screen_buffer[index].bg_color = color; // Pixel fills the background of its cell
 }
 
+// Colors half of a cell, for drawing at twice the vertical resolution. Row y of the
+// half-pixels is the top (y even) or bottom (y odd) of cell row y / 2. The other half
+// keeps its color, or takes the cell's background if it wasn't a half-pixel yet.
+static inline void TR_DrawHalfPixel(int x, int y, Color color) {
+  if (!__tr_window_open || x < 0 || x >= __tr_buffer_width || y < 0 || y >= __tr_buffer_height * 2) return;
+  __TR_Cell* cell = &__tr_screen_buffer[(y >> 1) * __tr_buffer_width + x];
+  if (cell->character != TR_GLYPH_UPPER_HALF) {
+    cell->character = TR_GLYPH_UPPER_HALF;
+    cell->fg_color = cell->bg_color;
+  }
+  if (y & 1) cell->bg_color = color;
+  else cell->fg_color = color;
+}
+
+// Draws a braille character at (x, y), for drawing at 2x4 dots per cell. Bit i of
+// `dots` raises dot i + 1 in Unicode's numbering: bits 0-2 are the left column from the
+// top, bits 3-5 the right column, bits 6 and 7 the bottom-left and bottom-right dots.
+// Pass BLANK for bg_color to use the current TR_ClearBackground color as background.
+static inline void TR_DrawBraille(int x, int y, unsigned char dots, Color fg_color, Color bg_color) {
+  if (!__tr_window_open || x < 0 || x >= __tr_buffer_width || y < 0 || y >= __tr_buffer_height) return;
+  __TR_Cell* cell = &__tr_screen_buffer[y * __tr_buffer_width + x];
+  cell->character = TR_GLYPH_BRAILLE;
+  cell->dots = dots;
+  cell->fg_color = fg_color;
+  cell->bg_color = __tr_colors_equal(bg_color, BLANK) ? __tr_current_bg_color : bg_color;
+}
+
 // Draws text at (x, y) with the specified font size (ignored), foreground color, and background color.
 // Pass BLANK for bg_color to use the current TR_ClearBackground color as background.
 static inline void TR_DrawText(const char* text, int x, int y, int fontSize, Color fg_color, Color bg_color) {
@@ -1263,4 +1625,4438 @@ static inline void TR_DrawCubeFilled3D(TR_Vector3 position, TR_Vector3 size, TR_
 
 #endif // TR_3D
 
+#ifdef TR_LOG
+
+// --- Asynchronous Logging ---
+// Log calls only copy the message into a lock-free ring buffer. A background thread
+// adds the timestamp and writes "[DD/MM/YY | HH:MM:SS] [LOG] [TYPE] message" lines
+// (the same format as the logger tool) to a file descriptor, so an app can log without
+// touching the terminal it draws on. POSIX builds need -pthread.
+//
+// TR_LogDeferred goes further: the caller only stores an ID for the call site's format
+// string and the raw argument bytes, and the formatting happens on the writer thread.
+// A logger opened with TR_LogOpenBinary skips formatting entirely and writes the records
+// as they are; `logger -d <file>` expands them into the text format later.
+
+#include <stdatomic.h> // For the ring buffer's lock-free sequence numbers
+#include <stdint.h>    // For intptr_t, uintptr_t, intmax_t
+#include <stddef.h>    // For ptrdiff_t
+#include <stdarg.h>    // For va_list
+#include <time.h>      // For time, localtime, strftime
+#ifdef _WIN32
+  #include <io.h>      // For _write, _open, _close
+  #include <fcntl.h>   // For _O_WRONLY, _O_CREAT, _O_APPEND
+  #include <sys/stat.h> // For _S_IREAD, _S_IWRITE
+#else
+  #include <pthread.h> // For the writer thread
+#endif
+
+#ifndef TR_LOG_CAPACITY
+  #define TR_LOG_CAPACITY 4096 // Records in the ring buffer (must be a power of two)
+#endif
+#if TR_LOG_CAPACITY < 1 || (TR_LOG_CAPACITY & (TR_LOG_CAPACITY - 1)) != 0 // Positions wrap with & (TR_LOG_CAPACITY - 1)
+  #error "TR_LOG_CAPACITY must be a power of two"
+#endif
+#ifndef TR_LOG_MESSAGE_SIZE
+  #define TR_LOG_MESSAGE_SIZE 218 // Longest message (or packed arguments) kept per record
+#endif
+#ifndef TR_LOG_MAX_FORMATS
+  #define TR_LOG_MAX_FORMATS 1024 // TR_LogDeferred call sites that get an ID (later ones format right away)
+#endif
+#define TR_LOG_TYPE_SIZE 16 // Longest log type kept, including the null terminator
+#define TR_LOG_MAX_ARGS 16 // Most arguments (including '*' widths) a deferred format can take
+#define TR_LOG_RENDER_SIZE 1024 // Longest message a deferred record expands to
+#define TR_LOG_WRITE_BUFFER 65536 // Bytes the writer thread batches into one write
+#define TR_LOG_IDLE_MAX_US 2000 // Longest the writer thread sleeps when there's nothing to write
+#define TR_LOG_BINARY_VERSION 1 // Bumped whenever the binary record layout changes
+
+// Binary log records, each starting with one of these tags. Numbers are stored in the
+// byte order of the machine that wrote the log (the header says which).
+#define __TR_LOG_TAG_HEADER 0x89 // "TRLOG", version, sizeof(long double), byte order mark; starts every session
+#define __TR_LOG_TAG_FORMAT 'F'  // Format ID, type, format string
+#define __TR_LOG_TAG_EVENT 'E'   // Format ID, time, packed arguments
+#define __TR_LOG_TAG_TEXT 'T'    // Time, type, already formatted message
+#define __TR_LOG_BYTE_ORDER 0x01020304u
+
+// How a deferred argument is read from the va_list and stored in the record
+enum {
+  __TR_LOG_ARG_INT,     // int (also char, short and '*' widths), stored as 8 bytes
+  __TR_LOG_ARG_LONG,    // long, stored as 8 bytes
+  __TR_LOG_ARG_LLONG,   // long long, stored as 8 bytes
+  __TR_LOG_ARG_SIZE,    // size_t, stored as 8 bytes
+  __TR_LOG_ARG_INTMAX,  // intmax_t, stored as 8 bytes
+  __TR_LOG_ARG_PTRDIFF, // ptrdiff_t, stored as 8 bytes
+  __TR_LOG_ARG_DOUBLE,  // double, stored as 8 bytes
+  __TR_LOG_ARG_LDOUBLE, // long double, stored as sizeof(long double) bytes
+  __TR_LOG_ARG_POINTER, // void*, stored as 8 bytes
+  __TR_LOG_ARG_STRING   // char*, stored by value as a 2 byte length and the characters
+};
+
+// Counters for the logger (see TR_LogGetStats)
+typedef struct {
+  unsigned long long logged;    // Messages accepted into the ring buffer
+  unsigned long long written;   // Messages written out by the background thread
+  unsigned long long dropped;   // Messages lost because the ring buffer was full
+  unsigned long long truncated; // Messages (or deferred string arguments) cut to fit in a record
+} TR_LogStats;
+
+// One fixed-size slot of the ring buffer (256 bytes with the default sizes)
+typedef struct {
+  atomic_size_t sequence;   // Slot state: free for position p when == p, readable when == p + 1
+  long long time_sec;       // Unix time of the log call
+  unsigned int format_id;   // 0 for a formatted message, else the TR_LogDeferred format it was packed for
+  unsigned short length;    // Message (or packed argument) length
+  char type[TR_LOG_TYPE_SIZE]; // Unused by deferred records; the type comes with the format
+  char message[TR_LOG_MESSAGE_SIZE];
+} __TR_LogRecord;
+
+// A TR_LogDeferred call site's format, registered the first time it runs
+typedef struct {
+  char type[TR_LOG_TYPE_SIZE];
+  const char* format;       // The call site's format string (a literal, so it outlives the logger)
+  int num_args;             // -1 if the format can't be deferred (e.g. it uses %n or %ls)
+  unsigned char kinds[TR_LOG_MAX_ARGS];
+} __TR_LogFormat;
+
+static __TR_LogRecord* __tr_log_ring = NULL;
+static atomic_size_t __tr_log_enqueue_pos;   // Next position producers claim
+static atomic_size_t __tr_log_dequeued;      // Records written out (only the writer thread stores it)
+static atomic_ullong __tr_log_dropped;
+static atomic_ullong __tr_log_truncated;
+static atomic_bool __tr_log_running;
+static int __tr_log_fd = -1;
+static bool __tr_log_owns_fd = false;        // True if TR_LogOpenFile opened the descriptor
+static bool __tr_log_binary = false;         // True if records are written in the binary format
+static __TR_LogFormat __tr_log_formats[TR_LOG_MAX_FORMATS]; // Format ID n is __tr_log_formats[n - 1]
+static atomic_uint __tr_log_num_formats;
+static atomic_flag __tr_log_formats_lock = ATOMIC_FLAG_INIT; // Only taken when a call site registers
+#ifdef _WIN32
+  static HANDLE __tr_log_thread = NULL;
+#else
+  static pthread_t __tr_log_thread;
+#endif
+
+// Parses one conversion of a format string (p points just past its '%'). Returns the
+// conversion's length, or 0 if it can't be deferred. Sets how many '*' arguments it takes
+// and which kind of argument it prints.
+static inline int __tr_log_parse_spec(const char* p, int* stars, int* kind) {
+  const char* start = p;
+  *stars = 0;
+  while (*p != '\0' && strchr("-+ #0'", *p) != NULL) p++;
+  if (*p == '*') {
+    (*stars)++;
+    p++;
+  } else {
+    while (*p >= '0' && *p <= '9') p++;
+  }
+  if (*p == '.') {
+    p++;
+    if (*p == '*') {
+      (*stars)++;
+      p++;
+    } else {
+      while (*p >= '0' && *p <= '9') p++;
+    }
+  }
+
+  // Length modifier ('H' stands for hh and 'q' for ll)
+  char modifier = 0;
+  if (p[0] == 'h' && p[1] == 'h') {
+    modifier = 'H';
+    p += 2;
+  } else if (p[0] == 'l' && p[1] == 'l') {
+    modifier = 'q';
+    p += 2;
+  } else if (*p != '\0' && strchr("hlzjtL", *p) != NULL) {
+    modifier = *p++;
+  }
+
+  switch (*p) {
+    case 'd': case 'i': case 'u': case 'o': case 'x': case 'X': case 'c':
+      if (*p == 'c' && modifier != 0) return 0; // %lc takes a wint_t
+      switch (modifier) {
+        case 'l': *kind = __TR_LOG_ARG_LONG; break;
+        case 'q': *kind = __TR_LOG_ARG_LLONG; break;
+        case 'z': *kind = __TR_LOG_ARG_SIZE; break;
+        case 'j': *kind = __TR_LOG_ARG_INTMAX; break;
+        case 't': *kind = __TR_LOG_ARG_PTRDIFF; break;
+        case 'L': return 0;
+        default: *kind = __TR_LOG_ARG_INT; break; // hh and h are promoted to int
+      }
+      break;
+    case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+      if (modifier == 'L') *kind = __TR_LOG_ARG_LDOUBLE;
+      else if (modifier == 0 || modifier == 'l') *kind = __TR_LOG_ARG_DOUBLE;
+      else return 0;
+      break;
+    case 's':
+      if (modifier != 0) return 0; // Wide strings aren't supported
+      *kind = __TR_LOG_ARG_STRING;
+      break;
+    case 'p':
+      if (modifier != 0) return 0;
+      *kind = __TR_LOG_ARG_POINTER;
+      break;
+    default:
+      return 0; // %n, or not a conversion at all
+  }
+  return (int)(p - start) + 1;
+}
+
+// Works out the argument kinds a format string takes. Returns how many there are, or -1
+// if the format can't be deferred.
+static inline int __tr_log_parse_format(const char* format, unsigned char* kinds) {
+  int count = 0;
+  for (const char* p = format; *p != '\0'; ++p) {
+    if (*p != '%') continue;
+    if (p[1] == '%') {
+      p++;
+      continue;
+    }
+    int stars, kind;
+    int length = __tr_log_parse_spec(p + 1, &stars, &kind);
+    if (length == 0 || length > 30 || count + stars + 1 > TR_LOG_MAX_ARGS) return -1;
+    for (int i = 0; i < stars; ++i) kinds[count++] = __TR_LOG_ARG_INT;
+    kinds[count++] = (unsigned char)kind;
+    p += length;
+  }
+  return count;
+}
+
+// Copies the arguments of a deferred call into a record as raw bytes. Returns the number
+// of bytes used; sets truncated if a string had to be cut or arguments didn't fit.
+static inline size_t __tr_log_pack_args(const __TR_LogFormat* format, char* out, size_t size, va_list args, bool* truncated) {
+  size_t used = 0;
+  for (int i = 0; i < format->num_args; ++i) {
+    int kind = format->kinds[i];
+    if (kind == __TR_LOG_ARG_STRING) {
+      const char* text = va_arg(args, const char*);
+      if (text == NULL) text = "(null)";
+      if (used + 2 > size) {
+        *truncated = true;
+        break;
+      }
+      size_t length = strlen(text);
+      if (length > size - used - 2) {
+        length = size - used - 2;
+        *truncated = true;
+      }
+      unsigned short stored = (unsigned short)length;
+      memcpy(out + used, &stored, 2);
+      memcpy(out + used + 2, text, length);
+      used += 2 + length;
+      continue;
+    }
+
+    // Everything else has a fixed size
+    size_t length = (kind == __TR_LOG_ARG_LDOUBLE) ? sizeof(long double) : 8;
+    if (used + length > size) {
+      *truncated = true;
+      break;
+    }
+    long long integer = 0;
+    switch (kind) {
+      case __TR_LOG_ARG_INT: integer = va_arg(args, int); break;
+      case __TR_LOG_ARG_LONG: integer = va_arg(args, long); break;
+      case __TR_LOG_ARG_LLONG: integer = va_arg(args, long long); break;
+      case __TR_LOG_ARG_SIZE: integer = (long long)va_arg(args, size_t); break;
+      case __TR_LOG_ARG_INTMAX: integer = (long long)va_arg(args, intmax_t); break;
+      case __TR_LOG_ARG_PTRDIFF: integer = (long long)va_arg(args, ptrdiff_t); break;
+      case __TR_LOG_ARG_POINTER: integer = (long long)(uintptr_t)va_arg(args, void*); break;
+      case __TR_LOG_ARG_DOUBLE: {
+        double value = va_arg(args, double);
+        memcpy(out + used, &value, 8);
+        used += 8;
+        continue;
+      }
+      case __TR_LOG_ARG_LDOUBLE: {
+        long double value = va_arg(args, long double);
+        memcpy(out + used, &value, sizeof(long double));
+        used += sizeof(long double);
+        continue;
+      }
+    }
+    memcpy(out + used, &integer, 8);
+    used += 8;
+  }
+  return used;
+}
+
+// Takes the next `length` bytes of packed arguments. Returns false if there aren't enough.
+static inline bool __tr_log_take(const unsigned char** args, size_t* remaining, void* out, size_t length) {
+  if (*remaining < length) return false;
+  memcpy(out, *args, length);
+  *args += length;
+  *remaining -= length;
+  return true;
+}
+
+// Formats one conversion with up to two '*' values in front of its argument
+#define __TR_LOG_EMIT(value) \
+  (stars == 0 ? snprintf(out + used, size - used, spec, value) : \
+   stars == 1 ? snprintf(out + used, size - used, spec, star_values[0], value) : \
+                snprintf(out + used, size - used, spec, star_values[0], star_values[1], value))
+
+// Expands a format string with the packed arguments of a deferred record. Stops early if
+// the arguments run out (e.g. they were cut off to fit the record). Returns the length.
+static inline size_t __tr_log_render(const char* format, const unsigned char* args, size_t args_length, char* out, size_t size) {
+  size_t used = 0;
+  const char* p = format;
+  while (*p != '\0' && used + 1 < size) {
+    if (*p != '%') {
+      out[used++] = *p++;
+      continue;
+    }
+    if (p[1] == '%') {
+      out[used++] = '%';
+      p += 2;
+      continue;
+    }
+
+    int stars, kind;
+    int length = __tr_log_parse_spec(p + 1, &stars, &kind);
+    if (length == 0 || length > 30) break; // Can't happen for a format that was registered
+    char spec[32];
+    memcpy(spec, p, (size_t)length + 1);
+    spec[length + 1] = '\0';
+    char conversion = spec[length];
+    bool is_unsigned = (strchr("uoxX", conversion) != NULL);
+    p += length + 1;
+
+    int star_values[2] = {0, 0};
+    bool complete = true;
+    for (int i = 0; i < stars; ++i) {
+      long long value = 0;
+      complete = complete && __tr_log_take(&args, &args_length, &value, 8);
+      star_values[i] = (int)value;
+    }
+    if (!complete) break;
+
+    int written = 0;
+    if (kind == __TR_LOG_ARG_STRING) {
+      unsigned short text_length;
+      if (!__tr_log_take(&args, &args_length, &text_length, 2) || text_length > args_length) break;
+      char text[TR_LOG_RENDER_SIZE];
+      size_t copied = (text_length < sizeof(text)) ? text_length : sizeof(text) - 1;
+      memcpy(text, args, copied);
+      text[copied] = '\0';
+      args += text_length;
+      args_length -= text_length;
+      written = __TR_LOG_EMIT(text);
+    } else if (kind == __TR_LOG_ARG_DOUBLE) {
+      double value;
+      if (!__tr_log_take(&args, &args_length, &value, 8)) break;
+      written = __TR_LOG_EMIT(value);
+    } else if (kind == __TR_LOG_ARG_LDOUBLE) {
+      long double value;
+      if (!__tr_log_take(&args, &args_length, &value, sizeof(long double))) break;
+      written = __TR_LOG_EMIT(value);
+    } else {
+      long long value;
+      if (!__tr_log_take(&args, &args_length, &value, 8)) break;
+      switch (kind) {
+        case __TR_LOG_ARG_INT: written = is_unsigned ? __TR_LOG_EMIT((unsigned int)value) : __TR_LOG_EMIT((int)value); break;
+        case __TR_LOG_ARG_LONG: written = is_unsigned ? __TR_LOG_EMIT((unsigned long)value) : __TR_LOG_EMIT((long)value); break;
+        case __TR_LOG_ARG_LLONG: written = is_unsigned ? __TR_LOG_EMIT((unsigned long long)value) : __TR_LOG_EMIT(value); break;
+        case __TR_LOG_ARG_SIZE: written = __TR_LOG_EMIT((size_t)value); break;
+        case __TR_LOG_ARG_INTMAX: written = is_unsigned ? __TR_LOG_EMIT((uintmax_t)value) : __TR_LOG_EMIT((intmax_t)value); break;
+        case __TR_LOG_ARG_PTRDIFF: written = __TR_LOG_EMIT((ptrdiff_t)value); break;
+        case __TR_LOG_ARG_POINTER: written = __TR_LOG_EMIT((void*)(uintptr_t)value); break;
+      }
+    }
+    if (written > 0) used += (size_t)written;
+    if (used >= size) used = size - 1; // snprintf cut it off
+  }
+  out[used] = '\0';
+  return used;
+}
+
+#undef __TR_LOG_EMIT
+
+// Formats a Unix time as "[DD/MM/YY | HH:MM:SS]". Returns the length.
+static inline size_t __tr_log_format_time(long long time_sec, char* out, size_t size) {
+  time_t raw_time = (time_t)time_sec;
+  struct tm time_info;
+#ifdef _WIN32
+  localtime_s(&time_info, &raw_time);
+#else
+  localtime_r(&raw_time, &time_info);
+#endif
+  return strftime(out, size, "[%d/%m/%y | %H:%M:%S]", &time_info);
+}
+
+// Writes a whole buffer to the log descriptor, retrying partial writes
+static inline void __tr_log_write_all(const char* data, size_t length) {
+  while (length > 0) {
+#ifdef _WIN32
+    int written = _write(__tr_log_fd, data, (unsigned int)length);
+#else
+    ssize_t written = write(__tr_log_fd, data, length);
+    if (written < 0 && errno == EINTR) continue;
+#endif
+    if (written <= 0) return; // Nowhere to put it; the lines are lost
+    data += written;
+    length -= (size_t)written;
+  }
+}
+
+// Adds bytes to the writer thread's batch, writing the batch out first if they don't fit
+static inline void __tr_log_emit(char* buffer, size_t* used, const void* data, size_t length) {
+  if (*used + length > TR_LOG_WRITE_BUFFER) {
+    __tr_log_write_all(buffer, *used);
+    *used = 0;
+  }
+  memcpy(buffer + *used, data, length);
+  *used += length;
+}
+
+// Adds a text record (binary mode) or a "[TIMESTAMP] [LOG] [TYPE] MESSAGE" line to the batch
+static inline void __tr_log_emit_message(char* buffer, size_t* used, long long time_sec, const char* time_string,
+                                         size_t time_length, const char* type, const char* message, size_t length) {
+  size_t type_length = strlen(type);
+  if (__tr_log_binary) {
+    unsigned char tag = __TR_LOG_TAG_TEXT;
+    unsigned char stored_type_length = (unsigned char)type_length;
+    unsigned short stored_length = (unsigned short)length;
+    __tr_log_emit(buffer, used, &tag, 1);
+    __tr_log_emit(buffer, used, &time_sec, 8);
+    __tr_log_emit(buffer, used, &stored_type_length, 1);
+    __tr_log_emit(buffer, used, type, type_length);
+    __tr_log_emit(buffer, used, &stored_length, 2);
+    __tr_log_emit(buffer, used, message, length);
+    return;
+  }
+  __tr_log_emit(buffer, used, time_string, time_length);
+  __tr_log_emit(buffer, used, " [LOG] [", 8);
+  __tr_log_emit(buffer, used, type, type_length);
+  __tr_log_emit(buffer, used, "] ", 2);
+  __tr_log_emit(buffer, used, message, length);
+  if (length == 0 || message[length - 1] != '\n') __tr_log_emit(buffer, used, "\n", 1);
+}
+
+// Sleeps the writer thread for a number of microseconds
+static inline void __tr_log_sleep_us(int us) {
+#ifdef _WIN32
+  Sleep((DWORD)((us + 999) / 1000));
+#else
+  struct timespec req = { 0, (long)us * 1000L };
+  nanosleep(&req, NULL);
+#endif
+}
+
+// Background thread: formats published records in order and writes them out in batches
+#ifdef _WIN32
+static DWORD WINAPI __tr_log_writer(LPVOID arg) {
+#else
+static void* __tr_log_writer(void* arg) {
+#endif
+  (void)arg;
+  char* buffer = (char*)malloc(TR_LOG_WRITE_BUFFER);
+  size_t used = 0;
+  size_t position = atomic_load_explicit(&__tr_log_dequeued, memory_order_relaxed);
+  long long cached_sec = -1;  // Second the cached timestamp string is for
+  char time_string[32] = "";
+  size_t time_length = 0;
+  char rendered[TR_LOG_RENDER_SIZE];
+  unsigned int formats_written = 0; // Formats already described in a binary log
+  unsigned long long reported_dropped = 0;
+  int idle_us = 50;
+
+  if (buffer != NULL && __tr_log_binary) {
+    unsigned char header[7] = { __TR_LOG_TAG_HEADER, 'T', 'R', 'L', 'O', 'G', TR_LOG_BINARY_VERSION };
+    unsigned char long_double_size = (unsigned char)sizeof(long double);
+    unsigned int byte_order = __TR_LOG_BYTE_ORDER;
+    __tr_log_emit(buffer, &used, header, sizeof(header));
+    __tr_log_emit(buffer, &used, &long_double_size, 1);
+    __tr_log_emit(buffer, &used, &byte_order, 4);
+  }
+
+  for (;;) {
+    bool running = atomic_load_explicit(&__tr_log_running, memory_order_acquire);
+    size_t drained = 0;
+
+    for (;;) {
+      __TR_LogRecord* record = &__tr_log_ring[position & (TR_LOG_CAPACITY - 1)];
+      if (atomic_load_explicit(&record->sequence, memory_order_acquire) != position + 1) break; // Not published yet
+
+      // The timestamp string only changes once a second
+      if (!__tr_log_binary && record->time_sec != cached_sec) {
+        time_length = __tr_log_format_time(record->time_sec, time_string, sizeof(time_string));
+        cached_sec = record->time_sec;
+      }
+
+      if (buffer != NULL) {
+        if (record->format_id == 0) {
+          __tr_log_emit_message(buffer, &used, record->time_sec, time_string, time_length,
+                                record->type, record->message, record->length);
+        } else if (__tr_log_binary) {
+          // Describe any formats registered since the last event, then store the raw arguments
+          unsigned int num_formats = atomic_load_explicit(&__tr_log_num_formats, memory_order_acquire);
+          for (; formats_written < num_formats; ++formats_written) {
+            const __TR_LogFormat* format = &__tr_log_formats[formats_written];
+            if (format->num_args < 0) continue;
+            unsigned char tag = __TR_LOG_TAG_FORMAT;
+            unsigned int id = formats_written + 1;
+            unsigned char type_length = (unsigned char)strlen(format->type);
+            size_t format_length = strlen(format->format);
+            unsigned short stored_length = (unsigned short)((format_length > 65535) ? 65535 : format_length);
+            __tr_log_emit(buffer, &used, &tag, 1);
+            __tr_log_emit(buffer, &used, &id, 4);
+            __tr_log_emit(buffer, &used, &type_length, 1);
+            __tr_log_emit(buffer, &used, format->type, type_length);
+            __tr_log_emit(buffer, &used, &stored_length, 2);
+            __tr_log_emit(buffer, &used, format->format, stored_length);
+          }
+          unsigned char tag = __TR_LOG_TAG_EVENT;
+          __tr_log_emit(buffer, &used, &tag, 1);
+          __tr_log_emit(buffer, &used, &record->format_id, 4);
+          __tr_log_emit(buffer, &used, &record->time_sec, 8);
+          __tr_log_emit(buffer, &used, &record->length, 2);
+          __tr_log_emit(buffer, &used, record->message, record->length);
+        } else {
+          const __TR_LogFormat* format = &__tr_log_formats[record->format_id - 1];
+          size_t length = __tr_log_render(format->format, (const unsigned char*)record->message, record->length,
+                                          rendered, sizeof(rendered));
+          __tr_log_emit_message(buffer, &used, record->time_sec, time_string, time_length,
+                                format->type, rendered, length);
+        }
+      }
+
+      // Hand the slot back to producers for the next lap of the ring
+      atomic_store_explicit(&record->sequence, position + TR_LOG_CAPACITY, memory_order_release);
+      position++;
+      drained++;
+    }
+
+    // Report overflow as a log message of its own
+    unsigned long long dropped = atomic_load_explicit(&__tr_log_dropped, memory_order_relaxed);
+    if (dropped != reported_dropped && buffer != NULL) {
+      long long now = (long long)time(NULL);
+      if (!__tr_log_binary && now != cached_sec) {
+        time_length = __tr_log_format_time(now, time_string, sizeof(time_string));
+        cached_sec = now;
+      }
+      int length = snprintf(rendered, sizeof(rendered), "%llu message(s) dropped, ring buffer full",
+                            dropped - reported_dropped);
+      __tr_log_emit_message(buffer, &used, now, time_string, time_length, "LOG", rendered, (size_t)length);
+      reported_dropped = dropped;
+    }
+
+    if (used > 0) {
+      __tr_log_write_all(buffer, used);
+      used = 0;
+    }
+    atomic_store_explicit(&__tr_log_dequeued, position, memory_order_release);
+
+    if (drained == 0) {
+      if (!running) break; // Closed and fully drained
+      __tr_log_sleep_us(idle_us);
+      idle_us = (idle_us * 2 > TR_LOG_IDLE_MAX_US) ? TR_LOG_IDLE_MAX_US : idle_us * 2;
+    } else {
+      idle_us = 50;
+    }
+  }
+
+  free(buffer);
+#ifdef _WIN32
+  return 0;
+#else
+  return NULL;
+#endif
+}
+
+// Sets up the ring buffer and starts the writer thread on a descriptor
+static inline bool __tr_log_start(int fd, bool binary) {
+  if (__tr_log_ring != NULL) return true; // Already open
+
+  __tr_log_ring = (__TR_LogRecord*)malloc(sizeof(__TR_LogRecord) * TR_LOG_CAPACITY);
+  if (__tr_log_ring == NULL) return false;
+  for (size_t i = 0; i < TR_LOG_CAPACITY; ++i) {
+    atomic_init(&__tr_log_ring[i].sequence, i);
+  }
+  atomic_store(&__tr_log_enqueue_pos, 0);
+  atomic_store(&__tr_log_dequeued, 0);
+  atomic_store(&__tr_log_dropped, 0);
+  atomic_store(&__tr_log_truncated, 0);
+  atomic_store(&__tr_log_running, true);
+  __tr_log_fd = fd;
+  __tr_log_binary = binary;
+
+#ifdef _WIN32
+  __tr_log_thread = CreateThread(NULL, 0, __tr_log_writer, NULL, 0, NULL);
+  bool started = (__tr_log_thread != NULL);
+#else
+  bool started = (pthread_create(&__tr_log_thread, NULL, __tr_log_writer, NULL) == 0);
+#endif
+  if (!started) {
+    free(__tr_log_ring);
+    __tr_log_ring = NULL;
+    return false;
+  }
+  return true;
+}
+
+// Opens a file for appending (created if needed) and starts the logger on it
+static inline bool __tr_log_start_file(const char* path, bool binary) {
+#ifdef _WIN32
+  int fd = _open(path, _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+  int fd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+#endif
+  if (fd < 0) return false;
+  if (!__tr_log_start(fd, binary)) {
+#ifdef _WIN32
+    _close(fd);
+#else
+    close(fd);
+#endif
+    return false;
+  }
+  __tr_log_owns_fd = true;
+  return true;
+}
+
+// Starts the logger, writing to an already open file descriptor (e.g. a file or a pipe).
+// Returns false if the logger couldn't be started.
+static inline bool TR_LogOpen(int fd) {
+  return __tr_log_start(fd, false);
+}
+
+// Starts the logger, appending to a file (created if needed). Returns false on failure.
+static inline bool TR_LogOpenFile(const char* path) {
+  return __tr_log_start_file(path, false);
+}
+
+// Starts the logger in binary mode: deferred records are written with their raw arguments
+// and never formatted in this process. Read the log with `logger -d <file>`.
+static inline bool TR_LogOpenBinary(int fd) {
+  return __tr_log_start(fd, true);
+}
+
+// Starts the logger in binary mode, appending to a file (created if needed).
+static inline bool TR_LogOpenBinaryFile(const char* path) {
+  return __tr_log_start_file(path, true);
+}
+
+// Claims the next free slot of the ring buffer (Vyukov bounded queue: a CAS on the
+// position, no locks). Returns NULL and counts a drop if the ring buffer is full.
+static inline __TR_LogRecord* __tr_log_claim(size_t* position_out) {
+  size_t position = atomic_load_explicit(&__tr_log_enqueue_pos, memory_order_relaxed);
+  for (;;) {
+    __TR_LogRecord* record = &__tr_log_ring[position & (TR_LOG_CAPACITY - 1)];
+    size_t sequence = atomic_load_explicit(&record->sequence, memory_order_acquire);
+    intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+    if (difference == 0) {
+      if (atomic_compare_exchange_weak_explicit(&__tr_log_enqueue_pos, &position, position + 1,
+                                                memory_order_relaxed, memory_order_relaxed)) {
+        *position_out = position;
+        return record;
+      }
+    } else if (difference < 0) {
+      atomic_fetch_add_explicit(&__tr_log_dropped, 1, memory_order_relaxed); // Full
+      return NULL;
+    } else {
+      position = atomic_load_explicit(&__tr_log_enqueue_pos, memory_order_relaxed);
+    }
+  }
+}
+
+// Formats a message into a record on the calling thread
+static inline void __tr_log_text(const char* type, const char* format, va_list args) {
+  size_t position;
+  __TR_LogRecord* record = __tr_log_claim(&position);
+  if (record == NULL) return;
+
+  record->time_sec = (long long)time(NULL);
+  record->format_id = 0;
+  int i = 0;
+  for (; i < TR_LOG_TYPE_SIZE - 1 && type[i] != '\0'; ++i) record->type[i] = type[i];
+  record->type[i] = '\0';
+
+  int length;
+  if (strchr(format, '%') == NULL) {
+    // Nothing to format: a plain copy is much cheaper than vsnprintf
+    length = (int)strlen(format);
+    memcpy(record->message, format, (length < (int)sizeof(record->message)) ? (size_t)length : sizeof(record->message) - 1);
+  } else {
+    length = vsnprintf(record->message, sizeof(record->message), format, args);
+    if (length < 0) length = 0;
+  }
+  if (length >= (int)sizeof(record->message)) {
+    length = (int)sizeof(record->message) - 1;
+    atomic_fetch_add_explicit(&__tr_log_truncated, 1, memory_order_relaxed);
+  }
+  record->length = (unsigned short)length;
+
+  atomic_store_explicit(&record->sequence, position + 1, memory_order_release); // Publish to the writer
+}
+
+// Logs a printf-style message. Safe to call from any thread; never blocks and never
+// writes to the terminal. If the ring buffer is full the message is counted as dropped.
+static inline void TR_Log(const char* type, const char* format, ...) {
+  if (__tr_log_ring == NULL) return;
+  va_list args;
+  va_start(args, format);
+  __tr_log_text(type, format, args);
+  va_end(args);
+}
+
+// Gives a TR_LogDeferred call site its format ID the first time it runs. Returns 0 if
+// every ID is taken.
+static inline unsigned int __tr_log_register(atomic_uint* site, const char* type, const char* format) {
+  while (atomic_flag_test_and_set_explicit(&__tr_log_formats_lock, memory_order_acquire)) {}
+  unsigned int id = atomic_load_explicit(site, memory_order_relaxed);
+  if (id == 0) {
+    unsigned int count = atomic_load_explicit(&__tr_log_num_formats, memory_order_relaxed);
+    if (count < TR_LOG_MAX_FORMATS) {
+      __TR_LogFormat* entry = &__tr_log_formats[count];
+      int i = 0;
+      for (; i < TR_LOG_TYPE_SIZE - 1 && type[i] != '\0'; ++i) entry->type[i] = type[i];
+      entry->type[i] = '\0';
+      entry->format = format;
+      entry->num_args = __tr_log_parse_format(format, entry->kinds);
+      id = count + 1;
+      atomic_store_explicit(&__tr_log_num_formats, count + 1, memory_order_release);
+      atomic_store_explicit(site, id, memory_order_release);
+    }
+  }
+  atomic_flag_clear_explicit(&__tr_log_formats_lock, memory_order_release);
+  return id;
+}
+
+// Used by TR_LogDeferred: packs the raw arguments under the call site's format ID
+static inline void __tr_log_deferred(atomic_uint* site, const char* type, const char* format, ...) {
+  if (__tr_log_ring == NULL) return;
+  unsigned int id = atomic_load_explicit(site, memory_order_acquire);
+  if (id == 0) id = __tr_log_register(site, type, format);
+
+  va_list args;
+  va_start(args, format);
+  if (id == 0 || __tr_log_formats[id - 1].num_args < 0) {
+    __tr_log_text(type, format, args); // No ID or not deferrable: format it right away
+  } else {
+    size_t position;
+    __TR_LogRecord* record = __tr_log_claim(&position);
+    if (record != NULL) {
+      record->time_sec = (long long)time(NULL);
+      record->format_id = id;
+      bool truncated = false;
+      record->length = (unsigned short)__tr_log_pack_args(&__tr_log_formats[id - 1], record->message,
+                                                          sizeof(record->message), args, &truncated);
+      if (truncated) atomic_fetch_add_explicit(&__tr_log_truncated, 1, memory_order_relaxed);
+      atomic_store_explicit(&record->sequence, position + 1, memory_order_release); // Publish to the writer
+    }
+  }
+  va_end(args);
+}
+
+// Logs a printf-style message like TR_Log, but leaves the formatting to the writer thread
+// (or to `logger -d` for a binary log), so the call only copies its arguments. The type and
+// format must be string literals, the same every time that line runs. Strings are copied by
+// value; %n and wide characters/strings aren't deferred and fall back to TR_Log.
+#define TR_LogDeferred(type, format, ...) do { \
+    static atomic_uint __tr_log_site; \
+    __tr_log_deferred(&__tr_log_site, (type), (format), ##__VA_ARGS__); \
+  } while (0)
+
+// Waits until every message logged before this call has been written out.
+static inline void TR_LogFlush() {
+  if (__tr_log_ring == NULL) return;
+  size_t target = atomic_load_explicit(&__tr_log_enqueue_pos, memory_order_acquire);
+  while (atomic_load_explicit(&__tr_log_dequeued, memory_order_acquire) < target) {
+    __tr_log_sleep_us(100);
+  }
+}
+
+// Returns the logger's counters.
+static inline TR_LogStats TR_LogGetStats() {
+  TR_LogStats stats = {0};
+  if (__tr_log_ring == NULL) return stats;
+  stats.logged = atomic_load(&__tr_log_enqueue_pos);
+  stats.written = atomic_load(&__tr_log_dequeued);
+  stats.dropped = atomic_load(&__tr_log_dropped);
+  stats.truncated = atomic_load(&__tr_log_truncated);
+  return stats;
+}
+
+// Writes out everything still queued, stops the writer thread and frees the ring buffer.
+// Closes the file if it was opened with TR_LogOpenFile or TR_LogOpenBinaryFile.
+static inline void TR_LogClose() {
+  if (__tr_log_ring == NULL) return;
+  atomic_store_explicit(&__tr_log_running, false, memory_order_release);
+#ifdef _WIN32
+  WaitForSingleObject(__tr_log_thread, INFINITE);
+  CloseHandle(__tr_log_thread);
+  __tr_log_thread = NULL;
+#else
+  pthread_join(__tr_log_thread, NULL);
+#endif
+  free(__tr_log_ring);
+  __tr_log_ring = NULL;
+
+  if (__tr_log_owns_fd) {
+#ifdef _WIN32
+    _close(__tr_log_fd);
+#else
+    close(__tr_log_fd);
+#endif
+  }
+  __tr_log_fd = -1;
+  __tr_log_owns_fd = false;
+}
+
+// Expands a binary log (see TR_LogOpenBinary) into "[DD/MM/YY | HH:MM:SS] [LOG] [TYPE] message"
+// lines. Returns the number of lines written, or -1 if the input isn't a binary log written
+// on a compatible machine or is corrupted (the lines before the damage are still written).
+static inline long long TR_LogDecodeBinary(FILE* in, FILE* out) {
+  char** formats = NULL;          // Format string of ID n is formats[n - 1]
+  char (*types)[TR_LOG_TYPE_SIZE] = NULL;
+  unsigned int num_formats = 0;
+  unsigned char* data = (unsigned char*)malloc(65536);
+  char* rendered = (char*)malloc(TR_LOG_RENDER_SIZE);
+  long long lines = 0;
+  bool valid = (data != NULL && rendered != NULL);
+  bool seen_header = false;
+
+  while (valid) {
+    int tag = fgetc(in);
+    if (tag == EOF) break;
+
+    if (tag == __TR_LOG_TAG_HEADER) {
+      // A new session: format IDs start over
+      unsigned char header[6];
+      unsigned int byte_order;
+      valid = fread(header, 1, 6, in) == 6 && memcmp(header, "TRLOG", 5) == 0 && header[5] == TR_LOG_BINARY_VERSION &&
+              fread(header, 1, 1, in) == 1 && header[0] == sizeof(long double) &&
+              fread(&byte_order, 4, 1, in) == 1 && byte_order == __TR_LOG_BYTE_ORDER;
+      for (unsigned int i = 0; i < num_formats; ++i) free(formats[i]);
+      num_formats = 0;
+      seen_header = true;
+    } else if (!seen_header) {
+      valid = false;
+    } else if (tag == __TR_LOG_TAG_FORMAT) {
+      unsigned int id;
+      unsigned char type_length;
+      unsigned short format_length;
+      char type[256];
+      valid = fread(&id, 4, 1, in) == 1 && id > 0 && id <= TR_LOG_MAX_FORMATS &&
+              fread(&type_length, 1, 1, in) == 1 && fread(type, 1, type_length, in) == type_length &&
+              fread(&format_length, 2, 1, in) == 1 && fread(data, 1, format_length, in) == format_length;
+      if (!valid) break;
+      if (id > num_formats) {
+        char** grown_formats = (char**)realloc(formats, sizeof(char*) * id);
+        if (grown_formats != NULL) formats = grown_formats;
+        char (*grown_types)[TR_LOG_TYPE_SIZE] = realloc(types, sizeof(*types) * id);
+        if (grown_types != NULL) types = grown_types;
+        if (grown_formats == NULL || grown_types == NULL) {
+          valid = false;
+          break;
+        }
+        for (; num_formats < id; ++num_formats) formats[num_formats] = NULL;
+      }
+      free(formats[id - 1]);
+      formats[id - 1] = (char*)malloc((size_t)format_length + 1);
+      if (formats[id - 1] != NULL) {
+        memcpy(formats[id - 1], data, format_length);
+        formats[id - 1][format_length] = '\0';
+      }
+      size_t kept = (type_length < TR_LOG_TYPE_SIZE) ? type_length : TR_LOG_TYPE_SIZE - 1;
+      memcpy(types[id - 1], type, kept);
+      types[id - 1][kept] = '\0';
+    } else if (tag == __TR_LOG_TAG_EVENT || tag == __TR_LOG_TAG_TEXT) {
+      unsigned int id = 0;
+      long long time_sec;
+      unsigned char type_length = 0;
+      unsigned short length;
+      char type[256] = "";
+      if (tag == __TR_LOG_TAG_EVENT) {
+        valid = fread(&id, 4, 1, in) == 1 && fread(&time_sec, 8, 1, in) == 1;
+      } else {
+        valid = fread(&time_sec, 8, 1, in) == 1 && fread(&type_length, 1, 1, in) == 1 &&
+                fread(type, 1, type_length, in) == type_length;
+        type[type_length] = '\0';
+      }
+      valid = valid && fread(&length, 2, 1, in) == 1 && fread(data, 1, length, in) == length;
+      if (!valid) break;
+
+      const char* message = (const char*)data;
+      size_t message_length = length;
+      if (tag == __TR_LOG_TAG_EVENT) {
+        if (id == 0 || id > num_formats || formats[id - 1] == NULL) {
+          message_length = (size_t)snprintf(rendered, TR_LOG_RENDER_SIZE, "(unknown format %u)", id);
+          strcpy(type, "LOG");
+        } else {
+          message_length = __tr_log_render(formats[id - 1], data, length, rendered, TR_LOG_RENDER_SIZE);
+          strcpy(type, types[id - 1]);
+        }
+        message = rendered;
+      }
+
+      // Format: [TIMESTAMP] [LOG] [TYPE] MESSAGE
+      char time_string[32];
+      __tr_log_format_time(time_sec, time_string, sizeof(time_string));
+      fprintf(out, "%s [LOG] [%s] ", time_string, type);
+      fwrite(message, 1, message_length, out);
+      if (message_length == 0 || message[message_length - 1] != '\n') fputc('\n', out);
+      lines++;
+    } else {
+      valid = false;
+    }
+  }
+
+  for (unsigned int i = 0; i < num_formats; ++i) free(formats[i]);
+  free(formats);
+  free(types);
+  free(data);
+  free(rendered);
+  return valid ? lines : -1;
+}
+
+#endif // TR_LOG
+
+#ifdef TR_LOG_VIEWER
+
+// --- Log Viewer ---
+// A scrolling view of a text file that may be huge and still growing (e.g. a service log),
+// for use inside a Tread app. The file is memory-mapped and drawing a frame only reads the
+// lines that are on screen. A sparse line index (the offset of every TR_VIEWER_INDEX_STRIDE-th
+// line) is built one chunk per update, so line numbers fill in without stalling the frame
+// loop. Appends are followed like `tail -f` (inotify on Linux, polling elsewhere) and substring
+// search runs on a worker thread. POSIX builds need -pthread.
+
+#include <stdatomic.h> // For the search thread's quit flag
+#include <ctype.h>     // For tolower, isupper
+#ifndef _WIN32
+  #include <pthread.h>  // For the search thread
+  #include <sys/mman.h> // For mmap, munmap
+  #include <sys/stat.h> // For fstat, stat
+  #ifdef __linux__
+    #include <sys/inotify.h> // For following appends without polling
+  #endif
+#endif
+
+#define TR_VIEWER_PATH_SIZE 1024
+#define TR_VIEWER_INDEX_STRIDE 1024 // Lines between two entries of the sparse line index
+#define TR_VIEWER_INDEX_CHUNK (16 * 1024 * 1024) // Bytes indexed per TR_LogViewerUpdate
+#define TR_VIEWER_SEARCH_SLICE (4 * 1024 * 1024) // Bytes the search thread scans each time it takes the lock
+#define TR_VIEWER_MAX_QUERY 128 // Longest search query, including the null terminator
+#define TR_VIEWER_POLL_MS 250 // How often the file is checked for changes (and rotation) without inotify
+#define TR_VIEWER_TAB_WIDTH 8
+#define TR_VIEWER_SEARCH_CONTEXT 3 // Lines kept above a search match when the view jumps to it
+#define TR_VIEWER_NOT_FOUND ((size_t)-1)
+
+// Search states reported by TR_LogViewerGetStatus
+#define TR_VIEWER_SEARCH_IDLE 0
+#define TR_VIEWER_SEARCH_RUNNING 1
+#define TR_VIEWER_SEARCH_FOUND 2
+#define TR_VIEWER_SEARCH_NOT_FOUND 3
+
+// What a viewer is showing, for status bars (see TR_LogViewerGetStatus)
+typedef struct {
+  size_t file_size;
+  size_t lines;            // Lines counted so far
+  bool index_complete;     // True once `lines` covers the whole file
+  long long top_line;      // 1-based number of the first visible line, or -1 if it isn't indexed yet
+  bool following;          // True if the view sticks to the end of the file
+  int search_state;        // One of the TR_VIEWER_SEARCH_ states
+  double search_progress;  // Share of the file searched so far (0 to 1)
+} TR_LogViewerStatus;
+
+typedef struct {
+  char path[TR_VIEWER_PATH_SIZE];
+#ifdef _WIN32
+  HANDLE file;
+  HANDLE mapping;
+  HANDLE thread;
+  CRITICAL_SECTION lock;
+#else
+  int fd;
+  int inotify_fd;          // -1 if inotify isn't available
+  pthread_t thread;
+  pthread_mutex_t lock;
+#endif
+  // The mapping (only the main thread changes it, always while holding the lock)
+  const char* data;
+  size_t size;
+  long long next_poll_ns;
+
+  // Sparse line index: checkpoints[k] is the offset of line k * TR_VIEWER_INDEX_STRIDE
+  size_t* checkpoints;
+  size_t num_checkpoints;
+  size_t checkpoint_capacity;
+  size_t indexed_bytes;    // Bytes scanned for line breaks so far
+  size_t indexed_lines;    // Line breaks found in them
+
+  // View
+  size_t top;              // Offset of the first visible line
+  int left;                // Columns scrolled to the right
+  int rows;                // Height of the last draw
+  bool follow;
+
+  // Search (shared with the search thread, guarded by the lock)
+  char query[TR_VIEWER_MAX_QUERY];
+  size_t query_length;
+  size_t search_origin;    // Where the current query started searching from
+  size_t search_start;     // Where the search thread should start
+  size_t search_scanned;
+  size_t match;            // Offset of the match when the state is TR_VIEWER_SEARCH_FOUND
+  unsigned int search_generation; // Bumped for every new request
+  unsigned int shown_generation;  // Request whose match the view last jumped to
+  int search_state;
+  bool search_thread_started;
+  atomic_bool quit;
+} TR_LogViewer;
+
+#ifdef _WIN32
+  #define __TR_VIEWER_LOCK(viewer) EnterCriticalSection(&(viewer)->lock)
+  #define __TR_VIEWER_UNLOCK(viewer) LeaveCriticalSection(&(viewer)->lock)
+#else
+  #define __TR_VIEWER_LOCK(viewer) pthread_mutex_lock(&(viewer)->lock)
+  #define __TR_VIEWER_UNLOCK(viewer) pthread_mutex_unlock(&(viewer)->lock)
+#endif
+
+static inline void __tr_viewer_sleep_ms(int ms) {
+#ifdef _WIN32
+  Sleep((DWORD)ms);
+#else
+  struct timespec req = { ms / 1000, (long)(ms % 1000) * 1000000L };
+  nanosleep(&req, NULL);
+#endif
+}
+
+// Finds the first match of a query starting in [from, to). The query is all lowercase when
+// ignore_case is set. Returns TR_VIEWER_NOT_FOUND if there isn't one.
+static inline size_t __tr_viewer_find(const char* data, size_t size, size_t from, size_t to,
+                                      const char* query, size_t length, bool ignore_case) {
+  if (length == 0 || length > size) return TR_VIEWER_NOT_FOUND;
+  if (to > size - length + 1) to = size - length + 1; // Matches may run past `to`, not past the end
+  if (from >= to) return TR_VIEWER_NOT_FOUND;
+
+  // Candidates come from memchr on the first character (both cases of it when ignoring case)
+  char first = query[0];
+  char other = ignore_case ? (char)toupper((unsigned char)first) : first;
+  const char* end = data + to;
+  const char* next_first = (const char*)memchr(data + from, first, to - from);
+  const char* next_other = (other != first) ? (const char*)memchr(data + from, other, to - from) : NULL;
+  while (next_first != NULL || next_other != NULL) {
+    const char* hit;
+    if (next_other == NULL || (next_first != NULL && next_first < next_other)) {
+      hit = next_first;
+      next_first = (hit + 1 < end) ? (const char*)memchr(hit + 1, first, (size_t)(end - hit - 1)) : NULL;
+    } else {
+      hit = next_other;
+      next_other = (hit + 1 < end) ? (const char*)memchr(hit + 1, other, (size_t)(end - hit - 1)) : NULL;
+    }
+
+    if (!ignore_case) {
+      if (memcmp(hit, query, length) == 0) return (size_t)(hit - data);
+      continue;
+    }
+    size_t k = 1;
+    while (k < length && (char)tolower((unsigned char)hit[k]) == query[k]) k++;
+    if (k == length) return (size_t)(hit - data);
+  }
+  return TR_VIEWER_NOT_FOUND;
+}
+
+// Gets the current size of the open file
+static inline size_t __tr_viewer_file_size(TR_LogViewer* viewer) {
+#ifdef _WIN32
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(viewer->file, &size)) return viewer->size;
+  return (size_t)size.QuadPart;
+#else
+  struct stat st;
+  if (fstat(viewer->fd, &st) != 0) return viewer->size;
+  return (size_t)st.st_size;
+#endif
+}
+
+// Search thread: scans the file a slice at a time (wrapping around at the end) for the
+// latest query, taking the lock for each slice so the main thread can remap in between.
+#ifdef _WIN32
+static DWORD WINAPI __tr_viewer_search_thread(LPVOID arg) {
+#else
+static void* __tr_viewer_search_thread(void* arg) {
+#endif
+  TR_LogViewer* viewer = (TR_LogViewer*)arg;
+  unsigned int generation = 0;
+  char query[TR_VIEWER_MAX_QUERY];
+  size_t length = 0;
+  size_t position = 0;
+  size_t scanned = 0;
+  bool ignore_case = false;
+  bool active = false;
+  int idle_ms = 1;
+
+  while (!atomic_load(&viewer->quit)) {
+    __TR_VIEWER_LOCK(viewer);
+    if (viewer->search_generation != generation) {
+      // A new request replaces whatever was being searched
+      generation = viewer->search_generation;
+      active = (viewer->search_state == TR_VIEWER_SEARCH_RUNNING);
+      length = viewer->query_length;
+      memcpy(query, viewer->query, length + 1);
+      position = viewer->search_start;
+      scanned = 0;
+      // Smart case: a query with capitals is matched exactly, otherwise case is ignored
+      ignore_case = true;
+      for (size_t i = 0; i < length; ++i) {
+        if (isupper((unsigned char)query[i])) ignore_case = false;
+      }
+    }
+
+    if (active && __tr_viewer_file_size(viewer) < viewer->size) {
+      // Truncated under the mapping: leave it alone until the main thread remaps it
+      __TR_VIEWER_UNLOCK(viewer);
+      __tr_viewer_sleep_ms(1);
+      continue;
+    }
+    if (active) {
+      size_t size = viewer->size;
+      if (position >= size) position = 0;
+      size_t end = (size - position > TR_VIEWER_SEARCH_SLICE) ? position + TR_VIEWER_SEARCH_SLICE : size;
+      size_t found = __tr_viewer_find(viewer->data, size, position, end, query, length, ignore_case);
+      scanned += end - position;
+      position = end;
+      if (found != TR_VIEWER_NOT_FOUND) {
+        viewer->match = found;
+        viewer->search_state = TR_VIEWER_SEARCH_FOUND;
+        active = false;
+      } else if (scanned >= size) {
+        viewer->search_state = TR_VIEWER_SEARCH_NOT_FOUND;
+        active = false;
+      }
+      viewer->search_scanned = scanned;
+    }
+    __TR_VIEWER_UNLOCK(viewer);
+
+    if (active) {
+      idle_ms = 1;
+    } else {
+      __tr_viewer_sleep_ms(idle_ms);
+      idle_ms = (idle_ms * 2 > 20) ? 20 : idle_ms * 2;
+    }
+  }
+#ifdef _WIN32
+  return 0;
+#else
+  return NULL;
+#endif
+}
+
+// Maps the first `size` bytes of the file, replacing the old mapping. Call with the lock held
+// once the search thread is running.
+static inline void __tr_viewer_map(TR_LogViewer* viewer, size_t size) {
+#ifdef _WIN32
+  if (viewer->data != NULL) UnmapViewOfFile(viewer->data);
+  if (viewer->mapping != NULL) CloseHandle(viewer->mapping);
+  viewer->mapping = NULL;
+#else
+  if (viewer->data != NULL) munmap((void*)viewer->data, viewer->size);
+#endif
+  viewer->data = NULL;
+  viewer->size = 0;
+  if (size == 0) return; // Empty files can't be mapped
+
+#ifdef _WIN32
+  viewer->mapping = CreateFileMappingA(viewer->file, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (viewer->mapping == NULL) return;
+  void* data = MapViewOfFile(viewer->mapping, FILE_MAP_READ, 0, 0, size);
+  if (data == NULL) return;
+#else
+  void* data = mmap(NULL, size, PROT_READ, MAP_SHARED, viewer->fd, 0);
+  if (data == MAP_FAILED) return;
+#endif
+  viewer->data = (const char*)data;
+  viewer->size = size;
+}
+
+// Forgets the line index, view position and search (after the file was truncated or replaced).
+// Call with the lock held.
+static inline void __tr_viewer_reset(TR_LogViewer* viewer) {
+  viewer->checkpoints[0] = 0;
+  viewer->num_checkpoints = 1;
+  viewer->indexed_bytes = 0;
+  viewer->indexed_lines = 0;
+  viewer->top = 0;
+  viewer->search_state = TR_VIEWER_SEARCH_IDLE;
+  viewer->query[0] = '\0';
+  viewer->query_length = 0;
+  viewer->search_generation++;
+}
+
+// Remaps the file if it was truncated since it was mapped. Touching a mapped page past the
+// end of the file raises SIGBUS, so the main thread calls this before reading the mapping.
+static inline void __tr_viewer_check_shrunk(TR_LogViewer* viewer) {
+  if (viewer->size == 0) return;
+  __TR_VIEWER_LOCK(viewer);
+  size_t size = __tr_viewer_file_size(viewer);
+  if (size < viewer->size) {
+    __tr_viewer_reset(viewer);
+    __tr_viewer_map(viewer, size);
+    if (viewer->size != size) __tr_viewer_reset(viewer); // Mapping failed; nothing left to index
+  }
+  __TR_VIEWER_UNLOCK(viewer);
+}
+
+#if !defined(_WIN32) && defined(__linux__)
+// Watches the open file for appends, truncation and rotation
+static inline void __tr_viewer_watch(TR_LogViewer* viewer) {
+  if (viewer->inotify_fd >= 0) close(viewer->inotify_fd);
+  viewer->inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (viewer->inotify_fd < 0) return;
+  if (inotify_add_watch(viewer->inotify_fd, viewer->path, IN_MODIFY | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF) < 0) {
+    close(viewer->inotify_fd);
+    viewer->inotify_fd = -1;
+  }
+}
+#endif
+
+// Opens a file for viewing. The view starts out following the end of the file.
+// Returns NULL if the file can't be opened.
+static inline TR_LogViewer* TR_LogViewerOpen(const char* path) {
+  if (strlen(path) >= TR_VIEWER_PATH_SIZE) return NULL;
+  TR_LogViewer* viewer = (TR_LogViewer*)calloc(1, sizeof(TR_LogViewer));
+  if (viewer == NULL) return NULL;
+  strcpy(viewer->path, path);
+  viewer->checkpoint_capacity = 1024;
+  viewer->checkpoints = (size_t*)malloc(sizeof(size_t) * viewer->checkpoint_capacity);
+
+#ifdef _WIN32
+  viewer->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                             NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (viewer->file == INVALID_HANDLE_VALUE || viewer->checkpoints == NULL) {
+    if (viewer->file != INVALID_HANDLE_VALUE) CloseHandle(viewer->file);
+    free(viewer->checkpoints);
+    free(viewer);
+    return NULL;
+  }
+  InitializeCriticalSection(&viewer->lock);
+#else
+  viewer->fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (viewer->fd < 0 || viewer->checkpoints == NULL) {
+    if (viewer->fd >= 0) close(viewer->fd);
+    free(viewer->checkpoints);
+    free(viewer);
+    return NULL;
+  }
+  pthread_mutex_init(&viewer->lock, NULL);
+  viewer->inotify_fd = -1;
+  #ifdef __linux__
+    __tr_viewer_watch(viewer);
+  #endif
+#endif
+
+  __tr_viewer_reset(viewer);
+  __tr_viewer_map(viewer, __tr_viewer_file_size(viewer));
+  viewer->follow = true;
+  viewer->rows = 1;
+  viewer->next_poll_ns = __tr_get_time_ns() + TR_VIEWER_POLL_MS * 1000000LL;
+  atomic_init(&viewer->quit, false);
+
+#ifdef _WIN32
+  viewer->thread = CreateThread(NULL, 0, __tr_viewer_search_thread, viewer, 0, NULL);
+  bool started = (viewer->thread != NULL);
+#else
+  bool started = (pthread_create(&viewer->thread, NULL, __tr_viewer_search_thread, viewer) == 0);
+#endif
+  viewer->search_thread_started = started; // Without it the viewer still works, searches just never finish
+  return viewer;
+}
+
+// Stops the search thread, unmaps and closes the file and frees the viewer.
+static inline void TR_LogViewerClose(TR_LogViewer* viewer) {
+  if (viewer == NULL) return;
+  atomic_store(&viewer->quit, true);
+#ifdef _WIN32
+  if (viewer->search_thread_started) {
+    WaitForSingleObject(viewer->thread, INFINITE);
+    CloseHandle(viewer->thread);
+  }
+  __tr_viewer_map(viewer, 0);
+  CloseHandle(viewer->file);
+  DeleteCriticalSection(&viewer->lock);
+#else
+  if (viewer->search_thread_started) pthread_join(viewer->thread, NULL);
+  __tr_viewer_map(viewer, 0);
+  close(viewer->fd);
+  if (viewer->inotify_fd >= 0) close(viewer->inotify_fd);
+  pthread_mutex_destroy(&viewer->lock);
+#endif
+  free(viewer->checkpoints);
+  free(viewer);
+}
+
+// Returns the offset of the start of the line containing `offset`
+static inline size_t __tr_viewer_line_start(const TR_LogViewer* viewer, size_t offset) {
+  while (offset > 0 && viewer->data[offset - 1] != '\n') offset--;
+  return offset;
+}
+
+// Returns the offset of the first of the last `rows` lines of the file
+static inline size_t __tr_viewer_tail_start(const TR_LogViewer* viewer, int rows) {
+  if (viewer->size == 0) return 0;
+  size_t end = viewer->size;
+  if (viewer->data[end - 1] == '\n') end--; // The last line's own line break
+  size_t start = __tr_viewer_line_start(viewer, end);
+  for (int row = 1; row < rows && start > 0; ++row) {
+    start = __tr_viewer_line_start(viewer, start - 1);
+  }
+  return start;
+}
+
+// Scans the next chunk of the file for line breaks, adding to the sparse line index
+static inline void __tr_viewer_index_chunk(TR_LogViewer* viewer) {
+  if (viewer->indexed_bytes >= viewer->size) return;
+  size_t end = viewer->indexed_bytes + TR_VIEWER_INDEX_CHUNK;
+  if (end > viewer->size) end = viewer->size;
+
+  const char* p = viewer->data + viewer->indexed_bytes;
+  const char* stop = viewer->data + end;
+  while (p < stop) {
+    const char* newline = (const char*)memchr(p, '\n', (size_t)(stop - p));
+    if (newline == NULL) break;
+    p = newline + 1;
+    viewer->indexed_lines++;
+    if (viewer->indexed_lines % TR_VIEWER_INDEX_STRIDE == 0) {
+      if (viewer->num_checkpoints == viewer->checkpoint_capacity) {
+        size_t* grown = (size_t*)realloc(viewer->checkpoints, sizeof(size_t) * viewer->checkpoint_capacity * 2);
+        if (grown == NULL) break; // Keep the index we have; the rest stays unnumbered
+        viewer->checkpoints = grown;
+        viewer->checkpoint_capacity *= 2;
+      }
+      viewer->checkpoints[viewer->num_checkpoints++] = (size_t)(p - viewer->data);
+    }
+  }
+  viewer->indexed_bytes = (p < stop) ? end : (size_t)(p - viewer->data);
+}
+
+// Returns the 1-based number of the line starting at `offset`, or -1 if it isn't indexed yet
+static inline long long __tr_viewer_line_number(const TR_LogViewer* viewer, size_t offset) {
+  if (offset > viewer->indexed_bytes) return -1;
+  // The last checkpoint at or before the offset, then count the few lines after it
+  size_t low = 0, high = viewer->num_checkpoints;
+  while (high - low > 1) {
+    size_t middle = (low + high) / 2;
+    if (viewer->checkpoints[middle] <= offset) low = middle;
+    else high = middle;
+  }
+  long long line = (long long)low * TR_VIEWER_INDEX_STRIDE;
+  const char* p = viewer->data + viewer->checkpoints[low];
+  const char* stop = viewer->data + offset;
+  while (p < stop) {
+    const char* newline = (const char*)memchr(p, '\n', (size_t)(stop - p));
+    if (newline == NULL) break;
+    line++;
+    p = newline + 1;
+  }
+  return line + 1;
+}
+
+// Picks up file changes, extends the line index by one chunk and moves the view to a new
+// search match. Call once per frame, before TR_LogViewerDraw.
+static inline void TR_LogViewerUpdate(TR_LogViewer* viewer) {
+  long long now = __tr_get_time_ns();
+  bool poll = (now >= viewer->next_poll_ns);
+  bool changed = false;
+  if (poll) viewer->next_poll_ns = now + TR_VIEWER_POLL_MS * 1000000LL;
+
+#ifndef _WIN32
+  #ifdef __linux__
+    if (viewer->inotify_fd >= 0) {
+      char events[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+      while (read(viewer->inotify_fd, events, sizeof(events)) > 0) changed = true;
+    } else {
+      changed = poll;
+    }
+  #else
+    changed = poll;
+  #endif
+
+  // Log rotation: the path now names a different file, so switch to it
+  struct stat path_stat, open_stat;
+  if (poll && stat(viewer->path, &path_stat) == 0 && fstat(viewer->fd, &open_stat) == 0 &&
+      (path_stat.st_ino != open_stat.st_ino || path_stat.st_dev != open_stat.st_dev)) {
+    int fd = open(viewer->path, O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+      __TR_VIEWER_LOCK(viewer);
+      __tr_viewer_map(viewer, 0);
+      close(viewer->fd);
+      viewer->fd = fd;
+      __tr_viewer_reset(viewer);
+      __tr_viewer_map(viewer, __tr_viewer_file_size(viewer));
+      __TR_VIEWER_UNLOCK(viewer);
+      #ifdef __linux__
+        __tr_viewer_watch(viewer);
+      #endif
+      changed = false;
+    }
+  }
+#else
+  changed = poll;
+#endif
+
+  // A truncation is handled right away, even before its change event arrives
+  __tr_viewer_check_shrunk(viewer);
+  if (changed) {
+    size_t size = __tr_viewer_file_size(viewer);
+    if (size != viewer->size) {
+      __TR_VIEWER_LOCK(viewer);
+      if (size < viewer->size) __tr_viewer_reset(viewer); // Truncated: start over
+      __tr_viewer_map(viewer, size);
+      if (viewer->size != size) __tr_viewer_reset(viewer); // Mapping failed; nothing left to index
+      __TR_VIEWER_UNLOCK(viewer);
+    }
+  }
+
+  __tr_viewer_index_chunk(viewer);
+
+  // Jump to a search match the first time it's reported
+  size_t match = TR_VIEWER_NOT_FOUND;
+  __TR_VIEWER_LOCK(viewer);
+  if (viewer->search_state == TR_VIEWER_SEARCH_FOUND && viewer->shown_generation != viewer->search_generation) {
+    viewer->shown_generation = viewer->search_generation;
+    match = viewer->match;
+  }
+  __TR_VIEWER_UNLOCK(viewer);
+  if (match != TR_VIEWER_NOT_FOUND && match < viewer->size) {
+    viewer->follow = false;
+    viewer->top = __tr_viewer_line_start(viewer, match);
+    for (int i = 0; i < TR_VIEWER_SEARCH_CONTEXT && viewer->top > 0; ++i) {
+      viewer->top = __tr_viewer_line_start(viewer, viewer->top - 1);
+    }
+  }
+}
+
+// Writes one cell of the viewer straight into the screen buffer
+static inline void __tr_viewer_put(int x, int y, char character, Color fg_color, Color bg_color) {
+  if (x < 0 || x >= __tr_buffer_width || y < 0 || y >= __tr_buffer_height) return;
+  __TR_Cell* cell = &__tr_screen_buffer[y * __tr_buffer_width + x];
+  cell->character = character;
+  cell->fg_color = fg_color;
+  cell->bg_color = bg_color;
+}
+
+// Draws the visible part of the file into a rectangle. Only the lines on screen are read.
+// Tabs are expanded, other control characters and non-ASCII characters are shown as '?',
+// and the current search match is highlighted.
+static inline void TR_LogViewerDraw(TR_LogViewer* viewer, int x, int y, int width, int height, Color fg_color, Color bg_color) {
+  if (!__tr_window_open || width <= 0 || height <= 0) return;
+  if (__tr_colors_equal(bg_color, BLANK)) bg_color = __tr_current_bg_color;
+  TR_DrawRectangle(x, y, width, height, fg_color, bg_color);
+  viewer->rows = height;
+  __tr_viewer_check_shrunk(viewer);
+  if (viewer->size == 0) return;
+
+  if (viewer->follow) viewer->top = __tr_viewer_tail_start(viewer, height);
+  if (viewer->top > viewer->size) viewer->top = 0;
+
+  // The match to highlight
+  size_t highlight = TR_VIEWER_NOT_FOUND, highlight_end = 0;
+  __TR_VIEWER_LOCK(viewer);
+  if (viewer->search_state == TR_VIEWER_SEARCH_FOUND) {
+    highlight = viewer->match;
+    highlight_end = viewer->match + viewer->query_length;
+  }
+  __TR_VIEWER_UNLOCK(viewer);
+
+  size_t offset = viewer->top;
+  for (int row = 0; row < height && offset < viewer->size; ++row) {
+    const char* line = viewer->data + offset;
+    const char* newline = (const char*)memchr(line, '\n', viewer->size - offset);
+    size_t length = (newline != NULL) ? (size_t)(newline - line) : viewer->size - offset;
+    if (length > 0 && line[length - 1] == '\r') length--; // CRLF line endings
+
+    int column = 0;
+    for (size_t i = 0; i < length && column < viewer->left + width; ++i) {
+      unsigned char c = (unsigned char)line[i];
+      if (c >= 0x80 && c < 0xC0) continue; // UTF-8 continuation byte, drawn with its lead byte
+      int cells = (c == '\t') ? TR_VIEWER_TAB_WIDTH - column % TR_VIEWER_TAB_WIDTH : 1;
+      char shown = (c == '\t') ? ' ' : (c < 32 || c >= 127) ? '?' : (char)c;
+      bool highlighted = (offset + i >= highlight && offset + i < highlight_end);
+      for (int k = 0; k < cells; ++k, ++column) {
+        if (column < viewer->left || column >= viewer->left + width) continue;
+        __tr_viewer_put(x + column - viewer->left, y + row, shown,
+                        highlighted ? BLACK : fg_color, highlighted ? YELLOW : bg_color);
+      }
+    }
+    offset += (newline != NULL) ? (size_t)(newline - line) + 1 : viewer->size - offset;
+  }
+}
+
+// Scrolls by a number of lines (negative is up). Scrolling down past the end of the file
+// starts following it again.
+static inline void TR_LogViewerScroll(TR_LogViewer* viewer, long long lines) {
+  __tr_viewer_check_shrunk(viewer);
+  if (viewer->size == 0) return;
+  if (lines < 0) {
+    viewer->follow = false;
+    for (long long i = 0; i > lines && viewer->top > 0; --i) {
+      viewer->top = __tr_viewer_line_start(viewer, viewer->top - 1);
+    }
+    return;
+  }
+  size_t tail = __tr_viewer_tail_start(viewer, viewer->rows);
+  for (long long i = 0; i < lines && !viewer->follow; ++i) {
+    const char* newline = (viewer->top < tail) ?
+      (const char*)memchr(viewer->data + viewer->top, '\n', viewer->size - viewer->top) : NULL;
+    if (newline == NULL) {
+      viewer->follow = true;
+    } else {
+      viewer->top = (size_t)(newline - viewer->data) + 1;
+    }
+  }
+}
+
+// Scrolls sideways by a number of columns (negative is left).
+static inline void TR_LogViewerScrollColumns(TR_LogViewer* viewer, int columns) {
+  viewer->left += columns;
+  if (viewer->left < 0) viewer->left = 0;
+}
+
+// Jumps to the start of the file.
+static inline void TR_LogViewerScrollToStart(TR_LogViewer* viewer) {
+  viewer->follow = false;
+  viewer->top = 0;
+  viewer->left = 0;
+}
+
+// Jumps to the end of the file and keeps following new lines as they're appended.
+static inline void TR_LogViewerFollow(TR_LogViewer* viewer) {
+  viewer->follow = true;
+}
+
+// Searches for a substring from the top of the view, wrapping around at the end of the file.
+// Meant to be called on every keystroke: when the query only grew, the search carries on from
+// the previous match instead of starting over. Queries without capitals ignore case. An empty
+// query clears the search. The view jumps to the match once it's found (see TR_LogViewerUpdate).
+static inline void TR_LogViewerSearch(TR_LogViewer* viewer, const char* query) {
+  size_t length = strlen(query);
+  if (length >= TR_VIEWER_MAX_QUERY) length = TR_VIEWER_MAX_QUERY - 1;
+
+  __TR_VIEWER_LOCK(viewer);
+  bool extends = (viewer->query_length > 0 && length > viewer->query_length &&
+                  memcmp(query, viewer->query, viewer->query_length) == 0);
+  if (viewer->query_length == 0) viewer->search_origin = viewer->top;
+  size_t start = viewer->search_origin;
+  int state = TR_VIEWER_SEARCH_RUNNING;
+  if (length == 0) {
+    state = TR_VIEWER_SEARCH_IDLE;
+  } else if (extends && viewer->search_state == TR_VIEWER_SEARCH_FOUND) {
+    start = viewer->match; // A longer query can't match before the shorter one did
+  } else if (extends && viewer->search_state == TR_VIEWER_SEARCH_NOT_FOUND) {
+    state = TR_VIEWER_SEARCH_NOT_FOUND; // Nor anywhere the shorter one didn't
+  }
+  memcpy(viewer->query, query, length);
+  viewer->query[length] = '\0';
+  viewer->query_length = length;
+  viewer->search_start = start;
+  viewer->search_scanned = 0;
+  viewer->search_state = state;
+  viewer->search_generation++;
+  __TR_VIEWER_UNLOCK(viewer);
+}
+
+// Searches for the next match of the current query after the one shown.
+static inline void TR_LogViewerSearchNext(TR_LogViewer* viewer) {
+  __TR_VIEWER_LOCK(viewer);
+  if (viewer->query_length > 0) {
+    size_t start = (viewer->search_state == TR_VIEWER_SEARCH_FOUND) ? viewer->match + 1 : viewer->top;
+    viewer->search_origin = start;
+    viewer->search_start = start;
+    viewer->search_scanned = 0;
+    viewer->search_state = TR_VIEWER_SEARCH_RUNNING;
+    viewer->search_generation++;
+  }
+  __TR_VIEWER_UNLOCK(viewer);
+}
+
+// Handles the viewer's navigation keys: arrows (and j/k) scroll, space/b page down/up,
+// g jumps to the start, G follows the end and n finds the next search match.
+// Returns true if the key was used.
+static inline bool TR_LogViewerHandleKey(TR_LogViewer* viewer, int key) {
+  int page = (viewer->rows > 1) ? viewer->rows - 1 : 1;
+  switch (key) {
+    case TR_KEY_UP: case 'k': TR_LogViewerScroll(viewer, -1); break;
+    case TR_KEY_DOWN: case 'j': TR_LogViewerScroll(viewer, 1); break;
+    case TR_KEY_LEFT: TR_LogViewerScrollColumns(viewer, -TR_VIEWER_TAB_WIDTH); break;
+    case TR_KEY_RIGHT: TR_LogViewerScrollColumns(viewer, TR_VIEWER_TAB_WIDTH); break;
+    case ' ': TR_LogViewerScroll(viewer, page); break;
+    case 'b': TR_LogViewerScroll(viewer, -page); break;
+    case 'g': TR_LogViewerScrollToStart(viewer); break;
+    case 'G': TR_LogViewerFollow(viewer); break;
+    case 'n': TR_LogViewerSearchNext(viewer); break;
+    default: return false;
+  }
+  return true;
+}
+
+// Returns what the viewer is showing, for a status bar.
+static inline TR_LogViewerStatus TR_LogViewerGetStatus(TR_LogViewer* viewer) {
+  TR_LogViewerStatus status = {0};
+  __tr_viewer_check_shrunk(viewer);
+  status.file_size = viewer->size;
+  status.index_complete = (viewer->indexed_bytes >= viewer->size);
+  status.lines = viewer->indexed_lines;
+  if (status.index_complete && viewer->size > 0 && viewer->data[viewer->size - 1] != '\n') status.lines++; // Unterminated last line
+  status.top_line = (viewer->size > 0) ? __tr_viewer_line_number(viewer, viewer->top) : -1;
+  status.following = viewer->follow;
+
+  __TR_VIEWER_LOCK(viewer);
+  status.search_state = viewer->search_state;
+  if (viewer->search_state == TR_VIEWER_SEARCH_RUNNING && viewer->size > 0) {
+    status.search_progress = (double)viewer->search_scanned / (double)viewer->size;
+  } else if (viewer->search_state != TR_VIEWER_SEARCH_IDLE) {
+    status.search_progress = 1.0;
+  }
+  __TR_VIEWER_UNLOCK(viewer);
+  return status;
+}
+
+#endif // TR_LOG_VIEWER
+
+#ifdef TR_PATHFINDING
+
+// --- Pathfinding ---
+// Grid pathfinding for tile games: A* over a binary heap, Jump Point Search, and multi-source
+// flow fields. A pathfinder copies the walls of a char map or a bitset into its own grid once.
+// That grid has a blocked border, so neighbour lookups need no bounds checks. Every search
+// after that runs in memory allocated up front. Call TR_PathfinderSetGrid (or
+// TR_PathfinderSetBlocked) again when walls change. Moves are 4-way, or 8-way with
+// TR_PATH_DIAGONAL (never cutting a wall's corner). Costs are in TR_PATH_STRAIGHT_COST and
+// TR_PATH_DIAGONAL_COST units.
+
+#define TR_PATH_STRAIGHT_COST 10 // Cost of an orthogonal step
+#define TR_PATH_DIAGONAL_COST 14 // Cost of a diagonal step (10 * sqrt(2), rounded)
+#define TR_PATH_UNREACHABLE -1   // Flow field value of walls and cells no source can reach
+
+// Flags for TR_PathfinderCreate
+#define TR_PATH_DIAGONAL 1 // Allow 8-way moves
+
+typedef struct {
+  int x;
+  int y;
+} TR_PathPoint;
+
+// An open list entry. The key orders by estimated total cost (f), then by the higher cost
+// so far (g), which reaches the goal sooner; keeping it next to the node means sifting
+// the heap never reads the node pool.
+typedef struct {
+  unsigned long long key; // f << 32 | (0xFFFFFFFF - g)
+  int node;
+} __TR_PathHeapEntry;
+
+typedef struct {
+  int width;
+  int height;
+  int stride;             // width + 2: the grid has a one-cell blocked border
+  bool diagonal;
+  unsigned char* blocked; // (width + 2) * (height + 2) cells, 1 for walls
+
+  // Node pool, one node per grid cell. A node only holds data for the current search
+  // if its stamp matches search_stamp, so nothing has to be cleared between searches.
+  int* cost;              // Cost from the start (g)
+  int* parent;            // Also the queue of 4-way flow fields
+  int* heap_slot;         // Position in the open list, or -1 once the node is closed
+  unsigned int* stamp;
+  unsigned int search_stamp;
+  __TR_PathHeapEntry* heap; // Open list: a binary min-heap
+  int heap_size;
+  int expanded;           // Nodes the last search took off the open list
+} TR_Pathfinder;
+
+static const int __tr_path_dx[8] = { 0, 1, 0, -1, 1, 1, -1, -1 }; // 4 straight directions, then 4 diagonals
+static const int __tr_path_dy[8] = { -1, 0, 1, 0, -1, 1, 1, -1 };
+
+// Creates a pathfinder for a width x height grid with every cell open.
+// flags can be TR_PATH_DIAGONAL. Returns NULL if it can't be allocated.
+static inline TR_Pathfinder* TR_PathfinderCreate(int width, int height, int flags) {
+  if (width <= 0 || height <= 0) return NULL;
+  TR_Pathfinder* pf = (TR_Pathfinder*)calloc(1, sizeof(TR_Pathfinder));
+  if (pf == NULL) return NULL;
+  size_t cells = (size_t)(width + 2) * (size_t)(height + 2);
+  pf->width = width;
+  pf->height = height;
+  pf->stride = width + 2;
+  pf->diagonal = (flags & TR_PATH_DIAGONAL) != 0;
+  pf->blocked = (unsigned char*)malloc(cells);
+  pf->cost = (int*)malloc(cells * sizeof(int));
+  pf->parent = (int*)malloc(cells * sizeof(int));
+  pf->heap_slot = (int*)malloc(cells * sizeof(int));
+  pf->stamp = (unsigned int*)calloc(cells, sizeof(unsigned int));
+  pf->heap = (__TR_PathHeapEntry*)malloc(cells * sizeof(__TR_PathHeapEntry));
+  if (pf->blocked == NULL || pf->cost == NULL || pf->parent == NULL ||
+      pf->heap_slot == NULL || pf->stamp == NULL || pf->heap == NULL) {
+    free(pf->blocked); free(pf->cost); free(pf->parent);
+    free(pf->heap_slot); free(pf->stamp); free(pf->heap);
+    free(pf);
+    return NULL;
+  }
+
+  // Open inside, blocked border
+  memset(pf->blocked, 1, cells);
+  for (int y = 0; y < height; y++) {
+    memset(pf->blocked + (size_t)(y + 1) * pf->stride + 1, 0, width);
+  }
+  return pf;
+}
+
+static inline void TR_PathfinderDestroy(TR_Pathfinder* pf) {
+  if (pf == NULL) return;
+  free(pf->blocked);
+  free(pf->cost);
+  free(pf->parent);
+  free(pf->heap_slot);
+  free(pf->stamp);
+  free(pf->heap);
+  free(pf);
+}
+
+// Copies the walls from a char map: row y starts at cells + y * row_stride (so a
+// `char map[H][W + 1]` of strings has a row_stride of W + 1) and any character in
+// `blocking` (e.g. "#") is a wall.
+static inline void TR_PathfinderSetGrid(TR_Pathfinder* pf, const char* cells, int row_stride, const char* blocking) {
+  unsigned char is_wall[256] = {0};
+  for (const char* c = blocking; *c != '\0'; c++) is_wall[(unsigned char)*c] = 1;
+  for (int y = 0; y < pf->height; y++) {
+    const unsigned char* row = (const unsigned char*)cells + (size_t)y * row_stride;
+    unsigned char* out = pf->blocked + (size_t)(y + 1) * pf->stride + 1;
+    for (int x = 0; x < pf->width; x++) out[x] = is_wall[row[x]];
+  }
+}
+
+// Copies the walls from a bitset: bit (y * width + x) is set for a wall, lowest bit first.
+static inline void TR_PathfinderSetGridBits(TR_Pathfinder* pf, const unsigned char* bits) {
+  for (int y = 0; y < pf->height; y++) {
+    unsigned char* out = pf->blocked + (size_t)(y + 1) * pf->stride + 1;
+    size_t bit = (size_t)y * pf->width;
+    for (int x = 0; x < pf->width; x++, bit++) out[x] = (bits[bit >> 3] >> (bit & 7)) & 1;
+  }
+}
+
+static inline void TR_PathfinderSetBlocked(TR_Pathfinder* pf, int x, int y, bool blocked) {
+  if (x < 0 || y < 0 || x >= pf->width || y >= pf->height) return;
+  pf->blocked[(y + 1) * pf->stride + x + 1] = blocked ? 1 : 0;
+}
+
+// Returns true for walls and cells outside the grid.
+static inline bool TR_PathfinderIsBlocked(TR_Pathfinder* pf, int x, int y) {
+  if (x < 0 || y < 0 || x >= pf->width || y >= pf->height) return true;
+  return pf->blocked[(y + 1) * pf->stride + x + 1] != 0;
+}
+
+// Starts a new search: every node becomes stale without touching the pool
+static inline void __tr_path_begin(TR_Pathfinder* pf) {
+  pf->search_stamp++;
+  if (pf->search_stamp == 0) { // Wrapped around: stamps from 2^32 searches ago would look current
+    memset(pf->stamp, 0, (size_t)pf->stride * (pf->height + 2) * sizeof(unsigned int));
+    pf->search_stamp = 1;
+  }
+  pf->heap_size = 0;
+  pf->expanded = 0;
+}
+
+static inline unsigned long long __tr_path_key(int estimate, int cost) {
+  return ((unsigned long long)(unsigned int)estimate << 32) | (0xFFFFFFFFu - (unsigned int)cost);
+}
+
+// Moves the entry at slot up to where it belongs
+static inline void __tr_path_sift_up(TR_Pathfinder* pf, int slot, __TR_PathHeapEntry entry) {
+  while (slot > 0) {
+    int up = (slot - 1) / 2;
+    if (pf->heap[up].key <= entry.key) break;
+    pf->heap[slot] = pf->heap[up];
+    pf->heap_slot[pf->heap[slot].node] = slot;
+    slot = up;
+  }
+  pf->heap[slot] = entry;
+  pf->heap_slot[entry.node] = slot;
+}
+
+// Takes the best node off the open list and closes it
+static inline int __tr_path_pop(TR_Pathfinder* pf) {
+  int top = pf->heap[0].node;
+  pf->heap_slot[top] = -1;
+  __TR_PathHeapEntry entry = pf->heap[--pf->heap_size];
+  int slot = 0;
+  if (pf->heap_size > 0) {
+    for (;;) {
+      int child = slot * 2 + 1;
+      if (child >= pf->heap_size) break;
+      if (child + 1 < pf->heap_size && pf->heap[child + 1].key < pf->heap[child].key) child++;
+      if (pf->heap[child].key >= entry.key) break;
+      pf->heap[slot] = pf->heap[child];
+      pf->heap_slot[pf->heap[slot].node] = slot;
+      slot = child;
+    }
+    pf->heap[slot] = entry;
+    pf->heap_slot[entry.node] = slot;
+  }
+  return top;
+}
+
+// Octile distance (Manhattan without diagonals) between two cells, in cost units
+static inline int __tr_path_distance(const TR_Pathfinder* pf, int a, int b) {
+  int dx = abs(a % pf->stride - b % pf->stride);
+  int dy = abs(a / pf->stride - b / pf->stride);
+  if (!pf->diagonal) return (dx + dy) * TR_PATH_STRAIGHT_COST;
+  int low = (dx < dy) ? dx : dy;
+  int high = (dx < dy) ? dy : dx;
+  return low * TR_PATH_DIAGONAL_COST + (high - low) * TR_PATH_STRAIGHT_COST;
+}
+
+// Reaches `node` from `from` at `cost`, opening it or lowering its cost if that's better
+static inline void __tr_path_relax(TR_Pathfinder* pf, int node, int from, int cost, int goal) {
+  if (pf->stamp[node] != pf->search_stamp) {
+    pf->stamp[node] = pf->search_stamp;
+    pf->cost[node] = cost;
+    pf->parent[node] = from;
+    __TR_PathHeapEntry entry = { __tr_path_key(cost + (goal >= 0 ? __tr_path_distance(pf, node, goal) : 0), cost), node };
+    __tr_path_sift_up(pf, pf->heap_size++, entry);
+  } else if (pf->heap_slot[node] >= 0 && cost < pf->cost[node]) {
+    int slot = pf->heap_slot[node];
+    int estimate = (int)(pf->heap[slot].key >> 32) - (pf->cost[node] - cost); // The heuristic part stays the same
+    pf->cost[node] = cost;
+    pf->parent[node] = from;
+    __TR_PathHeapEntry entry = { __tr_path_key(estimate, cost), node };
+    __tr_path_sift_up(pf, slot, entry);
+  }
+}
+
+// A diagonal step is only allowed if both cells it passes between are open
+static inline bool __tr_path_can_step(const TR_Pathfinder* pf, int cell, int dx, int dy) {
+  if (pf->blocked[cell + dy * pf->stride + dx]) return false;
+  return dx == 0 || dy == 0 || (!pf->blocked[cell + dx] && !pf->blocked[cell + dy * pf->stride]);
+}
+
+// Jump Point Search: walks from cell in (dx, dy) until it hits a wall (returns -1), the goal,
+// or a jump point, a cell where an optimal path may have to turn because a wall beside the
+// line ends. Those are the only cells the search needs to put on the open list.
+static inline int __tr_path_jump(const TR_Pathfinder* pf, int cell, int dx, int dy, int goal) {
+  const unsigned char* blocked = pf->blocked;
+  int stride = pf->stride;
+  int step = dy * stride + dx;
+  for (;;) {
+    if (!__tr_path_can_step(pf, cell, dx, dy)) return -1;
+    cell += step;
+    if (cell == goal) return cell;
+    if (dx != 0 && dy != 0) {
+      // Diagonal: stop wherever a straight jump out of this cell finds something
+      if (__tr_path_jump(pf, cell, dx, 0, goal) >= 0 || __tr_path_jump(pf, cell, 0, dy, goal) >= 0) return cell;
+    } else if (dx != 0) {
+      if ((!blocked[cell - stride] && blocked[cell - dx - stride]) ||
+          (!blocked[cell + stride] && blocked[cell - dx + stride])) return cell;
+    } else {
+      if ((!blocked[cell - 1] && blocked[cell - 1 - dy * stride]) ||
+          (!blocked[cell + 1] && blocked[cell + 1 - dy * stride])) return cell;
+      // Without diagonals a vertical line also stops where a sideways jump finds something
+      if (!pf->diagonal && (__tr_path_jump(pf, cell, 1, 0, goal) >= 0 || __tr_path_jump(pf, cell, -1, 0, goal) >= 0)) return cell;
+    }
+  }
+}
+
+// Which of the 8 directions (bit d for __tr_path_dx[d], __tr_path_dy[d]) JPS should try
+// from a node reached by moving (dx, dy). Only the directions a path through the node
+// could need; the start node (0, 0) tries them all.
+static inline int __tr_path_prune(const TR_Pathfinder* pf, int dx, int dy) {
+  // Bit masks of the direction table: up 1, right 2, down 4, left 8, diagonals 16 (up right),
+  // 32 (down right), 64 (down left), 128 (up left)
+  int all = pf->diagonal ? 0xFF : 0x0F;
+  if (dx == 0 && dy == 0) return all;
+  int up = 1, right = 2, down = 4, left = 8;
+  int forward = (dy < 0 ? up : 0) | (dy > 0 ? down : 0) | (dx > 0 ? right : 0) | (dx < 0 ? left : 0);
+  if (!pf->diagonal) {
+    return forward | ((dx != 0) ? (up | down) : (left | right));
+  }
+  if (dx != 0 && dy != 0) {
+    int diagonal_bit = (dx > 0) ? ((dy < 0) ? 16 : 32) : ((dy > 0) ? 64 : 128);
+    return forward | diagonal_bit; // Straight parts of the move, and the move itself
+  }
+  if (dx != 0) {
+    int turns = (dx > 0) ? (16 | 32) : (64 | 128);
+    return forward | up | down | turns;
+  }
+  int turns = (dy < 0) ? (16 | 128) : (32 | 64);
+  return forward | left | right | turns;
+}
+
+// The search shared by A* and JPS. Returns true if the goal was reached; the path is then
+// in the parent links.
+static inline bool __tr_path_search(TR_Pathfinder* pf, int start, int goal, bool jump) {
+  __tr_path_begin(pf);
+  int directions = pf->diagonal ? 8 : 4;
+  __tr_path_relax(pf, start, -1, 0, goal);
+  while (pf->heap_size > 0) {
+    int node = __tr_path_pop(pf);
+    pf->expanded++;
+    if (node == goal) return true;
+
+    int mask = 0xFF;
+    if (jump) {
+      int dx = 0, dy = 0;
+      int from = pf->parent[node];
+      if (from >= 0) {
+        int px = from % pf->stride, py = from / pf->stride;
+        int x = node % pf->stride, y = node / pf->stride;
+        dx = (x > px) - (x < px);
+        dy = (y > py) - (y < py);
+      }
+      mask = __tr_path_prune(pf, dx, dy);
+    }
+    for (int d = 0; d < directions; d++) {
+      if (!(mask & (1 << d))) continue;
+      int next;
+      if (jump) {
+        next = __tr_path_jump(pf, node, __tr_path_dx[d], __tr_path_dy[d], goal);
+        if (next < 0) continue;
+      } else {
+        if (!__tr_path_can_step(pf, node, __tr_path_dx[d], __tr_path_dy[d])) continue;
+        next = node + __tr_path_dy[d] * pf->stride + __tr_path_dx[d];
+      }
+      __tr_path_relax(pf, next, node, pf->cost[node] + __tr_path_distance(pf, node, next), goal);
+    }
+  }
+  return false;
+}
+
+// Writes the path ending at goal (every cell, including the ones JPS jumped over) and returns
+// its length in points.
+static inline int __tr_path_write(TR_Pathfinder* pf, int goal, TR_PathPoint* path, int max_points) {
+  int length = 1;
+  for (int node = goal; pf->parent[node] >= 0; node = pf->parent[node]) {
+    int from = pf->parent[node];
+    int dx = abs(node % pf->stride - from % pf->stride);
+    int dy = abs(node / pf->stride - from / pf->stride);
+    length += (dx > dy) ? dx : dy;
+  }
+  if (path == NULL) return length;
+
+  int index = length - 1;
+  for (int node = goal; index >= 0; node = pf->parent[node]) {
+    int x = node % pf->stride - 1;
+    int y = node / pf->stride - 1;
+    int from = pf->parent[node];
+    int sx = 0, sy = 0;
+    if (from >= 0) {
+      sx = (from % pf->stride - 1 > x) - (from % pf->stride - 1 < x);
+      sy = (from / pf->stride - 1 > y) - (from / pf->stride - 1 < y);
+    }
+    // Walk back along the segment to the parent, which the next iteration writes
+    do {
+      if (index < max_points) {
+        path[index].x = x;
+        path[index].y = y;
+      }
+      index--;
+      x += sx;
+      y += sy;
+    } while (from >= 0 && y * pf->stride + x + pf->stride + 1 != from);
+  }
+  return length;
+}
+
+static inline int __tr_path_find(TR_Pathfinder* pf, int start_x, int start_y, int goal_x, int goal_y,
+                                 TR_PathPoint* path, int max_points, bool jump) {
+  if (TR_PathfinderIsBlocked(pf, start_x, start_y) || TR_PathfinderIsBlocked(pf, goal_x, goal_y)) return -1;
+  int start = (start_y + 1) * pf->stride + start_x + 1;
+  int goal = (goal_y + 1) * pf->stride + goal_x + 1;
+  if (!__tr_path_search(pf, start, goal, jump)) return -1;
+  return __tr_path_write(pf, goal, path, max_points);
+}
+
+// Finds a shortest path with A*. Returns the number of points on it (start and goal
+// included) or -1 if there's none. Only the first max_points are written to path
+// (which may be NULL to just get the length).
+static inline int TR_FindPath(TR_Pathfinder* pf, int start_x, int start_y, int goal_x, int goal_y,
+                              TR_PathPoint* path, int max_points) {
+  return __tr_path_find(pf, start_x, start_y, goal_x, goal_y, path, max_points, false);
+}
+
+// Same as TR_FindPath but with Jump Point Search, which finds an equally short path while
+// opening far fewer nodes on open grids. Mazes of one-cell corridors gain little.
+static inline int TR_FindPathJPS(TR_Pathfinder* pf, int start_x, int start_y, int goal_x, int goal_y,
+                                 TR_PathPoint* path, int max_points) {
+  return __tr_path_find(pf, start_x, start_y, goal_x, goal_y, path, max_points, true);
+}
+
+// Fills field (width * height values, row by row) with the cost from every cell to the
+// nearest of the sources, or TR_PATH_UNREACHABLE. Without diagonals that's a plain
+// breadth-first search; with them, Dijkstra's algorithm on a bucket queue. Blocked
+// sources are skipped. Follow the field with TR_FlowFieldDirection.
+static inline void TR_ComputeFlowField(TR_Pathfinder* pf, const TR_PathPoint* sources, int num_sources, int* field) {
+  __tr_path_begin(pf);
+  const unsigned char* blocked = pf->blocked;
+  int stride = pf->stride;
+
+  // Walls start at -2 and open cells at -1, so the search reads nothing but costs
+  size_t cells = (size_t)stride * (pf->height + 2);
+  int* cost = pf->cost;
+  for (size_t cell = 0; cell < cells; cell++) cost[cell] = -1 - blocked[cell];
+
+  if (!pf->diagonal) {
+    int* queue = pf->parent;
+    int head = 0, tail = 0;
+    for (int i = 0; i < num_sources; i++) {
+      if (TR_PathfinderIsBlocked(pf, sources[i].x, sources[i].y)) continue;
+      int cell = (sources[i].y + 1) * stride + sources[i].x + 1;
+      if (cost[cell] == 0) continue;
+      cost[cell] = 0;
+      queue[tail++] = cell;
+    }
+    while (head < tail) {
+      int cell = queue[head++];
+      int next_cost = cost[cell] + TR_PATH_STRAIGHT_COST;
+      if (cost[cell - stride] == -1) { cost[cell - stride] = next_cost; queue[tail++] = cell - stride; }
+      if (cost[cell + 1] == -1) { cost[cell + 1] = next_cost; queue[tail++] = cell + 1; }
+      if (cost[cell + stride] == -1) { cost[cell + stride] = next_cost; queue[tail++] = cell + stride; }
+      if (cost[cell - 1] == -1) { cost[cell - 1] = next_cost; queue[tail++] = cell - 1; }
+    }
+    pf->expanded = tail;
+  } else {
+    // No step costs more than TR_PATH_DIAGONAL_COST, so every pending cost falls in one of
+    // that many + 1 buckets: doubly linked lists through parent (next) and heap_slot (prev,
+    // -1 at a bucket's head and -3 once a cell is final).
+    #define __TR_PATH_BUCKETS (TR_PATH_DIAGONAL_COST + 1)
+    int* next = pf->parent;
+    int* prev = pf->heap_slot;
+    int buckets[__TR_PATH_BUCKETS];
+    for (int b = 0; b < __TR_PATH_BUCKETS; b++) buckets[b] = -1;
+    int pending = 0;
+    for (int i = 0; i < num_sources; i++) {
+      if (TR_PathfinderIsBlocked(pf, sources[i].x, sources[i].y)) continue;
+      int cell = (sources[i].y + 1) * stride + sources[i].x + 1;
+      if (cost[cell] == 0) continue;
+      cost[cell] = 0;
+      next[cell] = buckets[0];
+      prev[cell] = -1;
+      if (buckets[0] >= 0) prev[buckets[0]] = cell;
+      buckets[0] = cell;
+      pending++;
+    }
+    for (int current = 0; pending > 0; current++) {
+      int* bucket = &buckets[current % __TR_PATH_BUCKETS];
+      while (*bucket >= 0) {
+        int cell = *bucket;
+        *bucket = next[cell];
+        if (next[cell] >= 0) prev[next[cell]] = -1;
+        prev[cell] = -3;
+        pending--;
+        pf->expanded++;
+        for (int d = 0; d < 8; d++) {
+          if (!__tr_path_can_step(pf, cell, __tr_path_dx[d], __tr_path_dy[d])) continue;
+          int neighbour = cell + __tr_path_dy[d] * stride + __tr_path_dx[d];
+          int next_cost = current + (d < 4 ? TR_PATH_STRAIGHT_COST : TR_PATH_DIAGONAL_COST);
+          if (cost[neighbour] == -1) {
+            pending++;
+          } else if (prev[neighbour] != -3 && next_cost < cost[neighbour]) {
+            // Move it to a cheaper bucket
+            if (prev[neighbour] >= 0) next[prev[neighbour]] = next[neighbour];
+            else buckets[cost[neighbour] % __TR_PATH_BUCKETS] = next[neighbour];
+            if (next[neighbour] >= 0) prev[next[neighbour]] = prev[neighbour];
+          } else {
+            continue;
+          }
+          int* target = &buckets[next_cost % __TR_PATH_BUCKETS];
+          cost[neighbour] = next_cost;
+          next[neighbour] = *target;
+          prev[neighbour] = -1;
+          if (*target >= 0) prev[*target] = neighbour;
+          *target = neighbour;
+        }
+      }
+    }
+    #undef __TR_PATH_BUCKETS
+  }
+
+  for (int y = 0; y < pf->height; y++) {
+    const int* row = cost + (size_t)(y + 1) * stride + 1;
+    int* out = field + (size_t)y * pf->width;
+    for (int x = 0; x < pf->width; x++) out[x] = (row[x] < 0) ? TR_PATH_UNREACHABLE : row[x];
+  }
+}
+
+// Looks up which way to go from (x, y) in a flow field: the step that leaves the least
+// cost to pay. Returns false at a source, on an unreachable cell or outside the grid.
+static inline bool TR_FlowFieldDirection(TR_Pathfinder* pf, const int* field, int x, int y, int* dx, int* dy) {
+  if (TR_PathfinderIsBlocked(pf, x, y)) return false;
+  int here = field[y * pf->width + x];
+  if (here <= 0) return false; // A source, or unreachable
+  int cell = (y + 1) * pf->stride + x + 1;
+  int best = -1;
+  int best_cost = 0;
+  for (int d = 0; d < (pf->diagonal ? 8 : 4); d++) {
+    if (!__tr_path_can_step(pf, cell, __tr_path_dx[d], __tr_path_dy[d])) continue;
+    int cost = field[(y + __tr_path_dy[d]) * pf->width + x + __tr_path_dx[d]];
+    if (cost < 0) continue;
+    cost += (d < 4) ? TR_PATH_STRAIGHT_COST : TR_PATH_DIAGONAL_COST;
+    if (best < 0 || cost < best_cost) {
+      best = d;
+      best_cost = cost;
+    }
+  }
+  if (best < 0) return false;
+  *dx = __tr_path_dx[best];
+  *dy = __tr_path_dy[best];
+  return true;
+}
+
+#endif // TR_PATHFINDING
+
+#ifdef TR_HEADLESS
+
+// --- Headless Simulation ---
+// Runs many independent game instances without a terminal, as fast as the CPU allows,
+// for AI experiments and regression tests. Each instance gets its own xoshiro256** RNG
+// seeded from the run's seed and the instance's index. Any thread count gives the same
+// results, and the report's digest shows whether two runs matched. Worker threads (the
+// calling thread is one of them) take instances off a shared counter. POSIX builds need
+// -pthread.
+
+#include <stdatomic.h> // For the shared instance counter
+#include <stdint.h>    // For uint64_t
+#ifndef _WIN32
+  #include <pthread.h> // For the worker threads
+#endif
+
+#define TR_HEADLESS_MAX_THREADS 256
+#define TR_HEADLESS_OUTCOMES 4 // Outcome codes an instance can report (0 to 3, the game decides what they mean)
+
+// xoshiro256** state. Seed it with TR_RngSeed; an all-zero state never leaves zero.
+typedef struct {
+  uint64_t s[4];
+} TR_Rng;
+
+// What one instance reports back
+typedef struct {
+  long long ticks;
+  long long score;
+  int outcome; // 0 to TR_HEADLESS_OUTCOMES - 1
+} TR_HeadlessResult;
+
+typedef struct {
+  int instances;
+  int threads;
+  long long total_ticks;
+  double seconds;
+  double ticks_per_second;
+  double mean_score;
+  long long best_score;
+  long long outcomes[TR_HEADLESS_OUTCOMES]; // Instances that ended with each outcome
+  uint64_t digest;                          // Hash of every result in instance order
+} TR_HeadlessReport;
+
+// Runs instance `index` to the end using only `rng` for randomness and fills in `result`.
+// Called on worker threads, so it must not touch shared state (other than reading `user`).
+typedef void (*TR_HeadlessInstanceFn)(int index, TR_Rng* rng, void* user, TR_HeadlessResult* result);
+
+static inline uint64_t __tr_splitmix64(uint64_t* x) {
+  uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+// Seeds the generator (any seed is fine, 0 included).
+static inline void TR_RngSeed(TR_Rng* rng, uint64_t seed) {
+  for (int i = 0; i < 4; i++) rng->s[i] = __tr_splitmix64(&seed);
+}
+
+static inline uint64_t TR_RngNext(TR_Rng* rng) {
+  uint64_t* s = rng->s;
+  uint64_t x = s[1] * 5;
+  uint64_t result = ((x << 7) | (x >> 57)) * 9;
+  uint64_t t = s[1] << 17;
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = (s[3] << 45) | (s[3] >> 19);
+  return result;
+}
+
+// Returns a number from 0 to count - 1 (count must be positive).
+static inline int TR_RngRange(TR_Rng* rng, int count) {
+  return (int)(((TR_RngNext(rng) >> 32) * (uint64_t)(unsigned int)count) >> 32);
+}
+
+// Returns the number of CPU cores available, at least 1.
+static inline int TR_GetCPUCount() {
+#ifdef _WIN32
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  int count = (int)info.dwNumberOfProcessors;
+#else
+  int count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+  return (count > 0) ? count : 1;
+}
+
+typedef struct {
+  int instances;
+  uint64_t seed;
+  TR_HeadlessInstanceFn run;
+  void* user;
+  TR_HeadlessResult* results;
+  atomic_int next; // Next instance to hand out
+} __TR_HeadlessRun;
+
+#ifdef _WIN32
+static DWORD WINAPI __tr_headless_worker(LPVOID arg) {
+#else
+static void* __tr_headless_worker(void* arg) {
+#endif
+  __TR_HeadlessRun* run = (__TR_HeadlessRun*)arg;
+  for (;;) {
+    int index = atomic_fetch_add_explicit(&run->next, 1, memory_order_relaxed);
+    if (index >= run->instances) break;
+    TR_Rng rng;
+    TR_RngSeed(&rng, run->seed + (uint64_t)index * 0xD1B54A32D192ED03ULL);
+    TR_HeadlessResult* result = &run->results[index];
+    memset(result, 0, sizeof(*result));
+    run->run(index, &rng, run->user, result);
+  }
+  return 0;
+}
+
+// Runs `instances` instances of a game on `threads` threads (0 for one per core) and
+// returns the totals. `seed` decides every instance's RNG, so the same seed gives the
+// same results and digest on any machine and with any thread count.
+static inline TR_HeadlessReport TR_RunHeadless(int instances, int threads, uint64_t seed, TR_HeadlessInstanceFn run, void* user) {
+  TR_HeadlessReport report;
+  memset(&report, 0, sizeof(report));
+  if (instances <= 0) return report;
+  if (threads <= 0) threads = TR_GetCPUCount();
+  if (threads > instances) threads = instances;
+  if (threads > TR_HEADLESS_MAX_THREADS) threads = TR_HEADLESS_MAX_THREADS;
+
+  __TR_HeadlessRun state;
+  state.instances = instances;
+  state.seed = seed;
+  state.run = run;
+  state.user = user;
+  state.results = (TR_HeadlessResult*)calloc((size_t)instances, sizeof(TR_HeadlessResult));
+  atomic_init(&state.next, 0);
+  if (state.results == NULL) return report;
+
+  long long start_ns = __tr_get_time_ns();
+#ifdef _WIN32
+  HANDLE workers[TR_HEADLESS_MAX_THREADS];
+#else
+  pthread_t workers[TR_HEADLESS_MAX_THREADS];
+#endif
+  int started = 0;
+  for (int i = 1; i < threads; i++) { // The calling thread is the first worker
+#ifdef _WIN32
+    workers[started] = CreateThread(NULL, 0, __tr_headless_worker, &state, 0, NULL);
+    if (workers[started] == NULL) break;
+#else
+    if (pthread_create(&workers[started], NULL, __tr_headless_worker, &state) != 0) break;
+#endif
+    started++;
+  }
+  __tr_headless_worker(&state);
+  for (int i = 0; i < started; i++) {
+#ifdef _WIN32
+    WaitForSingleObject(workers[i], INFINITE);
+    CloseHandle(workers[i]);
+#else
+    pthread_join(workers[i], NULL);
+#endif
+  }
+  long long elapsed_ns = __tr_get_time_ns() - start_ns;
+
+  // Totals, and an FNV-1a hash of the results in instance order
+  uint64_t digest = 0xCBF29CE484222325ULL;
+  long long total_score = 0;
+  report.best_score = state.results[0].score;
+  for (int i = 0; i < instances; i++) {
+    const TR_HeadlessResult* result = &state.results[i];
+    long long values[3] = { result->ticks, result->score, result->outcome };
+    const unsigned char* bytes = (const unsigned char*)values;
+    for (size_t b = 0; b < sizeof(values); b++) {
+      digest = (digest ^ bytes[b]) * 0x100000001B3ULL;
+    }
+    report.total_ticks += result->ticks;
+    total_score += result->score;
+    if (result->score > report.best_score) report.best_score = result->score;
+    if (result->outcome >= 0 && result->outcome < TR_HEADLESS_OUTCOMES) report.outcomes[result->outcome]++;
+  }
+  free(state.results);
+
+  report.instances = instances;
+  report.threads = started + 1;
+  report.seconds = (double)elapsed_ns / 1e9;
+  report.ticks_per_second = (elapsed_ns > 0) ? (double)report.total_ticks * 1e9 / (double)elapsed_ns : 0.0;
+  report.mean_score = (double)total_score / instances;
+  report.digest = digest;
+  return report;
+}
+
+// Prints a report to out. outcome_names labels the outcome codes (NULL entries are skipped).
+static inline void TR_PrintHeadlessReport(FILE* out, const TR_HeadlessReport* report, const char* const outcome_names[TR_HEADLESS_OUTCOMES]) {
+  fprintf(out, "Instances:    %d on %d thread%s\n", report->instances, report->threads, report->threads == 1 ? "" : "s");
+  fprintf(out, "Ticks:        %lld in %.3f s\n", report->total_ticks, report->seconds);
+  fprintf(out, "Ticks/second: %.0f\n", report->ticks_per_second);
+  fprintf(out, "Score:        %.1f mean, %lld best\n", report->mean_score, report->best_score);
+  for (int i = 0; i < TR_HEADLESS_OUTCOMES; i++) {
+    if (outcome_names[i] != NULL) fprintf(out, "%-13s %lld\n", outcome_names[i], report->outcomes[i]);
+  }
+  fprintf(out, "Digest:       %016llx\n", (unsigned long long)report->digest);
+}
+
+#endif // TR_HEADLESS
+
+#ifdef TR_TILEMAP
+
+// --- Tile Maps ---
+// A tile map is a grid of tile types (0 to 255), each drawn with the character and
+// colors its style gives. The grid is split into TR_TILE_CHUNK_SIZE x TR_TILE_CHUNK_SIZE
+// chunks. A chunk is only allocated once a non-zero tile is set in it, so empty space
+// costs nothing. Drawing only visits the chunks the viewport touches. Each drawn chunk
+// keeps a raster of ready-made cells, which is copied to the screen a row at a time and
+// only rebuilt after its tiles or the styles change. Rasters of chunks that have scrolled
+// out of view are freed once more than TR_TILEMAP_MAX_RASTERS exist, so a world far
+// bigger than the terminal costs about as much to draw as the visible part.
+
+#define TR_TILE_CHUNK_SHIFT 5
+#define TR_TILE_CHUNK_SIZE (1 << TR_TILE_CHUNK_SHIFT) // Tiles along each side of a chunk
+#define TR_TILE_CHUNK_MASK (TR_TILE_CHUNK_SIZE - 1)
+#define TR_TILEMAP_MAX_RASTERS 256 // Cached chunk rasters kept before the unseen ones are freed
+
+// How one tile type looks. A BLANK background uses the TR_ClearBackground color.
+typedef struct {
+  char character;
+  Color fg_color;
+  Color bg_color;
+} TR_TileStyle;
+
+typedef struct {
+  unsigned char tiles[TR_TILE_CHUNK_SIZE * TR_TILE_CHUNK_SIZE];
+  __TR_Cell* raster;       // The tiles as screen cells, NULL until the chunk is first drawn
+  bool raster_dirty;       // Tiles or styles changed since the raster was built
+  bool raster_has_blank;   // Some cell has a BLANK background, so rows can't just be copied
+  unsigned int drawn_at;   // Draw call that last showed this chunk
+} __TR_TileChunk;
+
+typedef struct {
+  int width;               // Size in tiles
+  int height;
+  int chunks_x;            // Size in chunks
+  int chunks_y;
+  __TR_TileChunk** chunks; // chunks_x * chunks_y, NULL for chunks that are all tile 0
+  TR_TileStyle styles[256];
+  int camera_x;            // Tile drawn at the top left of the viewport
+  int camera_y;
+  unsigned int draw_count;
+  int chunks_allocated;
+  int rasters_cached;
+  int chunks_drawn;        // Chunks visited by the last TR_TileMapDraw
+  int rasters_built;       // Rasters rebuilt by the last TR_TileMapDraw
+} TR_TileMap;
+
+// Creates an all-zero tile map of width x height tiles. Every style starts as a blank space.
+// Returns NULL if it can't be allocated.
+static inline TR_TileMap* TR_TileMapCreate(int width, int height) {
+  if (width <= 0 || height <= 0) return NULL;
+  TR_TileMap* map = (TR_TileMap*)calloc(1, sizeof(TR_TileMap));
+  if (map == NULL) return NULL;
+  map->width = width;
+  map->height = height;
+  map->chunks_x = (width + TR_TILE_CHUNK_MASK) >> TR_TILE_CHUNK_SHIFT;
+  map->chunks_y = (height + TR_TILE_CHUNK_MASK) >> TR_TILE_CHUNK_SHIFT;
+  map->chunks = (__TR_TileChunk**)calloc((size_t)map->chunks_x * map->chunks_y, sizeof(__TR_TileChunk*));
+  if (map->chunks == NULL) {
+    free(map);
+    return NULL;
+  }
+  for (int i = 0; i < 256; i++) {
+    map->styles[i] = (TR_TileStyle){ ' ', WHITE, BLANK };
+  }
+  return map;
+}
+
+static inline void TR_TileMapDestroy(TR_TileMap* map) {
+  if (map == NULL) return;
+  for (int i = 0; i < map->chunks_x * map->chunks_y; i++) {
+    if (map->chunks[i] != NULL) {
+      free(map->chunks[i]->raster);
+      free(map->chunks[i]);
+    }
+  }
+  free(map->chunks);
+  free(map);
+}
+
+// Sets how a tile type is drawn. Every cached raster is rebuilt the next time it's drawn.
+static inline void TR_TileMapSetStyle(TR_TileMap* map, unsigned char tile, char character, Color fg_color, Color bg_color) {
+  map->styles[tile] = (TR_TileStyle){ character, fg_color, bg_color };
+  for (int i = 0; i < map->chunks_x * map->chunks_y; i++) {
+    if (map->chunks[i] != NULL) map->chunks[i]->raster_dirty = true;
+  }
+}
+
+// Returns the tile at (x, y), or 0 outside the map.
+static inline unsigned char TR_TileMapGet(const TR_TileMap* map, int x, int y) {
+  if (x < 0 || y < 0 || x >= map->width || y >= map->height) return 0;
+  const __TR_TileChunk* chunk = map->chunks[(y >> TR_TILE_CHUNK_SHIFT) * map->chunks_x + (x >> TR_TILE_CHUNK_SHIFT)];
+  if (chunk == NULL) return 0;
+  return chunk->tiles[((y & TR_TILE_CHUNK_MASK) << TR_TILE_CHUNK_SHIFT) | (x & TR_TILE_CHUNK_MASK)];
+}
+
+// Sets the tile at (x, y), allocating its chunk if needed. Returns false outside the map
+// or if the chunk can't be allocated.
+static inline bool TR_TileMapSet(TR_TileMap* map, int x, int y, unsigned char tile) {
+  if (x < 0 || y < 0 || x >= map->width || y >= map->height) return false;
+  __TR_TileChunk** slot = &map->chunks[(y >> TR_TILE_CHUNK_SHIFT) * map->chunks_x + (x >> TR_TILE_CHUNK_SHIFT)];
+  if (*slot == NULL) {
+    if (tile == 0) return true; // Already 0
+    *slot = (__TR_TileChunk*)calloc(1, sizeof(__TR_TileChunk));
+    if (*slot == NULL) return false;
+    map->chunks_allocated++;
+  }
+  unsigned char* cell = &(*slot)->tiles[((y & TR_TILE_CHUNK_MASK) << TR_TILE_CHUNK_SHIFT) | (x & TR_TILE_CHUNK_MASK)];
+  if (*cell != tile) {
+    *cell = tile;
+    (*slot)->raster_dirty = true;
+  }
+  return true;
+}
+
+// Puts the top left of the viewport at tile (x, y).
+static inline void TR_TileMapSetCamera(TR_TileMap* map, int x, int y) {
+  map->camera_x = x;
+  map->camera_y = y;
+}
+
+// Centers a view_width x view_height viewport on tile (x, y) without showing anything past
+// the edges of the map. Along a side where the map fits in the view, the camera stays at 0.
+static inline void TR_TileMapFollow(TR_TileMap* map, int x, int y, int view_width, int view_height) {
+  map->camera_x = 0;
+  map->camera_y = 0;
+  if (map->width > view_width) {
+    map->camera_x = x - view_width / 2;
+    if (map->camera_x > map->width - view_width) map->camera_x = map->width - view_width;
+    if (map->camera_x < 0) map->camera_x = 0;
+  }
+  if (map->height > view_height) {
+    map->camera_y = y - view_height / 2;
+    if (map->camera_y > map->height - view_height) map->camera_y = map->height - view_height;
+    if (map->camera_y < 0) map->camera_y = 0;
+  }
+}
+
+static inline void __tr_tilemap_build_raster(TR_TileMap* map, __TR_TileChunk* chunk) {
+  bool has_blank = false;
+  for (int i = 0; i < TR_TILE_CHUNK_SIZE * TR_TILE_CHUNK_SIZE; i++) {
+    const TR_TileStyle* style = &map->styles[chunk->tiles[i]];
+    chunk->raster[i] = (__TR_Cell){ style->character, style->fg_color, style->bg_color, 0 };
+    if (__tr_colors_equal(style->bg_color, BLANK)) has_blank = true;
+  }
+  chunk->raster_has_blank = has_blank;
+  chunk->raster_dirty = false;
+  map->rasters_built++;
+}
+
+// Frees the rasters of chunks the last draw didn't show
+static inline void __tr_tilemap_evict_rasters(TR_TileMap* map) {
+  for (int i = 0; i < map->chunks_x * map->chunks_y; i++) {
+    __TR_TileChunk* chunk = map->chunks[i];
+    if (chunk != NULL && chunk->raster != NULL && chunk->drawn_at != map->draw_count) {
+      free(chunk->raster);
+      chunk->raster = NULL;
+      map->rasters_cached--;
+    }
+  }
+}
+
+// Draws the part of the map under the camera into the screen rectangle at (x, y) of
+// width x height cells. Tiles past the edges of the map are left alone.
+static inline void TR_TileMapDraw(TR_TileMap* map, int x, int y, int width, int height) {
+  if (!__tr_window_open || map == NULL) return;
+  map->draw_count++;
+  map->chunks_drawn = 0;
+  map->rasters_built = 0;
+
+  // Clip the rectangle to the screen, then the view to the map
+  int view_x = map->camera_x;
+  int view_y = map->camera_y;
+  if (x < 0) { view_x -= x; width += x; x = 0; }
+  if (y < 0) { view_y -= y; height += y; y = 0; }
+  if (x + width > __tr_buffer_width) width = __tr_buffer_width - x;
+  if (y + height > __tr_buffer_height) height = __tr_buffer_height - y;
+  if (view_x < 0) { x -= view_x; width += view_x; view_x = 0; }
+  if (view_y < 0) { y -= view_y; height += view_y; view_y = 0; }
+  if (view_x + width > map->width) width = map->width - view_x;
+  if (view_y + height > map->height) height = map->height - view_y;
+  if (width <= 0 || height <= 0) return;
+
+  const TR_TileStyle* empty = &map->styles[0];
+  bool empty_visible = (empty->character != ' ' || !__tr_colors_equal(empty->bg_color, BLANK));
+  __TR_Cell empty_cell = { empty->character, empty->fg_color,
+                           __tr_colors_equal(empty->bg_color, BLANK) ? __tr_current_bg_color : empty->bg_color, 0 };
+
+  for (int chunk_y = view_y >> TR_TILE_CHUNK_SHIFT; chunk_y <= (view_y + height - 1) >> TR_TILE_CHUNK_SHIFT; chunk_y++) {
+    int top = chunk_y << TR_TILE_CHUNK_SHIFT;
+    int bottom = top + TR_TILE_CHUNK_SIZE;
+    if (top < view_y) top = view_y;
+    if (bottom > view_y + height) bottom = view_y + height;
+    for (int chunk_x = view_x >> TR_TILE_CHUNK_SHIFT; chunk_x <= (view_x + width - 1) >> TR_TILE_CHUNK_SHIFT; chunk_x++) {
+      int left = chunk_x << TR_TILE_CHUNK_SHIFT;
+      int right = left + TR_TILE_CHUNK_SIZE;
+      if (left < view_x) left = view_x;
+      if (right > view_x + width) right = view_x + width;
+      int span = right - left;
+      map->chunks_drawn++;
+
+      __TR_TileChunk* chunk = map->chunks[chunk_y * map->chunks_x + chunk_x];
+      if (chunk == NULL) {
+        // All tile 0: fill with its style, or leave the background showing
+        if (!empty_visible) continue;
+        for (int tile_y = top; tile_y < bottom; tile_y++) {
+          __TR_Cell* dst = __tr_screen_buffer + (y + tile_y - view_y) * __tr_buffer_width + x + left - view_x;
+          for (int i = 0; i < span; i++) dst[i] = empty_cell;
+        }
+        continue;
+      }
+
+      if (chunk->raster == NULL) {
+        chunk->raster = (__TR_Cell*)malloc(sizeof(__TR_Cell) * TR_TILE_CHUNK_SIZE * TR_TILE_CHUNK_SIZE);
+        if (chunk->raster == NULL) continue;
+        map->rasters_cached++;
+        chunk->raster_dirty = true;
+      }
+      if (chunk->raster_dirty) __tr_tilemap_build_raster(map, chunk);
+      chunk->drawn_at = map->draw_count;
+
+      for (int tile_y = top; tile_y < bottom; tile_y++) {
+        __TR_Cell* dst = __tr_screen_buffer + (y + tile_y - view_y) * __tr_buffer_width + x + left - view_x;
+        const __TR_Cell* src = chunk->raster + ((tile_y & TR_TILE_CHUNK_MASK) << TR_TILE_CHUNK_SHIFT) + (left & TR_TILE_CHUNK_MASK);
+        if (!chunk->raster_has_blank) {
+          memcpy(dst, src, sizeof(__TR_Cell) * span);
+        } else {
+          for (int i = 0; i < span; i++) {
+            dst[i] = src[i];
+            if (__tr_colors_equal(src[i].bg_color, BLANK)) dst[i].bg_color = __tr_current_bg_color;
+          }
+        }
+      }
+    }
+  }
+
+  if (map->rasters_cached > TR_TILEMAP_MAX_RASTERS) __tr_tilemap_evict_rasters(map);
+}
+
+#endif // TR_TILEMAP
+
+#ifdef TR_ENTITIES
+
+// --- Entities ---
+// A store for many moving sprites kept as a structure of arrays: positions, velocities,
+// glyphs and colors each live in their own packed array, so a batch update is a few
+// straight loops over floats that the compiler can vectorize (build with -O2 or -O3).
+// Entities are referred to by handles that carry a generation, so a handle to an
+// entity that has been removed (even if its slot was reused) is simply rejected.
+// Removal swaps the last entity into the hole, which keeps the arrays packed; index i
+// of every array is the same entity until the next removal.
+
+#define TR_ENTITY_NONE 0 // Never a valid handle
+
+// How TR_EntitiesUpdate keeps entities inside the bounds set by TR_EntitiesSetBounds
+#define TR_ENTITY_BOUNDS_NONE 0   // Let them leave
+#define TR_ENTITY_BOUNDS_CLAMP 1  // Stop at the edge
+#define TR_ENTITY_BOUNDS_BOUNCE 2 // Reflect off the edge, reversing that velocity
+#define TR_ENTITY_BOUNDS_WRAP 3   // Come back in on the other side
+
+// Slot index in the low 32 bits, the slot's generation in the high 32
+typedef uint64_t TR_Entity;
+
+typedef struct {
+  int count;    // Live entities, at indices 0 to count - 1 of the arrays below
+  int capacity;
+  float* x;
+  float* y;
+  float* vx;    // Velocity in cells per second
+  float* vy;
+  char* glyph;
+  Color* fg_color;
+  Color* bg_color; // BLANK to keep what's underneath
+  int* data;       // Free for the game to use (a type, an index into its own arrays...)
+
+  // Handles: a slot per entity ever needed, pointing at its current index
+  unsigned int* index_slot;      // Slot of the entity at each index
+  unsigned int* slot_index;      // Index of each slot's entity, or the next free slot
+  unsigned int* slot_generation; // Bumped when a slot's entity is removed
+  int slot_count;
+  int free_slot;                 // First free slot, -1 if none
+
+  float min_x;
+  float min_y;
+  float max_x;
+  float max_y;
+  int bounds_mode;
+} TR_EntityStore;
+
+static inline bool __tr_entities_grow(TR_EntityStore* store, int capacity) {
+  void* arrays[11];
+  size_t sizes[11] = { sizeof(float), sizeof(float), sizeof(float), sizeof(float), sizeof(char), sizeof(Color),
+                       sizeof(Color), sizeof(int), sizeof(unsigned int), sizeof(unsigned int), sizeof(unsigned int) };
+  void** fields[11] = { (void**)&store->x, (void**)&store->y, (void**)&store->vx, (void**)&store->vy,
+                        (void**)&store->glyph, (void**)&store->fg_color, (void**)&store->bg_color, (void**)&store->data,
+                        (void**)&store->index_slot, (void**)&store->slot_index, (void**)&store->slot_generation };
+  for (int i = 0; i < 11; i++) {
+    arrays[i] = realloc(*fields[i], sizes[i] * (size_t)capacity);
+    if (arrays[i] == NULL) return false; // The ones already grown are kept, which is harmless
+    *fields[i] = arrays[i];
+  }
+  store->capacity = capacity;
+  return true;
+}
+
+static inline void TR_EntityStoreDestroy(TR_EntityStore* store) {
+  if (store == NULL) return;
+  free(store->x);
+  free(store->y);
+  free(store->vx);
+  free(store->vy);
+  free(store->glyph);
+  free(store->fg_color);
+  free(store->bg_color);
+  free(store->data);
+  free(store->index_slot);
+  free(store->slot_index);
+  free(store->slot_generation);
+  free(store);
+}
+
+// Creates an empty store with room for `capacity` entities (it grows as needed).
+// Returns NULL if it can't be allocated.
+static inline TR_EntityStore* TR_EntityStoreCreate(int capacity) {
+  TR_EntityStore* store = (TR_EntityStore*)calloc(1, sizeof(TR_EntityStore));
+  if (store == NULL) return NULL;
+  store->free_slot = -1;
+  if (!__tr_entities_grow(store, capacity > 0 ? capacity : 64)) {
+    TR_EntityStoreDestroy(store);
+    return NULL;
+  }
+  return store;
+}
+
+// Adds an entity and returns its handle, or TR_ENTITY_NONE if the store can't grow.
+static inline TR_Entity TR_EntitySpawn(TR_EntityStore* store, float x, float y, float vx, float vy,
+                                       char glyph, Color fg_color, Color bg_color) {
+  if (store->count == store->capacity && !__tr_entities_grow(store, store->capacity * 2)) return TR_ENTITY_NONE;
+  unsigned int slot;
+  if (store->free_slot >= 0) {
+    slot = (unsigned int)store->free_slot;
+    store->free_slot = (store->slot_index[slot] == (unsigned int)-1) ? -1 : (int)store->slot_index[slot];
+  } else {
+    slot = (unsigned int)store->slot_count++;
+    store->slot_generation[slot] = 1;
+  }
+  int i = store->count++;
+  store->x[i] = x;
+  store->y[i] = y;
+  store->vx[i] = vx;
+  store->vy[i] = vy;
+  store->glyph[i] = glyph;
+  store->fg_color[i] = fg_color;
+  store->bg_color[i] = bg_color;
+  store->data[i] = 0;
+  store->index_slot[i] = slot;
+  store->slot_index[slot] = (unsigned int)i;
+  return ((uint64_t)store->slot_generation[slot] << 32) | slot;
+}
+
+// Returns the entity's index into the store's arrays, or -1 if the handle is stale.
+static inline int TR_EntityIndex(const TR_EntityStore* store, TR_Entity entity) {
+  unsigned int slot = (unsigned int)(entity & 0xFFFFFFFFu);
+  unsigned int generation = (unsigned int)(entity >> 32);
+  if (slot >= (unsigned int)store->slot_count || store->slot_generation[slot] != generation) return -1;
+  return (int)store->slot_index[slot];
+}
+
+// Removes an entity. The last entity moves into its index. Returns false if the handle is stale.
+static inline bool TR_EntityDespawn(TR_EntityStore* store, TR_Entity entity) {
+  int i = TR_EntityIndex(store, entity);
+  if (i < 0) return false;
+  unsigned int slot = store->index_slot[i];
+  int last = --store->count;
+  if (i != last) {
+    store->x[i] = store->x[last];
+    store->y[i] = store->y[last];
+    store->vx[i] = store->vx[last];
+    store->vy[i] = store->vy[last];
+    store->glyph[i] = store->glyph[last];
+    store->fg_color[i] = store->fg_color[last];
+    store->bg_color[i] = store->bg_color[last];
+    store->data[i] = store->data[last];
+    store->index_slot[i] = store->index_slot[last];
+    store->slot_index[store->index_slot[i]] = (unsigned int)i;
+  }
+  if (++store->slot_generation[slot] == 0) store->slot_generation[slot] = 1; // Handles are never 0
+  store->slot_index[slot] = (store->free_slot >= 0) ? (unsigned int)store->free_slot : (unsigned int)-1;
+  store->free_slot = (int)slot;
+  return true;
+}
+
+// Sets the box TR_EntitiesUpdate keeps entities in and how (TR_ENTITY_BOUNDS_*).
+// Positions run from min up to, but not including, max.
+static inline void TR_EntitiesSetBounds(TR_EntityStore* store, float min_x, float min_y, float max_x, float max_y, int mode) {
+  store->min_x = min_x;
+  store->min_y = min_y;
+  store->max_x = max_x;
+  store->max_y = max_y;
+  store->bounds_mode = mode;
+}
+
+// Moves every entity along one axis and applies the bounds. Written without branches or
+// calls so each loop vectorizes: clamps are the min/max pattern compilers know, and the
+// distance past an edge is tested with != (a quiet compare, unlike < and >, which GCC
+// won't turn into a vector select under its default -ftrapping-math).
+static inline void __tr_entities_move_axis(float* restrict position, float* restrict velocity, int count,
+                                           float dt, float min, float max, int mode) {
+  for (int i = 0; i < count; i++) position[i] += velocity[i] * dt;
+  float limit = max - 0.001f; // Just inside max, so (int)floorf(position) stays below it
+  if (mode == TR_ENTITY_BOUNDS_CLAMP) {
+    for (int i = 0; i < count; i++) {
+      float p = position[i];
+      p = (p < min) ? min : p;
+      position[i] = (p > limit) ? limit : p;
+    }
+  } else if (mode == TR_ENTITY_BOUNDS_BOUNCE) {
+    for (int i = 0; i < count; i++) {
+      float p = position[i];
+      float v = velocity[i];
+      float below = ((p < min) ? min : p) - p;     // How far past the low edge, else 0
+      float above = p - ((p > limit) ? limit : p); // How far past the high edge, else 0
+      position[i] = p + 2.0f * below - 2.0f * above;
+      velocity[i] = v - 2.0f * v * ((float)(below != 0.0f) + (float)(above != 0.0f));
+    }
+    // Something moving more than the box's width in one update can still be outside
+    for (int i = 0; i < count; i++) {
+      float p = position[i];
+      p = (p < min) ? min : p;
+      position[i] = (p > limit) ? limit : p;
+    }
+  } else if (mode == TR_ENTITY_BOUNDS_WRAP) {
+    float span = max - min;
+    for (int i = 0; i < count; i++) {
+      float p = position[i];
+      float below = ((p < min) ? min : p) - p;
+      float above = p - ((p > limit) ? limit : p);
+      position[i] = p + span * ((float)(below != 0.0f) - (float)(above != 0.0f));
+    }
+  }
+}
+
+// Moves every entity by its velocity times `dt` seconds and keeps it inside the bounds.
+static inline void TR_EntitiesUpdate(TR_EntityStore* store, float dt) {
+  int mode = store->bounds_mode;
+  __tr_entities_move_axis(store->x, store->vx, store->count, dt, store->min_x, store->max_x, mode);
+  __tr_entities_move_axis(store->y, store->vy, store->count, dt, store->min_y, store->max_y, mode);
+}
+
+// Draws every entity in view into the screen rectangle at (x, y) of width x height cells.
+// The rectangle's top left shows position (camera_x, camera_y).
+static inline void TR_EntitiesDraw(const TR_EntityStore* store, int x, int y, int width, int height,
+                                   float camera_x, float camera_y) {
+  if (!__tr_window_open) return;
+  if (x < 0) { camera_x -= (float)x; width += x; x = 0; }
+  if (y < 0) { camera_y -= (float)y; height += y; y = 0; }
+  if (x + width > __tr_buffer_width) width = __tr_buffer_width - x;
+  if (y + height > __tr_buffer_height) height = __tr_buffer_height - y;
+  if (width <= 0 || height <= 0) return;
+
+  const float* restrict px = store->x;
+  const float* restrict py = store->y;
+  for (int i = 0; i < store->count; i++) {
+    float view_x = px[i] - camera_x;
+    float view_y = py[i] - camera_y;
+    // A single unsigned compare per axis rejects both sides at once
+    int cell_x = (int)floorf(view_x);
+    int cell_y = (int)floorf(view_y);
+    if ((unsigned int)cell_x >= (unsigned int)width || (unsigned int)cell_y >= (unsigned int)height) continue;
+    __TR_Cell* cell = &__tr_screen_buffer[(y + cell_y) * __tr_buffer_width + x + cell_x];
+    cell->character = store->glyph[i];
+    cell->fg_color = store->fg_color[i];
+    if (!__tr_colors_equal(store->bg_color[i], BLANK)) cell->bg_color = store->bg_color[i];
+  }
+}
+
+#endif // TR_ENTITIES
+
+#ifdef TR_SPATIAL_HASH
+
+// --- Spatial Hash ---
+// A uniform grid for finding what's near a point without testing every pair. It is
+// rebuilt from scratch each tick with a counting sort: count the items in each cell,
+// turn the counts into offsets, then write every item's id and position into flat
+// arrays ordered by cell. The cells of one grid row are next to each other in those
+// arrays, so a query reads one contiguous run per row it covers and never allocates.
+// Items outside the bounds are kept in the edge cells, so they are still found.
+
+typedef struct {
+  float min_x;
+  float min_y;
+  float cell_size;
+  float inv_cell_size;
+  int columns;
+  int rows;
+  int* cell_start; // columns * rows + 1 offsets; cell c holds items cell_start[c] to cell_start[c + 1] - 1
+  int* cell_of;    // Scratch: the cell of each item while building
+
+  // Items ordered by cell, with a copy of their positions so a query doesn't chase ids
+  int count;
+  int capacity;
+  int* ids;
+  float* x;
+  float* y;
+} TR_SpatialHash;
+
+// Creates a grid covering (min_x, min_y) to (max_x, max_y) with square cells of
+// `cell_size`. Cells about as big as the usual query radius work best. Returns NULL if
+// it can't be allocated.
+static inline TR_SpatialHash* TR_SpatialHashCreate(float min_x, float min_y, float max_x, float max_y, float cell_size) {
+  if (!(cell_size > 0.0f) || !(max_x > min_x) || !(max_y > min_y)) return NULL;
+  float columns = ceilf((max_x - min_x) / cell_size);
+  float rows = ceilf((max_y - min_y) / cell_size);
+  if (columns * rows > (float)(1 << 28)) return NULL;
+  TR_SpatialHash* hash = (TR_SpatialHash*)calloc(1, sizeof(TR_SpatialHash));
+  if (hash == NULL) return NULL;
+  hash->min_x = min_x;
+  hash->min_y = min_y;
+  hash->cell_size = cell_size;
+  hash->inv_cell_size = 1.0f / cell_size;
+  hash->columns = (int)columns;
+  hash->rows = (int)rows;
+  hash->cell_start = (int*)calloc((size_t)hash->columns * hash->rows + 1, sizeof(int));
+  if (hash->cell_start == NULL) {
+    free(hash);
+    return NULL;
+  }
+  return hash;
+}
+
+static inline void TR_SpatialHashDestroy(TR_SpatialHash* hash) {
+  if (hash == NULL) return;
+  free(hash->cell_start);
+  free(hash->cell_of);
+  free(hash->ids);
+  free(hash->x);
+  free(hash->y);
+  free(hash);
+}
+
+// The column or row of a coordinate, clamped to the grid
+static inline int __tr_spatial_cell(float position, float min, float inv_cell_size, int cells) {
+  float cell = (position - min) * inv_cell_size;
+  cell = (cell < 0.0f) ? 0.0f : cell;
+  cell = (cell > (float)(cells - 1)) ? (float)(cells - 1) : cell;
+  return (int)cell;
+}
+
+// Replaces the contents with `count` items at (x[i], y[i]); item i's id is i. The arrays
+// can be an entity store's x and y, making ids entity indices. Returns false if the
+// grid can't grow to hold them.
+static inline bool TR_SpatialHashBuild(TR_SpatialHash* hash, const float* x, const float* y, int count) {
+  if (count > hash->capacity) {
+    int capacity = (hash->capacity > 0) ? hash->capacity : 64;
+    while (capacity < count) capacity *= 2;
+    int* cell_of = (int*)realloc(hash->cell_of, sizeof(int) * (size_t)capacity);
+    if (cell_of != NULL) hash->cell_of = cell_of;
+    int* ids = (int*)realloc(hash->ids, sizeof(int) * (size_t)capacity);
+    if (ids != NULL) hash->ids = ids;
+    float* sorted_x = (float*)realloc(hash->x, sizeof(float) * (size_t)capacity);
+    if (sorted_x != NULL) hash->x = sorted_x;
+    float* sorted_y = (float*)realloc(hash->y, sizeof(float) * (size_t)capacity);
+    if (sorted_y != NULL) hash->y = sorted_y;
+    if (cell_of == NULL || ids == NULL || sorted_x == NULL || sorted_y == NULL) return false;
+    hash->capacity = capacity;
+  }
+
+  int cells = hash->columns * hash->rows;
+  int* cell_start = hash->cell_start;
+  memset(cell_start, 0, sizeof(int) * (size_t)(cells + 1));
+  for (int i = 0; i < count; i++) {
+    int cell = __tr_spatial_cell(y[i], hash->min_y, hash->inv_cell_size, hash->rows) * hash->columns +
+               __tr_spatial_cell(x[i], hash->min_x, hash->inv_cell_size, hash->columns);
+    hash->cell_of[i] = cell;
+    cell_start[cell]++;
+  }
+  // Each cell's end offset; filling the cells from the back leaves them at their start
+  int total = 0;
+  for (int c = 0; c < cells; c++) {
+    total += cell_start[c];
+    cell_start[c] = total;
+  }
+  cell_start[cells] = count;
+  for (int i = count - 1; i >= 0; i--) {
+    int slot = --cell_start[hash->cell_of[i]];
+    hash->ids[slot] = i;
+    hash->x[slot] = x[i];
+    hash->y[slot] = y[i];
+  }
+  hash->count = count;
+  return true;
+}
+
+// Finds the items with min_x <= x < max_x and min_y <= y < max_y. Writes up to `max_out`
+// ids to `out` (in no particular order) and returns how many items matched, which can
+// be more than `max_out`.
+static inline int TR_SpatialHashQueryRect(const TR_SpatialHash* hash, float min_x, float min_y, float max_x, float max_y,
+                                          int* out, int max_out) {
+  if (hash->count == 0 || !(max_x > min_x) || !(max_y > min_y)) return 0;
+  int first_column = __tr_spatial_cell(min_x, hash->min_x, hash->inv_cell_size, hash->columns);
+  int last_column = __tr_spatial_cell(max_x, hash->min_x, hash->inv_cell_size, hash->columns);
+  int first_row = __tr_spatial_cell(min_y, hash->min_y, hash->inv_cell_size, hash->rows);
+  int last_row = __tr_spatial_cell(max_y, hash->min_y, hash->inv_cell_size, hash->rows);
+  int found = 0;
+  for (int row = first_row; row <= last_row; row++) {
+    int start = hash->cell_start[row * hash->columns + first_column];
+    int end = hash->cell_start[row * hash->columns + last_column + 1];
+    for (int i = start; i < end; i++) {
+      float x = hash->x[i];
+      float y = hash->y[i];
+      if (x >= min_x && x < max_x && y >= min_y && y < max_y) {
+        if (found < max_out) out[found] = hash->ids[i];
+        found++;
+      }
+    }
+  }
+  return found;
+}
+
+// Finds the items on the terminal cell (x, y), i.e. floored to the same integers.
+// Works like TR_SpatialHashQueryRect.
+static inline int TR_SpatialHashQueryPoint(const TR_SpatialHash* hash, int x, int y, int* out, int max_out) {
+  return TR_SpatialHashQueryRect(hash, (float)x, (float)y, (float)x + 1.0f, (float)y + 1.0f, out, max_out);
+}
+
+// Finds the items at most `radius` away from (x, y). Works like TR_SpatialHashQueryRect.
+static inline int TR_SpatialHashQueryRadius(const TR_SpatialHash* hash, float x, float y, float radius, int* out, int max_out) {
+  if (hash->count == 0 || radius < 0.0f) return 0;
+  int first_column = __tr_spatial_cell(x - radius, hash->min_x, hash->inv_cell_size, hash->columns);
+  int last_column = __tr_spatial_cell(x + radius, hash->min_x, hash->inv_cell_size, hash->columns);
+  int first_row = __tr_spatial_cell(y - radius, hash->min_y, hash->inv_cell_size, hash->rows);
+  int last_row = __tr_spatial_cell(y + radius, hash->min_y, hash->inv_cell_size, hash->rows);
+  float radius_squared = radius * radius;
+  int found = 0;
+  for (int row = first_row; row <= last_row; row++) {
+    int start = hash->cell_start[row * hash->columns + first_column];
+    int end = hash->cell_start[row * hash->columns + last_column + 1];
+    for (int i = start; i < end; i++) {
+      float dx = hash->x[i] - x;
+      float dy = hash->y[i] - y;
+      if (dx * dx + dy * dy <= radius_squared) {
+        if (found < max_out) out[found] = hash->ids[i];
+        found++;
+      }
+    }
+  }
+  return found;
+}
+
+#endif // TR_SPATIAL_HASH
+
+#ifdef TR_PARTICLES
+
+// --- Particles ---
+// A fixed-capacity pool of short-lived particles for effects, stored as a structure of
+// arrays like TR_ENTITIES. Updating is one straight loop over the float arrays that the
+// compiler vectorizes (build with -O2 or -O3), optionally split across threads, then a
+// pass that swaps the last live particle into each dead one's place. Particles are
+// drawn as glyphs or as half-block pixels, picking a glyph and color from their style's
+// ramps by age. Emitters spawn them for explosions, trails and rain. POSIX builds that
+// pass more than one thread to TR_ParticlesUpdate need -pthread; the threads are started
+// the first time they're asked for and stay parked between updates until the pool is
+// destroyed.
+
+#ifndef _WIN32
+  #include <pthread.h> // For the update threads
+#endif
+
+#define TR_PARTICLE_MAX_STYLES 16
+#define TR_PARTICLE_MAX_RAMP 8          // Glyphs and colors per style
+#define TR_PARTICLE_MAX_THREADS 64
+#define TR_PARTICLE_MIN_PER_THREAD 16384 // Fewer particles than this per thread aren't worth a thread
+
+// What a particle looks like over its life: the first glyph and color when it's spawned,
+// the last ones just before it dies
+typedef struct {
+  char glyphs[TR_PARTICLE_MAX_RAMP + 1];
+  int num_glyphs;
+  Color colors[TR_PARTICLE_MAX_RAMP];
+  int num_colors;
+} TR_ParticleStyle;
+
+struct __TR_ParticleWorkers;
+
+typedef struct {
+  int count; // Live particles, at indices 0 to count - 1 of the arrays below
+  int capacity;
+  float* x;
+  float* y;
+  float* vx;       // Velocity per second
+  float* vy;
+  float* ax;       // Acceleration per second, e.g. gravity
+  float* ay;
+  float* damping;  // Fraction of the velocity lost per second
+  float* age;      // 0 when spawned, dead at 1
+  float* age_rate; // 1 / lifetime in seconds
+  unsigned char* style;
+  TR_ParticleStyle styles[TR_PARTICLE_MAX_STYLES];
+  uint32_t rng;    // xorshift32 state for the emitters
+  struct __TR_ParticleWorkers* workers; // Update threads, NULL until an update uses more than one
+} TR_ParticlePool;
+
+// Where and how an emitter spawns particles. Start from one of TR_ParticleExplosion,
+// TR_ParticleTrail or TR_ParticleRain and adjust it, or fill one in from scratch.
+typedef struct {
+  float x;              // Particles appear in a width x height area centered here
+  float y;
+  float width;
+  float height;
+  float direction;      // Radians; 0 points right and PI / 2 down
+  float spread;         // Radians either side of direction
+  float min_speed;      // Per second
+  float max_speed;
+  float min_life;       // Seconds
+  float max_life;
+  float ax;             // Acceleration given to every particle
+  float ay;
+  float damping;
+  float rate;           // Particles per second for TR_ParticlesEmit
+  unsigned char style;
+  float pending;        // Part of a particle TR_ParticlesEmit carries over to the next call
+} TR_ParticleEmitter;
+
+// Creates a pool that holds up to `capacity` particles. `seed` drives the emitters'
+// randomness. Every style starts as a white '*'. Returns NULL if it can't be allocated.
+static inline TR_ParticlePool* TR_ParticlePoolCreate(int capacity, uint64_t seed) {
+  if (capacity <= 0) return NULL;
+  TR_ParticlePool* pool = (TR_ParticlePool*)calloc(1, sizeof(TR_ParticlePool));
+  if (pool == NULL) return NULL;
+  size_t floats = sizeof(float) * (size_t)capacity;
+  pool->capacity = capacity;
+  pool->x = (float*)malloc(floats);
+  pool->y = (float*)malloc(floats);
+  pool->vx = (float*)malloc(floats);
+  pool->vy = (float*)malloc(floats);
+  pool->ax = (float*)malloc(floats);
+  pool->ay = (float*)malloc(floats);
+  pool->damping = (float*)malloc(floats);
+  pool->age = (float*)malloc(floats);
+  pool->age_rate = (float*)malloc(floats);
+  pool->style = (unsigned char*)malloc((size_t)capacity);
+  if (pool->x == NULL || pool->y == NULL || pool->vx == NULL || pool->vy == NULL || pool->ax == NULL ||
+      pool->ay == NULL || pool->damping == NULL || pool->age == NULL || pool->age_rate == NULL || pool->style == NULL) {
+    free(pool->x);
+    free(pool->y);
+    free(pool->vx);
+    free(pool->vy);
+    free(pool->ax);
+    free(pool->ay);
+    free(pool->damping);
+    free(pool->age);
+    free(pool->age_rate);
+    free(pool->style);
+    free(pool);
+    return NULL;
+  }
+  for (int i = 0; i < TR_PARTICLE_MAX_STYLES; i++) {
+    strcpy(pool->styles[i].glyphs, "*");
+    pool->styles[i].num_glyphs = 1;
+    pool->styles[i].colors[0] = WHITE;
+    pool->styles[i].num_colors = 1;
+  }
+  seed ^= seed >> 32;
+  pool->rng = (uint32_t)seed ? (uint32_t)seed : 0x9E3779B9u; // xorshift32 can't leave 0
+  return pool;
+}
+
+static inline void __tr_particles_stop_workers(TR_ParticlePool* pool);
+
+static inline void TR_ParticlePoolDestroy(TR_ParticlePool* pool) {
+  if (pool == NULL) return;
+  __tr_particles_stop_workers(pool);
+  free(pool->x);
+  free(pool->y);
+  free(pool->vx);
+  free(pool->vy);
+  free(pool->ax);
+  free(pool->ay);
+  free(pool->damping);
+  free(pool->age);
+  free(pool->age_rate);
+  free(pool->style);
+  free(pool);
+}
+
+// Sets how particles of `style` look. `glyphs` (up to TR_PARTICLE_MAX_RAMP of them) and
+// `colors` are ramps from young to old; glyphs are ignored when drawing pixels.
+static inline void TR_ParticlesSetStyle(TR_ParticlePool* pool, unsigned char style, const char* glyphs,
+                                        const Color* colors, int num_colors) {
+  if (style >= TR_PARTICLE_MAX_STYLES) return;
+  TR_ParticleStyle* target = &pool->styles[style];
+  int num_glyphs = (glyphs != NULL) ? (int)strlen(glyphs) : 0;
+  if (num_glyphs > TR_PARTICLE_MAX_RAMP) num_glyphs = TR_PARTICLE_MAX_RAMP;
+  if (num_glyphs == 0) {
+    strcpy(target->glyphs, "*");
+    num_glyphs = 1;
+  } else {
+    memcpy(target->glyphs, glyphs, (size_t)num_glyphs);
+    target->glyphs[num_glyphs] = '\0';
+  }
+  target->num_glyphs = num_glyphs;
+  if (num_colors > TR_PARTICLE_MAX_RAMP) num_colors = TR_PARTICLE_MAX_RAMP;
+  if (colors == NULL || num_colors <= 0) {
+    target->colors[0] = WHITE;
+    num_colors = 1;
+  } else {
+    memcpy(target->colors, colors, sizeof(Color) * (size_t)num_colors);
+  }
+  target->num_colors = num_colors;
+}
+
+// Adds one particle that lives for `life` seconds. Returns false if the pool is full.
+static inline bool TR_ParticleSpawn(TR_ParticlePool* pool, float x, float y, float vx, float vy, float ax, float ay,
+                                    float damping, float life, unsigned char style) {
+  if (pool->count >= pool->capacity || !(life > 0.0f)) return false;
+  int i = pool->count++;
+  pool->x[i] = x;
+  pool->y[i] = y;
+  pool->vx[i] = vx;
+  pool->vy[i] = vy;
+  pool->ax[i] = ax;
+  pool->ay[i] = ay;
+  pool->damping[i] = damping;
+  pool->age[i] = 0.0f;
+  pool->age_rate[i] = 1.0f / life;
+  pool->style[i] = (style < TR_PARTICLE_MAX_STYLES) ? style : 0;
+  return true;
+}
+
+// Returns a number from 0 up to (not including) 1
+static inline float __tr_particle_random(TR_ParticlePool* pool) {
+  uint32_t x = pool->rng;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  pool->rng = x;
+  return (float)(x >> 8) * (1.0f / 16777216.0f);
+}
+
+static inline float __tr_particle_between(TR_ParticlePool* pool, float min, float max) {
+  return min + (max - min) * __tr_particle_random(pool);
+}
+
+// Spawns `count` particles from an emitter at once (for explosions). Returns how many
+// fit in the pool.
+static inline int TR_ParticlesBurst(TR_ParticlePool* pool, const TR_ParticleEmitter* emitter, int count) {
+  int spawned = 0;
+  for (; spawned < count && pool->count < pool->capacity; spawned++) {
+    float angle = emitter->direction + __tr_particle_between(pool, -emitter->spread, emitter->spread);
+    float speed = __tr_particle_between(pool, emitter->min_speed, emitter->max_speed);
+    float x = emitter->x + (__tr_particle_random(pool) - 0.5f) * emitter->width;
+    float y = emitter->y + (__tr_particle_random(pool) - 0.5f) * emitter->height;
+    float life = __tr_particle_between(pool, emitter->min_life, emitter->max_life);
+    TR_ParticleSpawn(pool, x, y, cosf(angle) * speed, sinf(angle) * speed, emitter->ax, emitter->ay,
+                     emitter->damping, (life > 0.001f) ? life : 0.001f, emitter->style);
+  }
+  return spawned;
+}
+
+// Spawns the particles an emitter makes at its rate over `dt` seconds (for trails and
+// rain; move the emitter between calls for a trail). Returns how many were spawned.
+static inline int TR_ParticlesEmit(TR_ParticlePool* pool, TR_ParticleEmitter* emitter, float dt) {
+  emitter->pending += emitter->rate * dt;
+  int count = (int)emitter->pending;
+  emitter->pending -= (float)count;
+  return TR_ParticlesBurst(pool, emitter, count);
+}
+
+// Particles flying out in every direction from (x, y) at up to `speed`, slowing down
+// and falling a little
+static inline TR_ParticleEmitter TR_ParticleExplosion(float x, float y, float speed, unsigned char style) {
+  TR_ParticleEmitter emitter;
+  memset(&emitter, 0, sizeof(emitter));
+  emitter.x = x;
+  emitter.y = y;
+  emitter.spread = 3.14159265f;
+  emitter.min_speed = speed * 0.2f;
+  emitter.max_speed = speed;
+  emitter.min_life = 0.6f;
+  emitter.max_life = 1.4f;
+  emitter.ay = speed * 0.4f;
+  emitter.damping = 1.5f;
+  emitter.style = style;
+  return emitter;
+}
+
+// Short-lived particles drifting away from (x, y); move x and y to where the trail's
+// source is before each TR_ParticlesEmit
+static inline TR_ParticleEmitter TR_ParticleTrail(float x, float y, float rate, unsigned char style) {
+  TR_ParticleEmitter emitter;
+  memset(&emitter, 0, sizeof(emitter));
+  emitter.x = x;
+  emitter.y = y;
+  emitter.spread = 3.14159265f;
+  emitter.max_speed = 3.0f;
+  emitter.min_life = 0.3f;
+  emitter.max_life = 0.8f;
+  emitter.damping = 2.0f;
+  emitter.rate = rate;
+  emitter.style = style;
+  return emitter;
+}
+
+// Drops falling at about `speed` from anywhere along the line from (x, y) to (x + width, y),
+// living long enough to fall `height`
+static inline TR_ParticleEmitter TR_ParticleRain(float x, float y, float width, float height, float speed, float rate,
+                                                 unsigned char style) {
+  TR_ParticleEmitter emitter;
+  memset(&emitter, 0, sizeof(emitter));
+  emitter.x = x + width * 0.5f;
+  emitter.y = y;
+  emitter.width = width;
+  emitter.direction = 3.14159265f * 0.5f;
+  emitter.spread = 0.05f;
+  emitter.min_speed = speed * 0.8f;
+  emitter.max_speed = speed * 1.2f;
+  emitter.min_life = height / (speed * 1.2f);
+  emitter.max_life = height / (speed * 0.8f);
+  emitter.rate = rate;
+  emitter.style = style;
+  return emitter;
+}
+
+// Moves `count` particles and ages them. No branches, and the arrays are parameters so
+// GCC trusts restrict, which together let the loop vectorize.
+static inline void __tr_particles_integrate_arrays(float* restrict x, float* restrict y, float* restrict vx, float* restrict vy,
+                                                   const float* restrict ax, const float* restrict ay,
+                                                   const float* restrict damping, float* restrict age,
+                                                   const float* restrict age_rate, int count, float dt) {
+  for (int i = 0; i < count; i++) {
+    float keep = 1.0f - damping[i] * dt;
+    keep = (keep < 0.0f) ? 0.0f : keep;
+    float new_vx = (vx[i] + ax[i] * dt) * keep;
+    float new_vy = (vy[i] + ay[i] * dt) * keep;
+    vx[i] = new_vx;
+    vy[i] = new_vy;
+    x[i] += new_vx * dt;
+    y[i] += new_vy * dt;
+    age[i] += age_rate[i] * dt;
+  }
+}
+
+// Moves particles begin to end - 1 and ages them
+static inline void __tr_particles_integrate(TR_ParticlePool* pool, int begin, int end, float dt) {
+  __tr_particles_integrate_arrays(pool->x + begin, pool->y + begin, pool->vx + begin, pool->vy + begin, pool->ax + begin,
+                                  pool->ay + begin, pool->damping + begin, pool->age + begin, pool->age_rate + begin,
+                                  end - begin, dt);
+}
+
+typedef struct {
+  int begin;
+  int end;
+  float dt;
+} __TR_ParticleJob;
+
+typedef struct {
+  struct __TR_ParticleWorkers* workers;
+  int index; // Of the job it runs; job 0 is the calling thread's
+} __TR_ParticleWorkerArg;
+
+// Threads that each move a slice of the particles. They stay parked on `wake` between
+// updates, so an update doesn't pay for starting threads.
+struct __TR_ParticleWorkers {
+  TR_ParticlePool* pool;
+  int started; // Worker threads running, jobs 1 to started
+  int active;  // Jobs in this update, the caller's included
+  int step;    // Bumped to start an update
+  int busy;    // Workers still moving their slice
+  bool quit;
+  __TR_ParticleJob jobs[TR_PARTICLE_MAX_THREADS];
+  __TR_ParticleWorkerArg args[TR_PARTICLE_MAX_THREADS];
+#ifdef _WIN32
+  HANDLE threads[TR_PARTICLE_MAX_THREADS];
+  CRITICAL_SECTION lock;
+  CONDITION_VARIABLE wake;
+  CONDITION_VARIABLE done;
+#else
+  pthread_t threads[TR_PARTICLE_MAX_THREADS];
+  pthread_mutex_t lock;
+  pthread_cond_t wake;
+  pthread_cond_t done;
+#endif
+};
+
+#ifdef _WIN32
+  #define __TR_PARTICLES_LOCK(w) EnterCriticalSection(&(w)->lock)
+  #define __TR_PARTICLES_UNLOCK(w) LeaveCriticalSection(&(w)->lock)
+  #define __TR_PARTICLES_WAIT(w, cond) SleepConditionVariableCS(&(w)->cond, &(w)->lock, INFINITE)
+  #define __TR_PARTICLES_WAKE_ALL(w, cond) WakeAllConditionVariable(&(w)->cond)
+#else
+  #define __TR_PARTICLES_LOCK(w) pthread_mutex_lock(&(w)->lock)
+  #define __TR_PARTICLES_UNLOCK(w) pthread_mutex_unlock(&(w)->lock)
+  #define __TR_PARTICLES_WAIT(w, cond) pthread_cond_wait(&(w)->cond, &(w)->lock)
+  #define __TR_PARTICLES_WAKE_ALL(w, cond) pthread_cond_broadcast(&(w)->cond)
+#endif
+
+#ifdef _WIN32
+static DWORD WINAPI __tr_particles_worker(LPVOID param) {
+#else
+static void* __tr_particles_worker(void* param) {
+#endif
+  __TR_ParticleWorkerArg* arg = (__TR_ParticleWorkerArg*)param;
+  struct __TR_ParticleWorkers* workers = arg->workers;
+  int seen = 0;
+  __TR_PARTICLES_LOCK(workers);
+  for (;;) {
+    while (!workers->quit && workers->step == seen) __TR_PARTICLES_WAIT(workers, wake);
+    if (workers->quit) break;
+    seen = workers->step;
+    if (arg->index >= workers->active) continue; // Not needed for this update
+    __TR_ParticleJob job = workers->jobs[arg->index];
+    __TR_PARTICLES_UNLOCK(workers);
+    __tr_particles_integrate(workers->pool, job.begin, job.end, job.dt);
+    __TR_PARTICLES_LOCK(workers);
+    if (--workers->busy == 0) __TR_PARTICLES_WAKE_ALL(workers, done);
+  }
+  __TR_PARTICLES_UNLOCK(workers);
+  return 0;
+}
+
+// Makes sure `count` worker threads are running, starting the missing ones. Returns how
+// many are running, which is fewer if a thread couldn't be started.
+static inline int __tr_particles_start_workers(TR_ParticlePool* pool, int count) {
+  struct __TR_ParticleWorkers* workers = pool->workers;
+  if (workers == NULL) {
+    workers = (struct __TR_ParticleWorkers*)calloc(1, sizeof(struct __TR_ParticleWorkers));
+    if (workers == NULL) return 0;
+    workers->pool = pool;
+#ifdef _WIN32
+    InitializeCriticalSection(&workers->lock);
+    InitializeConditionVariable(&workers->wake);
+    InitializeConditionVariable(&workers->done);
+#else
+    pthread_mutex_init(&workers->lock, NULL);
+    pthread_cond_init(&workers->wake, NULL);
+    pthread_cond_init(&workers->done, NULL);
+#endif
+    pool->workers = workers;
+  }
+  while (workers->started < count) { // Safe without the lock: no update is running
+    int index = workers->started + 1;
+    workers->args[index].workers = workers;
+    workers->args[index].index = index;
+#ifdef _WIN32
+    workers->threads[index] = CreateThread(NULL, 0, __tr_particles_worker, &workers->args[index], 0, NULL);
+    if (workers->threads[index] == NULL) break;
+#else
+    if (pthread_create(&workers->threads[index], NULL, __tr_particles_worker, &workers->args[index]) != 0) break;
+#endif
+    workers->started++;
+  }
+  return (workers->started < count) ? workers->started : count;
+}
+
+// Stops and joins the worker threads (TR_ParticlePoolDestroy calls it)
+static inline void __tr_particles_stop_workers(TR_ParticlePool* pool) {
+  struct __TR_ParticleWorkers* workers = pool->workers;
+  if (workers == NULL) return;
+  __TR_PARTICLES_LOCK(workers);
+  workers->quit = true;
+  __TR_PARTICLES_WAKE_ALL(workers, wake);
+  __TR_PARTICLES_UNLOCK(workers);
+  for (int i = 1; i <= workers->started; i++) {
+#ifdef _WIN32
+    WaitForSingleObject(workers->threads[i], INFINITE);
+    CloseHandle(workers->threads[i]);
+#else
+    pthread_join(workers->threads[i], NULL);
+#endif
+  }
+#ifdef _WIN32
+  DeleteCriticalSection(&workers->lock);
+#else
+  pthread_mutex_destroy(&workers->lock);
+  pthread_cond_destroy(&workers->wake);
+  pthread_cond_destroy(&workers->done);
+#endif
+  free(workers);
+  pool->workers = NULL;
+}
+
+// Advances every particle by `dt` seconds and removes the ones that died. With `threads`
+// above 1 the movement is split across that many threads (the calling thread is one of
+// them), as long as each gets at least TR_PARTICLE_MIN_PER_THREAD particles.
+static inline void TR_ParticlesUpdate(TR_ParticlePool* pool, float dt, int threads) {
+  int count = pool->count;
+  if (threads > TR_PARTICLE_MAX_THREADS) threads = TR_PARTICLE_MAX_THREADS;
+  if (threads > count / TR_PARTICLE_MIN_PER_THREAD) threads = count / TR_PARTICLE_MIN_PER_THREAD;
+  if (threads > 1) threads = __tr_particles_start_workers(pool, threads - 1) + 1;
+  if (threads <= 1) {
+    __tr_particles_integrate(pool, 0, count, dt);
+  } else {
+    struct __TR_ParticleWorkers* workers = pool->workers;
+    int chunk = ((count + threads - 1) / threads + 15) & ~15; // Whole vectors per thread
+    __TR_PARTICLES_LOCK(workers);
+    for (int t = 0; t < threads; t++) {
+      workers->jobs[t].begin = (t * chunk < count) ? t * chunk : count;
+      workers->jobs[t].end = ((t + 1) * chunk < count) ? (t + 1) * chunk : count;
+      workers->jobs[t].dt = dt;
+    }
+    workers->active = threads;
+    workers->busy = threads - 1;
+    workers->step++;
+    __TR_PARTICLES_WAKE_ALL(workers, wake);
+    __TR_PARTICLES_UNLOCK(workers);
+    __tr_particles_integrate(pool, workers->jobs[0].begin, workers->jobs[0].end, dt);
+    __TR_PARTICLES_LOCK(workers);
+    while (workers->busy > 0) __TR_PARTICLES_WAIT(workers, done);
+    __TR_PARTICLES_UNLOCK(workers);
+  }
+
+  // Swap the last live particle into each dead one's place. The arrays are copied into
+  // locals so the stores below don't make the compiler reload them from the pool.
+  float* x = pool->x;
+  float* y = pool->y;
+  float* vx = pool->vx;
+  float* vy = pool->vy;
+  float* ax = pool->ax;
+  float* ay = pool->ay;
+  float* damping = pool->damping;
+  float* age = pool->age;
+  float* age_rate = pool->age_rate;
+  unsigned char* style = pool->style;
+  int i = 0;
+  while (i < count) {
+    if (age[i] < 1.0f) {
+      i++;
+      continue;
+    }
+    int last = --count;
+    x[i] = x[last];
+    y[i] = y[last];
+    vx[i] = vx[last];
+    vy[i] = vy[last];
+    ax[i] = ax[last];
+    ay[i] = ay[last];
+    damping[i] = damping[last];
+    age[i] = age[last];
+    age_rate[i] = age_rate[last];
+    style[i] = style[last];
+  }
+  pool->count = count;
+}
+
+// Clamps a view rectangle to the screen, moving the camera with its top left
+static inline bool __tr_particles_clip(int* x, int* y, int* width, int* height, float* camera_x, float* camera_y, float scale_y) {
+  if (!__tr_window_open) return false;
+  if (*x < 0) { *camera_x -= (float)*x; *width += *x; *x = 0; }
+  if (*y < 0) { *camera_y -= (float)*y * scale_y; *height += *y; *y = 0; }
+  if (*x + *width > __tr_buffer_width) *width = __tr_buffer_width - *x;
+  if (*y + *height > __tr_buffer_height) *height = __tr_buffer_height - *y;
+  return *width > 0 && *height > 0;
+}
+
+// Draws every particle in view as its style's glyph for its age, keeping the background.
+// The screen rectangle at (x, y) of width x height cells shows positions from
+// (camera_x, camera_y), one unit per cell.
+static inline void TR_ParticlesDraw(const TR_ParticlePool* pool, int x, int y, int width, int height,
+                                    float camera_x, float camera_y) {
+  if (!__tr_particles_clip(&x, &y, &width, &height, &camera_x, &camera_y, 1.0f)) return;
+  for (int i = 0; i < pool->count; i++) {
+    int cell_x = (int)floorf(pool->x[i] - camera_x);
+    int cell_y = (int)floorf(pool->y[i] - camera_y);
+    if ((unsigned int)cell_x >= (unsigned int)width || (unsigned int)cell_y >= (unsigned int)height) continue;
+    const TR_ParticleStyle* style = &pool->styles[pool->style[i]];
+    float age = pool->age[i];
+    int glyph = (int)(age * (float)style->num_glyphs);
+    int color = (int)(age * (float)style->num_colors);
+    __TR_Cell* cell = &__tr_screen_buffer[(y + cell_y) * __tr_buffer_width + x + cell_x];
+    cell->character = style->glyphs[(glyph < style->num_glyphs) ? glyph : style->num_glyphs - 1];
+    cell->fg_color = style->colors[(color < style->num_colors) ? color : style->num_colors - 1];
+  }
+}
+
+// Draws every particle in view as a half-block pixel in its style's color for its age.
+// Pixels are one unit wide and half a cell tall, so the screen rectangle at (x, y) of
+// width x height cells shows width x (height * 2) units from (camera_x, camera_y).
+static inline void TR_ParticlesDrawPixels(const TR_ParticlePool* pool, int x, int y, int width, int height,
+                                          float camera_x, float camera_y) {
+  if (!__tr_particles_clip(&x, &y, &width, &height, &camera_x, &camera_y, 2.0f)) return;
+  int pixel_height = height * 2;
+  for (int i = 0; i < pool->count; i++) {
+    int pixel_x = (int)floorf(pool->x[i] - camera_x);
+    int pixel_y = (int)floorf(pool->y[i] - camera_y);
+    if ((unsigned int)pixel_x >= (unsigned int)width || (unsigned int)pixel_y >= (unsigned int)pixel_height) continue;
+    const TR_ParticleStyle* style = &pool->styles[pool->style[i]];
+    int color = (int)(pool->age[i] * (float)style->num_colors);
+    __TR_Cell* cell = &__tr_screen_buffer[(y + (pixel_y >> 1)) * __tr_buffer_width + x + pixel_x];
+    if (cell->character != TR_GLYPH_UPPER_HALF) {
+      cell->character = TR_GLYPH_UPPER_HALF;
+      cell->fg_color = cell->bg_color;
+    }
+    Color pixel = style->colors[(color < style->num_colors) ? color : style->num_colors - 1];
+    if (pixel_y & 1) cell->bg_color = pixel;
+    else cell->fg_color = pixel;
+  }
+}
+
+#endif // TR_PARTICLES
+
+#ifdef TR_NET
+
+// --- Networking ---
+// Non-blocking message connections between processes on one machine (or a network), over
+// UNIX-domain sockets ("unix:/path/to/socket") or TCP ("host:port", e.g. "127.0.0.1:7777";
+// ":7777" listens on every interface). A message is a type byte and up to
+// TR_NET_MAX_MESSAGE bytes of payload, framed with a varint length. Sending only queues
+// the message; TR_NetFlush writes as much as the socket takes without blocking, so a
+// slow peer never stalls the caller (TR_NetPending shows one falling behind). Every
+// connection counts the bytes and messages it moves, for bandwidth figures. Windows
+// builds link -lws2_32 and only have TCP.
+
+#ifdef _WIN32
+  typedef SOCKET TR_Socket;
+  #define TR_NET_INVALID_SOCKET INVALID_SOCKET
+#else
+  #include <sys/socket.h>  // For socket, bind, listen, accept, connect, send, recv
+  #include <sys/un.h>      // For sockaddr_un
+  #include <netinet/in.h>  // For IPPROTO_TCP
+  #include <netinet/tcp.h> // For TCP_NODELAY
+  #include <netdb.h>       // For getaddrinfo
+  #include <poll.h>        // For poll
+  #include <sys/stat.h>    // For lstat, to check a UNIX-domain address is a socket before replacing it
+  typedef int TR_Socket;
+  #define TR_NET_INVALID_SOCKET (-1)
+#endif
+
+#define TR_NET_MAX_MESSAGE (1 << 24) // Largest payload, in bytes
+#define TR_NET_MAX_WAIT 1024         // Connections TR_NetWait watches at most
+#define TR_NET_READ_SIZE 65536       // Bytes asked of the socket per read
+
+typedef struct {
+  TR_Socket socket;
+  bool closed;            // The peer hung up, a read or write failed, or a bad frame arrived
+  unsigned char* in;      // Bytes received but not handed out yet, from in_start
+  int in_start;
+  int in_length;
+  int in_capacity;
+  unsigned char* out;     // Bytes queued but not written yet, from out_start
+  int out_start;
+  int out_length;
+  int out_capacity;
+  unsigned long long bytes_sent; // Written to the socket, framing included
+  unsigned long long bytes_received;
+  unsigned long long messages_sent; // Queued
+  unsigned long long messages_received;
+} TR_NetConn;
+
+// Writes `value` as a little-endian base-128 varint (1 to 5 bytes) and returns its length.
+static inline int TR_NetPutVarint(unsigned char* out, uint32_t value) {
+  int length = 0;
+  while (value >= 0x80) {
+    out[length++] = (unsigned char)(value | 0x80);
+    value >>= 7;
+  }
+  out[length++] = (unsigned char)value;
+  return length;
+}
+
+// Reads a varint at *p, moving *p past it. Returns false if it runs past `end` or is too long.
+static inline bool TR_NetGetVarint(const unsigned char** p, const unsigned char* end, uint32_t* value) {
+  uint32_t result = 0;
+  for (int shift = 0; shift < 35; shift += 7) {
+    if (*p >= end) return false;
+    unsigned char byte = *(*p)++;
+    result |= (uint32_t)(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      *value = result;
+      return true;
+    }
+  }
+  return false;
+}
+
+static inline bool __tr_net_startup() {
+#ifdef _WIN32
+  static bool started = false;
+  if (!started) {
+    WSADATA data;
+    if (WSAStartup(MAKEWORD(2, 2), &data) != 0) return false;
+    started = true;
+  }
+#endif
+  return true;
+}
+
+static inline void __tr_net_close_socket(TR_Socket socket_fd) {
+#ifdef _WIN32
+  closesocket(socket_fd);
+#else
+  close(socket_fd);
+#endif
+}
+
+static inline bool __tr_net_set_nonblocking(TR_Socket socket_fd) {
+#ifdef _WIN32
+  u_long enabled = 1;
+  return ioctlsocket(socket_fd, FIONBIO, &enabled) == 0;
+#else
+  int flags = fcntl(socket_fd, F_GETFL, 0);
+  return flags >= 0 && fcntl(socket_fd, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+// True if the last socket call failed only because it would have had to wait
+static inline bool __tr_net_would_block() {
+#ifdef _WIN32
+  int error = WSAGetLastError();
+  return error == WSAEWOULDBLOCK || error == WSAEINTR;
+#else
+  return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
+// Turns an address into a socket address. `listening` makes an empty host mean every interface
+// (instead of this machine).
+static inline bool __tr_net_resolve(const char* address, bool listening, struct sockaddr_storage* result, socklen_t* length, int* family) {
+  memset(result, 0, sizeof(*result));
+  if (strncmp(address, "unix:", 5) == 0) {
+#ifdef _WIN32
+    return false;
+#else
+    struct sockaddr_un* unix_address = (struct sockaddr_un*)result;
+    const char* path = address + 5;
+    if (path[0] == '\0' || strlen(path) >= sizeof(unix_address->sun_path)) return false;
+    unix_address->sun_family = AF_UNIX;
+    strcpy(unix_address->sun_path, path);
+    *length = (socklen_t)sizeof(*unix_address);
+    *family = AF_UNIX;
+    return true;
+#endif
+  }
+
+  const char* colon = strrchr(address, ':');
+  if (colon == NULL || colon[1] == '\0') return false;
+  char host[256];
+  size_t host_length = (size_t)(colon - address);
+  if (host_length >= sizeof(host)) return false;
+  memcpy(host, address, host_length);
+  host[host_length] = '\0';
+
+  struct addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  if (listening) hints.ai_flags = AI_PASSIVE;
+  struct addrinfo* found = NULL;
+  const char* node = (host_length > 0) ? host : (listening ? NULL : "127.0.0.1");
+  if (getaddrinfo(node, colon + 1, &hints, &found) != 0 || found == NULL) return false;
+  memcpy(result, found->ai_addr, found->ai_addrlen);
+  *length = (socklen_t)found->ai_addrlen;
+  *family = found->ai_family;
+  freeaddrinfo(found);
+  return true;
+}
+
+// Makes room for `extra` more bytes after the `length` kept ones, moving them to the front of
+// the buffer or growing it. Returns false if it can't.
+static inline bool __tr_net_reserve(unsigned char** buffer, int* start, int length, int* capacity, int extra) {
+  if (extra > INT32_MAX / 2 - length) return false;
+  if (*start + length + extra <= *capacity) return true;
+  if (*start > 0) {
+    memmove(*buffer, *buffer + *start, (size_t)length);
+    *start = 0;
+    if (length + extra <= *capacity) return true;
+  }
+  int new_capacity = (*capacity > 0) ? *capacity : 4096;
+  while (new_capacity < length + extra) new_capacity *= 2;
+  unsigned char* grown = (unsigned char*)realloc(*buffer, (size_t)new_capacity);
+  if (grown == NULL) return false;
+  *buffer = grown;
+  *capacity = new_capacity;
+  return true;
+}
+
+static inline TR_NetConn* __tr_net_wrap(TR_Socket socket_fd, int family) {
+  TR_NetConn* conn = (TR_NetConn*)calloc(1, sizeof(TR_NetConn));
+  if (conn == NULL || !__tr_net_set_nonblocking(socket_fd)) {
+    free(conn);
+    __tr_net_close_socket(socket_fd);
+    return NULL;
+  }
+  conn->socket = socket_fd;
+  if (family != AF_UNIX) {
+    int enabled = 1; // Small messages go out at once instead of waiting to be batched
+    setsockopt(socket_fd, IPPROTO_TCP, TCP_NODELAY, (const char*)&enabled, sizeof(enabled));
+  }
+#ifdef SO_NOSIGPIPE
+  int enabled = 1; // Where send has no MSG_NOSIGNAL, a closed peer must not raise SIGPIPE
+  setsockopt(socket_fd, SOL_SOCKET, SO_NOSIGPIPE, &enabled, sizeof(enabled));
+#endif
+  return conn;
+}
+
+// Starts listening at `address`. Returns TR_NET_INVALID_SOCKET on failure, including when
+// another process is already listening there. A socket file left behind by a process that
+// exited without TR_NetCloseListener is replaced; any other file at a UNIX-domain address is
+// left alone and the call fails.
+static inline TR_Socket TR_NetListen(const char* address) {
+  struct sockaddr_storage socket_address;
+  socklen_t length;
+  int family;
+  if (!__tr_net_startup() || !__tr_net_resolve(address, true, &socket_address, &length, &family)) return TR_NET_INVALID_SOCKET;
+  TR_Socket listener = socket(family, SOCK_STREAM, 0);
+  if (listener == TR_NET_INVALID_SOCKET) return TR_NET_INVALID_SOCKET;
+
+#ifndef _WIN32
+  const char* path = ((struct sockaddr_un*)&socket_address)->sun_path;
+  struct stat path_stat;
+  if (family == AF_UNIX && lstat(path, &path_stat) == 0) {
+    // Only a socket nobody answers on is stale; someone serving there, or a file that
+    // isn't a socket at all, makes the address unusable
+    if (!S_ISSOCK(path_stat.st_mode) || connect(listener, (struct sockaddr*)&socket_address, length) == 0 ||
+        errno != ECONNREFUSED) {
+      __tr_net_close_socket(listener);
+      return TR_NET_INVALID_SOCKET;
+    }
+    __tr_net_close_socket(listener);
+    unlink(path);
+    listener = socket(family, SOCK_STREAM, 0);
+    if (listener == TR_NET_INVALID_SOCKET) return TR_NET_INVALID_SOCKET;
+  }
+#endif
+  if (family != AF_UNIX) {
+    int enabled = 1; // Restarting a server doesn't have to wait for old connections to time out
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, (const char*)&enabled, sizeof(enabled));
+  }
+  if (bind(listener, (struct sockaddr*)&socket_address, length) != 0 || listen(listener, 512) != 0 ||
+      !__tr_net_set_nonblocking(listener)) {
+    __tr_net_close_socket(listener);
+    return TR_NET_INVALID_SOCKET;
+  }
+  return listener;
+}
+
+// Stops listening, removing the socket file of a UNIX-domain address.
+static inline void TR_NetCloseListener(TR_Socket listener, const char* address) {
+  if (listener == TR_NET_INVALID_SOCKET) return;
+  __tr_net_close_socket(listener);
+#ifndef _WIN32
+  if (strncmp(address, "unix:", 5) == 0) unlink(address + 5);
+#else
+  (void)address;
+#endif
+}
+
+// Accepts one waiting connection. Returns NULL if none is waiting.
+static inline TR_NetConn* TR_NetAccept(TR_Socket listener) {
+  struct sockaddr_storage peer;
+  socklen_t length = (socklen_t)sizeof(peer);
+  TR_Socket socket_fd = accept(listener, (struct sockaddr*)&peer, &length);
+  if (socket_fd == TR_NET_INVALID_SOCKET) return NULL;
+  return __tr_net_wrap(socket_fd, peer.ss_family);
+}
+
+// Connects to `address`, waiting until the connection is made or refused. Returns NULL on failure.
+static inline TR_NetConn* TR_NetConnect(const char* address) {
+  struct sockaddr_storage socket_address;
+  socklen_t length;
+  int family;
+  if (!__tr_net_startup() || !__tr_net_resolve(address, false, &socket_address, &length, &family)) return NULL;
+  TR_Socket socket_fd = socket(family, SOCK_STREAM, 0);
+  if (socket_fd == TR_NET_INVALID_SOCKET) return NULL;
+  if (connect(socket_fd, (struct sockaddr*)&socket_address, length) != 0) {
+    __tr_net_close_socket(socket_fd);
+    return NULL;
+  }
+  return __tr_net_wrap(socket_fd, family);
+}
+
+// Closes the connection without flushing and frees it (NULL is fine).
+static inline void TR_NetClose(TR_NetConn* conn) {
+  if (conn == NULL) return;
+  __tr_net_close_socket(conn->socket);
+  free(conn->in);
+  free(conn->out);
+  free(conn);
+}
+
+// Queues a message. Returns false if the connection is closed or the message is too big.
+static inline bool TR_NetSend(TR_NetConn* conn, unsigned char type, const void* data, int length) {
+  if (conn->closed || length < 0 || length > TR_NET_MAX_MESSAGE) return false;
+  if (!__tr_net_reserve(&conn->out, &conn->out_start, conn->out_length, &conn->out_capacity, length + 6)) {
+    conn->closed = true;
+    return false;
+  }
+  unsigned char* frame = conn->out + conn->out_start + conn->out_length;
+  int header = TR_NetPutVarint(frame, (uint32_t)length);
+  frame[header++] = type;
+  if (length > 0) memcpy(frame + header, data, (size_t)length);
+  conn->out_length += header + length;
+  conn->messages_sent++;
+  return true;
+}
+
+// Writes queued messages until the socket would block. Returns false once the connection is closed.
+static inline bool TR_NetFlush(TR_NetConn* conn) {
+#ifdef MSG_NOSIGNAL
+  const int flags = MSG_NOSIGNAL; // A closed peer is reported as an error, not SIGPIPE
+#else
+  const int flags = 0;
+#endif
+  while (conn->out_length > 0 && !conn->closed) {
+    int chunk = (conn->out_length < (1 << 30)) ? conn->out_length : (1 << 30);
+    long written = (long)send(conn->socket, (const char*)conn->out + conn->out_start, chunk, flags);
+    if (written > 0) {
+      conn->out_start += (int)written;
+      conn->out_length -= (int)written;
+      conn->bytes_sent += (unsigned long long)written;
+    } else if (written < 0 && __tr_net_would_block()) {
+      break;
+    } else {
+      conn->closed = true;
+    }
+  }
+  if (conn->out_length == 0) conn->out_start = 0;
+  return !conn->closed;
+}
+
+// Bytes queued but not written yet.
+static inline int TR_NetPending(const TR_NetConn* conn) {
+  return conn->out_length;
+}
+
+// Hands out the next complete message, reading from the socket as needed without blocking.
+// `data` stays valid until the next call for this connection. Returns false if no whole
+// message has arrived yet (or the connection is closed; check conn->closed).
+static inline bool TR_NetReceive(TR_NetConn* conn, unsigned char* type, const unsigned char** data, int* length) {
+  for (;;) {
+    const unsigned char* start = conn->in + conn->in_start;
+    const unsigned char* p = start;
+    const unsigned char* end = start + conn->in_length;
+    uint32_t payload;
+    if (conn->in_length > 0 && TR_NetGetVarint(&p, end, &payload)) {
+      if (payload > TR_NET_MAX_MESSAGE) {
+        conn->closed = true;
+        return false;
+      }
+      if (end - p >= (long)payload + 1) {
+        *type = p[0];
+        *data = p + 1;
+        *length = (int)payload;
+        int frame = (int)(p + 1 + payload - start);
+        conn->in_start += frame;
+        conn->in_length -= frame;
+        if (conn->in_length == 0) conn->in_start = 0;
+        conn->messages_received++;
+        return true;
+      }
+    } else if (conn->in_length >= 5) { // A varint this long is corrupt
+      conn->closed = true;
+      return false;
+    }
+
+    if (conn->closed) return false;
+    if (!__tr_net_reserve(&conn->in, &conn->in_start, conn->in_length, &conn->in_capacity, TR_NET_READ_SIZE)) {
+      conn->closed = true;
+      return false;
+    }
+    long got = (long)recv(conn->socket, (char*)conn->in + conn->in_start + conn->in_length, TR_NET_READ_SIZE, 0);
+    if (got > 0) {
+      conn->in_length += (int)got;
+      conn->bytes_received += (unsigned long long)got;
+    } else {
+      if (got == 0 || !__tr_net_would_block()) conn->closed = true;
+      return false;
+    }
+  }
+}
+
+// Waits up to `timeout_ms` (0 to just check, -1 forever) until the listener has a connection
+// waiting or one of the connections has something to read or room to write its queued bytes.
+// Either may be left out (TR_NET_INVALID_SOCKET, NULL entries). Returns false on timeout.
+static inline bool TR_NetWait(TR_Socket listener, TR_NetConn* const* conns, int count, int timeout_ms) {
+#ifdef _WIN32
+  WSAPOLLFD fds[TR_NET_MAX_WAIT + 1];
+#else
+  struct pollfd fds[TR_NET_MAX_WAIT + 1];
+#endif
+  int num_fds = 0;
+  if (listener != TR_NET_INVALID_SOCKET) {
+    fds[num_fds].fd = listener;
+    fds[num_fds].events = POLLIN;
+    fds[num_fds++].revents = 0;
+  }
+  for (int i = 0; i < count && num_fds <= TR_NET_MAX_WAIT; i++) {
+    if (conns[i] == NULL || conns[i]->closed) continue;
+    fds[num_fds].fd = conns[i]->socket;
+    fds[num_fds].events = (short)(POLLIN | (conns[i]->out_length > 0 ? POLLOUT : 0));
+    fds[num_fds++].revents = 0;
+  }
+#ifdef _WIN32
+  if (num_fds == 0) {
+    Sleep((DWORD)(timeout_ms > 0 ? timeout_ms : 0));
+    return false;
+  }
+  return WSAPoll(fds, (ULONG)num_fds, timeout_ms) > 0;
+#else
+  return poll(fds, (nfds_t)num_fds, timeout_ms) > 0;
+#endif
+}
+
+#endif // TR_NET
+
+#ifdef TR_STREAM
+
+// --- Frame Streaming ---
+// Serves the app's frames to any number of viewer processes (see tread-view) at a TR_NET
+// address, so one dashboard can be watched from several terminals. Start it with
+// TR_StreamStart, or set TREAD_STREAM to an address before TR_InitWindow. Each viewer
+// says what colors its terminal has and how big it is, and keeps its own copy of the last
+// frame it was sent: it gets only the cells that changed since then, encoded for its
+// terminal, with cursor moves only where changed cells aren't side by side and colors only
+// when they change. A viewer still taking in its previous frame skips frames instead of
+// making the app wait; its copy stays as it was, so the next frame it gets catches it up.
+
+#define TR_STREAM_COLORS_NONE 0 // Characters only
+#define TR_STREAM_COLORS_8 1    // The 8 ANSI colors and their bright versions, as tread.h draws them
+#define TR_STREAM_COLORS_256 2  // The xterm 256-color cube
+#define TR_STREAM_COLORS_TRUE 3 // 24-bit color
+
+#define TR_STREAM_MSG_HELLO 1  // Viewer: color mode, columns, rows (varints)
+#define TR_STREAM_MSG_SIZE 2   // Viewer: its terminal's new columns and rows
+#define TR_STREAM_MSG_OUTPUT 3 // App: bytes to write to the viewer's terminal as they are
+
+typedef struct {
+  int viewers;
+  unsigned long long frames_sent;    // Counted per viewer
+  unsigned long long frames_skipped; // Frames a slow viewer caught up on in a later one
+  unsigned long long bytes_sent;
+} TR_StreamStats;
+
+typedef struct {
+  TR_NetConn* conn;
+  int colors;          // -1 until the viewer's hello arrives
+  int width;           // The viewer's terminal
+  int height;
+  __TR_Cell* previous; // What the viewer's terminal shows, in app coordinates
+  bool synced;         // False until `previous` holds a frame the viewer was sent
+} __TR_StreamViewer;
+
+static TR_Socket __tr_stream_listener = TR_NET_INVALID_SOCKET;
+static char __tr_stream_address[256];
+static __TR_StreamViewer* __tr_stream_viewers = NULL;
+static int __tr_stream_num_viewers = 0;
+static int __tr_stream_viewer_capacity = 0;
+static unsigned char* __tr_stream_out = NULL; // One viewer's encoded frame
+static int __tr_stream_out_length = 0;
+static int __tr_stream_out_capacity = 0;
+static TR_StreamStats __tr_stream_stats = {0};
+static unsigned long long __tr_stream_closed_bytes = 0; // Sent to viewers that have gone
+
+// Starts serving frames at `address` (see TR_NET). Returns false if it can't listen there.
+static inline bool TR_StreamStart(const char* address) {
+  if (__tr_stream_listener != TR_NET_INVALID_SOCKET || strlen(address) >= sizeof(__tr_stream_address)) return false;
+  __tr_stream_listener = TR_NetListen(address);
+  if (__tr_stream_listener == TR_NET_INVALID_SOCKET) return false;
+  strcpy(__tr_stream_address, address);
+  return true;
+}
+
+static inline void __tr_stream_drop_viewer(int index) {
+  __TR_StreamViewer* viewer = &__tr_stream_viewers[index];
+  __tr_stream_closed_bytes += viewer->conn->bytes_sent;
+  TR_NetClose(viewer->conn);
+  free(viewer->previous);
+  *viewer = __tr_stream_viewers[--__tr_stream_num_viewers];
+}
+
+// Disconnects every viewer and stops listening (TR_CloseWindow calls it).
+static inline void TR_StreamStop() {
+  while (__tr_stream_num_viewers > 0) __tr_stream_drop_viewer(__tr_stream_num_viewers - 1);
+  free(__tr_stream_viewers);
+  free(__tr_stream_out);
+  __tr_stream_viewers = NULL;
+  __tr_stream_out = NULL;
+  __tr_stream_viewer_capacity = 0;
+  __tr_stream_out_capacity = 0;
+  if (__tr_stream_listener != TR_NET_INVALID_SOCKET) TR_NetCloseListener(__tr_stream_listener, __tr_stream_address);
+  __tr_stream_listener = TR_NET_INVALID_SOCKET;
+}
+
+static inline TR_StreamStats TR_GetStreamStats() {
+  TR_StreamStats stats = __tr_stream_stats;
+  stats.viewers = __tr_stream_num_viewers;
+  stats.bytes_sent = __tr_stream_closed_bytes;
+  for (int i = 0; i < __tr_stream_num_viewers; i++) stats.bytes_sent += __tr_stream_viewers[i].conn->bytes_sent;
+  return stats;
+}
+
+static inline void __tr_stream_check_env() {
+  static bool checked = false;
+  if (checked) return;
+  checked = true;
+  const char* address = getenv("TREAD_STREAM");
+  if (address == NULL || address[0] == '\0') return;
+  if (!TR_StreamStart(address)) fprintf(stderr, "TREAD WARNING: Could not serve frames at '%s'.\n", address);
+}
+
+// A color as the viewer's terminal will get it, so cells that look the same there compare equal
+static inline int __tr_stream_color_key(int colors, Color color, bool is_background) {
+  switch (colors) {
+    case TR_STREAM_COLORS_8: // 0-15: bright (+8) when a channel is above 128, as __tr_set_terminal_color does
+      return __tr_map_color_to_terminal(color, is_background) + ((color.r > 128 || color.g > 128 || color.b > 128) ? 8 : 0);
+    case TR_STREAM_COLORS_256: return 16 + 36 * ((color.r * 5 + 127) / 255) + 6 * ((color.g * 5 + 127) / 255) + (color.b * 5 + 127) / 255;
+    case TR_STREAM_COLORS_TRUE: return (color.r << 16) | (color.g << 8) | color.b;
+    default: return 0;
+  }
+}
+
+static inline void __tr_stream_put(const char* data, int length) {
+  memcpy(__tr_stream_out + __tr_stream_out_length, data, (size_t)length);
+  __tr_stream_out_length += length;
+}
+
+static inline void __tr_stream_put_color(int colors, int key, bool is_background) {
+  char text[24];
+  int length;
+  if (colors == TR_STREAM_COLORS_8) length = snprintf(text, sizeof(text), "%d", (is_background ? 40 : 30) + (key & 7) + ((key & 8) ? 60 : 0));
+  else if (colors == TR_STREAM_COLORS_256) length = snprintf(text, sizeof(text), "%d;5;%d", is_background ? 48 : 38, key);
+  else length = snprintf(text, sizeof(text), "%d;2;%d;%d;%d", is_background ? 48 : 38, (key >> 16) & 0xFF, (key >> 8) & 0xFF, key & 0xFF);
+  __tr_stream_put(text, length);
+}
+
+// Encodes the cells that changed since the viewer's last frame into __tr_stream_out
+static inline bool __tr_stream_encode(__TR_StreamViewer* viewer) {
+  int width = (__tr_buffer_width < viewer->width) ? __tr_buffer_width : viewer->width;
+  int height = (__tr_buffer_height < viewer->height) ? __tr_buffer_height : viewer->height;
+  // At most a cursor move, two colors and a glyph per cell, plus the clear
+  int start = 0;
+  if (!__tr_net_reserve(&__tr_stream_out, &start, 0, &__tr_stream_out_capacity, width * height * 64 + 64)) return false;
+  __tr_stream_out_length = 0;
+  if (!viewer->synced) __tr_stream_put("\x1b[0m\x1b[2J", 8);
+
+  int cursor_x = -1;
+  int cursor_y = -1;
+  int fg_key = -1;
+  int bg_key = -1;
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      int index = y * __tr_buffer_width + x;
+      __TR_Cell cell = __tr_screen_buffer[index];
+      __TR_Cell* previous = &viewer->previous[index];
+      if (viewer->synced && cell.character == previous->character && __tr_colors_equal(cell.fg_color, previous->fg_color) &&
+          __tr_colors_equal(cell.bg_color, previous->bg_color) && (cell.character != TR_GLYPH_BRAILLE || cell.dots == previous->dots)) {
+        continue;
+      }
+      *previous = cell;
+
+      if (x != cursor_x || y != cursor_y) {
+        char move[24];
+        __tr_stream_put(move, snprintf(move, sizeof(move), "\x1b[%d;%dH", y + 1, x + 1));
+      }
+      if (viewer->colors != TR_STREAM_COLORS_NONE) {
+        int fg = __tr_stream_color_key(viewer->colors, cell.fg_color, false);
+        int bg = __tr_stream_color_key(viewer->colors, cell.bg_color, true);
+        if (fg != fg_key || bg != bg_key) {
+          __tr_stream_put("\x1b[", 2);
+          __tr_stream_put_color(viewer->colors, fg, false);
+          __tr_stream_put(";", 1);
+          __tr_stream_put_color(viewer->colors, bg, true);
+          __tr_stream_put("m", 1);
+          fg_key = fg;
+          bg_key = bg;
+        }
+      }
+      if (cell.character == TR_GLYPH_UPPER_HALF) {
+        __tr_stream_put("\xE2\x96\x80", 3);
+      } else if (cell.character == TR_GLYPH_BRAILLE) {
+        char braille[3] = { (char)0xE2, (char)(0xA0 | (cell.dots >> 6)), (char)(0x80 | (cell.dots & 0x3F)) };
+        __tr_stream_put(braille, 3);
+      } else {
+        __tr_stream_put(&cell.character, 1);
+      }
+      cursor_x = x + 1;
+      cursor_y = y;
+    }
+  }
+  viewer->synced = true;
+  return true;
+}
+
+// Reads a viewer's hello and size changes. Returns false if it should be dropped.
+static inline bool __tr_stream_read_viewer(__TR_StreamViewer* viewer) {
+  unsigned char type;
+  const unsigned char* data;
+  int length;
+  while (TR_NetReceive(viewer->conn, &type, &data, &length)) {
+    const unsigned char* p = data;
+    const unsigned char* end = data + length;
+    uint32_t colors = (uint32_t)viewer->colors;
+    uint32_t width;
+    uint32_t height;
+    if (type == TR_STREAM_MSG_HELLO && !TR_NetGetVarint(&p, end, &colors)) return false;
+    if ((type != TR_STREAM_MSG_HELLO && type != TR_STREAM_MSG_SIZE) || colors > TR_STREAM_COLORS_TRUE ||
+        !TR_NetGetVarint(&p, end, &width) || !TR_NetGetVarint(&p, end, &height)) {
+      return false;
+    }
+    viewer->colors = (int)colors;
+    viewer->width = (width < 10000) ? (int)width : 10000;
+    viewer->height = (height < 10000) ? (int)height : 10000;
+    viewer->synced = false; // A new (or resized) terminal starts blank
+  }
+  return !viewer->conn->closed;
+}
+
+// Called by TR_EndDrawing: takes in new viewers and sends each one this frame, unless it's
+// still taking in an earlier one
+static inline void __tr_stream_frame() {
+  if (__tr_stream_listener == TR_NET_INVALID_SOCKET) return;
+  TR_NetConn* conn;
+  while ((conn = TR_NetAccept(__tr_stream_listener)) != NULL) {
+    if (__tr_stream_num_viewers == __tr_stream_viewer_capacity) {
+      int capacity = (__tr_stream_viewer_capacity > 0) ? __tr_stream_viewer_capacity * 2 : 4;
+      __TR_StreamViewer* viewers = (__TR_StreamViewer*)realloc(__tr_stream_viewers, sizeof(__TR_StreamViewer) * capacity);
+      if (viewers == NULL) {
+        TR_NetClose(conn);
+        break;
+      }
+      __tr_stream_viewers = viewers;
+      __tr_stream_viewer_capacity = capacity;
+    }
+    __TR_StreamViewer* viewer = &__tr_stream_viewers[__tr_stream_num_viewers++];
+    memset(viewer, 0, sizeof(*viewer));
+    viewer->conn = conn;
+    viewer->colors = -1;
+  }
+
+  for (int i = 0; i < __tr_stream_num_viewers; i++) {
+    __TR_StreamViewer* viewer = &__tr_stream_viewers[i];
+    if (!__tr_stream_read_viewer(viewer) || !TR_NetFlush(viewer->conn)) {
+      __tr_stream_drop_viewer(i--);
+      continue;
+    }
+    if (viewer->colors < 0) continue;
+    if (TR_NetPending(viewer->conn) > 0) { // Still taking in an earlier frame
+      __tr_stream_stats.frames_skipped++;
+      continue;
+    }
+    if (viewer->previous == NULL) {
+      viewer->previous = (__TR_Cell*)malloc(sizeof(__TR_Cell) * __tr_buffer_width * __tr_buffer_height);
+      if (viewer->previous == NULL) {
+        __tr_stream_drop_viewer(i--);
+        continue;
+      }
+    }
+    if (!__tr_stream_encode(viewer)) continue;
+    __tr_stream_stats.frames_sent++;
+    if (__tr_stream_out_length == 0) continue; // Nothing changed for this viewer
+    if (!TR_NetSend(viewer->conn, TR_STREAM_MSG_OUTPUT, __tr_stream_out, __tr_stream_out_length) || !TR_NetFlush(viewer->conn)) {
+      __tr_stream_drop_viewer(i--);
+    }
+  }
+}
+
+#endif // TR_STREAM
+
+#ifdef TR_INSPECT
+
+// --- Live Inspector ---
+// Publishes the app's frame statistics, the timings of its last TR_INSPECT_TIMINGS frames
+// and its screen into a named shared-memory segment after every TR_EndDrawing, for a tool
+// like tread-top to watch without stopping or slowing the app. Start it with
+// TR_InspectStart, or set TREAD_INSPECT to a name before TR_InitWindow. Publishing is a
+// copy of the screen and a few counters; it happens after the frame is timed, and how long
+// it took is published too. The segment is guarded by a sequence lock: the app makes the
+// sequence odd, writes, and makes it even again, and a reader retries any copy that
+// overlapped a write, so the app never waits for readers. On Linux the segment shows up as
+// /dev/shm/tread-<name>; glibc before 2.34 needs -lrt.
+
+#include <stdatomic.h> // For the sequence lock
+#include <stdint.h>    // For uint32_t, int64_t
+#include <ctype.h>     // For isalnum
+#ifndef _WIN32
+  #include <sys/mman.h> // For shm_open, mmap
+  #include <sys/stat.h> // For fstat
+  #include <fcntl.h>    // For O_CREAT, O_EXCL
+#endif
+
+#define TR_INSPECT_MAGIC 0x4E495254u // "TRIN"
+#define TR_INSPECT_VERSION 1
+#define TR_INSPECT_TIMINGS 256 // Frame times kept (a power of two)
+#define TR_INSPECT_NAME_SIZE 64
+#define __TR_INSPECT_CELLS_OFFSET ((sizeof(TR_InspectHeader) + 63) & ~(size_t)63)
+
+// The start of the segment; the screen's cells follow at __TR_INSPECT_CELLS_OFFSET
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t header_size; // sizeof(TR_InspectHeader) and sizeof(__TR_Cell) in the app, so a reader
+  uint32_t cell_size;   // built differently can tell it can't read the segment
+  int32_t width;        // Of the screen
+  int32_t height;
+  int64_t pid;
+  char name[TR_INSPECT_NAME_SIZE];
+  atomic_uint sequence; // Odd while the app is writing
+  atomic_uint closed;   // Set when the app stops publishing
+  // Everything below is written under the sequence lock
+  long long updated_ns; // __tr_get_time_ns() when the last frame was published
+  long long publish_ns; // How long publishing the previous frame took
+  TR_FrameStats stats;
+  float frame_ms[TR_INSPECT_TIMINGS]; // Frame N's time is at N % TR_INSPECT_TIMINGS (counting from 0)
+} TR_InspectHeader;
+
+// A read-only view of another process's segment
+typedef struct {
+  const TR_InspectHeader* header;
+  size_t size;
+#ifdef _WIN32
+  HANDLE mapping;
+#endif
+} TR_Inspector;
+
+static TR_InspectHeader* __tr_inspect_header = NULL;
+static size_t __tr_inspect_size = 0;
+static char __tr_inspect_name[TR_INSPECT_NAME_SIZE];
+#ifdef _WIN32
+static HANDLE __tr_inspect_mapping = NULL;
+#endif
+
+// Segment names are kept to letters, digits, '-', '_' and '.', as the OS name is built from them
+static inline bool __tr_inspect_segment_name(const char* name, char* out, size_t size) {
+  size_t length = strlen(name);
+  if (length == 0 || length >= TR_INSPECT_NAME_SIZE) return false;
+  for (size_t i = 0; i < length; i++) {
+    char c = name[i];
+    if (!isalnum((unsigned char)c) && c != '-' && c != '_' && c != '.') return false;
+  }
+#ifdef _WIN32
+  snprintf(out, size, "Local\\tread-%s", name);
+#else
+  snprintf(out, size, "/tread-%s", name);
+#endif
+  return true;
+}
+
+static inline bool __tr_inspect_process_alive(int64_t pid) {
+#ifdef _WIN32
+  HANDLE process = OpenProcess(PROCESS_QUERY_INFORMATION, FALSE, (DWORD)pid);
+  if (process == NULL) return false;
+  DWORD code = 0;
+  bool alive = GetExitCodeProcess(process, &code) && code == STILL_ACTIVE;
+  CloseHandle(process);
+  return alive;
+#else
+  return kill((pid_t)pid, 0) == 0 || errno == EPERM;
+#endif
+}
+
+#ifndef _WIN32
+// Removes a segment left behind by an app that died without closing its window. Returns
+// false if the segment belongs to an app that's still running.
+static inline bool __tr_inspect_remove_stale(const char* segment) {
+  int fd = shm_open(segment, O_RDONLY, 0);
+  if (fd < 0) return errno == ENOENT;
+  struct stat st;
+  bool stale = true;
+  if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(TR_InspectHeader)) {
+    TR_InspectHeader* header = (TR_InspectHeader*)mmap(NULL, sizeof(TR_InspectHeader), PROT_READ, MAP_SHARED, fd, 0);
+    if (header != MAP_FAILED) {
+      stale = header->magic != TR_INSPECT_MAGIC || atomic_load(&header->closed) || !__tr_inspect_process_alive(header->pid);
+      munmap(header, sizeof(TR_InspectHeader));
+    }
+  }
+  close(fd);
+  return stale && (shm_unlink(segment) == 0 || errno == ENOENT);
+}
+#endif
+
+// Starts publishing under `name` (letters, digits, '-', '_' and '.'). Call it after
+// TR_InitWindow. Returns false if another running app already publishes under that name.
+static inline bool TR_InspectStart(const char* name) {
+  char segment[TR_INSPECT_NAME_SIZE + 16];
+  if (!__tr_window_open || __tr_inspect_header != NULL || !__tr_inspect_segment_name(name, segment, sizeof(segment))) return false;
+  size_t size = __TR_INSPECT_CELLS_OFFSET + sizeof(__TR_Cell) * (size_t)__tr_buffer_width * (size_t)__tr_buffer_height;
+
+#ifdef _WIN32
+  HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, (DWORD)((unsigned long long)size >> 32), (DWORD)size, segment);
+  if (mapping == NULL) return false;
+  if (GetLastError() == ERROR_ALREADY_EXISTS) { // Mappings go away with their last handle, so its app is running
+    CloseHandle(mapping);
+    return false;
+  }
+  void* data = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size);
+  if (data == NULL) {
+    CloseHandle(mapping);
+    return false;
+  }
+  __tr_inspect_mapping = mapping;
+  int64_t pid = (int64_t)GetCurrentProcessId();
+#else
+  int fd = shm_open(segment, O_RDWR | O_CREAT | O_EXCL, 0644);
+  if (fd < 0 && errno == EEXIST && __tr_inspect_remove_stale(segment)) fd = shm_open(segment, O_RDWR | O_CREAT | O_EXCL, 0644);
+  if (fd < 0) return false;
+  void* data = MAP_FAILED;
+  if (ftruncate(fd, (off_t)size) == 0) data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    shm_unlink(segment);
+    return false;
+  }
+  int64_t pid = (int64_t)getpid();
+#endif
+
+  TR_InspectHeader* header = (TR_InspectHeader*)data;
+  memset(header, 0, __TR_INSPECT_CELLS_OFFSET);
+  header->header_size = (uint32_t)sizeof(TR_InspectHeader);
+  header->cell_size = (uint32_t)sizeof(__TR_Cell);
+  header->width = __tr_buffer_width;
+  header->height = __tr_buffer_height;
+  header->pid = pid;
+  strcpy(header->name, name);
+  header->version = TR_INSPECT_VERSION;
+  atomic_thread_fence(memory_order_release);
+  header->magic = TR_INSPECT_MAGIC; // Last, so a reader never sees a half-made header as valid
+  __tr_inspect_header = header;
+  __tr_inspect_size = size;
+  strcpy(__tr_inspect_name, segment);
+  return true;
+}
+
+// Stops publishing and removes the segment (TR_CloseWindow calls it). Attached readers see
+// it as closed.
+static inline void TR_InspectStop() {
+  if (__tr_inspect_header == NULL) return;
+  atomic_store(&__tr_inspect_header->closed, 1u);
+#ifdef _WIN32
+  UnmapViewOfFile(__tr_inspect_header);
+  CloseHandle(__tr_inspect_mapping);
+  __tr_inspect_mapping = NULL;
+#else
+  munmap(__tr_inspect_header, __tr_inspect_size);
+  shm_unlink(__tr_inspect_name);
+#endif
+  __tr_inspect_header = NULL;
+}
+
+static inline void __tr_inspect_check_env() {
+  const char* name = getenv("TREAD_INSPECT");
+  if (name == NULL || name[0] == '\0') return;
+  if (!TR_InspectStart(name)) fprintf(stderr, "TREAD WARNING: Could not publish to the inspector as '%s'.\n", name);
+}
+
+// Called by TR_EndDrawing with the frame's time: publishes the frame
+static inline void __tr_inspect_frame(double frame_ms) {
+  TR_InspectHeader* header = __tr_inspect_header;
+  if (header == NULL) return;
+  long long start_ns = __tr_get_time_ns();
+  unsigned int sequence = atomic_load_explicit(&header->sequence, memory_order_relaxed);
+  atomic_store_explicit(&header->sequence, sequence + 1, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release); // The odd sequence is visible before any of the writes
+
+  header->frame_ms[(__tr_frame_stats.frames - 1) & (TR_INSPECT_TIMINGS - 1)] = (float)frame_ms;
+  header->stats = __tr_frame_stats;
+  header->updated_ns = start_ns;
+  memcpy((unsigned char*)header + __TR_INSPECT_CELLS_OFFSET, __tr_screen_buffer, sizeof(__TR_Cell) * __tr_buffer_width * __tr_buffer_height);
+
+  atomic_store_explicit(&header->sequence, sequence + 2, memory_order_release);
+  header->publish_ns = __tr_get_time_ns() - start_ns; // Read with the next frame
+}
+
+static inline void TR_InspectDetach(TR_Inspector* inspector) {
+  if (inspector == NULL) return;
+#ifdef _WIN32
+  UnmapViewOfFile((void*)inspector->header);
+  CloseHandle(inspector->mapping);
+#else
+  munmap((void*)inspector->header, inspector->size);
+#endif
+  free(inspector);
+}
+
+// Attaches read-only to the segment an app publishes as `name`. Returns NULL if there is
+// none, or if it was written by a build of tread.h this one can't read.
+static inline TR_Inspector* TR_InspectAttach(const char* name) {
+  char segment[TR_INSPECT_NAME_SIZE + 16];
+  if (!__tr_inspect_segment_name(name, segment, sizeof(segment))) return NULL;
+  TR_Inspector* inspector = (TR_Inspector*)calloc(1, sizeof(TR_Inspector));
+  if (inspector == NULL) return NULL;
+
+#ifdef _WIN32
+  inspector->mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, segment);
+  if (inspector->mapping == NULL) {
+    free(inspector);
+    return NULL;
+  }
+  void* data = MapViewOfFile(inspector->mapping, FILE_MAP_READ, 0, 0, 0);
+  if (data == NULL) {
+    CloseHandle(inspector->mapping);
+    free(inspector);
+    return NULL;
+  }
+  MEMORY_BASIC_INFORMATION info; // The view's size, rounded up to whole pages
+  size_t size = (VirtualQuery(data, &info, sizeof(info)) != 0) ? info.RegionSize : 0;
+#else
+  int fd = shm_open(segment, O_RDONLY, 0);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0 || (size_t)st.st_size < __TR_INSPECT_CELLS_OFFSET) {
+    if (fd >= 0) close(fd);
+    free(inspector);
+    return NULL;
+  }
+  size_t size = (size_t)st.st_size;
+  void* data = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    free(inspector);
+    return NULL;
+  }
+#endif
+
+  inspector->header = (const TR_InspectHeader*)data;
+  inspector->size = size;
+  const TR_InspectHeader* header = inspector->header;
+  bool valid = header->magic == TR_INSPECT_MAGIC;
+  atomic_thread_fence(memory_order_acquire);
+  valid = valid && header->version == TR_INSPECT_VERSION && header->header_size == sizeof(TR_InspectHeader) &&
+          header->cell_size == sizeof(__TR_Cell) && header->width > 0 && header->height > 0 &&
+          __TR_INSPECT_CELLS_OFFSET + sizeof(__TR_Cell) * (size_t)header->width * (size_t)header->height <= size;
+  if (!valid) {
+    TR_InspectDetach(inspector);
+    return NULL;
+  }
+  return inspector;
+}
+
+// Copies a consistent snapshot of the header and (if `cells` isn't NULL) the width * height
+// cells of the screen. Returns false if the app kept writing through every try.
+static inline bool TR_InspectRead(const TR_Inspector* inspector, TR_InspectHeader* header, __TR_Cell* cells) {
+  const TR_InspectHeader* shared = inspector->header;
+  size_t cells_size = sizeof(__TR_Cell) * (size_t)shared->width * (size_t)shared->height;
+  for (int attempt = 0; attempt < 1000; attempt++) {
+    unsigned int before = atomic_load_explicit(&((TR_InspectHeader*)shared)->sequence, memory_order_acquire);
+    if (before & 1) continue; // Mid-write
+    memcpy(header, (const void*)shared, sizeof(TR_InspectHeader));
+    if (cells != NULL) memcpy(cells, (const unsigned char*)shared + __TR_INSPECT_CELLS_OFFSET, cells_size);
+    atomic_thread_fence(memory_order_acquire);
+    if (atomic_load_explicit(&((TR_InspectHeader*)shared)->sequence, memory_order_relaxed) == before) return true;
+  }
+  return false;
+}
+
+// Whether the app behind a snapshot is still publishing: it hasn't closed its window, and
+// (if it died without doing so) its process is still running
+static inline bool TR_InspectAlive(const TR_InspectHeader* header) {
+  return !atomic_load(&((TR_InspectHeader*)header)->closed) && __tr_inspect_process_alive(header->pid);
+}
+
+#endif // TR_INSPECT
+
 #endif // TREAD_H